@@ -0,0 +1,74 @@
+/**
+ * Tests that the statistics collected by 'analyze' on the primary are used by the planner of a
+ * secondary, and that the secondary picks up the statistics refreshed by a later 'analyze'.
+ *
+ * @tags: [
+ *   requires_replication,
+ * ]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getWinningPlan, getPlanStage and getRejectedPlans.
+
+const rst = new ReplSetTest({
+    nodes: 2,
+    nodeOptions: {setParameter: {internalQueryPlannerStatisticsPreFilterMinWorks: 0}}
+});
+rst.startSet();
+rst.initiate();
+
+const primaryDb = rst.getPrimary().getDB("test");
+const secondary = rst.getSecondary();
+secondary.setSecondaryOk();
+const secondaryColl = secondary.getDB("test").analyze_statistics_on_secondaries;
+const coll = primaryDb.analyze_statistics_on_secondaries;
+
+const filter = {
+    a: 5,
+    b: {$gt: 0},
+    c: 1
+};
+
+// Only the value 5 of 'a' is rare, so that the index of 'a' is the only candidate left once the
+// planner knows the statistics of every field.
+const docs = [];
+for (let i = 0; i < 2000; ++i) {
+    docs.push({_id: i, a: i === 0 ? 5 : (i % 2 ? 1 : 10), b: 1 + (i % 2), c: 1 + (i % 2)});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}, {c: 1}]));
+
+function analyze() {
+    for (let key of ["a", "b", "c"]) {
+        assert.commandWorked(primaryDb.runCommand({analyze: coll.getName(), key: key}));
+    }
+    rst.awaitReplication();
+}
+
+// The statistics are loaded in the background, so the first queries may plan without them.
+function assertOnlyCandidateOnSecondary(keyPattern) {
+    assert.soon(() => {
+        const explain = secondaryColl.find(filter).explain();
+        const ixscan = getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN");
+        return getRejectedPlans(explain).length === 0 && ixscan !== null &&
+            bsonWoCompare(ixscan.keyPattern, keyPattern) === 0;
+    }, () => tojson(secondaryColl.find(filter).explain()));
+}
+
+// Without statistics, every index is a candidate.
+rst.awaitReplication();
+assert.eq(2, getRejectedPlans(secondaryColl.find(filter).explain()).length);
+
+analyze();
+assertOnlyCandidateOnSecondary({a: 1});
+
+// Make 'a' unselective and the value 1 of 'c' rare instead. The secondary drops its cached
+// statistics when it applies the writes to the statistics collection.
+assert.commandWorked(coll.updateMany({}, {$set: {a: 5, c: 2}}));
+assert.commandWorked(coll.updateOne({_id: 0}, {$set: {c: 1}}));
+analyze();
+assertOnlyCandidateOnSecondary({c: 1});
+
+rst.stopSet();
+})();
@@ -0,0 +1,81 @@
+/**
+ * Tests that the filter of an SBE collection scan is evaluated block-at-a-time when
+ * 'internalQuerySlotBasedExecutionBlockSize' is set, and that block mode returns the same documents
+ * as row mode, including for values the block-wise comparisons cannot decide on their own.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+// Yield on every document, so that the plans are saved and restored in the middle of a block.
+const conn = MongoRunner.runMongod({setParameter: {internalQueryExecYieldIterations: 1}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+if (!checkSBEEnabled(testDb)) {
+    jsTestLog("Skipping test because SBE is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDb.sbe_block_mode;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 100; ++i) {
+    docs.push({_id: i, a: i % 10, b: i});
+}
+docs.push({_id: 100, a: NaN, b: 1});
+docs.push({_id: 101, a: [1, 7], b: 2});
+docs.push({_id: 102, a: "7", b: 3});
+docs.push({_id: 103, b: 4});
+docs.push({_id: 104, a: null, b: 5});
+docs.push({_id: 105, a: NumberDecimal("7.5"), b: 6});
+docs.push({_id: 106, a: {c: 7}, b: 7});
+assert.commandWorked(coll.insert(docs));
+
+function setBlockSize(blockSize) {
+    assert.commandWorked(testDb.adminCommand(
+        {setParameter: 1, internalQuerySlotBasedExecutionBlockSize: blockSize}));
+}
+
+// Sort in the shell, as a sort on '_id' could make the planner scan the '_id' index.
+function runQuery(filter) {
+    return coll.find(filter).toArray().sort((lhs, rhs) => lhs._id - rhs._id);
+}
+
+function usesBlockMode(filter) {
+    const explain = coll.find(filter).explain();
+    return explain.queryPlanner.winningPlan.slotBasedPlan.stages.includes("blockToRow");
+}
+
+const blockFilters = [
+    {a: 7},
+    {a: {$gt: 6}},
+    {a: {$gte: 7}},
+    {a: {$gt: 2}, b: {$gte: 50}},
+    {a: {$gte: 7}, b: {$lt: 20}},
+];
+const rowFilters = [
+    {a: {$lt: 3}},
+    {a: {$gt: "6"}},
+    {a: {$gt: NaN}},
+    {"a.c": 7},
+    {$or: [{a: 1}, {b: 2}]},
+];
+
+for (let filter of blockFilters.concat(rowFilters)) {
+    setBlockSize(0);
+    const expected = runQuery(filter);
+    assert(!usesBlockMode(filter), filter);
+
+    for (let blockSize of [1, 7, 1024]) {
+        setBlockSize(blockSize);
+        assert.eq(expected, runQuery(filter), {filter, blockSize});
+        assert.eq(blockFilters.includes(filter), usesBlockMode(filter), {filter, blockSize});
+    }
+}
+
+MongoRunner.stopMongod(conn);
+}());
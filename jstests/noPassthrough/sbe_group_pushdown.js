@@ -0,0 +1,124 @@
+/**
+ * Tests that a $group at the front of a pipeline is pushed down into the slot-based execution
+ * engine, that it is computed from index keys without fetching the documents when an index covers
+ * it, and that the pushed-down $group returns the same results as the classic engine, including
+ * for null and missing values and when the hash table spills to disk.
+ */
+(function() {
+"use strict";
+
+load("jstests/aggregation/extras/utils.js");  // For arrayEq.
+load("jstests/libs/analyze_plan.js");         // For getPlanStages.
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        featureFlagSBEGroupAndLookup: true,
+        internalQueryEnableSlotBasedExecutionEngine: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.sbe_group_pushdown;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 200; ++i) {
+    docs.push({_id: i, a: i % 7, b: i % 3, c: i});
+}
+docs.push({_id: 200, a: null, b: 1, c: 1});
+docs.push({_id: 201, b: 1, c: 2});
+docs.push({_id: 202, a: null, c: 3});
+docs.push({_id: 203, c: 4});
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, c: 1}));
+
+function setSbeEnabled(enabled) {
+    assert.commandWorked(testDb.adminCommand(
+        {setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: enabled}));
+}
+
+function runPipeline(pipeline, options = {}) {
+    return coll.aggregate(pipeline, options).toArray();
+}
+
+// Returns the winning plan of the query layer, whether or not the pipeline was absorbed entirely.
+function getQueryLayerPlan(pipeline) {
+    const explain = coll.explain().aggregate(pipeline);
+    return explain.hasOwnProperty("stages") ? explain.stages[0].$cursor.queryPlanner.winningPlan
+                                            : explain.queryPlanner.winningPlan;
+}
+
+// Returns whether the slot-based plan holds a stage of the given name. A "seek" stage fetches the
+// documents, and an "sgroup" stage is a streaming aggregation.
+function hasSbeStage(plan, stageName) {
+    return new RegExp("\\b" + stageName + "\\b").test(plan.slotBasedPlan.stages);
+}
+
+function assertSameResultsAsClassic(pipeline, options = {}) {
+    setSbeEnabled(false);
+    const expected = runPipeline(pipeline, options);
+    setSbeEnabled(true);
+    const actual = runPipeline(pipeline, options);
+    assert(arrayEq(expected, actual), {pipeline, expected, actual});
+}
+
+// A missing '_id' groups along with null, whereas a missing field of a compound '_id' is left out.
+const pipelines = [
+    [{$group: {_id: "$a", count: {$sum: 1}, total: {$sum: "$c"}}}],
+    [{$group: {_id: {a: "$a", b: "$b"}, count: {$sum: 1}}}],
+    [{$group: {_id: "$b", lo: {$min: "$a"}, hi: {$max: "$a"}, avg: {$avg: "$c"}}}],
+    [{$group: {_id: "$b", all: {$push: "$a"}, set: {$addToSet: "$a"}}}],
+    [{$match: {a: {$gte: 2}}}, {$group: {_id: "$a", lo: {$min: "$c"}, total: {$sum: "$c"}}}],
+    [{$group: {_id: "$a", count: {$sum: 1}}}, {$group: {_id: "$count", n: {$sum: 1}}}],
+];
+for (let pipeline of pipelines) {
+    assertSameResultsAsClassic(pipeline);
+
+    const plan = getQueryLayerPlan(pipeline);
+    assert.neq(0, getPlanStages(plan.queryPlan, "GROUP").length, plan);
+    assert(hasSbeStage(plan, "group") || hasSbeStage(plan, "sgroup"), plan);
+}
+
+// A $group reading only fields of the index is computed from the index keys. It streams over the
+// keys when the index is ordered by the group-by field.
+const coveredPipeline = [{$match: {a: {$gte: 2}}}, {$group: {_id: "$a", total: {$sum: "$c"}}}];
+assertSameResultsAsClassic(coveredPipeline);
+let plan = getQueryLayerPlan(coveredPipeline);
+assert.neq(0, getPlanStages(plan.queryPlan, "IXSCAN").length, plan);
+assert(hasSbeStage(plan, "sgroup"), plan);
+assert(!hasSbeStage(plan, "seek"), plan);
+
+// Grouping by the second field of the index needs a hash table, but still no fetch.
+const unorderedPipeline = [{$match: {a: {$gte: 2}}}, {$group: {_id: "$c", lo: {$min: "$a"}}}];
+assertSameResultsAsClassic(unorderedPipeline);
+plan = getQueryLayerPlan(unorderedPipeline);
+assert(!hasSbeStage(plan, "sgroup"), plan);
+assert(!hasSbeStage(plan, "seek"), plan);
+
+// The $push reads a field the index does not hold, so the documents are fetched.
+const fetchingPipeline = [{$match: {a: {$gte: 2}}}, {$group: {_id: "$a", all: {$push: "$b"}}}];
+assertSameResultsAsClassic(fetchingPipeline);
+plan = getQueryLayerPlan(fetchingPipeline);
+assert(hasSbeStage(plan, "seek"), plan);
+
+// The hash table spills to disk and combines the partial aggregates once they are read back.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionHashAggApproxMemoryUseInBytesBeforeSpill: 1}));
+for (let pipeline of [
+         [{$group: {_id: "$c", count: {$sum: 1}, lo: {$min: "$a"}, hi: {$max: "$b"}}}],
+         [{$group: {_id: "$b", avg: {$avg: "$c"}, total: {$sum: "$c"}}}],
+]) {
+    assertSameResultsAsClassic(pipeline, {allowDiskUse: true});
+}
+
+// A $group which cannot combine its partial aggregates is left to the classic $group when it may
+// spill.
+const pushPipeline = [{$group: {_id: "$c", all: {$push: "$a"}}}];
+assertSameResultsAsClassic(pushPipeline, {allowDiskUse: true});
+const explain = coll.explain().aggregate(pushPipeline, {allowDiskUse: true});
+assert.eq(0, getPlanStages(getWinningPlan(explain.stages[0].$cursor.queryPlanner), "GROUP").length,
+          explain);
+
+MongoRunner.stopMongod(conn);
+}());
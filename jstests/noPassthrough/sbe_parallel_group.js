@@ -0,0 +1,92 @@
+/**
+ * Tests that a $group over a collection scan split across exchange producers returns the same
+ * results as the same $group computed by a single thread, including when the hash tables spill to
+ * disk.
+ * @tags: [requires_majority_read_concern, requires_replication]
+ */
+(function() {
+"use strict";
+
+load("jstests/aggregation/extras/utils.js");  // For arrayEq.
+
+const rst = new ReplSetTest({
+    nodes: 1,
+    nodeOptions: {
+        setParameter: {
+            featureFlagSBEGroupAndLookup: true,
+            internalQueryEnableSlotBasedExecutionEngine: true,
+            internalQuerySlotBasedExecutionParallelScanMinRecords: 0,
+        }
+    }
+});
+rst.startSet();
+rst.initiate();
+
+const testDb = rst.getPrimary().getDB("test");
+const coll = testDb.sbe_parallel_group;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({_id: i, a: i % 13, b: i % 5, c: i, d: (i % 3 === 0) ? null : i % 11});
+}
+docs.push({_id: 1000, b: 1, c: 1});
+assert.commandWorked(coll.insert(docs));
+
+function setDegreeOfParallelism(degreeOfParallelism) {
+    assert.commandWorked(testDb.adminCommand({
+        setParameter: 1,
+        internalQuerySlotBasedExecutionMaxDegreeOfParallelism: degreeOfParallelism
+    }));
+}
+
+// A parallel scan needs a read timestamp for every producer to read the same snapshot.
+const readConcern = {level: "majority"};
+
+function runPipeline(pipeline, options) {
+    return coll.aggregate(pipeline, Object.assign({readConcern}, options)).toArray();
+}
+
+// Returns whether the $group was split across the producers of an exchange.
+function isParallel(pipeline, options) {
+    const explain = assert.commandWorked(testDb.runCommand({
+        explain: Object.assign({aggregate: coll.getName(), pipeline, cursor: {}}, options),
+        readConcern
+    }));
+    const plan = explain.hasOwnProperty("stages") ? explain.stages[0].$cursor.queryPlanner
+                                                  : explain.queryPlanner;
+    return /\bexchange\b/.test(plan.winningPlan.slotBasedPlan.stages);
+}
+
+function assertSameResultsAsSerial(pipeline, options = {}) {
+    setDegreeOfParallelism(1);
+    const expected = runPipeline(pipeline, options);
+    setDegreeOfParallelism(4);
+    assert(isParallel(pipeline, options), pipeline);
+    const actual = runPipeline(pipeline, options);
+    assert(arrayEq(expected, actual), {pipeline, expected, actual});
+}
+
+const pipelines = [
+    [{$group: {_id: "$a", count: {$sum: 1}, total: {$sum: "$c"}}}],
+    [{$group: {_id: {a: "$a", b: "$b"}, lo: {$min: "$d"}, hi: {$max: "$d"}}}],
+    [{$group: {_id: "$b", avg: {$avg: "$c"}, avgD: {$avg: "$d"}, total: {$sum: "$d"}}}],
+    [{$match: {b: {$ne: 2}}}, {$group: {_id: "$d", count: {$sum: 1}, lo: {$min: "$c"}}}],
+];
+for (let pipeline of pipelines) {
+    assertSameResultsAsSerial(pipeline);
+}
+
+// Every producer spills its own hash table, and so does the merging hash table above them.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionHashAggApproxMemoryUseInBytesBeforeSpill: 1}));
+for (let pipeline of pipelines) {
+    assertSameResultsAsSerial(pipeline, {allowDiskUse: true});
+}
+
+// An accumulator which cannot combine partial aggregates keeps the $group in a single thread.
+setDegreeOfParallelism(4);
+assert(!isParallel([{$group: {_id: "$a", all: {$push: "$c"}}}], {}));
+
+rst.stopSet();
+}());
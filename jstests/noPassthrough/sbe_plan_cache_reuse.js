@@ -0,0 +1,91 @@
+/**
+ * Tests that a plan cached in the SBE plan cache is reused for queries which only differ in their
+ * literals and index bounds, returning the same documents as a freshly built plan, and that the
+ * cached plans of a collection are discarded by 'planCacheClear', index drops and collection drops.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+const conn = MongoRunner.runMongod({setParameter: {featureFlagSbePlanCache: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+if (!checkSBEEnabled(testDb)) {
+    jsTestLog("Skipping test because SBE is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDb.sbe_plan_cache_reuse;
+const docs = [];
+for (let i = 0; i < 200; ++i) {
+    docs.push({_id: i, a: i, b: i % 20});
+}
+
+function setUpCollection() {
+    coll.drop();
+    assert.commandWorked(coll.insert(docs));
+    assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}]));
+}
+
+// Every query scans a different range of the 'a' index and filters on a different 'b' value, so
+// that a reused plan must be rebound to both new index bounds and a new literal.
+let nextLo = 0;
+function runQuery() {
+    const lo = (nextLo++ * 10) % 190;
+    const bMin = lo % 7;
+    const expected = docs.filter(doc => doc.a >= lo && doc.a < lo + 10 && doc.b > bMin);
+    const actual = coll.find({a: {$gte: lo, $lt: lo + 10}, b: {$gt: bMin}}).toArray();
+    assert.sameMembers(expected, actual, {lo, bMin});
+}
+
+function sbePlanCacheLookups() {
+    const metrics = testDb.serverStatus().metrics.query.sbePlanCache;
+    return {hits: metrics.hits, misses: metrics.misses};
+}
+
+// The SBE plan cache is only looked up once the classic plan cache holds an active entry for the
+// query. Runs the query until it looks up the SBE plan cache, and returns whether a plan was found.
+function runUntilSbePlanCacheLookup() {
+    for (let i = 0; i < 10; ++i) {
+        const before = sbePlanCacheLookups();
+        runQuery();
+        const after = sbePlanCacheLookups();
+        if (after.hits + after.misses > before.hits + before.misses) {
+            return after.hits > before.hits;
+        }
+    }
+    assert(false, "the query never looked up the SBE plan cache");
+}
+
+setUpCollection();
+
+// The first lookup compiles and caches the plan, which later queries reuse.
+assert(!runUntilSbePlanCacheLookup());
+for (let i = 0; i < 5; ++i) {
+    assert(runUntilSbePlanCacheLookup());
+}
+
+assert.commandWorked(testDb.runCommand({planCacheClear: coll.getName()}));
+assert(!runUntilSbePlanCacheLookup());
+assert(runUntilSbePlanCacheLookup());
+
+// Clearing a single query shape removes the SBE plans of the whole collection.
+assert.commandWorked(testDb.runCommand({planCacheClear: coll.getName(), query: {a: 1, b: 1}}));
+assert(!runUntilSbePlanCacheLookup());
+assert(runUntilSbePlanCacheLookup());
+
+// The index is re-created under the same name, which appears in the key of the cached plan.
+assert.commandWorked(coll.dropIndex({b: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+assert(!runUntilSbePlanCacheLookup());
+assert(runUntilSbePlanCacheLookup());
+
+setUpCollection();
+assert(!runUntilSbePlanCacheLookup());
+assert(runUntilSbePlanCacheLookup());
+
+MongoRunner.stopMongod(conn);
+}());
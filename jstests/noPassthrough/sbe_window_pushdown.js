@@ -0,0 +1,109 @@
+/**
+ * Tests that a $setWindowFields at the front of a pipeline is pushed down into the slot-based
+ * execution engine, and that it returns the same results as the classic engine.
+ */
+(function() {
+"use strict";
+
+load("jstests/aggregation/extras/utils.js");  // For arrayEq.
+load("jstests/libs/analyze_plan.js");         // For getPlanStages.
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        featureFlagSBEGroupAndLookup: true,
+        internalQueryEnableSlotBasedExecutionEngine: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.sbe_window_pushdown;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 100; ++i) {
+    docs.push({_id: i, p: i % 4, t: i, v: (i * 7) % 11});
+}
+docs.push({_id: 100, p: null, t: 1, v: 3});
+docs.push({_id: 101, t: 2, v: 4});
+docs.push({_id: 102, p: null, t: 3, v: null});
+assert.commandWorked(coll.insert(docs));
+
+function setSbeEnabled(enabled) {
+    assert.commandWorked(testDb.adminCommand(
+        {setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: enabled}));
+}
+
+function assertSameResultsAsClassic(pipeline, options = {}) {
+    setSbeEnabled(false);
+    const expected = coll.aggregate(pipeline, options).toArray();
+    setSbeEnabled(true);
+    const actual = coll.aggregate(pipeline, options).toArray();
+    assert(arrayEq(expected, actual), {pipeline, expected, actual});
+}
+
+// Returns the winning plan of the query layer, whether or not the pipeline was absorbed entirely.
+function getQueryLayerPlan(pipeline, options = {}) {
+    const explain = coll.explain().aggregate(pipeline, options);
+    return explain.hasOwnProperty("stages") ? explain.stages[0].$cursor.queryPlanner.winningPlan
+                                            : explain.queryPlanner.winningPlan;
+}
+
+// Returns whether the slot-based plan holds a stage of the given name.
+function hasSbeStage(plan, stageName) {
+    return plan.hasOwnProperty("slotBasedPlan") &&
+        new RegExp("\\b" + stageName + "\\b").test(plan.slotBasedPlan.stages);
+}
+
+const pipelines = [
+    [{
+        $setWindowFields: {
+            partitionBy: "$p",
+            sortBy: {t: 1},
+            output: {
+                sum: {$sum: "$v", window: {documents: [-2, 2]}},
+                avg: {$avg: "$v", window: {documents: ["unbounded", "current"]}},
+                min: {$min: "$v", window: {documents: [-3, 0]}},
+                max: {$max: "$v"},
+                prev: {$shift: {output: "$v", by: -1, default: "none"}},
+            }
+        }
+    }],
+    [{
+        $setWindowFields: {
+            sortBy: {t: 1},
+            output: {
+                rate: {$derivative: {input: "$t"}, window: {documents: [-1, 0]}},
+                area: {$integral: {input: "$t"}, window: {documents: [-5, 0]}},
+            }
+        }
+    }],
+    [
+        {$match: {v: {$gte: 3}}},
+        {$setWindowFields: {partitionBy: "$p", sortBy: {t: -1}, output: {n: {$sum: 1}}}},
+        {$match: {n: {$gt: 2}}},
+    ],
+];
+for (let pipeline of pipelines) {
+    assertSameResultsAsClassic(pipeline);
+
+    const plan = getQueryLayerPlan(pipeline);
+    assert.neq(0, getPlanStages(plan.queryPlan, "WINDOW").length, plan);
+    assert(hasSbeStage(plan, "window"), plan);
+}
+
+// A window function the slot-based engine does not implement, a range-based window, and a stage
+// which may spill to disk are all left to the classic engine.
+const rangeWindow = {$sum: "$v", window: {range: [-2, 0]}};
+for (let [pipeline, options] of [
+         [[{$setWindowFields: {sortBy: {t: 1}, output: {r: {$rank: {}}}}}], {}],
+         [[{$setWindowFields: {sortBy: {t: 1}, output: {s: rangeWindow}}}], {}],
+         [[{$setWindowFields: {sortBy: {t: 1}, output: {s: {$sum: "$v"}}}}], {allowDiskUse: true}],
+]) {
+    assertSameResultsAsClassic(pipeline, options);
+    const plan = getQueryLayerPlan(pipeline, options);
+    assert(!hasSbeStage(plan, "window"), plan);
+}
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,72 @@
+/**
+ * Tests that a query which does not constrain the leading field of a compound index skip scans it
+ * when the statistics collected by 'analyze' show that this field has few distinct values and that
+ * the query is selective on the next field, and that it returns the same documents as a collection
+ * scan.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getWinningPlan, getPlanStage and getRejectedPlans.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.skip_scan;
+
+const docs = [];
+for (let i = 0; i < 3000; ++i) {
+    docs.push({_id: i, a: i % 3, b: i});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+for (let key of ["a", "b"]) {
+    assert.commandWorked(testDb.runCommand({analyze: coll.getName(), key: key}));
+}
+
+function assertSameResultsAsCollscan(filter) {
+    assert.sameMembers(coll.find(filter).hint({$natural: 1}).toArray(),
+                       coll.find(filter).toArray());
+}
+
+// The statistics are loaded in the background, so the first queries may plan without them.
+const selectiveFilter = {
+    b: {$in: [5, 2500]}
+};
+assert.soon(() => {
+    const explain = coll.find(selectiveFilter).explain("executionStats");
+    const ixscan = getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN");
+    if (ixscan === null) {
+        return false;
+    }
+    assert.eq({a: 1, b: 1}, ixscan.keyPattern, explain);
+    assert.eq({a: ["[MinKey, MaxKey]"], b: ["[5.0, 5.0]", "[2500.0, 2500.0]"]},
+              ixscan.indexBounds,
+              explain);
+
+    // The scan seeks from one value of 'a' to the next, rather than examining every key.
+    assert.eq(2, explain.executionStats.nReturned, explain);
+    assert.lte(explain.executionStats.totalKeysExamined, 20, explain);
+    return true;
+});
+assertSameResultsAsCollscan(selectiveFilter);
+
+// A skip scan which would examine most of the index is not considered, and the collection scan is
+// the only candidate.
+const unselectiveFilter = {
+    b: {$gte: 100}
+};
+const explain = coll.find(unselectiveFilter).explain();
+assert.neq(null, getPlanStage(getWinningPlan(explain.queryPlanner), "COLLSCAN"), explain);
+assert.eq(0, getRejectedPlans(explain).length, explain);
+assertSameResultsAsCollscan(unselectiveFilter);
+
+// Without statistics on 'b', the skip scan and the collection scan are both candidates.
+assert.commandWorked(
+    testDb.getCollection("system.statistics." + coll.getName()).deleteOne({_id: "b"}));
+assert.soon(() => getRejectedPlans(coll.find(unselectiveFilter).explain()).length === 1);
+assertSameResultsAsCollscan(unselectiveFilter);
+
+MongoRunner.stopMongod(conn);
+})();
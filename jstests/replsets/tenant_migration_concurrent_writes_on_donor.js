@@ -545,6 +545,7 @@ const testCases = {
             assert(!collectionExists(db, collName + "Out"));
         }
     },
+    analyze: {skip: isNotWriteCommand},
     appendOplogNote: {skip: isNotRunOnUserDatabase},
     applyOps: {skip: isNotSupportedInServerless},
     authenticate: {skip: isAuthCommand},
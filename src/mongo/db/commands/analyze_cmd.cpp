@@ -0,0 +1,227 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclient_cursor.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/analyze_gen.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/pipeline/aggregate_command_gen.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/scalar_histogram.h"
+#include "mongo/db/query/stats_catalog.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Builds a histogram over the values of 'field' in the collection 'nss', which contains
+ * 'numRecords' documents. Array values contribute one value per element, like they do to the
+ * keys of an index, and missing values are counted as null.
+ */
+ScalarHistogram buildHistogram(OperationContext* opCtx,
+                               const NamespaceString& nss,
+                               long long numRecords,
+                               const std::string& field,
+                               long long numberBuckets) {
+    std::vector<BSONObj> pipeline;
+    const long long sampleSize = internalQueryAnalyzeSampleSize.load();
+    const bool sampled = numRecords > sampleSize;
+    if (sampled) {
+        pipeline.push_back(BSON("$sample" << BSON("size" << sampleSize)));
+    }
+    pipeline.push_back(BSON("$project" << BSON("_id" << 0 << "v"
+                                                      << "$" + field)));
+    pipeline.push_back(BSON("$unwind" << BSON("path"
+                                              << "$v"
+                                              << "preserveNullAndEmptyArrays" << true)));
+    pipeline.push_back(BSON("$group" << BSON("_id"
+                                             << "$v"
+                                             << "n" << BSON("$sum" << 1))));
+    pipeline.push_back(BSON("$sort" << BSON("_id" << 1)));
+
+    AggregateCommandRequest aggRequest(nss, std::move(pipeline));
+    aggRequest.setAllowDiskUse(true);
+
+    DBDirectClient client(opCtx);
+    auto cursor = uassertStatusOK(DBClientCursor::fromAggregationRequest(
+        &client, std::move(aggRequest), false /* secondaryOk */, false /* useExhaust */));
+
+    // Counts measured on a sample are scaled up to the size of the collection.
+    const double scale = sampled ? static_cast<double>(numRecords) / sampleSize : 1.0;
+    std::vector<BSONObj> groups;
+    std::vector<std::pair<BSONElement, double>> values;
+    while (cursor->more()) {
+        groups.push_back(cursor->nextSafe().getOwned());
+    }
+    values.reserve(groups.size());
+    for (auto&& group : groups) {
+        values.emplace_back(group["_id"], group["n"].numberDouble() * scale);
+    }
+    return ScalarHistogram::make(values, numberBuckets);
+}
+
+/**
+ * Returns the previously analyzed fields of the collection with UUID 'collectionUUID' whose
+ * statistics were collected when the number of documents in the collection differed from
+ * 'numRecords' by more than the staleness ratio.
+ */
+std::vector<std::string> getStaleFields(OperationContext* opCtx,
+                                        const NamespaceString& statsNss,
+                                        const UUID& collectionUUID,
+                                        long long numRecords) {
+    const double stalenessRatio = internalQueryAnalyzeStalenessRatio.load();
+    std::vector<std::string> fields;
+
+    DBDirectClient client(opCtx);
+    auto cursor =
+        client.query(statsNss, BSON(StatsCatalog::kCollectionUUIDFieldName << collectionUUID));
+    while (cursor && cursor->more()) {
+        auto doc = cursor->nextSafe();
+        const auto documents = doc[StatsCatalog::kDocumentsFieldName].safeNumberLong();
+        if (std::abs(static_cast<double>(numRecords - documents)) >
+            stalenessRatio * std::max(documents, 1LL)) {
+            fields.push_back(doc[StatsCatalog::kIdFieldName].String());
+        }
+    }
+    return fields;
+}
+
+/**
+ * Collects statistics on the values of a field of a collection and stores them in the
+ * '<db>.system.statistics.<collection>' collection, from which the query planner loads them.
+ *
+ * {
+ *     analyze: <collection>,
+ *     key: <field path>,
+ *     numberBuckets: <number>,
+ * }
+ */
+class AnalyzeCmd final : public TypedCommand<AnalyzeCmd> {
+public:
+    using Request = AnalyzeCommandRequest;
+    using Reply = AnalyzeCommandReply;
+
+    std::string help() const override {
+        return "Collects statistics on the values of a field of a collection. Without a 'key', "
+               "refreshes the statistics of the previously analyzed fields which are stale.";
+    }
+
+    bool adminOnly() const override {
+        return false;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    class Invocation final : public InvocationBase {
+    public:
+        using InvocationBase::InvocationBase;
+
+        Reply typedRun(OperationContext* opCtx) {
+            const auto& nss = request().getNamespace();
+            uassert(6001108,
+                    str::stream() << "Cannot analyze system collection " << nss,
+                    !nss.isSystem());
+
+            long long numRecords;
+            boost::optional<UUID> collectionUUID;
+            {
+                AutoGetCollectionForReadCommand collection(opCtx, nss);
+                uassert(ErrorCodes::NamespaceNotFound,
+                        str::stream() << "Collection " << nss << " does not exist",
+                        collection);
+                numRecords = collection->numRecords(opCtx);
+                collectionUUID = collection->uuid();
+            }
+
+            const auto statsNss = StatsCatalog::makeStatisticsNamespace(nss);
+            std::vector<std::string> fields;
+            if (auto key = request().getKey()) {
+                // Validates the path.
+                FieldPath path(*key);
+                fields.push_back(path.fullPath());
+            } else {
+                fields = getStaleFields(opCtx, statsNss, *collectionUUID, numRecords);
+            }
+
+            DBDirectClient client(opCtx);
+            for (auto&& field : fields) {
+                auto histogram = buildHistogram(
+                    opCtx, nss, numRecords, field, request().getNumberBuckets());
+                auto res = client.updateAcknowledged(
+                    statsNss.ns(),
+                    BSON(StatsCatalog::kIdFieldName << field),
+                    BSON(StatsCatalog::kIdFieldName
+                         << field << StatsCatalog::kCollectionUUIDFieldName << *collectionUUID
+                         << StatsCatalog::kDocumentsFieldName << numRecords
+                         << StatsCatalog::kHistogramFieldName << histogram.toBSON()
+                         << StatsCatalog::kLastUpdatedFieldName << Date_t::now()),
+                    true /* upsert */);
+                uassertStatusOK(getStatusFromWriteCommandReply(res));
+            }
+
+            Reply reply;
+            reply.setAnalyzedFields({fields.begin(), fields.end()});
+            return reply;
+        }
+
+    private:
+        NamespaceString ns() const override {
+            return request().getNamespace();
+        }
+
+        bool supportsWriteConcern() const override {
+            return false;
+        }
+
+        void doCheckAuthorization(OperationContext* opCtx) const override {
+            uassert(ErrorCodes::Unauthorized,
+                    "Unauthorized",
+                    AuthorizationSession::get(opCtx->getClient())
+                        ->isAuthorizedForActionsOnResource(
+                            ResourcePattern::forExactNamespace(request().getNamespace()),
+                            ActionType::analyze));
+        }
+    };
+
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
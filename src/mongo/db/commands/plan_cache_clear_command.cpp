@@ -42,6 +42,8 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collection_query_info.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/logv2/log.h"
 
 namespace mongo {
@@ -190,6 +192,13 @@ bool PlanCacheClearCommand::run(OperationContext* opCtx,
 
     auto planCache = getPlanCache(opCtx, ctx.getCollection());
     uassertStatusOK(clear(opCtx, planCache, nss.ns(), cmdObj));
+
+    // The SBE plan cache is keyed by the shape of the query solution, which cannot be derived from
+    // the query alone. Its entries for the collection are therefore all removed, even when a
+    // single query shape is cleared from the classic plan cache.
+    if (feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV()) {
+        sbe::getPlanCache(opCtx).removeCollectionEntries(ctx.getCollection()->uuid());
+    }
     return true;
 }
 
@@ -714,6 +714,17 @@ void CurOp::reportState(OperationContext* opCtx, BSONObjBuilder* builder, bool t
     if (_debug.dataThroughputAverage) {
         builder->append("dataThroughputAverage", *_debug.dataThroughputAverage);
     }
+
+    if (_debug.indexBuildSpillStats) {
+        BSONObjBuilder sub(builder->subobjStart("sorterSpills"));
+        sub.appendNumber(
+            "bytesSpilledUncompressed",
+            static_cast<long long>(_debug.indexBuildSpillStats->bytesSpilledUncompressed));
+        sub.appendNumber("bytesSpilled",
+                         static_cast<long long>(_debug.indexBuildSpillStats->bytesSpilled));
+        sub.append("spillTimeMillis",
+                   durationCount<Milliseconds>(_debug.indexBuildSpillStats->spillTime));
+    }
 }
 
 namespace {
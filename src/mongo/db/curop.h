@@ -42,6 +42,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/profile_filter.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/sorter/sorter_stats.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/logv2/attribute_storage.h"
@@ -273,6 +274,9 @@ public:
     boost::optional<float> dataThroughputLastSecond;
     boost::optional<float> dataThroughputAverage;
 
+    // Stores the amount of data the external sorters of an index build have spilled to disk.
+    boost::optional<SorterFileStats> indexBuildSpillStats;
+
     // Used to track the amount of time spent waiting for a response from remote operations.
     boost::optional<Microseconds> remoteOpWaitTime;
 
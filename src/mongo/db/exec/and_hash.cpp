@@ -198,6 +198,11 @@ PlanStage::StageState AndHashStage::doWork(WorkingSetID* out) {
     // with no record id.
     invariant(member->hasRecordId());
 
+    if (!mayBeInDataMap(member->recordId)) {
+        _ws->free(*out);
+        return PlanStage::NEED_TIME;
+    }
+
     DataMap::iterator it = _dataMap.find(member->recordId);
     if (_dataMap.end() == it) {
         // Child's output wasn't in every previous child.  Throw it out.
@@ -249,6 +254,15 @@ PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_useBitmaps) {
+            if (member->recordId.isLong()) {
+                _dataBitmap.add(member->recordId.getLong());
+            } else {
+                _useBitmaps = false;
+                _dataBitmap.clear();
+            }
+        }
+
         // Ensure that the BSONObj underlying the WorkingSetMember is owned in case we yield.
         member->makeObjOwnedIfNeeded();
 
@@ -292,12 +306,18 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         // WSM with no record id.
         invariant(member->hasRecordId());
 
-        if (_dataMap.end() == _dataMap.find(member->recordId)) {
+        DataMap::iterator it =
+            mayBeInDataMap(member->recordId) ? _dataMap.find(member->recordId) : _dataMap.end();
+        if (_dataMap.end() == it) {
             // Ignore.  It's not in any previous child.
         } else {
             // We have a hit.  Copy data into the WSM we already have.
-            _seenMap.insert(member->recordId);
-            WorkingSetID olderMemberID = _dataMap[member->recordId];
+            if (_useBitmaps) {
+                _seenBitmap.add(member->recordId.getLong());
+            } else {
+                _seenMap.insert(member->recordId);
+            }
+            WorkingSetID olderMemberID = it->second;
             WorkingSetMember* olderMember = _ws->get(olderMemberID);
             size_t memUsageBefore = olderMember->getMemUsage();
 
@@ -313,9 +333,14 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         ++_currentChild;
 
         // Keep elements of _dataMap that are in _seenMap.
+        if (_useBitmaps) {
+            _dataBitmap.intersectWith(_seenBitmap);
+        }
         DataMap::iterator it = _dataMap.begin();
         while (it != _dataMap.end()) {
-            if (_seenMap.end() == _seenMap.find(it->first)) {
+            const bool seen = _useBitmaps ? _dataBitmap.contains(it->first.getLong())
+                                          : _seenMap.end() != _seenMap.find(it->first);
+            if (!seen) {
                 DataMap::iterator toErase = it;
                 ++it;
 
@@ -333,6 +358,7 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         _specificStats.mapAfterChild.push_back(_dataMap.size());
 
         _seenMap.clear();
+        _seenBitmap.clear();
 
         // _dataMap is now the intersection of the first _currentChild nodes.
 
@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
@@ -83,6 +84,13 @@ private:
     StageState hashOtherChildren(WorkingSetID* out);
     StageState workChild(size_t childNo, WorkingSetID* out);
 
+    /**
+     * Returns false if 'recordId' is known not to be a key of _dataMap, without probing the map.
+     */
+    bool mayBeInDataMap(const RecordId& recordId) const {
+        return !_useBitmaps || _dataBitmap.contains(recordId.getLong());
+    }
+
     // Not owned by us.
     WorkingSet* _ws;
 
@@ -97,10 +105,21 @@ private:
     DataMap _dataMap;
 
     // Keeps track of what elements from _dataMap subsequent children have seen.
-    // Only used while _hashingChildren.
+    // Only used while _hashingChildren, and only if '_useBitmaps' is false.
     typedef stdx::unordered_set<RecordId, RecordId::Hasher> SeenMap;
     SeenMap _seenMap;
 
+    // When the record ids are integers, '_dataBitmap' holds the same set of record ids as the keys
+    // of _dataMap, and '_seenBitmap' replaces _seenMap. Children outputs are probed against the
+    // bitmap first so that record ids which are not part of the intersection, typically the vast
+    // majority of them, can be discarded without hashing.
+    RecordIdBitmap _dataBitmap;
+    RecordIdBitmap _seenBitmap;
+
+    // Cleared as soon as we see a record id that is not an integer, e.g. when scanning a clustered
+    // collection.
+    bool _useBitmaps = true;
+
     // True if we're still intersecting _children[0..._children.size()-1].
     bool _hashingChildren;
 
@@ -134,10 +134,12 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
 
             if (_results.size() >= numResults) {
                 // Once a plan returns enough results, stop working. There is no need to replan.
+                recordTrialWorks(i + 1);
                 return Status::OK();
             }
         } else if (PlanStage::IS_EOF == state) {
             // Cached plan hit EOF quickly enough. No need to replan.
+            recordTrialWorks(i + 1);
             return Status::OK();
         } else if (PlanStage::NEED_YIELD == state) {
             invariant(id == WorkingSet::INVALID_ID);
@@ -179,6 +181,13 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
             << " works");
 }
 
+void CachedPlanStage::recordTrialWorks(size_t works) {
+    // Feed the cost of this trial period back into the plan cache, which deactivates the entry if
+    // its plan keeps performing much worse than when it was cached.
+    auto planCache = CollectionQueryInfo::get(collection()).getPlanCache();
+    planCache->recordTrialWorks(*_canonicalQuery, works);
+}
+
 Status CachedPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
     // These are the conditions which can cause us to yield:
     //   1) The yield policy's timer elapsed, or
@@ -109,6 +109,12 @@ private:
      */
     Status tryYield(PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Reports the number of works taken by a trial period which did not lead to replanning to the
+     * plan cache.
+     */
+    void recordTrialWorks(size_t works);
+
     // Not owned.
     WorkingSet* _ws;
 
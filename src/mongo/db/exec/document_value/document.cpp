@@ -31,12 +31,14 @@
 
 #include "mongo/db/exec/document_value/document.h"
 
+#include <array>
 #include <boost/functional/hash.hpp>
 
 #include "mongo/bson/bson_depth.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/resume_token.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -44,6 +46,89 @@ using boost::intrusive_ptr;
 using std::string;
 using std::vector;
 
+namespace {
+/**
+ * A per-thread cache of the buffers that DocumentStorage keeps its fields in. Pipelines create and
+ * free documents of similar sizes over and over, so when internalQueryRecycleDocumentBuffers is
+ * set, freed buffers are kept here and handed to the next document needing one of the same size.
+ *
+ * Only the power-of-two sizes that DocumentStorage::alloc() produces are cached, up to
+ * kMaxBufferBytes, and at most kMaxCachedBytes are held per thread. Buffers are allocated with
+ * new[] either way, so a buffer may be freed on a different thread from the one that allocated it,
+ * and recycling may be turned on or off at any time.
+ */
+class DocumentBufferCache {
+public:
+    static constexpr size_t kMinBufferBytes = 128;
+    static constexpr size_t kMaxBufferBytes = 16 * 1024;
+    static constexpr size_t kMaxCachedBytes = 256 * 1024;
+
+    ~DocumentBufferCache() {
+        for (auto& buffers : _buffers) {
+            for (auto buffer : buffers) {
+                delete[] buffer;
+            }
+        }
+    }
+
+    char* allocate(size_t bytes) {
+        auto sizeClass = sizeClassFor(bytes);
+        if (sizeClass && !_buffers[*sizeClass].empty()) {
+            char* buffer = _buffers[*sizeClass].back();
+            _buffers[*sizeClass].pop_back();
+            _cachedBytes -= bytes;
+            return buffer;
+        }
+        return new char[bytes];
+    }
+
+    void deallocate(char* buffer, size_t bytes) {
+        auto sizeClass = sizeClassFor(bytes);
+        if (!sizeClass || _cachedBytes + bytes > kMaxCachedBytes) {
+            delete[] buffer;
+            return;
+        }
+        _buffers[*sizeClass].push_back(buffer);
+        _cachedBytes += bytes;
+    }
+
+private:
+    static constexpr size_t kNumSizeClasses = 8;
+    MONGO_STATIC_ASSERT(kMinBufferBytes << (kNumSizeClasses - 1) == kMaxBufferBytes);
+
+    static boost::optional<size_t> sizeClassFor(size_t bytes) {
+        size_t sizeClass = 0;
+        for (size_t classBytes = kMinBufferBytes; classBytes <= kMaxBufferBytes; classBytes *= 2) {
+            if (bytes == classBytes) {
+                return sizeClass;
+            }
+            ++sizeClass;
+        }
+        return boost::none;
+    }
+
+    std::array<std::vector<char*>, kNumSizeClasses> _buffers;
+    size_t _cachedBytes = 0;
+};
+
+thread_local DocumentBufferCache documentBufferCache;
+
+char* allocateDocumentBuffer(size_t bytes) {
+    if (internalQueryRecycleDocumentBuffers.load()) {
+        return documentBufferCache.allocate(bytes);
+    }
+    return new char[bytes];
+}
+
+void freeDocumentBuffer(char* buffer, size_t bytes) {
+    if (buffer && internalQueryRecycleDocumentBuffers.load()) {
+        documentBufferCache.deallocate(buffer, bytes);
+        return;
+    }
+    delete[] buffer;
+}
+}  // namespace
+
 const DocumentStorage DocumentStorage::kEmptyDoc;
 
 const StringDataSet Document::allMetadataFieldNames{Document::metaFieldTextScore,
@@ -246,6 +331,7 @@ void DocumentStorage::alloc(unsigned newSize) {
     const bool firstAlloc = !_cache;
     const bool doingRehash = needRehash();
     const size_t oldCapacity = _cacheEnd - _cache;
+    const size_t oldBufferBytes = allocatedBytes();
 
     // make new bucket count big enough
     while (needRehash() || hashTabBuckets() < HASH_TAB_INIT_SIZE)
@@ -258,13 +344,13 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_cache);
-    _cache = new char[capacity];
+    char* oldBuf = _cache;
+    _cache = allocateDocumentBuffer(capacity);
     _cacheEnd = _cache + capacity - hashTabBytes();
 
     if (!firstAlloc) {
         // This just copies the elements
-        memcpy(_cache, oldBuf.get(), _usedBytes);
+        memcpy(_cache, oldBuf, _usedBytes);
 
         if (_numFields >= HASH_TAB_MIN) {
             // if we were hashing, deal with the hash table
@@ -272,10 +358,12 @@ void DocumentStorage::alloc(unsigned newSize) {
                 rehash();
             } else {
                 // no rehash needed so just slide table down to new position
-                memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
             }
         }
     }
+
+    freeDocumentBuffer(oldBuf, oldBufferBytes);
 }
 
 void DocumentStorage::reserveFields(size_t expectedFields) {
@@ -291,7 +379,7 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _cache = new char[newSize + hashTabBytes()];
+    _cache = allocateDocumentBuffer(newSize + hashTabBytes());
     _cacheEnd = _cache + newSize;
 }
 
@@ -303,7 +391,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
         // Make a copy of the buffer with the fields.
         // It is very important that the positions of each field are the same after cloning.
         const size_t bufferBytes = allocatedBytes();
-        out->_cache = new char[bufferBytes];
+        out->_cache = allocateDocumentBuffer(bufferBytes);
         out->_cacheEnd = out->_cache + (_cacheEnd - _cache);
         memcpy(out->_cache, _cache, bufferBytes);
 
@@ -335,11 +423,11 @@ size_t DocumentStorage::getMetadataApproximateSize() const {
 }
 
 DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_cache);
-
     for (auto it = iteratorCacheOnly(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
+
+    freeDocumentBuffer(_cache, allocatedBytes());
 }
 
 void DocumentStorage::reset(const BSONObj& bson, bool stripMetadata) {
@@ -348,11 +436,13 @@ void DocumentStorage::reset(const BSONObj& bson, bool stripMetadata) {
     _stripMetadata = stripMetadata;
     _modified = false;
 
-    // Clean cache.
+    // Clean cache. The buffer is released rather than kept, since the next alloc() replaces it.
     for (auto it = iteratorCacheOnly(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
 
+    freeDocumentBuffer(_cache, allocatedBytes());
+    _cache = nullptr;
     _cacheEnd = _cache;
     _usedBytes = 0;
     _numFields = 0;
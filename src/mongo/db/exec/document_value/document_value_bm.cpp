@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo {
+namespace {
+
+std::vector<std::string> makeFieldNames(int numFields) {
+    std::vector<std::string> names;
+    for (int i = 0; i < numFields; ++i) {
+        names.push_back(fmt::format("field{}", i));
+    }
+    return names;
+}
+
+BSONObj makeInput(int numFields) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < numFields; ++i) {
+        bob.append(fmt::format("field{}", i), i);
+    }
+    return bob.obj();
+}
+
+/**
+ * Builds a document field by field and then drops it, as $project and $group do for each result.
+ * The second argument turns recycling of document buffers on or off.
+ */
+void BM_BuildDocument(benchmark::State& state) {
+    internalQueryRecycleDocumentBuffers.store(state.range(1));
+    const auto names = makeFieldNames(state.range(0));
+
+    for (auto _ : state) {
+        MutableDocument md;
+        for (size_t i = 0; i < names.size(); ++i) {
+            md.addField(names[i], Value(static_cast<int>(i)));
+        }
+        benchmark::DoNotOptimize(md.freeze());
+    }
+    state.SetItemsProcessed(state.iterations());
+    internalQueryRecycleDocumentBuffers.store(false);
+}
+
+/**
+ * Adds one field to a document that is also referenced elsewhere, which clones its storage as
+ * $addFields and $set do.
+ */
+void BM_AddFieldToSharedDocument(benchmark::State& state) {
+    internalQueryRecycleDocumentBuffers.store(state.range(1));
+    const Document input(makeInput(state.range(0)));
+    input.fillCache();
+
+    for (auto _ : state) {
+        MutableDocument md(input);
+        md.addField("added"_sd, Value(1));
+        benchmark::DoNotOptimize(md.freeze());
+    }
+    state.SetItemsProcessed(state.iterations());
+    internalQueryRecycleDocumentBuffers.store(false);
+}
+
+/**
+ * Reads every field of a document converted from BSON, then drops it. The document and the values
+ * are each referenced from a single place, so this mostly measures reference count traffic.
+ */
+void BM_ReadFieldsFromBson(benchmark::State& state) {
+    internalQueryRecycleDocumentBuffers.store(state.range(1));
+    const auto input = makeInput(state.range(0));
+    const auto names = makeFieldNames(state.range(0));
+
+    for (auto _ : state) {
+        Document doc(input);
+        for (const auto& name : names) {
+            benchmark::DoNotOptimize(doc[name]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    internalQueryRecycleDocumentBuffers.store(false);
+}
+
+BENCHMARK(BM_BuildDocument)->ArgsProduct({{4, 16, 64}, {0, 1}});
+BENCHMARK(BM_AddFieldToSharedDocument)->ArgsProduct({{4, 16, 64}, {0, 1}});
+BENCHMARK(BM_ReadFieldsFromBson)->ArgsProduct({{4, 16, 64}, {0, 1}});
+
+}  // namespace
+}  // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/logv2/log.h"
 
 namespace DocumentTests {
@@ -137,6 +138,37 @@ TEST(DocumentConstruction, FromBsonReset) {
     ASSERT_BSONOBJ_EQ(bson, toBson(newDocument));
 }
 
+TEST(DocumentConstruction, RecycledBuffersDoNotLeakFieldsBetweenDocuments) {
+    RAIIServerParameterControllerForTest controller{"internalQueryRecycleDocumentBuffers", true};
+
+    // Grow documents through several buffer sizes, including past the point where a hash table is
+    // kept in the buffer, so that buffers of each size are freed and then reused.
+    for (int round = 0; round < 3; ++round) {
+        for (int numFields : {1, 8, 40, 200}) {
+            MutableDocument md;
+            BSONObjBuilder expected;
+            for (int i = 0; i < numFields; ++i) {
+                const std::string name = str::stream() << "r" << round << "f" << i;
+                md.addField(name, Value(i));
+                expected.append(name, i);
+            }
+            auto document = md.freeze();
+            ASSERT_BSONOBJ_EQ(expected.obj(), document.toBson());
+
+            auto clone = document.clone();
+            ASSERT_DOCUMENT_EQ(document, clone);
+        }
+    }
+
+    // Resetting a document releases its buffer for the next one to use.
+    MutableDocument md;
+    md.addField("a", Value(1));
+    md.addField("b", Value(2));
+    md.reset(BSON("c" << 3), false);
+    md.addField("d", Value(4));
+    ASSERT_BSONOBJ_EQ(BSON("c" << 3 << "d" << 4), md.freeze().toBson());
+}
+
 /**
  * Appends to 'builder' an object nested 'depth' levels deep.
  */
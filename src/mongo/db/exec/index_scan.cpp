@@ -149,12 +149,15 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
                 kv = _indexCursor->next();
                 break;
             case NEED_SEEK:
+                // The bounds checker only ever asks to move forward in the scan direction, often
+                // just a few keys ahead when walking the intervals of a large $in.
                 ++_specificStats.seeks;
-                kv = _indexCursor->seek(IndexEntryComparison::makeKeyStringFromSeekPointForSeek(
-                    _seekPoint,
-                    indexAccessMethod()->getSortedDataInterface()->getKeyStringVersion(),
-                    indexAccessMethod()->getSortedDataInterface()->getOrdering(),
-                    _forward));
+                kv = _indexCursor->seekNearby(
+                    IndexEntryComparison::makeKeyStringFromSeekPointForSeek(
+                        _seekPoint,
+                        indexAccessMethod()->getSortedDataInterface()->getKeyStringVersion(),
+                        indexAccessMethod()->getSortedDataInterface()->getOrdering(),
+                        _forward));
                 break;
             case HIT_END:
                 return PlanStage::IS_EOF;
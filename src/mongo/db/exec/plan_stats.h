@@ -627,6 +627,12 @@ struct SortStats : public SpecificStats {
 
     // The number of times that we spilled data to disk during the execution of this query.
     uint64_t spills = 0u;
+
+    // The size of the data spilled to disk before compression, the number of bytes that were
+    // actually written to disk, and the time spent writing them.
+    uint64_t spilledDataSizeUncompressed = 0u;
+    uint64_t spilledDataStorageSize = 0u;
+    Microseconds spillTime{0};
 };
 
 struct MergeSortStats : public SpecificStats {
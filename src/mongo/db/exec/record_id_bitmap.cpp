@@ -0,0 +1,231 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+
+#include <algorithm>
+#include <bitset>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+constexpr size_t kBitmapWords = (1 << 16) / 64;
+
+uint64_t highBits(int64_t id) {
+    return static_cast<uint64_t>(id) >> 16;
+}
+
+uint16_t lowBits(int64_t id) {
+    return static_cast<uint16_t>(static_cast<uint64_t>(id) & 0xFFFF);
+}
+
+size_t countBits(uint64_t word) {
+    return std::bitset<64>(word).count();
+}
+
+}  // namespace
+
+bool RecordIdBitmap::Container::add(uint16_t low) {
+    if (isBitmap()) {
+        auto& word = bits[low / 64];
+        const uint64_t mask = uint64_t{1} << (low % 64);
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        ++cardinality;
+        return true;
+    }
+
+    // Ids usually arrive in increasing order, in which case this is an append.
+    auto it = (values.empty() || values.back() < low)
+        ? values.end()
+        : std::lower_bound(values.begin(), values.end(), low);
+    if (it != values.end() && *it == low) {
+        return false;
+    }
+    values.insert(it, low);
+    ++cardinality;
+
+    if (cardinality > kMaxArrayContainerSize) {
+        convertToBitmap();
+    }
+    return true;
+}
+
+bool RecordIdBitmap::Container::contains(uint16_t low) const {
+    if (isBitmap()) {
+        return bits[low / 64] & (uint64_t{1} << (low % 64));
+    }
+    return std::binary_search(values.begin(), values.end(), low);
+}
+
+void RecordIdBitmap::Container::convertToBitmap() {
+    invariant(!isBitmap());
+    bits.assign(kBitmapWords, 0);
+    for (auto low : values) {
+        bits[low / 64] |= uint64_t{1} << (low % 64);
+    }
+    values.clear();
+    values.shrink_to_fit();
+}
+
+void RecordIdBitmap::Container::convertToArray() {
+    invariant(isBitmap());
+    values.reserve(cardinality);
+    for (size_t i = 0; i < kBitmapWords; ++i) {
+        for (uint64_t word = bits[i]; word; word &= word - 1) {
+            values.push_back(static_cast<uint16_t>(i * 64 + countTrailingZerosNonZero64(word)));
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void RecordIdBitmap::Container::intersectWith(const Container& other) {
+    invariant(high == other.high);
+
+    if (isBitmap() && other.isBitmap()) {
+        cardinality = 0;
+        for (size_t i = 0; i < kBitmapWords; ++i) {
+            bits[i] &= other.bits[i];
+            cardinality += countBits(bits[i]);
+        }
+        if (cardinality <= kMaxArrayContainerSize) {
+            convertToArray();
+        }
+        return;
+    }
+
+    if (isBitmap()) {
+        // The result cannot be larger than 'other', so it always fits in an array container.
+        std::vector<uint16_t> result;
+        result.reserve(other.cardinality);
+        std::copy_if(other.values.begin(),
+                     other.values.end(),
+                     std::back_inserter(result),
+                     [&](uint16_t low) { return contains(low); });
+        bits.clear();
+        bits.shrink_to_fit();
+        values = std::move(result);
+    } else if (other.isBitmap()) {
+        values.erase(std::remove_if(values.begin(),
+                                    values.end(),
+                                    [&](uint16_t low) { return !other.contains(low); }),
+                     values.end());
+    } else {
+        std::vector<uint16_t> result;
+        result.reserve(std::min(cardinality, other.cardinality));
+        std::set_intersection(values.begin(),
+                              values.end(),
+                              other.values.begin(),
+                              other.values.end(),
+                              std::back_inserter(result));
+        values = std::move(result);
+    }
+    cardinality = values.size();
+}
+
+const RecordIdBitmap::Container* RecordIdBitmap::findContainer(uint64_t high) const {
+    auto it = std::lower_bound(
+        _containers.begin(), _containers.end(), high, [](const Container& c, uint64_t h) {
+            return c.high < h;
+        });
+    if (it == _containers.end() || it->high != high) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+bool RecordIdBitmap::add(int64_t id) {
+    const uint64_t high = highBits(id);
+
+    if (_lastContainer >= _containers.size() || _containers[_lastContainer].high != high) {
+        auto it = std::lower_bound(
+            _containers.begin(), _containers.end(), high, [](const Container& c, uint64_t h) {
+                return c.high < h;
+            });
+        if (it == _containers.end() || it->high != high) {
+            it = _containers.insert(it, Container{});
+            it->high = high;
+        }
+        _lastContainer = it - _containers.begin();
+    }
+
+    if (!_containers[_lastContainer].add(lowBits(id))) {
+        return false;
+    }
+    ++_size;
+    return true;
+}
+
+bool RecordIdBitmap::contains(int64_t id) const {
+    auto container = findContainer(highBits(id));
+    return container && container->contains(lowBits(id));
+}
+
+void RecordIdBitmap::intersectWith(const RecordIdBitmap& other) {
+    std::vector<Container> result;
+    _size = 0;
+    for (auto& container : _containers) {
+        auto otherContainer = other.findContainer(container.high);
+        if (!otherContainer) {
+            continue;
+        }
+        container.intersectWith(*otherContainer);
+        if (container.cardinality > 0) {
+            _size += container.cardinality;
+            result.push_back(std::move(container));
+        }
+    }
+    _containers = std::move(result);
+    _lastContainer = 0;
+}
+
+void RecordIdBitmap::clear() {
+    _containers.clear();
+    _lastContainer = 0;
+    _size = 0;
+}
+
+size_t RecordIdBitmap::memUsage() const {
+    size_t usage = sizeof(*this) + _containers.capacity() * sizeof(Container);
+    for (auto&& container : _containers) {
+        usage += container.values.capacity() * sizeof(uint16_t) +
+            container.bits.capacity() * sizeof(uint64_t);
+    }
+    return usage;
+}
+
+}  // namespace mongo
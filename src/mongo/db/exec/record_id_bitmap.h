@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mongo {
+
+/**
+ * A compressed set of 64-bit integer record ids, modelled after roaring bitmaps. Ids are
+ * partitioned by their high 48 bits into containers, each of which stores the low 16 bits either
+ * as a sorted array (sparse containers) or as a fixed-size 65536-bit bitmap (dense containers).
+ *
+ * Membership tests cost a binary search over the containers plus either a bit test or a binary
+ * search over at most 'kMaxArrayContainerSize' 16-bit values, which is considerably cheaper than
+ * hashing a RecordId. This makes it suitable for intersecting the outputs of several index scans
+ * by record id.
+ */
+class RecordIdBitmap {
+public:
+    // An array container holding more values than this is converted to a bitmap container, since
+    // beyond this point the bitmap is the smaller of the two representations.
+    static constexpr size_t kMaxArrayContainerSize = 4096;
+
+    /**
+     * Adds 'id' to the set. Returns true if it was not already present.
+     */
+    bool add(int64_t id);
+
+    /**
+     * Returns true if 'id' is present in the set.
+     */
+    bool contains(int64_t id) const;
+
+    /**
+     * Removes from this set every id which is not present in 'other'.
+     */
+    void intersectWith(const RecordIdBitmap& other);
+
+    /**
+     * Returns the number of ids in the set.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    void clear();
+
+    /**
+     * Returns an approximation of the number of bytes used by this set.
+     */
+    size_t memUsage() const;
+
+private:
+    struct Container {
+        bool isBitmap() const {
+            return !bits.empty();
+        }
+
+        bool add(uint16_t low);
+        bool contains(uint16_t low) const;
+
+        // Converts an array container into a bitmap container.
+        void convertToBitmap();
+
+        // Converts a bitmap container back into an array container.
+        void convertToArray();
+
+        // Intersects with 'other', which must have the same 'high' value.
+        void intersectWith(const Container& other);
+
+        uint64_t high = 0;
+        size_t cardinality = 0;
+
+        // Exactly one of 'values' and 'bits' is in use, depending on the container type.
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> bits;
+    };
+
+    const Container* findContainer(uint64_t high) const;
+
+    // Containers, ordered by their 'high' value.
+    std::vector<Container> _containers;
+
+    // Index of the container most recently accessed by add(). Index scans typically produce ids in
+    // increasing order, so this container is usually the one that the next id belongs to.
+    size_t _lastContainer = 0;
+
+    size_t _size = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/exec/record_id_bitmap.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(RecordIdBitmapTest, AddAndContains) {
+    RecordIdBitmap bitmap;
+    ASSERT_TRUE(bitmap.empty());
+
+    ASSERT_TRUE(bitmap.add(5));
+    ASSERT_TRUE(bitmap.add(1));
+    ASSERT_TRUE(bitmap.add(int64_t{1} << 40));
+    ASSERT_FALSE(bitmap.add(5));
+    ASSERT_EQ(bitmap.size(), 3U);
+
+    ASSERT_TRUE(bitmap.contains(1));
+    ASSERT_TRUE(bitmap.contains(5));
+    ASSERT_TRUE(bitmap.contains(int64_t{1} << 40));
+    ASSERT_FALSE(bitmap.contains(2));
+    ASSERT_FALSE(bitmap.contains((int64_t{1} << 40) + 1));
+    ASSERT_FALSE(bitmap.contains(1 << 16));
+
+    bitmap.clear();
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_FALSE(bitmap.contains(5));
+}
+
+TEST(RecordIdBitmapTest, DenseContainerMatchesReferenceSet) {
+    RecordIdBitmap bitmap;
+    std::set<int64_t> reference;
+
+    // Insert enough ids into a single container to convert it to a bitmap, in a scrambled order.
+    for (int64_t i = 0; i < 20000; ++i) {
+        const int64_t id = (i * 7919) % 30000;
+        ASSERT_EQ(bitmap.add(id), reference.insert(id).second);
+    }
+    ASSERT_EQ(bitmap.size(), reference.size());
+    for (int64_t id = 0; id < 70000; ++id) {
+        ASSERT_EQ(bitmap.contains(id), reference.count(id) > 0) << id;
+    }
+}
+
+TEST(RecordIdBitmapTest, IntersectSparseContainers) {
+    RecordIdBitmap left;
+    RecordIdBitmap right;
+    for (int64_t id = 0; id < 1000; id += 2) {
+        left.add(id);
+    }
+    for (int64_t id = 0; id < 1000; id += 3) {
+        right.add(id);
+    }
+    right.add(int64_t{1} << 20);
+
+    left.intersectWith(right);
+    ASSERT_EQ(left.size(), 167U);
+    for (int64_t id = 0; id < 1000; ++id) {
+        ASSERT_EQ(left.contains(id), id % 6 == 0) << id;
+    }
+    ASSERT_FALSE(left.contains(int64_t{1} << 20));
+}
+
+TEST(RecordIdBitmapTest, IntersectMixedContainers) {
+    RecordIdBitmap dense;
+    for (int64_t id = 0; id < 3 * (1 << 16); ++id) {
+        if (id % 5 != 0) {
+            dense.add(id);
+        }
+    }
+
+    RecordIdBitmap sparse;
+    for (int64_t id = 0; id < 3 * (1 << 16); id += 10) {
+        sparse.add(id + 1);
+    }
+
+    // Intersecting a dense set with a sparse one, in both directions, gives the same result.
+    RecordIdBitmap denseCopy = dense;
+    denseCopy.intersectWith(sparse);
+    sparse.intersectWith(dense);
+    ASSERT_EQ(denseCopy.size(), sparse.size());
+    ASSERT_EQ(sparse.size(), 3U * (1 << 16) / 10 + 1);
+    for (int64_t id = 0; id < 3 * (1 << 16); ++id) {
+        const bool expected = id % 10 == 1;
+        ASSERT_EQ(denseCopy.contains(id), expected) << id;
+        ASSERT_EQ(sparse.contains(id), expected) << id;
+    }
+}
+
+TEST(RecordIdBitmapTest, IntersectDenseContainers) {
+    RecordIdBitmap left;
+    RecordIdBitmap right;
+    for (int64_t id = 0; id < (1 << 16); ++id) {
+        if (id % 2 == 0) {
+            left.add(id);
+        }
+        if (id % 3 == 0) {
+            right.add(id);
+        }
+    }
+
+    left.intersectWith(right);
+    ASSERT_EQ(left.size(), 10923U);
+    for (int64_t id = 0; id < (1 << 16); ++id) {
+        ASSERT_EQ(left.contains(id), id % 6 == 0) << id;
+    }
+
+    // A container that becomes sparse after an intersection keeps working after more inserts.
+    RecordIdBitmap few;
+    few.add(6);
+    few.add(7);
+    left.intersectWith(few);
+    ASSERT_EQ(left.size(), 1U);
+    ASSERT_TRUE(left.contains(6));
+    ASSERT_TRUE(left.add(7));
+    ASSERT_FALSE(left.add(6));
+    ASSERT_EQ(left.size(), 2U);
+}
+
+TEST(RecordIdBitmapTest, IntersectWithEmptySet) {
+    RecordIdBitmap bitmap;
+    for (int64_t id = 0; id < 100; ++id) {
+        bitmap.add(id);
+    }
+    bitmap.intersectWith(RecordIdBitmap{});
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_FALSE(bitmap.contains(0));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -128,6 +128,31 @@ std::unique_ptr<EExpression> EPrimBinary::clone() const {
     }
 }
 
+namespace {
+/**
+ * Returns the instruction comparing the value on top of the stack with a constant for the
+ * comparison operator 'op', if there is one.
+ */
+boost::optional<vm::Instruction::Tags> getCompareConstInstruction(EPrimBinary::Op op) {
+    switch (op) {
+        case EPrimBinary::less:
+            return vm::Instruction::lessConst;
+        case EPrimBinary::lessEq:
+            return vm::Instruction::lessEqConst;
+        case EPrimBinary::greater:
+            return vm::Instruction::greaterConst;
+        case EPrimBinary::greaterEq:
+            return vm::Instruction::greaterEqConst;
+        case EPrimBinary::eq:
+            return vm::Instruction::eqConst;
+        case EPrimBinary::neq:
+            return vm::Instruction::neqConst;
+        default:
+            return boost::none;
+    }
+}
+}  // namespace
+
 vm::CodeFragment EPrimBinary::compileDirect(CompileCtx& ctx) const {
     const bool hasCollatorArg = (_nodes.size() == 3);
     vm::CodeFragment code;
@@ -174,6 +199,15 @@ vm::CodeFragment EPrimBinary::compileDirect(CompileCtx& ctx) const {
     if (hasCollatorArg) {
         auto collator = _nodes[2]->compileDirect(ctx);
         code.append(std::move(collator));
+    } else if (auto constTag = getCompareConstInstruction(_op)) {
+        // A comparison with a constant is the most common shape of a simple predicate. The
+        // constant is encoded in the comparison instruction rather than pushed on the stack.
+        if (auto rhsConst = dynamic_cast<const EConstant*>(_nodes[1].get())) {
+            auto [tag, val] = rhsConst->getConstantView();
+            code.append(std::move(lhs));
+            code.appendCompareConst(*constTag, tag, val);
+            return code;
+        }
     }
 
     code.append(std::move(lhs));
@@ -459,6 +493,38 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
      BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::generateSortKey, false}},
     {"tsSecond", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::tsSecond, false}},
     {"tsIncrement", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::tsIncrement, false}},
+    {"removableSumAdd",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::removableSumAdd, false}},
+    {"removableSumRemove",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::removableSumRemove, false}},
+    {"removableSumFinalize",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::removableSumFinalize, false}},
+    {"valueBlockFillEmpty",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockFillEmpty, false}},
+    {"valueBlockGetField",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockGetField, false}},
+    {"valueBlockGtScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockGtScalar, false}},
+    {"valueBlockGteScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockGteScalar, false}},
+    {"valueBlockLtScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockLtScalar, false}},
+    {"valueBlockLteScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockLteScalar, false}},
+    {"valueBlockEqScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockEqScalar, false}},
+    {"valueBlockNeqScalar",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockNeqScalar, false}},
+    {"valueBlockLogicalAnd",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockLogicalAnd, false}},
+    {"valueBlockSum",
+     BuiltinFn{[](size_t n) { return n == 1 || n == 2; }, vm::Builtin::valueBlockSum, true}},
+    {"valueBlockMin",
+     BuiltinFn{[](size_t n) { return n == 1 || n == 2; }, vm::Builtin::valueBlockMin, true}},
+    {"valueBlockMax",
+     BuiltinFn{[](size_t n) { return n == 1 || n == 2; }, vm::Builtin::valueBlockMax, true}},
+    {"valueBlockCount",
+     BuiltinFn{[](size_t n) { return n == 1 || n == 2; }, vm::Builtin::valueBlockCount, true}},
 };
 
 /**
@@ -572,6 +638,21 @@ vm::CodeFragment EFunction::compileDirect(CompileCtx& ctx) const {
         }
         vm::CodeFragment code;
 
+        // A lookup of a field by a constant name encodes the name in the instruction rather than
+        // pushing it on the stack.
+        if (_name == "getField") {
+            auto fieldName = dynamic_cast<const EConstant*>(_nodes[1].get());
+            if (fieldName && value::isString(fieldName->getConstantView().first)) {
+                auto [tag, val] = fieldName->getConstantView();
+                auto fieldStr = value::getStringView(tag, val);
+                if (fieldStr.size() <= vm::CodeFragment::kMaxImmFieldNameSize) {
+                    code.append(_nodes[0]->compileDirect(ctx));
+                    code.appendGetField(fieldStr);
+                    return code;
+                }
+            }
+        }
+
         if (it->second.aggregate) {
             uassert(4822846,
                     str::stream() << "aggregate function call: " << _name
@@ -936,6 +1017,25 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy() const {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    auto env = std::make_unique<RuntimeEnvironment>();
+    env->_isSmp = _isSmp;
+
+    auto& state = *env->_state;
+    state = *_state;
+    for (size_t idx = 0; idx < state.vals.size(); ++idx) {
+        if (state.owned[idx]) {
+            std::tie(state.typeTags[idx], state.vals[idx]) =
+                copyValue(state.typeTags[idx], state.vals[idx]);
+        }
+    }
+
+    for (auto&& [slotId, index] : state.slots) {
+        env->emplaceAccessor(slotId, index);
+    }
+    return env;
+}
+
 std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopyForParallelUse() {
     // Once this environment is used to create a copy for a parallel plan execution, it becomes
     // a parallel environment itself.
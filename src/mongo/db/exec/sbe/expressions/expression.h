@@ -166,6 +166,13 @@ public:
     std::unique_ptr<RuntimeEnvironment> makeCopyForParallelUse();
     std::unique_ptr<RuntimeEnvironment> makeCopy() const;
 
+    /**
+     * Make a copy of this environment which does not share slot values with this one. All owned
+     * values are copied, so slots in the new environment can be reset without affecting this
+     * environment or any other copies of it. Unowned values are shared by both environments.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
@@ -371,6 +378,10 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    std::pair<value::TypeTags, value::Value> getConstantView() const {
+        return {_tag, _val};
+    }
+
 private:
     value::TypeTags _tag;
     value::Value _val;
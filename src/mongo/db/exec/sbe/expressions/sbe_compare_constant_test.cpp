@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+
+namespace mongo::sbe {
+
+/**
+ * Comparisons with a constant and field lookups by a constant name compile to dedicated
+ * instructions with the constant encoded in the instruction. These tests check that they produce
+ * the same results as the generic instructions, which read both operands from the stack.
+ */
+class SBECompareConstantTest : public EExpressionTestFixture {
+protected:
+    using TypedValue = std::pair<value::TypeTags, value::Value>;
+
+    /**
+     * Runs 'lhs <op> rhs' twice, once with 'rhs' as a constant and once with 'rhs' read from a
+     * slot, and asserts that the results are the same.
+     */
+    void assertSameResult(EPrimBinary::Op op, TypedValue lhs, TypedValue rhs) {
+        value::ViewOfValueAccessor lhsAccessor;
+        value::ViewOfValueAccessor rhsAccessor;
+        auto lhsSlot = bindAccessor(&lhsAccessor);
+        auto rhsSlot = bindAccessor(&rhsAccessor);
+        lhsAccessor.reset(lhs.first, lhs.second);
+        rhsAccessor.reset(rhs.first, rhs.second);
+
+        auto [rhsCopyTag, rhsCopyVal] = value::copyValue(rhs.first, rhs.second);
+        auto constExpr = makeE<EPrimBinary>(
+            op, makeE<EVariable>(lhsSlot), makeE<EConstant>(rhsCopyTag, rhsCopyVal));
+        auto slotExpr =
+            makeE<EPrimBinary>(op, makeE<EVariable>(lhsSlot), makeE<EVariable>(rhsSlot));
+
+        auto compiledConstExpr = compileExpression(*constExpr);
+        auto compiledSlotExpr = compileExpression(*slotExpr);
+
+        auto constResult = runCompiledExpression(compiledConstExpr.get());
+        value::ValueGuard constGuard{constResult};
+        auto slotResult = runCompiledExpression(compiledSlotExpr.get());
+        value::ValueGuard slotGuard{slotResult};
+
+        ASSERT_EQ(constResult.first, slotResult.first);
+        ASSERT_EQ(constResult.second, slotResult.second);
+    }
+
+    std::vector<TypedValue> makeValues() {
+        return {makeInt32(1),
+                makeInt32(2),
+                makeInt64(1),
+                makeInt64(std::numeric_limits<int64_t>::max()),
+                makeDouble(1.0),
+                makeDouble(1.5),
+                makeDouble(std::numeric_limits<double>::quiet_NaN()),
+                value::makeNewString("abc"),
+                value::makeNewString("a string that does not fit in a small string"),
+                {value::TypeTags::Date, value::bitcastFrom<int64_t>(1000)},
+                {value::TypeTags::Boolean, value::bitcastFrom<bool>(true)},
+                {value::TypeTags::Null, 0},
+                makeNothing()};
+    }
+};
+
+TEST_F(SBECompareConstantTest, MatchesGenericComparison) {
+    auto values = makeValues();
+    for (auto op : {EPrimBinary::less,
+                    EPrimBinary::lessEq,
+                    EPrimBinary::greater,
+                    EPrimBinary::greaterEq,
+                    EPrimBinary::eq,
+                    EPrimBinary::neq}) {
+        for (auto lhs : values) {
+            for (auto rhs : values) {
+                assertSameResult(op, lhs, rhs);
+            }
+        }
+    }
+
+    for (auto [tag, val] : values) {
+        value::releaseValue(tag, val);
+    }
+}
+
+TEST_F(SBECompareConstantTest, GetFieldByConstantName) {
+    auto obj = BSON("a" << 1 << "b"
+                        << "two"
+                        << "c" << BSON("d" << 3));
+    value::ViewOfValueAccessor objAccessor;
+    auto objSlot = bindAccessor(&objAccessor);
+    objAccessor.reset(value::TypeTags::bsonObject, value::bitcastFrom<const char*>(obj.objdata()));
+
+    auto runGetField = [&](StringData fieldName) {
+        auto expr = makeE<EFunction>(
+            "getField", makeEs(makeE<EVariable>(objSlot), makeE<EConstant>(fieldName)));
+        auto compiledExpr = compileExpression(*expr);
+        return runCompiledExpression(compiledExpr.get());
+    };
+
+    auto [aTag, aVal] = runGetField("a");
+    value::ValueGuard aGuard{aTag, aVal};
+    ASSERT_EQ(value::TypeTags::NumberInt32, aTag);
+    ASSERT_EQ(1, value::bitcastTo<int32_t>(aVal));
+
+    auto [bTag, bVal] = runGetField("b");
+    value::ValueGuard bGuard{bTag, bVal};
+    ASSERT(value::isString(bTag));
+    ASSERT_EQ("two", value::getStringView(bTag, bVal));
+
+    auto [missingTag, missingVal] = runGetField("missing");
+    ASSERT_EQ(value::TypeTags::Nothing, missingTag);
+
+    // Field names too long to be encoded in the instruction take the generic path.
+    std::string longName(vm::CodeFragment::kMaxImmFieldNameSize + 1, 'x');
+    auto longObj = BSON(longName << 42);
+    objAccessor.reset(value::TypeTags::bsonObject,
+                      value::bitcastFrom<const char*>(longObj.objdata()));
+    auto [longTag, longVal] = runGetField(longName);
+    value::ValueGuard longGuard{longTag, longVal};
+    ASSERT_EQ(value::TypeTags::NumberInt32, longTag);
+    ASSERT_EQ(42, value::bitcastTo<int32_t>(longVal));
+}
+
+}  // namespace mongo::sbe
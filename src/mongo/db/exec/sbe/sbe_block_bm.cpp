@@ -0,0 +1,211 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * Compares block-at-a-time execution against row-at-a-time execution of the same SBE plans over a
+ * virtual scan: a filter on a field of each document, and a sum of that field.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/exec/sbe/stages/block_to_row.h"
+#include "mongo/db/exec/sbe/stages/filter.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/exec/sbe/stages/row_to_block.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+
+namespace mongo::sbe {
+namespace {
+const int32_t kFilterThreshold = 50;
+
+using MakePlanFn = std::function<std::pair<value::SlotId, std::unique_ptr<PlanStage>>(
+    value::SlotIdGenerator*, value::SlotId, std::unique_ptr<PlanStage>)>;
+
+std::unique_ptr<EExpression> makeInt32(int32_t value) {
+    return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(value));
+}
+
+/**
+ * Runs the plan built by 'makePlan' over 'state.range(0)' documents of the form {a: <0 to 99>}.
+ */
+void runPlan(benchmark::State& state, const MakePlanFn& makePlan) {
+    QueryTestServiceContext testServiceContext;
+    auto opCtx = testServiceContext.makeOperationContext();
+    value::SlotIdGenerator slotIdGenerator;
+
+    BSONArrayBuilder docs;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        docs.append(BSON("a" << static_cast<int32_t>(i % 100)));
+    }
+    auto [inputTag, inputVal] = stage_builder::makeValue(docs.arr());
+    auto [scanSlot, scanStage] =
+        stage_builder::generateVirtualScan(&slotIdGenerator, inputTag, inputVal);
+    auto [outSlot, stage] = makePlan(&slotIdGenerator, scanSlot, std::move(scanStage));
+
+    CompileCtx ctx{std::make_unique<RuntimeEnvironment>()};
+    stage->prepare(ctx);
+    stage->attachToOperationContext(opCtx.get());
+    auto accessor = stage->getAccessor(ctx, outSlot);
+
+    bool reOpen = false;
+    for (auto keepRunning : state) {
+        stage->open(reOpen);
+        reOpen = true;
+        while (stage->getNext() == PlanState::ADVANCED) {
+            benchmark::DoNotOptimize(accessor->getViewOfValue());
+        }
+        benchmark::ClobberMemory();
+    }
+    stage->close();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeRowFilter(
+    value::SlotIdGenerator* slotIdGenerator,
+    value::SlotId scanSlot,
+    std::unique_ptr<PlanStage> scanStage) {
+    auto predicate = stage_builder::makeFillEmptyFalse(stage_builder::makeBinaryOp(
+        EPrimBinary::greater,
+        stage_builder::makeFunction("getField",
+                                    stage_builder::makeVariable(scanSlot),
+                                    stage_builder::makeConstant("a"_sd)),
+        makeInt32(kFilterThreshold)));
+    auto stage =
+        makeS<FilterStage<false>>(std::move(scanStage), std::move(predicate), kEmptyPlanNodeId);
+    return {scanSlot, std::move(stage)};
+}
+
+MakePlanFn makeBlockFilter(size_t blockSize) {
+    return [blockSize](value::SlotIdGenerator* slotIdGenerator,
+                       value::SlotId scanSlot,
+                       std::unique_ptr<PlanStage> scanStage) {
+        auto blockSlot = slotIdGenerator->generate();
+        auto bitmapSlot = slotIdGenerator->generate();
+        auto outSlot = slotIdGenerator->generate();
+
+        auto stage = makeS<RowToBlockStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), blockSize, kEmptyPlanNodeId);
+        stage = makeProjectStage(
+            std::move(stage),
+            kEmptyPlanNodeId,
+            bitmapSlot,
+            stage_builder::makeFunction(
+                "valueBlockGtScalar",
+                stage_builder::makeFunction("valueBlockGetField",
+                                            stage_builder::makeVariable(blockSlot),
+                                            stage_builder::makeConstant("a"_sd)),
+                makeInt32(kFilterThreshold)));
+        stage = makeS<BlockToRowStage>(
+            std::move(stage), makeSV(blockSlot), makeSV(outSlot), bitmapSlot, kEmptyPlanNodeId);
+        return std::make_pair(outSlot, std::move(stage));
+    };
+}
+
+std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeRowSum(
+    value::SlotIdGenerator* slotIdGenerator,
+    value::SlotId scanSlot,
+    std::unique_ptr<PlanStage> scanStage) {
+    auto sumSlot = slotIdGenerator->generate();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(),
+        makeEM(sumSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   stage_builder::makeFunction("getField",
+                                               stage_builder::makeVariable(scanSlot),
+                                               stage_builder::makeConstant("a"_sd)))),
+        makeSV(),
+        true,
+        boost::none,
+        false /* allowDiskUse */,
+        HashAggStage::MergingExprMap{},
+        kEmptyPlanNodeId);
+    return {sumSlot, std::move(stage)};
+}
+
+MakePlanFn makeBlockSum(size_t blockSize) {
+    return [blockSize](value::SlotIdGenerator* slotIdGenerator,
+                       value::SlotId scanSlot,
+                       std::unique_ptr<PlanStage> scanStage) {
+        auto blockSlot = slotIdGenerator->generate();
+        auto fieldSlot = slotIdGenerator->generate();
+        auto sumSlot = slotIdGenerator->generate();
+
+        auto stage = makeS<RowToBlockStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), blockSize, kEmptyPlanNodeId);
+        stage = makeProjectStage(std::move(stage),
+                                 kEmptyPlanNodeId,
+                                 fieldSlot,
+                                 stage_builder::makeFunction("valueBlockGetField",
+                                                             stage_builder::makeVariable(blockSlot),
+                                                             stage_builder::makeConstant("a"_sd)));
+        stage = makeS<HashAggStage>(
+            std::move(stage),
+            makeSV(),
+            makeEM(sumSlot,
+                   stage_builder::makeFunction("valueBlockSum",
+                                               stage_builder::makeVariable(fieldSlot))),
+            makeSV(),
+            true,
+            boost::none,
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
+            kEmptyPlanNodeId);
+        return std::make_pair(sumSlot, std::move(stage));
+    };
+}
+
+void BM_RowFilter(benchmark::State& state) {
+    runPlan(state, makeRowFilter);
+}
+
+void BM_BlockFilter(benchmark::State& state) {
+    runPlan(state, makeBlockFilter(state.range(1)));
+}
+
+void BM_RowSum(benchmark::State& state) {
+    runPlan(state, makeRowSum);
+}
+
+void BM_BlockSum(benchmark::State& state) {
+    runPlan(state, makeBlockSum(state.range(1)));
+}
+
+BENCHMARK(BM_RowFilter)->Arg(100'000);
+BENCHMARK(BM_BlockFilter)->ArgsProduct({{100'000}, {256, 1024}});
+BENCHMARK(BM_RowSum)->Arg(100'000);
+BENCHMARK(BM_BlockSum)->ArgsProduct({{100'000}, {256, 1024}});
+}  // namespace
+}  // namespace mongo::sbe
@@ -0,0 +1,312 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for block-at-a-time execution: the 'valueBlock*' VM builtins as well as
+ * sbe::RowToBlockStage and sbe::BlockToRowStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/block_to_row.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/exec/sbe/stages/row_to_block.h"
+
+namespace mongo::sbe {
+
+class SBEValueBlockBuiltinTest : public EExpressionTestFixture {
+protected:
+    using TypedValue = std::pair<value::TypeTags, value::Value>;
+
+    static TypedValue makeBlock(const std::vector<TypedValue>& values) {
+        auto [blockTag, blockVal] = value::makeNewValueBlock();
+        auto block = value::getValueBlockView(blockVal);
+        for (auto [tag, val] : values) {
+            auto [copyTag, copyVal] = value::copyValue(tag, val);
+            block->push_back(copyTag, copyVal);
+        }
+        return {blockTag, blockVal};
+    }
+
+    /**
+     * Asserts that 'actual' is a block holding exactly the values in 'expected'.
+     */
+    void assertBlockEq(TypedValue actual, const std::vector<TypedValue>& expected) {
+        ASSERT_EQ(actual.first, value::TypeTags::valueBlock);
+        auto block = value::getValueBlockView(actual.second);
+        ASSERT_EQ(block->size(), expected.size());
+        for (size_t idx = 0; idx < expected.size(); ++idx) {
+            auto [tag, val] = block->getAt(idx);
+            auto [expectedTag, expectedVal] = expected[idx];
+            ASSERT_EQ(tag, expectedTag);
+            if (tag == value::TypeTags::Nothing) {
+                continue;
+            }
+            auto [cmpTag, cmpVal] = value::compareValue(tag, val, expectedTag, expectedVal);
+            ASSERT_EQ(cmpTag, value::TypeTags::NumberInt32);
+            ASSERT_EQ(value::bitcastTo<int32_t>(cmpVal), 0);
+        }
+    }
+
+    TypedValue runBinaryBuiltin(StringData name, TypedValue lhs, TypedValue rhs) {
+        auto expr = makeE<EFunction>(name,
+                                     makeEs(makeE<EConstant>(lhs.first, lhs.second),
+                                            makeE<EConstant>(rhs.first, rhs.second)));
+        auto compiledExpr = compileExpression(*expr);
+        return runCompiledExpression(compiledExpr.get());
+    }
+};
+
+TEST_F(SBEValueBlockBuiltinTest, CompareWithScalar) {
+    auto block = makeBlock({makeInt32(1), makeInt64(5), makeNothing(), makeDouble(10.5)});
+
+    auto result = runBinaryBuiltin("valueBlockGtScalar", block, makeInt32(4));
+    value::ValueGuard resultGuard{result};
+    assertBlockEq(result, {makeBool(false), makeBool(true), makeNothing(), makeBool(true)});
+
+    auto eqBlock = makeBlock({makeInt32(1), makeInt64(5), makeNothing(), makeDouble(10.5)});
+    auto eqResult = runBinaryBuiltin("valueBlockNeqScalar", eqBlock, makeInt32(5));
+    value::ValueGuard eqResultGuard{eqResult};
+    assertBlockEq(eqResult, {makeBool(true), makeBool(false), makeNothing(), makeBool(true)});
+}
+
+TEST_F(SBEValueBlockBuiltinTest, CompareNotABlock) {
+    auto result = runBinaryBuiltin("valueBlockLtScalar", makeInt32(1), makeInt32(4));
+    value::ValueGuard resultGuard{result};
+    ASSERT_EQ(result.first, value::TypeTags::Nothing);
+}
+
+TEST_F(SBEValueBlockBuiltinTest, FillEmpty) {
+    auto block = makeBlock({makeNothing(), makeInt32(2), makeNothing()});
+
+    auto result = runBinaryBuiltin("valueBlockFillEmpty", block, makeInt32(0));
+    value::ValueGuard resultGuard{result};
+    assertBlockEq(result, {makeInt32(0), makeInt32(2), makeInt32(0)});
+}
+
+TEST_F(SBEValueBlockBuiltinTest, GetField) {
+    auto [obj1Tag, obj1Val] = value::copyValue(
+        value::TypeTags::bsonObject, value::bitcastFrom<const char*>(BSON("a" << 1).objdata()));
+    value::ValueGuard obj1Guard{obj1Tag, obj1Val};
+    auto [obj2Tag, obj2Val] = value::copyValue(
+        value::TypeTags::bsonObject, value::bitcastFrom<const char*>(BSON("b" << 2).objdata()));
+    value::ValueGuard obj2Guard{obj2Tag, obj2Val};
+
+    auto block = makeBlock({{obj1Tag, obj1Val}, {obj2Tag, obj2Val}, makeInt32(3)});
+    auto [fieldTag, fieldVal] = value::makeNewString("a"_sd);
+
+    auto result = runBinaryBuiltin("valueBlockGetField", block, {fieldTag, fieldVal});
+    value::ValueGuard resultGuard{result};
+    assertBlockEq(result, {makeInt32(1), makeNothing(), makeNothing()});
+}
+
+TEST_F(SBEValueBlockBuiltinTest, LogicalAnd) {
+    auto lhs = makeBlock({makeBool(true), makeBool(true), makeBool(false), makeNothing()});
+    auto rhs = makeBlock({makeBool(true), makeBool(false), makeNothing(), makeBool(true)});
+
+    auto result = runBinaryBuiltin("valueBlockLogicalAnd", lhs, rhs);
+    value::ValueGuard resultGuard{result};
+    assertBlockEq(result, {makeBool(true), makeBool(false), makeBool(false), makeNothing()});
+}
+
+class BlockStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Builds a plan which batches the input into blocks of 'blockSize' values, evaluates
+     * 'valueBlockGtScalar(block, 4)' block-wise and unpacks the selected rows.
+     */
+    std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeFilterPlan(
+        value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage, size_t blockSize) {
+        auto blockSlot = generateSlotId();
+        auto bitmapSlot = generateSlotId();
+        auto outSlot = generateSlotId();
+
+        auto rowToBlock = makeS<RowToBlockStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), blockSize, kEmptyPlanNodeId);
+        auto project = makeProjectStage(
+            std::move(rowToBlock),
+            kEmptyPlanNodeId,
+            bitmapSlot,
+            stage_builder::makeFunction("valueBlockGtScalar",
+                                        makeE<EVariable>(blockSlot),
+                                        makeE<EConstant>(value::TypeTags::NumberInt32,
+                                                         value::bitcastFrom<int32_t>(4))));
+        auto blockToRow = makeS<BlockToRowStage>(
+            std::move(project), makeSV(blockSlot), makeSV(outSlot), bitmapSlot, kEmptyPlanNodeId);
+
+        return {outSlot, std::move(blockToRow)};
+    }
+
+    /**
+     * Builds a plan which batches the input into blocks and computes the block-wise aggregate
+     * 'aggName' over the values greater than 4.
+     */
+    std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeAggPlan(
+        value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage, StringData aggName) {
+        auto blockSlot = generateSlotId();
+        auto bitmapSlot = generateSlotId();
+        auto aggSlot = generateSlotId();
+
+        auto rowToBlock = makeS<RowToBlockStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), 3, kEmptyPlanNodeId);
+        auto project = makeProjectStage(
+            std::move(rowToBlock),
+            kEmptyPlanNodeId,
+            bitmapSlot,
+            stage_builder::makeFunction("valueBlockGtScalar",
+                                        makeE<EVariable>(blockSlot),
+                                        makeE<EConstant>(value::TypeTags::NumberInt32,
+                                                         value::bitcastFrom<int32_t>(4))));
+        auto agg = makeS<HashAggStage>(
+            std::move(project),
+            makeSV(),
+            makeEM(aggSlot,
+                   stage_builder::makeFunction(
+                       aggName, makeE<EVariable>(blockSlot), makeE<EVariable>(bitmapSlot))),
+            makeSV(),
+            true,
+            boost::none,
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
+            kEmptyPlanNodeId);
+
+        return {aggSlot, std::move(agg)};
+    }
+
+    void runAggTest(StringData aggName, BSONArray expected) {
+        auto [inputTag, inputVal] =
+            stage_builder::makeValue(BSON_ARRAY(1 << 7 << 3 << 9 << BSONNULL << 5 << 12));
+        auto [expectedTag, expectedVal] = stage_builder::makeValue(expected);
+
+        runTest(inputTag,
+                inputVal,
+                expectedTag,
+                expectedVal,
+                [this, aggName](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+                    return makeAggPlan(scanSlot, std::move(scanStage), aggName);
+                });
+    }
+};
+
+TEST_F(BlockStageTest, RowToBlockToRowRoundTrip) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+
+    runTest(inputTag,
+            inputVal,
+            expectedTag,
+            expectedVal,
+            [this](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+                auto blockSlot = generateSlotId();
+                auto outSlot = generateSlotId();
+                auto rowToBlock = makeS<RowToBlockStage>(std::move(scanStage),
+                                                         makeSV(scanSlot),
+                                                         makeSV(blockSlot),
+                                                         2,
+                                                         kEmptyPlanNodeId);
+                auto blockToRow = makeS<BlockToRowStage>(std::move(rowToBlock),
+                                                         makeSV(blockSlot),
+                                                         makeSV(outSlot),
+                                                         boost::none,
+                                                         kEmptyPlanNodeId);
+                return std::make_pair(outSlot, std::move(blockToRow));
+            });
+}
+
+TEST_F(BlockStageTest, BlockWiseFilter) {
+    for (size_t blockSize : {1, 2, 3, 64}) {
+        auto [inputTag, inputVal] =
+            stage_builder::makeValue(BSON_ARRAY(1 << 7 << 3 << 9 << BSONNULL << 5 << 12));
+        auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(7 << 9 << 5 << 12));
+
+        runTest(inputTag,
+                inputVal,
+                expectedTag,
+                expectedVal,
+                [this, blockSize](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+                    return makeFilterPlan(scanSlot, std::move(scanStage), blockSize);
+                });
+    }
+}
+
+TEST_F(BlockStageTest, BlockWiseFilterEmptyInput) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSONArray());
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSONArray());
+
+    runTest(inputTag,
+            inputVal,
+            expectedTag,
+            expectedVal,
+            [this](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+                return makeFilterPlan(scanSlot, std::move(scanStage), 4);
+            });
+}
+
+TEST_F(BlockStageTest, BlockWiseFilterSurvivesYieldInMiddleOfBlock) {
+    auto ctx = makeCompileCtx();
+    auto [inputTag, inputVal] =
+        stage_builder::makeValue(BSON_ARRAY(1 << 7 << 3 << 9 << BSONNULL << 5 << 12));
+    auto [scanSlot, scanStage] = generateVirtualScan(inputTag, inputVal);
+    auto [outSlot, stage] = makeFilterPlan(scanSlot, std::move(scanStage), 64);
+    auto accessor = prepareTree(ctx.get(), stage.get(), outSlot);
+
+    std::vector<int32_t> results;
+    while (stage->getNext() == PlanState::ADVANCED) {
+        // Yield after every row, while the rest of the block is still to be unpacked.
+        stage->saveState();
+        stage->restoreState();
+
+        auto [tag, val] = accessor->getViewOfValue();
+        ASSERT_EQ(tag, value::TypeTags::NumberInt32);
+        results.push_back(value::bitcastTo<int32_t>(val));
+    }
+    stage->close();
+
+    ASSERT(results == std::vector<int32_t>({7, 9, 5, 12}));
+}
+
+TEST_F(BlockStageTest, BlockWiseSum) {
+    runAggTest("valueBlockSum", BSON_ARRAY(33));
+}
+
+TEST_F(BlockStageTest, BlockWiseMin) {
+    runAggTest("valueBlockMin", BSON_ARRAY(5));
+}
+
+TEST_F(BlockStageTest, BlockWiseMax) {
+    runAggTest("valueBlockMax", BSON_ARRAY(12));
+}
+
+TEST_F(BlockStageTest, BlockWiseCount) {
+    runAggTest("valueBlockCount", BSON_ARRAY(4));
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for the server-wide budget of sbe::ExchangeConsumer producer threads.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/exchange.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::sbe {
+namespace {
+
+class ExchangeWorkerBudgetTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _savedMaxWorkers = internalQuerySBEMaxExchangeWorkers.load();
+        internalQuerySBEMaxExchangeWorkers.store(8);
+        ASSERT_EQ(0u, ExchangeWorkerBudget::get().inUse());
+    }
+
+    void tearDown() override {
+        internalQuerySBEMaxExchangeWorkers.store(_savedMaxWorkers);
+    }
+
+private:
+    int _savedMaxWorkers{0};
+};
+
+TEST_F(ExchangeWorkerBudgetTest, ReserveWithinBudgetGrantsAllWorkers) {
+    auto& budget = ExchangeWorkerBudget::get();
+    ASSERT_EQ(4u, budget.reserve(4));
+    ASSERT_EQ(4u, budget.inUse());
+    ASSERT_EQ(4u, budget.reserve(4));
+    ASSERT_EQ(8u, budget.inUse());
+
+    budget.release(8);
+    ASSERT_EQ(0u, budget.inUse());
+}
+
+TEST_F(ExchangeWorkerBudgetTest, ReserveIsCappedByRemainingBudget) {
+    auto& budget = ExchangeWorkerBudget::get();
+    ASSERT_EQ(6u, budget.reserve(6));
+    ASSERT_EQ(2u, budget.reserve(4));
+    ASSERT_EQ(8u, budget.inUse());
+
+    budget.release(2);
+    ASSERT_EQ(2u, budget.reserve(3));
+
+    budget.release(8);
+    ASSERT_EQ(0u, budget.inUse());
+}
+
+TEST_F(ExchangeWorkerBudgetTest, ExhaustedBudgetStillGrantsOneWorker) {
+    auto& budget = ExchangeWorkerBudget::get();
+    ASSERT_EQ(8u, budget.reserve(16));
+    ASSERT_EQ(1u, budget.reserve(4));
+    ASSERT_EQ(9u, budget.inUse());
+
+    budget.release(9);
+    ASSERT_EQ(0u, budget.inUse());
+}
+
+}  // namespace
+}  // namespace mongo::sbe
@@ -37,6 +37,8 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo::sbe {
@@ -80,6 +82,8 @@ void HashAggStageTest::performHashAggWithSpillChecking(
             makeSV(),
             true,
             boost::optional<value::SlotId>{shouldUseCollator, collatorSlot},
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         return std::make_pair(countsSlot, std::move(hashAggStage));
@@ -189,6 +193,8 @@ TEST_F(HashAggStageTest, HashAggMinMaxTest) {
             makeSV(),
             true,
             boost::none,
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         auto outSlot = generateSlotId();
@@ -245,6 +251,8 @@ TEST_F(HashAggStageTest, HashAggAddToSetTest) {
             makeSV(),
             true,
             boost::none,
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         return std::make_pair(hashAggSlot, std::move(hashAggStage));
@@ -342,6 +350,8 @@ TEST_F(HashAggStageTest, HashAggSeekKeysTest) {
             makeSV(seekSlot),
             true,
             boost::none,
+            false /* allowDiskUse */,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         return std::make_pair(countsSlot, std::move(hashAggStage));
@@ -420,4 +430,80 @@ TEST_F(HashAggStageTest, HashAggMemUsageTest) {
     performHashAggWithSpillChecking(spillInputArr, expectedOutputArr, true);
 }
 
+TEST_F(HashAggStageTest, HashAggSpillsToDiskAndMergesPartialAggregates) {
+    // Re-estimate the hash table size on every row and spill as soon as it holds a few groups.
+    auto defaultInternalQuerySBEAggApproxMemoryUseInBytesBeforeSpill =
+        internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load();
+    internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.store(128);
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.store(
+            defaultInternalQuerySBEAggApproxMemoryUseInBytesBeforeSpill);
+    });
+    auto defaultInternalQuerySBEAggMemoryUseSampleRate =
+        internalQuerySBEAggMemoryUseSampleRate.load();
+    internalQuerySBEAggMemoryUseSampleRate.store(1.0);
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEAggMemoryUseSampleRate.store(defaultInternalQuerySBEAggMemoryUseSampleRate);
+    });
+
+    unittest::TempDir tempDir("sbe_hash_agg_spill_test");
+    auto defaultDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = defaultDbPath; });
+
+    // The key 'k' occurs 'k + 1' times in the input, and the occurrences of each key are spread out
+    // so that its partial counts end up in several spilled runs.
+    const int numKeys = 20;
+    BSONArrayBuilder inputBab;
+    for (int round = 0; round < numKeys; ++round) {
+        for (int key = round; key < numKeys; ++key) {
+            inputBab.append(key);
+        }
+    }
+    // The merged groups are returned in the order of their keys.
+    BSONArrayBuilder expectedBab;
+    for (int key = 0; key < numKeys; ++key) {
+        expectedBab.append(static_cast<long long>(key + 1));
+    }
+
+    auto [inputTag, inputVal] = stage_builder::makeValue(inputBab.arr());
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(expectedBab.arr());
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto ctx = makeCompileCtx();
+    auto [scanSlot, scanStage] = generateVirtualScan(inputTag, inputVal);
+
+    auto countSlot = generateSlotId();
+    auto spilledCountSlot = generateSlotId();
+    HashAggStage::MergingExprMap mergingExprs;
+    mergingExprs.emplace(
+        countSlot,
+        std::make_pair(spilledCountSlot,
+                       stage_builder::makeFunction("sum", makeE<EVariable>(spilledCountSlot))));
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlot),
+        makeEM(countSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1)))),
+        makeSV(),
+        true,
+        boost::none,
+        true /* allowDiskUse */,
+        std::move(mergingExprs),
+        kEmptyPlanNodeId);
+
+    auto resultAccessor = prepareTree(ctx.get(), stage.get(), countSlot);
+    auto [resultsTag, resultsVal] = getAllResults(stage.get(), resultAccessor);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+    assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_GT(stats->spills, 1U);
+    ASSERT_GT(stats->spilledRecords, static_cast<size_t>(numKeys));
+
+    stage->close();
+}
 }  // namespace mongo::sbe
@@ -37,10 +37,56 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
 
 namespace mongo::sbe {
 
-using HashJoinStageTest = PlanStageTestFixture;
+class HashJoinStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Joins the integers in 'outerArr' with those in 'innerArr' and returns the matched pairs as
+     * [inner, outer] arrays, along with the stats of the join.
+     */
+    std::pair<std::vector<std::pair<int, int>>, HashJoinStats> runIntegerJoin(
+        BSONArray outerArr, BSONArray innerArr, bool allowDiskUse) {
+        auto [outerTag, outerVal] = stage_builder::makeValue(outerArr);
+        auto [innerTag, innerVal] = stage_builder::makeValue(innerArr);
+
+        auto ctx = makeCompileCtx();
+        auto [outerCondSlot, outerStage] = generateVirtualScan(outerTag, outerVal);
+        auto [innerCondSlot, innerStage] = generateVirtualScan(innerTag, innerVal);
+
+        auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                          std::move(innerStage),
+                                          makeSV(outerCondSlot),
+                                          makeSV(),
+                                          makeSV(innerCondSlot),
+                                          makeSV(),
+                                          boost::none,
+                                          allowDiskUse,
+                                          kEmptyPlanNodeId);
+
+        auto resultAccessors =
+            prepareTree(ctx.get(), stage.get(), makeSV(innerCondSlot, outerCondSlot));
+        auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+        value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+        std::vector<std::pair<int, int>> results;
+        auto resultsView = value::getArrayView(resultsVal);
+        for (size_t i = 0; i < resultsView->size(); ++i) {
+            auto pairView = value::getArrayView(resultsView->getAt(i).second);
+            results.emplace_back(value::numericCast<int32_t>(pairView->getAt(0).first,
+                                                             pairView->getAt(0).second),
+                                 value::numericCast<int32_t>(pairView->getAt(1).first,
+                                                             pairView->getAt(1).second));
+        }
+
+        auto stats = *static_cast<const HashJoinStats*>(stage->getSpecificStats());
+        stage->close();
+        return {std::move(results), stats};
+    }
+};
 
 TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     using namespace std::literals;
@@ -79,6 +125,7 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
                                      makeSV(innerCondSlot),
                                      makeSV(),
                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                     false /* allowDiskUse */,
                                      kEmptyPlanNodeId);
 
             return std::make_pair(makeSV(innerCondSlot, outerCondSlot), std::move(hashJoinStage));
@@ -137,4 +184,144 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     }
 }
 
+TEST_F(HashJoinStageTest, HashJoinSpillsToDiskWhenOuterSideDoesNotFit) {
+    auto defaultMemoryLimit = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(512);
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(defaultMemoryLimit);
+    });
+    auto defaultNumPartitions = internalQuerySBEHashJoinNumPartitions.load();
+    internalQuerySBEHashJoinNumPartitions.store(4);
+    ON_BLOCK_EXIT([&] { internalQuerySBEHashJoinNumPartitions.store(defaultNumPartitions); });
+    auto defaultMaxRecursionDepth = internalQuerySBEHashJoinMaxRecursionDepth.load();
+    internalQuerySBEHashJoinMaxRecursionDepth.store(2);
+    ON_BLOCK_EXIT(
+        [&] { internalQuerySBEHashJoinMaxRecursionDepth.store(defaultMaxRecursionDepth); });
+
+    unittest::TempDir tempDir("sbe_hash_join_spill_test");
+    auto defaultDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = defaultDbPath; });
+
+    // The outer side holds the keys [0, 50) once, plus 30 more copies of the key 7. The copies
+    // cannot be split by partitioning, so the partition holding them hits the recursion limit.
+    BSONArrayBuilder outerBab;
+    for (int i = 0; i < 50; ++i) {
+        outerBab.append(i);
+    }
+    for (int i = 0; i < 30; ++i) {
+        outerBab.append(7);
+    }
+    BSONArrayBuilder innerBab;
+    for (int i = 0; i < 100; ++i) {
+        innerBab.append(i);
+    }
+    auto outerArr = outerBab.arr();
+    auto innerArr = innerBab.arr();
+
+    auto [results, stats] = runIntegerJoin(outerArr, innerArr, true /* allowDiskUse */);
+
+    ASSERT_EQ(results.size(), 80U);
+    std::map<int, int> matchesPerKey;
+    for (auto [inner, outer] : results) {
+        ASSERT_EQ(inner, outer);
+        ++matchesPerKey[inner];
+    }
+    ASSERT_EQ(matchesPerKey.size(), 50U);
+    ASSERT_EQ(matchesPerKey[7], 31);
+
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledPartitions, 0U);
+    ASSERT_GT(stats.spilledBytes, 0U);
+    ASSERT_EQ(stats.maxRecursionDepth, 2U);
+
+    // Without allowDiskUse the hash table stays in memory, unless the memory limit is enforced.
+    auto [inMemoryResults, inMemoryStats] =
+        runIntegerJoin(outerArr, innerArr, false /* allowDiskUse */);
+    ASSERT_EQ(inMemoryResults.size(), 80U);
+    ASSERT_FALSE(inMemoryStats.usedDisk);
+
+    internalQuerySBEHashJoinFailWithoutDiskUse.store(true);
+    ON_BLOCK_EXIT([&] { internalQuerySBEHashJoinFailWithoutDiskUse.store(false); });
+    ASSERT_THROWS_CODE(runIntegerJoin(outerArr, innerArr, false /* allowDiskUse */),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashJoinStageTest, HashJoinDoesNotSpillWhenOuterSideFits) {
+    auto [results, stats] =
+        runIntegerJoin(BSON_ARRAY(1 << 2 << 3), BSON_ARRAY(2 << 3 << 4), true /* allowDiskUse */);
+
+    std::sort(results.begin(), results.end());
+    ASSERT(results == (std::vector<std::pair<int, int>>{{2, 2}, {3, 3}}));
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledRecords, 0U);
+}
+
+TEST_F(HashJoinStageTest, HashJoinFiltersRecordIdsNotOnTheOuterSide) {
+    auto defaultMemoryLimit = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(defaultMemoryLimit);
+    });
+
+    unittest::TempDir tempDir("sbe_hash_join_bitmap_test");
+    auto defaultDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = defaultDbPath; });
+
+    auto makeRecordIds = [](int64_t stop, int64_t step) {
+        auto [tag, val] = value::makeNewArray();
+        auto arr = value::getArrayView(val);
+        for (int64_t id = 0; id < stop; id += step) {
+            arr->push_back(value::TypeTags::RecordId, value::bitcastFrom<int64_t>(id));
+        }
+        return std::make_pair(tag, val);
+    };
+
+    // Intersects the record ids returned by two index scans, with and without spilling. Only 10 of
+    // the 100 inner record ids are also on the outer side.
+    for (auto memoryLimit : {defaultMemoryLimit, 512LL}) {
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(memoryLimit);
+
+        auto [outerTag, outerVal] = makeRecordIds(1000, 1);
+        auto [innerTag, innerVal] = makeRecordIds(10000, 100);
+
+        auto ctx = makeCompileCtx();
+        auto [outerCondSlot, outerStage] = generateVirtualScan(outerTag, outerVal);
+        auto [innerCondSlot, innerStage] = generateVirtualScan(innerTag, innerVal);
+
+        auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                          std::move(innerStage),
+                                          makeSV(outerCondSlot),
+                                          makeSV(),
+                                          makeSV(innerCondSlot),
+                                          makeSV(),
+                                          boost::none,
+                                          true /* allowDiskUse */,
+                                          kEmptyPlanNodeId);
+
+        auto resultAccessors =
+            prepareTree(ctx.get(), stage.get(), makeSV(innerCondSlot, outerCondSlot));
+        auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+        value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+        std::vector<int64_t> matches;
+        auto resultsView = value::getArrayView(resultsVal);
+        for (size_t i = 0; i < resultsView->size(); ++i) {
+            auto pairView = value::getArrayView(resultsView->getAt(i).second);
+            ASSERT_EQ(pairView->getAt(0).first, value::TypeTags::RecordId);
+            ASSERT_EQ(value::bitcastTo<int64_t>(pairView->getAt(0).second),
+                      value::bitcastTo<int64_t>(pairView->getAt(1).second));
+            matches.push_back(value::bitcastTo<int64_t>(pairView->getAt(0).second));
+        }
+        std::sort(matches.begin(), matches.end());
+        ASSERT(matches ==
+               (std::vector<int64_t>{0, 100, 200, 300, 400, 500, 600, 700, 800, 900}));
+
+        auto stats = *static_cast<const HashJoinStats*>(stage->getSpecificStats());
+        stage->close();
+        ASSERT_EQ(stats.usedDisk, memoryLimit == 512);
+        ASSERT_EQ(stats.rowsFilteredByBitmap, 90U);
+    }
+}
 }  // namespace mongo::sbe
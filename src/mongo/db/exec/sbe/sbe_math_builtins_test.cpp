@@ -537,6 +537,86 @@ TEST_F(SBEMathBuiltinTest, DoubleDoubleSummation) {
         ASSERT(value::bitcastTo<Decimal128>(resultVal).isEqual(Decimal128{"6.0"}));
     }
 }
+
+TEST_F(SBEMathBuiltinTest, RemovableSum) {
+    value::OwnedValueAccessor stateAccessor;
+    auto stateSlot = bindAccessor(&stateAccessor);
+    value::OwnedValueAccessor inputAccessor;
+    auto inputSlot = bindAccessor(&inputAccessor);
+
+    auto addExpr = makeE<EFunction>(
+        "removableSumAdd", makeEs(makeE<EVariable>(stateSlot), makeE<EVariable>(inputSlot)));
+    auto compiledAdd = compileExpression(*addExpr);
+    auto removeExpr = makeE<EFunction>(
+        "removableSumRemove", makeEs(makeE<EVariable>(stateSlot), makeE<EVariable>(inputSlot)));
+    auto compiledRemove = compileExpression(*removeExpr);
+    auto finalizeExpr =
+        makeE<EFunction>("removableSumFinalize", makeEs(makeE<EVariable>(stateSlot)));
+    auto compiledFinalize = compileExpression(*finalizeExpr);
+
+    using TypedValue = std::pair<value::TypeTags, value::Value>;
+    auto update = [&](const vm::CodeFragment* code, TypedValue input) {
+        inputAccessor.reset(false, input.first, input.second);
+        auto [tag, val] = runCompiledExpression(code);
+        stateAccessor.reset(tag, val);
+    };
+    auto add = [&](TypedValue input) { update(compiledAdd.get(), input); };
+    auto remove = [&](TypedValue input) { update(compiledRemove.get(), input); };
+    auto makeInt = [](int32_t i) {
+        return std::make_pair(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(i));
+    };
+    auto makeDouble = [](double d) {
+        return std::make_pair(value::TypeTags::NumberDouble, value::bitcastFrom<double>(d));
+    };
+    auto assertSum = [&](value::TypeTags expectedTag, double expected) {
+        auto [resultTag, resultVal] = runCompiledExpression(compiledFinalize.get());
+        value::ValueGuard guard(resultTag, resultVal);
+
+        ASSERT_EQ(expectedTag, resultTag);
+        auto result = value::numericCast<double>(resultTag, resultVal);
+        if (std::isnan(expected)) {
+            ASSERT(std::isnan(result));
+        } else {
+            ASSERT_EQ(expected, result);
+        }
+    };
+
+    // The sum of no values is 0.
+    assertSum(value::TypeTags::NumberInt32, 0);
+
+    // NaN and infinite values dominate the sum until they are removed again.
+    add(makeInt(1));
+    add(makeDouble(2.5));
+    add(makeDouble(std::numeric_limits<double>::quiet_NaN()));
+    add(makeDouble(std::numeric_limits<double>::infinity()));
+    assertSum(value::TypeTags::NumberDouble, std::numeric_limits<double>::quiet_NaN());
+    remove(makeDouble(std::numeric_limits<double>::quiet_NaN()));
+    assertSum(value::TypeTags::NumberDouble, std::numeric_limits<double>::infinity());
+    remove(makeDouble(std::numeric_limits<double>::infinity()));
+    assertSum(value::TypeTags::NumberDouble, 3.5);
+
+    // Once the last double leaves the sum, the result is integral again.
+    remove(makeDouble(2.5));
+    assertSum(value::TypeTags::NumberInt32, 1);
+
+    // The double-double summation does not lose the small values next to large ones.
+    add(makeDouble(1e20));
+    add(makeInt(1));
+    remove(makeDouble(1e20));
+    assertSum(value::TypeTags::NumberInt32, 2);
+
+    // Non-numeric values are ignored.
+    add(std::make_pair(value::TypeTags::Null, 0));
+    assertSum(value::TypeTags::NumberInt32, 2);
+
+    // Removing decimals narrows the result back down.
+    auto [decimalTag, decimalVal] = value::makeCopyDecimal(Decimal128{"0.5"});
+    value::ValueGuard decimalGuard(decimalTag, decimalVal);
+    add(std::make_pair(decimalTag, decimalVal));
+    assertSum(value::TypeTags::NumberDecimal, 2.5);
+    remove(std::make_pair(decimalTag, decimalVal));
+    assertSum(value::TypeTags::NumberInt32, 2);
+}
 }  // namespace
 
 }  // namespace mongo::sbe
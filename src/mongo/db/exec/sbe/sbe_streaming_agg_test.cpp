@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::StreamingAggStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/streaming_agg.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+
+namespace mongo::sbe {
+
+class StreamingAggStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Returns a function building a StreamingAggStage which groups its input by the first input
+     * slot (unless 'groupByKey' is false) and sums up the second one. The output slots are the
+     * group-by slot (if any) followed by the sum.
+     */
+    MakeStageFn<value::SlotVector> makeSumStageFn(
+        bool groupByKey, boost::optional<value::SlotId> collatorSlot = boost::none) {
+        return [this, groupByKey, collatorSlot](value::SlotVector scanSlots,
+                                                std::unique_ptr<PlanStage> scanStage) {
+            auto sumSlot = generateSlotId();
+            auto gbs = groupByKey ? makeSV(scanSlots[0]) : makeSV();
+            auto stage = makeS<StreamingAggStage>(
+                std::move(scanStage),
+                gbs,
+                makeEM(sumSlot, stage_builder::makeFunction("sum", makeE<EVariable>(scanSlots[1]))),
+                collatorSlot,
+                kEmptyPlanNodeId);
+
+            auto outSlots = gbs;
+            outSlots.push_back(sumSlot);
+            return std::make_pair(std::move(outSlots), std::move(stage));
+        };
+    }
+};
+
+TEST_F(StreamingAggStageTest, AggregatesContiguousRowsWithEqualKeys) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY("a" << 1) << BSON_ARRAY("a" << 2) << BSON_ARRAY("b" << 3)
+                             << BSON_ARRAY(1 << 4) << BSON_ARRAY(1.0 << 5)));
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY("a" << 3) << BSON_ARRAY("b" << 3) << BSON_ARRAY(1 << 9)));
+
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeSumStageFn(true));
+}
+
+TEST_F(StreamingAggStageTest, DoesNotMergeGroupsWhichAreNotContiguous) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY("a" << 1) << BSON_ARRAY("b" << 2) << BSON_ARRAY("a" << 3)));
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY("a" << 1) << BSON_ARRAY("b" << 2) << BSON_ARRAY("a" << 3)));
+
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeSumStageFn(true));
+}
+
+TEST_F(StreamingAggStageTest, NoGroupByKeysProducesSingleGroup) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY("a" << 1) << BSON_ARRAY("b" << 2) << BSON_ARRAY("a" << 3)));
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(BSON_ARRAY(6)));
+
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeSumStageFn(false));
+}
+
+TEST_F(StreamingAggStageTest, EmptyInputProducesNoGroups) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSONArray{});
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSONArray{});
+
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeSumStageFn(false));
+}
+
+TEST_F(StreamingAggStageTest, ComparesKeysWithCollator) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY("a" << 1) << BSON_ARRAY("A" << 2) << BSON_ARRAY("b" << 3)));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+    auto [expectedTag, expectedVal] =
+        stage_builder::makeValue(BSON_ARRAY(BSON_ARRAY("a" << 3) << BSON_ARRAY("b" << 3)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto collator =
+        std::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kToLowerString);
+    auto collatorSlot = generateSlotId();
+    auto ctx = makeCompileCtx();
+    value::OwnedValueAccessor collatorAccessor;
+    ctx->pushCorrelated(collatorSlot, &collatorAccessor);
+    collatorAccessor.reset(value::TypeTags::collator,
+                           value::bitcastFrom<CollatorInterface*>(collator.get()));
+
+    inputGuard.reset();
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(2, inputTag, inputVal);
+    auto [outSlots, stage] = makeSumStageFn(true, collatorSlot)(scanSlots, std::move(scanStage));
+
+    auto resultAccessors = prepareTree(ctx.get(), stage.get(), outSlots);
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+}
+}  // namespace mongo::sbe
@@ -27,6 +27,7 @@
  *    it in the license file.
  */
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
@@ -466,4 +467,40 @@ TEST(SBESmallString, Length) {
         ASSERT_EQ(length, value::getStringLength(tag, val));
     }
 }
+
+TEST(SBERuntimeEnvironment, CopySharesSlotValues) {
+    value::SlotIdGenerator slotIdGenerator;
+    RuntimeEnvironment env;
+    auto [tag, val] = value::makeNewString("not so small string"_sd);
+    auto slot = env.registerSlot("param"_sd, tag, val, true, &slotIdGenerator);
+
+    auto copy = env.makeCopy();
+    copy->resetSlot(slot, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(42), false);
+
+    auto [originalTag, originalVal] = env.getAccessor(slot)->getViewOfValue();
+    ASSERT_EQ(value::TypeTags::NumberInt32, originalTag);
+    ASSERT_EQ(42, value::bitcastTo<int32_t>(originalVal));
+}
+
+TEST(SBERuntimeEnvironment, DeepCopyDoesNotShareSlotValues) {
+    value::SlotIdGenerator slotIdGenerator;
+    RuntimeEnvironment env;
+    auto [tag, val] = value::makeNewString("not so small string"_sd);
+    auto slot = env.registerSlot("param"_sd, tag, val, true, &slotIdGenerator);
+
+    auto copy = env.makeDeepCopy();
+    ASSERT_EQ(slot, copy->getSlot("param"_sd));
+
+    // The owned string must have been copied rather than shared.
+    auto [copyTag, copyVal] = copy->getAccessor(slot)->getViewOfValue();
+    ASSERT_EQ(value::TypeTags::StringBig, copyTag);
+    ASSERT_NE(val, copyVal);
+    ASSERT_EQ("not so small string"_sd, value::getStringView(copyTag, copyVal));
+
+    copy->resetSlot(slot, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(42), false);
+
+    auto [originalTag, originalVal] = env.getAccessor(slot)->getViewOfValue();
+    ASSERT_EQ(value::TypeTags::StringBig, originalTag);
+    ASSERT_EQ("not so small string"_sd, value::getStringView(originalTag, originalVal));
+}
 }  // namespace mongo::sbe
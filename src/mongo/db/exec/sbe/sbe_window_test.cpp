@@ -0,0 +1,228 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::WindowStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/window.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+
+namespace mongo::sbe {
+
+class WindowStageTest : public PlanStageTestFixture {
+public:
+    using MakeWindowsFn = std::function<std::vector<WindowStage::Window>(value::SlotId valueSlot)>;
+
+    /**
+     * Runs a window stage over 'input', an array of [partition, value] pairs, and checks that it
+     * returns the rows of 'expected', each consisting of the partition, the value and the state of
+     * every window built by 'makeWindows'.
+     */
+    const WindowStats* runWindowTest(const BSONArray& input,
+                                     const MakeWindowsFn& makeWindows,
+                                     const BSONArray& expected);
+
+    static std::unique_ptr<EExpression> makeInt32(int32_t value) {
+        return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(value));
+    }
+
+    static std::unique_ptr<EExpression> makeNull() {
+        return makeE<EConstant>(value::TypeTags::Null, 0);
+    }
+
+private:
+    std::unique_ptr<PlanStage> _stage;
+};
+
+const WindowStats* WindowStageTest::runWindowTest(const BSONArray& input,
+                                                  const MakeWindowsFn& makeWindows,
+                                                  const BSONArray& expected) {
+    auto [scanSlots, scan] = generateVirtualScanMulti(2, input);
+    auto windows = makeWindows(scanSlots[1]);
+
+    auto outSlots = scanSlots;
+    for (auto& window : windows) {
+        outSlots.push_back(window.windowSlot);
+    }
+
+    _stage = makeS<WindowStage>(
+        std::move(scan), scanSlots, 1, std::move(windows), boost::none, kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors = prepareTree(ctx.get(), _stage.get(), outSlots);
+    auto [resultsTag, resultsVal] = getAllResultsMulti(_stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(expected);
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+    assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+    return static_cast<const WindowStats*>(_stage->getSpecificStats());
+}
+
+TEST_F(WindowStageTest, SlidingSumRemovesRowsLeavingTheFrame) {
+    auto makeWindows = [this](value::SlotId valueSlot) {
+        auto sumSlot = generateSlotId();
+        std::vector<WindowStage::Window> windows;
+        windows.push_back(WindowStage::Window{
+            sumSlot,
+            makeInt32(0),
+            makeE<EPrimBinary>(
+                EPrimBinary::add, makeE<EVariable>(sumSlot), makeE<EVariable>(valueSlot)),
+            makeE<EPrimBinary>(
+                EPrimBinary::sub, makeE<EVariable>(sumSlot), makeE<EVariable>(valueSlot)),
+            -1,
+            1});
+        return windows;
+    };
+
+    auto stats = runWindowTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2) << BSON_ARRAY(1 << 3)
+                                      << BSON_ARRAY(1 << 4) << BSON_ARRAY(2 << 10)
+                                      << BSON_ARRAY(2 << 20)),
+        makeWindows,
+        BSON_ARRAY(BSON_ARRAY(1 << 1 << 3) << BSON_ARRAY(1 << 2 << 6) << BSON_ARRAY(1 << 3 << 9)
+                                           << BSON_ARRAY(1 << 4 << 7) << BSON_ARRAY(2 << 10 << 30)
+                                           << BSON_ARRAY(2 << 20 << 30)));
+    ASSERT_EQ(stats->partitions, 2);
+    ASSERT_EQ(stats->recomputations, 0);
+    ASSERT_EQ(stats->maxBufferedRows, 4);
+}
+
+TEST_F(WindowStageTest, SlidingMinRecomputesStateWithoutRemoveExpression) {
+    auto makeWindows = [this](value::SlotId valueSlot) {
+        auto minSlot = generateSlotId();
+        std::vector<WindowStage::Window> windows;
+        windows.push_back(WindowStage::Window{
+            minSlot,
+            nullptr,
+            makeE<EIf>(makeE<EPrimBinary>(EPrimBinary::logicAnd,
+                                          makeE<EFunction>("exists",
+                                                           makeEs(makeE<EVariable>(minSlot))),
+                                          makeE<EPrimBinary>(EPrimBinary::lessEq,
+                                                             makeE<EVariable>(minSlot),
+                                                             makeE<EVariable>(valueSlot))),
+                       makeE<EVariable>(minSlot),
+                       makeE<EVariable>(valueSlot)),
+            nullptr,
+            -1,
+            0});
+        return windows;
+    };
+
+    auto stats = runWindowTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 3) << BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2)
+                                      << BSON_ARRAY(1 << 5)),
+        makeWindows,
+        BSON_ARRAY(BSON_ARRAY(1 << 3 << 3) << BSON_ARRAY(1 << 1 << 1) << BSON_ARRAY(1 << 2 << 1)
+                                           << BSON_ARRAY(1 << 5 << 2)));
+    ASSERT_EQ(stats->partitions, 1);
+    ASSERT_EQ(stats->recomputations, 2);
+}
+
+TEST_F(WindowStageTest, ShiftReturnsInitialStateOutsideOfPartition) {
+    auto makeWindows = [this](value::SlotId valueSlot) {
+        auto shiftSlot = generateSlotId();
+        std::vector<WindowStage::Window> windows;
+        windows.push_back(WindowStage::Window{shiftSlot,
+                                              makeNull(),
+                                              makeE<EVariable>(valueSlot),
+                                              makeNull(),
+                                              1,
+                                              1});
+        return windows;
+    };
+
+    runWindowTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2) << BSON_ARRAY(1 << 3)
+                                      << BSON_ARRAY(2 << 4)),
+        makeWindows,
+        BSON_ARRAY(BSON_ARRAY(1 << 1 << 2) << BSON_ARRAY(1 << 2 << 3)
+                                           << BSON_ARRAY(1 << 3 << BSONNULL)
+                                           << BSON_ARRAY(2 << 4 << BSONNULL)));
+}
+
+TEST_F(WindowStageTest, UnboundedFramesBufferTheWholePartition) {
+    auto makeWindows = [this](value::SlotId valueSlot) {
+        std::vector<WindowStage::Window> windows;
+        for (auto upperBound : {boost::optional<int64_t>{0}, boost::optional<int64_t>{}}) {
+            auto sumSlot = generateSlotId();
+            windows.push_back(WindowStage::Window{
+                sumSlot,
+                makeInt32(0),
+                makeE<EPrimBinary>(
+                    EPrimBinary::add, makeE<EVariable>(sumSlot), makeE<EVariable>(valueSlot)),
+                nullptr,
+                boost::none,
+                upperBound});
+        }
+        return windows;
+    };
+
+    auto stats = runWindowTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2) << BSON_ARRAY(1 << 3)
+                                      << BSON_ARRAY(2 << 4)),
+        makeWindows,
+        BSON_ARRAY(BSON_ARRAY(1 << 1 << 1 << 6) << BSON_ARRAY(1 << 2 << 3 << 6)
+                                                << BSON_ARRAY(1 << 3 << 6 << 6)
+                                                << BSON_ARRAY(2 << 4 << 4 << 4)));
+    ASSERT_EQ(stats->recomputations, 0);
+    ASSERT_EQ(stats->maxBufferedRows, 3);
+}
+
+TEST_F(WindowStageTest, RemoveSeesTheNextRowOfTheFrame) {
+    auto makeWindows = [this](value::SlotId valueSlot) {
+        auto firstSlot = generateSlotId();
+        std::vector<WindowStage::Window> windows;
+        windows.push_back(WindowStage::Window{
+            firstSlot,
+            nullptr,
+            makeE<EIf>(makeE<EFunction>("exists", makeEs(makeE<EVariable>(firstSlot))),
+                       makeE<EVariable>(firstSlot),
+                       makeE<EVariable>(valueSlot)),
+            makeE<EVariable>(valueSlot),
+            -1,
+            1,
+            true /* removeSeesNextRow */});
+        return windows;
+    };
+
+    auto stats = runWindowTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2) << BSON_ARRAY(1 << 3)
+                                      << BSON_ARRAY(1 << 4)),
+        makeWindows,
+        BSON_ARRAY(BSON_ARRAY(1 << 1 << 1) << BSON_ARRAY(1 << 2 << 1) << BSON_ARRAY(1 << 3 << 2)
+                                           << BSON_ARRAY(1 << 4 << 3)));
+    ASSERT_EQ(stats->recomputations, 0);
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,254 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/block_to_row.h"
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/util/str.h"
+
+namespace mongo::sbe {
+BlockToRowStage::BlockToRowStage(std::unique_ptr<PlanStage> input,
+                                 value::SlotVector blockSlots,
+                                 value::SlotVector outSlots,
+                                 boost::optional<value::SlotId> bitmapSlot,
+                                 PlanNodeId planNodeId)
+    : PlanStage("blockToRow"_sd, planNodeId),
+      _blockSlots(std::move(blockSlots)),
+      _outSlots(std::move(outSlots)),
+      _bitmapSlot(bitmapSlot) {
+    _children.emplace_back(std::move(input));
+    invariant(_blockSlots.size() == _outSlots.size());
+}
+
+std::unique_ptr<PlanStage> BlockToRowStage::clone() const {
+    return std::make_unique<BlockToRowStage>(
+        _children[0]->clone(), _blockSlots, _outSlots, _bitmapSlot, _commonStats.nodeId);
+}
+
+void BlockToRowStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    for (auto slot : _blockSlots) {
+        _blockAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+    }
+
+    if (_bitmapSlot) {
+        _bitmapAccessor = _children[0]->getAccessor(ctx, *_bitmapSlot);
+    }
+
+    _outAccessors.resize(_outSlots.size());
+    value::SlotSet dupCheck;
+    for (size_t idx = 0; idx < _outSlots.size(); ++idx) {
+        auto [it, inserted] = dupCheck.emplace(_outSlots[idx]);
+        uassert(6000102, str::stream() << "duplicate field: " << _outSlots[idx], inserted);
+        _outAccessorsMap[_outSlots[idx]] = &_outAccessors[idx];
+    }
+
+    _blocks.resize(_blockAccessors.size(), nullptr);
+}
+
+value::SlotAccessor* BlockToRowStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _outAccessorsMap.find(slot); it != _outAccessorsMap.end()) {
+        return it->second;
+    }
+
+    return _children[0]->getAccessor(ctx, slot);
+}
+
+void BlockToRowStage::open(bool reOpen) {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+
+    _blockSize = 0;
+    _rowIdx = 0;
+}
+
+bool BlockToRowStage::readBlocks() {
+    _blockSize = 0;
+    _rowIdx = 0;
+    _ownedBlocks.clear();
+    _ownedBitmap.reset();
+    _blocksOwned = false;
+
+    boost::optional<size_t> size;
+    for (size_t idx = 0; idx < _blockAccessors.size(); ++idx) {
+        auto [tag, val] = _blockAccessors[idx]->getViewOfValue();
+        if (tag != value::TypeTags::valueBlock) {
+            return false;
+        }
+
+        _blocks[idx] = value::getValueBlockView(val);
+        tassert(6000103,
+                "All blocks of a batch must have the same size",
+                !size || *size == _blocks[idx]->size());
+        size = _blocks[idx]->size();
+    }
+
+    _bitmap = nullptr;
+    if (_bitmapAccessor) {
+        auto [tag, val] = _bitmapAccessor->getViewOfValue();
+        if (tag != value::TypeTags::valueBlock) {
+            // Nothing is selected.
+            return false;
+        }
+
+        _bitmap = value::getValueBlockView(val);
+        tassert(6000104,
+                "The bitmap block must have the same size as the value blocks",
+                !size || *size == _bitmap->size());
+        size = _bitmap->size();
+    }
+
+    _blockSize = size.value_or(0);
+    return true;
+}
+
+PlanState BlockToRowStage::getNext() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    for (;;) {
+        for (; _rowIdx < _blockSize; ++_rowIdx) {
+            if (_bitmap) {
+                auto [tag, val] = _bitmap->getAt(_rowIdx);
+                if (tag != value::TypeTags::Boolean || !value::bitcastTo<bool>(val)) {
+                    continue;
+                }
+            }
+
+            for (size_t idx = 0; idx < _blocks.size(); ++idx) {
+                auto [tag, val] = _blocks[idx]->getAt(_rowIdx);
+                _outAccessors[idx].reset(false, tag, val);
+            }
+
+            ++_rowIdx;
+            return trackPlanState(PlanState::ADVANCED);
+        }
+
+        // We are about to call getNext() on our child so do not bother saving our internal state
+        // in case it yields as the state will be completely overwritten after the getNext() call.
+        disableSlotAccess();
+        auto state = _children[0]->getNext();
+        if (state != PlanState::ADVANCED) {
+            return trackPlanState(state);
+        }
+
+        if (!readBlocks()) {
+            _blockSize = 0;
+        }
+    }
+}
+
+void BlockToRowStage::close() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    trackClose();
+    _children[0]->close();
+}
+
+std::unique_ptr<PlanStageStats> BlockToRowStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.append("blockSlots", _blockSlots.begin(), _blockSlots.end());
+        bob.append("outputSlots", _outSlots.begin(), _outSlots.end());
+        if (_bitmapSlot) {
+            bob.appendNumber("bitmapSlot", static_cast<long long>(*_bitmapSlot));
+        }
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* BlockToRowStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> BlockToRowStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _outSlots.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addIdentifier(ret, _outSlots[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _blockSlots.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addIdentifier(ret, _blockSlots[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    if (_bitmapSlot) {
+        DebugPrinter::addIdentifier(ret, *_bitmapSlot);
+    }
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+
+void BlockToRowStage::doSaveState() {
+    if (!slotsAccessible()) {
+        return;
+    }
+
+    for (auto& accessor : _outAccessors) {
+        accessor.makeOwned();
+    }
+
+    // The remaining rows of the batch are read from the blocks, which are only views into the
+    // child's slots. Copy them so that they outlive the child's state across a yield.
+    if (_rowIdx < _blockSize && !_blocksOwned) {
+        for (auto& block : _blocks) {
+            _ownedBlocks.emplace_back(std::make_unique<value::ValueBlock>(*block));
+            block = _ownedBlocks.back().get();
+        }
+
+        if (_bitmap) {
+            _ownedBitmap = std::make_unique<value::ValueBlock>(*_bitmap);
+            _bitmap = _ownedBitmap.get();
+        }
+        _blocksOwned = true;
+    }
+}
+}  // namespace mongo::sbe
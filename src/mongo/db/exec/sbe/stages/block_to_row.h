@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+
+namespace mongo::sbe {
+/**
+ * Unpacks the 'valueBlock' values held by 'blockSlots' back into individual rows: for every entry
+ * of the blocks produced by the 'input' subtree, the slots in 'outSlots' hold the values found at
+ * the same position in the corresponding blocks. All blocks of a batch must have the same size.
+ *
+ * If the optional 'bitmapSlot' is provided, it must hold a block of the same size whose entries
+ * select the rows to produce; rows whose bitmap entry is not Boolean true are skipped. This is how
+ * a block-wise predicate (e.g. 'valueBlockGtScalar') filters rows.
+ *
+ * Debug string representation:
+ *
+ *  blockToRow [<out slots>] [<block slots>] <bitmap slot>? childStage
+ */
+class BlockToRowStage final : public PlanStage {
+public:
+    BlockToRowStage(std::unique_ptr<PlanStage> input,
+                    value::SlotVector blockSlots,
+                    value::SlotVector outSlots,
+                    boost::optional<value::SlotId> bitmapSlot,
+                    PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats(bool includeDebugInfo) const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+protected:
+    void doSaveState() final;
+
+private:
+    /**
+     * Fetches the blocks of the current batch from the child's accessors. Returns false if the
+     * batch does not hold valid blocks and must be skipped.
+     */
+    bool readBlocks();
+
+    const value::SlotVector _blockSlots;
+    const value::SlotVector _outSlots;
+    const boost::optional<value::SlotId> _bitmapSlot;
+
+    std::vector<value::SlotAccessor*> _blockAccessors;
+    value::SlotAccessor* _bitmapAccessor{nullptr};
+
+    std::vector<value::OwnedValueAccessor> _outAccessors;
+    value::SlotAccessorMap _outAccessorsMap;
+
+    // Views of the blocks of the current batch. They point either into the child's slots or, once
+    // the state has been saved, into the copies below which stay valid across yields.
+    std::vector<const value::ValueBlock*> _blocks;
+    const value::ValueBlock* _bitmap{nullptr};
+    std::vector<std::unique_ptr<value::ValueBlock>> _ownedBlocks;
+    std::unique_ptr<value::ValueBlock> _ownedBitmap;
+    bool _blocksOwned{false};
+    size_t _blockSize{0};
+    size_t _rowIdx{0};
+};
+}  // namespace mongo::sbe
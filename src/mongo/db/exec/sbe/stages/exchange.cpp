@@ -32,7 +32,10 @@
 #include "mongo/db/exec/sbe/stages/exchange.h"
 
 #include "mongo/base/init.h"
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/client.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/recovery_unit.h"
 
 namespace mongo::sbe {
 std::unique_ptr<ThreadPool> s_globalThreadPool;
@@ -117,6 +120,34 @@ void ExchangePipe::putFullBuffer(std::unique_ptr<ExchangeBuffer> b) {
     _cond.notify_all();
 }
 
+ExchangeWorkerBudget& ExchangeWorkerBudget::get() {
+    static ExchangeWorkerBudget budget;
+    return budget;
+}
+
+size_t ExchangeWorkerBudget::reserve(size_t requested) {
+    stdx::unique_lock lock(_mutex);
+
+    const size_t limit = internalQuerySBEMaxExchangeWorkers.load();
+    const size_t available = _inUse < limit ? limit - _inUse : 0;
+    const auto granted = std::max(size_t{1}, std::min(requested, available));
+    _inUse += granted;
+
+    return granted;
+}
+
+void ExchangeWorkerBudget::release(size_t count) {
+    stdx::unique_lock lock(_mutex);
+
+    invariant(count <= _inUse);
+    _inUse -= count;
+}
+
+size_t ExchangeWorkerBudget::inUse() const {
+    stdx::unique_lock lock(_mutex);
+    return _inUse;
+}
+
 ExchangeState::ExchangeState(size_t numOfProducers,
                              value::SlotVector fields,
                              ExchangePolicy policy,
@@ -128,6 +159,24 @@ ExchangeState::ExchangeState(size_t numOfProducers,
       _partition(std::move(partition)),
       _orderLess(std::move(orderLess)) {}
 
+ExchangeState::~ExchangeState() {
+    releaseProducers();
+}
+
+void ExchangeState::reserveProducers() {
+    invariant(!producersReserved());
+
+    _reservedProducers = ExchangeWorkerBudget::get().reserve(_numOfProducers);
+    _numOfProducers = _reservedProducers;
+}
+
+void ExchangeState::releaseProducers() {
+    if (producersReserved()) {
+        ExchangeWorkerBudget::get().release(_reservedProducers);
+        _reservedProducers = 0;
+    }
+}
+
 ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
 }
@@ -159,8 +208,9 @@ ExchangeConsumer::ExchangeConsumer(std::unique_ptr<PlanStage> input,
                                    ExchangePolicy policy,
                                    std::unique_ptr<EExpression> partition,
                                    std::unique_ptr<EExpression> orderLess,
+                                   PlanYieldPolicy* yieldPolicy,
                                    PlanNodeId planNodeId)
-    : PlanStage("exchange"_sd, planNodeId) {
+    : PlanStage("exchange"_sd, yieldPolicy, planNodeId) {
     _children.emplace_back(std::move(input));
     _state = std::make_shared<ExchangeState>(
         numOfProducers, std::move(fields), policy, std::move(partition), std::move(orderLess));
@@ -220,6 +270,12 @@ void ExchangeConsumer::open(bool reOpen) {
         stdx::unique_lock lock(_state->consumerOpenMutex());
         bool allConsumers = (++_state->consumerOpen()) == _state->numOfConsumers();
 
+        // The number of producers is settled by the first consumer to show up, as it determines the
+        // number of pipes.
+        if (!_state->producersReserved()) {
+            _state->reserveProducers();
+        }
+
         // Create all pipes.
         if (_orderPreserving) {
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
@@ -260,15 +316,30 @@ void ExchangeConsumer::open(bool reOpen) {
                 }
             }
 
+            // Every producer reads through its own recovery unit. If the consumer reads at a
+            // point in time, so do the producers, which then all see the same snapshot. The stage
+            // builder only parallelizes collection scans of queries which read at a point in time.
+            auto readTimestamp = _opCtx->recoveryUnit()->getPointInTimeReadTimestamp(_opCtx);
+
+            // The producers hold no locks. They resolve the collections through the catalog seen
+            // by the consumer, which keeps the collections alive until the producers are done.
+            auto catalog = CollectionCatalog::get(_opCtx);
+
             // Start n producers.
-            invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
+            invariant(_state->producerCompileCtxs().size() >= _state->numOfProducers());
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 auto pf = makePromiseFuture<void>();
                 s_globalThreadPool->schedule(
-                    [this, idx, promise = std::move(pf.promise)](auto status) mutable {
+                    [this, idx, readTimestamp, catalog, promise = std::move(pf.promise)](
+                        auto status) mutable {
                         invariant(status);
 
                         auto opCtx = cc().makeOperationContext();
+                        CollectionCatalog::stash(opCtx.get(), catalog);
+                        if (readTimestamp) {
+                            opCtx->recoveryUnit()->setTimestampReadSource(
+                                RecoveryUnit::ReadSource::kProvided, *readTimestamp);
+                        }
 
                         promise.setWith([&] {
                             ExchangeProducer::start(opCtx.get(),
@@ -278,6 +349,13 @@ void ExchangeConsumer::open(bool reOpen) {
                     });
                 _state->addProducerFuture(std::move(pf.future));
             }
+
+            // A yield would let the collection change under the locks of the consumer while the
+            // producers still read it, so the query only checks for interrupts until they are done.
+            if (_yieldPolicy) {
+                _yieldPolicy->disableAutoYields();
+                _autoYieldsDisabled = true;
+            }
         } else {
             // Consumer ID >0
 
@@ -355,6 +433,12 @@ void ExchangeConsumer::close() {
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 _state->producerResults()[idx].wait();
             }
+            _state->releaseProducers();
+
+            if (_autoYieldsDisabled) {
+                _yieldPolicy->enableAutoYields();
+                _autoYieldsDisabled = false;
+            }
         }
 
         if (_state->consumerClose() == _state->numOfConsumers()) {
@@ -141,6 +141,29 @@ private:
     bool _closed{false};
 };
 
+/**
+ * Tracks the number of exchange producer threads reserved by all of the exchanges running on the
+ * server. The total is limited by the 'internalQuerySBEMaxExchangeWorkers' knob.
+ */
+class ExchangeWorkerBudget {
+public:
+    static ExchangeWorkerBudget& get();
+
+    /**
+     * Reserves up to 'requested' producer threads and returns the number of threads reserved. At
+     * least one thread is always granted so that every exchange can make progress, even when the
+     * budget is exhausted.
+     */
+    size_t reserve(size_t requested);
+    void release(size_t count);
+
+    size_t inUse() const;
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("ExchangeWorkerBudget::_mutex");
+    size_t _inUse{0};
+};
+
 /**
  * Common shared state between all consumers and producers of a single exchange.
  */
@@ -152,6 +175,20 @@ public:
                   std::unique_ptr<EExpression> partition,
                   std::unique_ptr<EExpression> orderLess);
 
+    ~ExchangeState();
+
+    /**
+     * Reserves the producer threads from the server-wide ExchangeWorkerBudget, which may reduce
+     * the number of producers. Must be called once, by the first consumer to open, before any
+     * pipes are created.
+     */
+    void reserveProducers();
+    void releaseProducers();
+
+    bool producersReserved() const {
+        return _reservedProducers > 0;
+    }
+
     bool isOrderPreserving() const {
         return !!_orderLess;
     }
@@ -224,7 +261,9 @@ public:
 
 private:
     const ExchangePolicy _policy;
-    const size_t _numOfProducers;
+    // The number of producers asked for, which is reduced when the worker budget cannot cover it.
+    size_t _numOfProducers;
+    size_t _reservedProducers{0};
     std::vector<ExchangeConsumer*> _consumers;
     std::vector<ExchangeProducer*> _producers;
     std::vector<std::unique_ptr<PlanStage>> _producerPlans;
@@ -259,6 +298,7 @@ public:
                      ExchangePolicy policy,
                      std::unique_ptr<EExpression> partition,
                      std::unique_ptr<EExpression> orderLess,
+                     PlanYieldPolicy* yieldPolicy,
                      PlanNodeId planNodeId);
 
     ExchangeConsumer(std::shared_ptr<ExchangeState> state, PlanNodeId planNodeId);
@@ -302,6 +342,10 @@ private:
     bool _orderPreserving{false};
 
     size_t _rowProcessed{0};
+
+    // Set while consumer 0 keeps the query from yielding, as the producers read through the
+    // catalog and the storage snapshot established by the query.
+    bool _autoYieldsDisabled{false};
 };
 
 class ExchangeProducer final : public PlanStage {
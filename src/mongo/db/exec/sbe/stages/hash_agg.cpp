@@ -31,8 +31,18 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
@@ -41,18 +51,29 @@ HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector seekKeysSlots,
                            bool optimizedClose,
                            boost::optional<value::SlotId> collatorSlot,
+                           bool allowDiskUse,
+                           MergingExprMap mergingExprs,
                            PlanNodeId planNodeId)
     : PlanStage("group"_sd, planNodeId),
       _gbs(std::move(gbs)),
       _aggs(std::move(aggs)),
       _collatorSlot(collatorSlot),
       _seekKeysSlots(std::move(seekKeysSlots)),
-      _optimizedClose(optimizedClose) {
+      _optimizedClose(optimizedClose),
+      _allowDiskUse(allowDiskUse),
+      _mergingExprs(std::move(mergingExprs)) {
     _children.emplace_back(std::move(input));
     invariant(_seekKeysSlots.empty() || _seekKeysSlots.size() == _gbs.size());
     tassert(5843100,
             "HashAgg stage was given optimizedClose=false and seek keys",
             _seekKeysSlots.empty() || _optimizedClose);
+    tassert(6000200,
+            "HashAgg stage was given allowDiskUse=true and seek keys",
+            _seekKeysSlots.empty() || !_allowDiskUse);
+    tassert(6000201,
+            "HashAgg stage was given allowDiskUse=true without a merging expression for each "
+            "aggregate",
+            !_allowDiskUse || _mergingExprs.size() == _aggs.size());
 }
 
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
@@ -60,12 +81,18 @@ std::unique_ptr<PlanStage> HashAggStage::clone() const {
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
+    MergingExprMap mergingExprs;
+    for (auto& [k, v] : _mergingExprs) {
+        mergingExprs.emplace(k, std::make_pair(v.first, v.second->clone()));
+    }
     return std::make_unique<HashAggStage>(_children[0]->clone(),
                                           _gbs,
                                           std::move(aggs),
                                           _seekKeysSlots,
                                           _optimizedClose,
                                           _collatorSlot,
+                                          _allowDiskUse,
+                                          std::move(mergingExprs),
                                           _commonStats.nodeId);
 }
 
@@ -116,10 +143,42 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         _aggCodes.emplace_back(expr->compile(ctx));
         ctx.aggExpression = false;
     }
+
+    // Process merging expressions (if spilling is allowed). They are compiled in the same order as
+    // the aggregates so that the merging expression for the i-th aggregate is found at index i.
+    if (_allowDiskUse) {
+        counter = 0;
+        for (auto& [slot, expr] : _aggs) {
+            auto mergingIt = _mergingExprs.find(slot);
+            tassert(6000203,
+                    "HashAgg stage is missing a merging expression for an aggregate",
+                    mergingIt != _mergingExprs.end());
+
+            auto& [spilledSlot, mergingExpr] = mergingIt->second;
+            auto [it, inserted] = dupCheck.emplace(spilledSlot);
+            const auto spilledSlotId = spilledSlot;
+            uassert(6000202, str::stream() << "duplicate field: " << spilledSlotId, inserted);
+
+            _spilledAggAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+            _spilledAggAccessorsMap[spilledSlot] = _spilledAggAccessors.back().get();
+
+            ctx.root = this;
+            ctx.aggExpression = true;
+            ctx.accumulator = _outAggAccessors[counter++].get();
+
+            _mergingCodes.emplace_back(mergingExpr->compile(ctx));
+            ctx.aggExpression = false;
+        }
+    }
     _compiled = true;
 }
 
 value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    // The spilled partial aggregates are only visible to the merging expressions.
+    if (auto it = _spilledAggAccessorsMap.find(slot); it != _spilledAggAccessorsMap.end()) {
+        return it->second;
+    }
+
     if (_compiled) {
         if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
             return it->second;
@@ -144,13 +203,14 @@ void HashAggStage::open(bool reOpen) {
             auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
             uassert(
                 5402503, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
-            auto collatorView = value::getCollatorView(collatorVal);
-            const value::MaterializedRowHasher hasher(collatorView);
-            const value::MaterializedRowEq equator(collatorView);
+            _collator = value::getCollatorView(collatorVal);
+            const value::MaterializedRowHasher hasher(_collator);
+            const value::MaterializedRowEq equator(_collator);
             _ht.emplace(0, hasher, equator);
         } else {
             _ht.emplace();
         }
+        resetSpilledState();
 
         _seekKeys.resize(_seekKeysAccessors.size());
 
@@ -185,10 +245,26 @@ void HashAggStage::open(bool reOpen) {
                 long estimatedSizeForOneRow =
                     it->first.memUsageForSorter() + it->second.memUsageForSorter();
                 long long estimatedTotalSize = _ht->size() * estimatedSizeForOneRow;
-                uassert(5859000,
-                        "Need to spill to disk",
-                        estimatedTotalSize < _approxMemoryUseInBytesBeforeSpill);
+                if (estimatedTotalSize >= _approxMemoryUseInBytesBeforeSpill) {
+                    uassert(5859000,
+                            "Exceeded memory limit for $group, but didn't allow external "
+                            "spilling; pass allowDiskUse:true to opt in",
+                            _allowDiskUse);
+                    spill();
+                }
+            }
+        }
+
+        if (!_spilledRuns.empty()) {
+            // Some of the groups have already been written to disk, so the remaining ones must be
+            // spilled too in order to merge them with their partial aggregates from earlier runs.
+            if (!_ht->empty()) {
+                spill();
             }
+            _mergeIt.reset(SpillIterator::merge(
+                _spilledRuns, SortOptions{}, [this](const SpilledRow& lhs, const SpilledRow& rhs) {
+                    return compareKeys(lhs.first, rhs.first);
+                }));
         }
 
         if (_optimizedClose) {
@@ -209,9 +285,100 @@ void HashAggStage::open(bool reOpen) {
     _htIt = _ht->end();
 }
 
+int HashAggStage::compareKeys(const value::MaterializedRow& lhs,
+                              const value::MaterializedRow& rhs) const {
+    for (size_t idx = 0; idx < lhs.size(); ++idx) {
+        auto [lhsTag, lhsVal] = lhs.getViewOfValue(idx);
+        auto [rhsTag, rhsVal] = rhs.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal, _collator);
+
+        auto result = value::bitcastTo<int32_t>(val);
+        if (tag == value::TypeTags::NumberInt32 && result) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+void HashAggStage::spill() {
+    if (!_spillFile) {
+        _spillFile = std::make_shared<Sorter<value::MaterializedRow, value::MaterializedRow>::File>(
+            storageGlobalParams.dbpath + "/_tmp/" + nextFileName());
+    }
+
+    std::vector<TableType::iterator> rows;
+    rows.reserve(_ht->size());
+    for (auto it = _ht->begin(); it != _ht->end(); ++it) {
+        rows.push_back(it);
+    }
+    std::sort(rows.begin(), rows.end(), [this](const auto& lhs, const auto& rhs) {
+        return compareKeys(lhs->first, rhs->first) < 0;
+    });
+
+    SortOptions opts;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+    opts.extSortAllowed = true;
+    SortedFileWriter<value::MaterializedRow, value::MaterializedRow> writer(opts, _spillFile);
+    for (auto& it : rows) {
+        writer.addAlreadySorted(it->first, it->second);
+    }
+    _spilledRuns.emplace_back(writer.done());
+
+    _specificStats.usedDisk = true;
+    _specificStats.spills++;
+    _specificStats.spilledRecords += rows.size();
+
+    _ht->clear();
+}
+
+PlanState HashAggStage::getNextSpilled() {
+    if (!_stashedRow && !_mergeIt->more()) {
+        return PlanState::IS_EOF;
+    }
+
+    auto row = _stashedRow ? std::move(*_stashedRow) : _mergeIt->next();
+    _stashedRow = boost::none;
+
+    // The hash table only ever holds the group being returned, which makes it possible to reuse the
+    // accessors pointing into it.
+    _ht->clear();
+    auto [it, inserted] = _ht->try_emplace(std::move(row.first), std::move(row.second));
+    invariant(inserted);
+    _htIt = it;
+
+    while (_mergeIt->more()) {
+        auto next = _mergeIt->next();
+        if (compareKeys(next.first, _htIt->first) != 0) {
+            _stashedRow = std::move(next);
+            break;
+        }
+
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [tag, val] = next.second.getViewOfValue(idx);
+            _spilledAggAccessors[idx]->reset(tag, val);
+            auto [owned, resultTag, resultVal] = _bytecode.run(_mergingCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, resultTag, resultVal);
+        }
+    }
+
+    return PlanState::ADVANCED;
+}
+
+void HashAggStage::resetSpilledState() {
+    _stashedRow = boost::none;
+    _mergeIt.reset();
+    _spilledRuns.clear();
+    _spillFile.reset();
+}
+
 PlanState HashAggStage::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
+    if (_mergeIt) {
+        return trackPlanState(getNextSpilled());
+    }
+
     if (_htIt == _ht->end()) {
         // First invocation of getNext() after open().
         if (!_seekKeysAccessors.empty()) {
@@ -236,6 +403,7 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
 
     if (includeDebugInfo) {
         DebugPrinter printer;
@@ -247,6 +415,12 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
                 childrenBob.append(str::stream() << slot, printer.print(expr->debugPrint()));
             }
         }
+        if (_allowDiskUse) {
+            bob.appendBool("usedDisk", _specificStats.usedDisk);
+            bob.appendNumber("spills", static_cast<long long>(_specificStats.spills));
+            bob.appendNumber("spilledRecords",
+                             static_cast<long long>(_specificStats.spilledRecords));
+        }
         ret->debugInfo = bob.obj();
     }
 
@@ -255,13 +429,14 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
     auto optTimer(getOptTimer(_opCtx));
 
     trackClose();
+    resetSpilledState();
     _ht = boost::none;
 
     if (_childOpened) {
@@ -317,6 +492,23 @@ std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
         DebugPrinter::addIdentifier(ret, *_collatorSlot);
     }
 
+    if (_allowDiskUse) {
+        ret.emplace_back("spill");
+        ret.emplace_back(DebugPrinter::Block("[`"));
+        first = true;
+        value::orderedSlotMapTraverse(_mergingExprs, [&](auto slot, auto&& mergingExpr) {
+            if (!first) {
+                ret.emplace_back(DebugPrinter::Block("`,"));
+            }
+
+            DebugPrinter::addIdentifier(ret, slot);
+            ret.emplace_back("=");
+            DebugPrinter::addBlocks(ret, mergingExpr.second->debugPrint());
+            first = false;
+        });
+        ret.emplace_back("`]");
+    }
+
     DebugPrinter::addNewLine(ret);
     DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
 
@@ -32,9 +32,11 @@
 #include <unordered_map>
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
@@ -60,19 +62,36 @@ namespace sbe {
  * determining whether two group-by keys are equal. For instance, the plan may require us to do a
  * case-insensitive group on a string field.
  *
+ * The hash table is limited in size by the smaller of the
+ * 'internalQuerySlotBasedExecutionHashAggApproxMemoryUseInBytesBeforeSpill' and
+ * 'internalDocumentSourceGroupMaxMemoryBytes' knobs. When the limit is exceeded and 'allowDiskUse'
+ * is false, the stage fails the query. Otherwise the partial aggregates held in the hash table are
+ * written to disk as a run sorted by the group-by keys and the hash table is emptied. Once the
+ * input is exhausted, the spilled runs are merged and partial aggregates belonging to the same
+ * group are combined using 'mergingExprs'. This is a map from each aggregate output slot to a pair
+ * of a slot, through which a spilled partial aggregate is made visible, and an aggregate expression
+ * folding that slot into the accumulator. For example, a 'sum(s1)' aggregate is merged by
+ * 'sum(s2)', where 's2' is the slot holding the spilled partial sum. Spilling cannot be combined
+ * with seek keys.
+ *
  * Debug string representation:
  *
  *  group [<group by slots>] [slot_1 = expr_1, ..., slot_n = expr_n] [<seek slots>]? reopen?
- * collatorSlot? childStage
+ * collatorSlot? (spill [slot_1 = mergeExpr_1, ..., slot_n = mergeExpr_n])? childStage
  */
 class HashAggStage final : public PlanStage {
 public:
+    using MergingExprMap =
+        value::SlotMap<std::pair<value::SlotId, std::unique_ptr<EExpression>>>;
+
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
                  value::SlotVector seekKeysSlots,
                  bool optimizedClose,
                  boost::optional<value::SlotId> collatorSlot,
+                 bool allowDiskUse,
+                 MergingExprMap mergingExprs,
                  PlanNodeId planNodeId);
 
     std::unique_ptr<PlanStage> clone() const final;
@@ -96,6 +115,28 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
+    /**
+     * Orders rows by their group-by keys, honoring the collation if one was provided.
+     */
+    int compareKeys(const value::MaterializedRow& lhs, const value::MaterializedRow& rhs) const;
+
+    /**
+     * Writes the contents of the hash table to disk as a run sorted by the group-by keys and
+     * empties the hash table.
+     */
+    void spill();
+
+    /**
+     * Produces the next group from the merged spilled runs, combining all of its partial
+     * aggregates.
+     */
+    PlanState getNextSpilled();
+
+    void resetSpilledState();
+
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
     const boost::optional<value::SlotId> _collatorSlot;
@@ -103,9 +144,12 @@ private:
     // When this operator does not expect to be reopened (almost always) then it can close the child
     // early.
     const bool _optimizedClose{true};
+    const bool _allowDiskUse;
+    const MergingExprMap _mergingExprs;
     // Memory tracking variables.
     const long long _approxMemoryUseInBytesBeforeSpill =
-        internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load();
+        std::min(internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load(),
+                 internalDocumentSourceGroupMaxMemoryBytes.load());
     const int _memoryUseSampleRate = internalQuerySBEAggMemoryUseSampleRate.load();
     // Used in collaboration with memoryUseSampleRatePercentage to determine whether we should
     // re-approximate memory usage.
@@ -123,12 +167,28 @@ private:
 
     // Only set if collator slot provided on construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
 
     boost::optional<TableType> _ht;
     TableType::iterator _htIt;
 
+    // Accessors exposing a spilled partial aggregate to the merging expressions, along with the
+    // compiled merging expressions themselves. Both are in the same order as '_outAggAccessors'.
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _spilledAggAccessors;
+    value::SlotMap<value::SlotAccessor*> _spilledAggAccessorsMap;
+    std::vector<std::unique_ptr<vm::CodeFragment>> _mergingCodes;
+
+    std::shared_ptr<Sorter<value::MaterializedRow, value::MaterializedRow>::File> _spillFile;
+    std::vector<std::shared_ptr<SpillIterator>> _spilledRuns;
+    std::unique_ptr<SpillIterator> _mergeIt;
+    // The first row of the next group, read from '_mergeIt' while looking for the end of the
+    // current group.
+    boost::optional<SpilledRow> _stashedRow;
+
     vm::ByteCode _bytecode;
 
+    HashAggStats _specificStats;
+
     bool _compiled{false};
     bool _childOpened{false};
 };
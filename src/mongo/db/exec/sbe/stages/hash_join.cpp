@@ -32,8 +32,33 @@
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashJoinFileCounter;
+    return "extsort-hash-join-sbe." + std::to_string(hashJoinFileCounter.fetchAndAdd(1));
+}
+
+/**
+ * Maps the hash of a join key to a partition. The recursion depth is mixed into the hash so that
+ * rows which shared a partition at one level are spread out when that partition is partitioned
+ * again.
+ */
+size_t partitionIndex(size_t hash, size_t depth, size_t numPartitions) {
+    uint64_t x = hash + depth * 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb3fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x % numPartitions;
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
@@ -43,6 +68,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
                              boost::optional<value::SlotId> collatorSlot,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
@@ -50,6 +76,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
       _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse),
       _probeKey(0) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
@@ -67,6 +94,7 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _innerCond,
                                            _innerProjects,
                                            _collatorSlot,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
@@ -111,6 +139,32 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         _outOuterAccessors[slot] = _outOuterProjectAccessors.back().get();
     }
 
+    for (auto& slot : _innerProjects) {
+        _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+    }
+
+    // Once the stage has spilled, the inner side rows are read back from disk, so the inner keys
+    // and projections must be served from the current spilled row instead of the inner child.
+    counter = 0;
+    for (auto& slot : _innerCond) {
+        _spilledInnerAccessors.emplace_back(
+            std::make_unique<SpilledKeyAccessor>(_spilledProbeRowIt, counter++));
+        _outInnerAccessors[slot] = std::make_unique<value::SwitchAccessor>(
+            std::vector<value::SlotAccessor*>{_children[1]->getAccessor(ctx, slot),
+                                              _spilledInnerAccessors.back().get()});
+    }
+
+    counter = 0;
+    for (auto& slot : _innerProjects) {
+        _spilledInnerAccessors.emplace_back(
+            std::make_unique<SpilledProjectAccessor>(_spilledProbeRowIt, counter++));
+        _outInnerAccessors.emplace(
+            slot,
+            std::make_unique<value::SwitchAccessor>(
+                std::vector<value::SlotAccessor*>{_children[1]->getAccessor(ctx, slot),
+                                                  _spilledInnerAccessors.back().get()}));
+    }
+
     _probeKey.resize(_inInnerKeyAccessors.size());
 
     _compiled = true;
@@ -122,6 +176,10 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second.get();
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
@@ -142,9 +200,17 @@ void HashJoinStage::open(bool reOpen) {
         _ht.emplace();
     }
 
+    resetSpilledState();
+    _outerRecordIds.clear();
+    _useRecordIdBitmap = _outerCond.size() == 1;
+
     _commonStats.opens++;
     _children[0]->open(reOpen);
-    // Insert the outer side into the hash table.
+
+    // Insert the outer side into the hash table. If it does not fit, switch to partitioning the
+    // outer side to disk.
+    std::vector<Partition> partitions;
+    long long memUsage = 0;
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inOuterKeyAccessors.size()};
         value::MaterializedRow project{_inOuterProjectAccessors.size()};
@@ -163,17 +229,207 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
+        if (_useRecordIdBitmap) {
+            auto [tag, val] = key.getViewOfValue(0);
+            if (tag == value::TypeTags::RecordId) {
+                _outerRecordIds.add(value::bitcastTo<int64_t>(val));
+            } else {
+                _useRecordIdBitmap = false;
+                _outerRecordIds.clear();
+            }
+        }
+
+        if (!partitions.empty()) {
+            addToPartition(partitions, true, key, project);
+            continue;
+        }
+
+        memUsage += key.memUsageForSorter() + project.memUsageForSorter();
         _ht->emplace(std::move(key), std::move(project));
+
+        if (memUsage > _approxMemoryUseInBytesBeforeSpill) {
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    "Exceeded memory limit for hash join, but didn't allow external spilling; "
+                    "pass allowDiskUse:true to opt in",
+                    _allowDiskUse || !_failWithoutDiskUse);
+            if (_allowDiskUse) {
+                partitions = makePartitions(0);
+                spillHashTable(partitions);
+            }
+        }
     }
 
     _children[0]->close();
 
     _children[1]->open(reOpen);
 
+    if (!partitions.empty()) {
+        // Partition the inner side as well. The partitions are joined pairwise in getNext().
+        _spilled = true;
+        for (auto& [slot, accessor] : _outInnerAccessors) {
+            accessor->setIndex(1);
+        }
+
+        while (_children[1]->getNext() == PlanState::ADVANCED) {
+            value::MaterializedRow key{_inInnerKeyAccessors.size()};
+            value::MaterializedRow project{_inInnerProjectAccessors.size()};
+
+            size_t idx = 0;
+            for (auto& p : _inInnerKeyAccessors) {
+                auto [tag, val] = p->getViewOfValue();
+                key.reset(idx++, false, tag, val);
+            }
+
+            idx = 0;
+            for (auto& p : _inInnerProjectAccessors) {
+                auto [tag, val] = p->getViewOfValue();
+                project.reset(idx++, false, tag, val);
+            }
+
+            if (!mayHaveOuterMatch(key)) {
+                continue;
+            }
+            addToPartition(partitions, false, key, project);
+        }
+
+        finishPartitions(partitions);
+    }
+
     _htIt = _ht->end();
     _htItEnd = _ht->end();
 }
 
+std::vector<HashJoinStage::Partition> HashJoinStage::makePartitions(size_t depth) {
+    std::vector<Partition> partitions(_numPartitions);
+    for (auto& partition : partitions) {
+        partition.depth = depth;
+    }
+    return partitions;
+}
+
+void HashJoinStage::addToPartition(std::vector<Partition>& partitions,
+                                   bool build,
+                                   const value::MaterializedRow& key,
+                                   const value::MaterializedRow& project) {
+    auto hash = _ht->hash_function()(key);
+    auto& partition =
+        partitions[partitionIndex(hash, partitions.front().depth, partitions.size())];
+    auto& side = build ? partition.build : partition.probe;
+
+    if (!side.writer) {
+        SortOptions opts;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        opts.extSortAllowed = true;
+        side.file = std::make_shared<SpillFile>(opts.tempDir + "/" + nextFileName());
+        side.writer = std::make_unique<SpillWriter>(opts, side.file);
+    }
+
+    side.writer->addAlreadySorted(key, project);
+    ++side.numRows;
+    ++_specificStats.spilledRecords;
+}
+
+void HashJoinStage::spillHashTable(std::vector<Partition>& partitions) {
+    for (auto& [key, project] : *_ht) {
+        addToPartition(partitions, true, key, project);
+    }
+
+    _ht->clear();
+    _specificStats.usedDisk = true;
+}
+
+void HashJoinStage::finishPartitions(std::vector<Partition>& partitions) {
+    for (auto& partition : partitions) {
+        for (auto side : {&partition.build, &partition.probe}) {
+            if (side->writer) {
+                side->iterator.reset(side->writer->done());
+                side->writer.reset();
+                _specificStats.spilledBytes += side->file->currentOffset();
+            }
+        }
+
+        if (partition.build.numRows || partition.probe.numRows) {
+            ++_specificStats.spilledPartitions;
+        }
+
+        // This is an inner join, so a partition with an empty side cannot produce any results.
+        if (partition.build.numRows && partition.probe.numRows) {
+            _pendingPartitions.emplace_back(std::move(partition));
+        }
+    }
+}
+
+bool HashJoinStage::loadNextPartition() {
+    while (!_pendingPartitions.empty()) {
+        auto partition = std::move(_pendingPartitions.back());
+        _pendingPartitions.pop_back();
+
+        _ht->clear();
+        _htIt = _ht->end();
+        _htItEnd = _ht->end();
+        _spilledProbeIt.reset();
+        _specificStats.maxRecursionDepth =
+            std::max(_specificStats.maxRecursionDepth, partition.depth);
+
+        std::vector<Partition> subPartitions;
+        long long memUsage = 0;
+        while (partition.build.iterator->more()) {
+            auto [key, project] = partition.build.iterator->next();
+            if (!subPartitions.empty()) {
+                addToPartition(subPartitions, true, key, project);
+                continue;
+            }
+
+            memUsage += key.memUsageForSorter() + project.memUsageForSorter();
+            _ht->emplace(std::move(key), std::move(project));
+
+            if (memUsage > _approxMemoryUseInBytesBeforeSpill &&
+                partition.depth < _maxRecursionDepth) {
+                subPartitions = makePartitions(partition.depth + 1);
+                spillHashTable(subPartitions);
+            }
+        }
+
+        if (subPartitions.empty()) {
+            _spilledProbeIt = std::move(partition.probe.iterator);
+            return true;
+        }
+
+        while (partition.probe.iterator->more()) {
+            auto [key, project] = partition.probe.iterator->next();
+            addToPartition(subPartitions, false, key, project);
+        }
+        finishPartitions(subPartitions);
+    }
+
+    return false;
+}
+
+void HashJoinStage::resetSpilledState() {
+    _pendingPartitions.clear();
+    _spilledProbeIt.reset();
+    _spilled = false;
+    for (auto& [slot, accessor] : _outInnerAccessors) {
+        accessor->setIndex(0);
+    }
+}
+
+bool HashJoinStage::mayHaveOuterMatch(const value::MaterializedRow& key) {
+    if (!_useRecordIdBitmap) {
+        return true;
+    }
+
+    // A key of any other type cannot be equal to a RecordId.
+    auto [tag, val] = key.getViewOfValue(0);
+    if (tag == value::TypeTags::RecordId &&
+        _outerRecordIds.contains(value::bitcastTo<int64_t>(val))) {
+        return true;
+    }
+
+    ++_specificStats.rowsFilteredByBitmap;
+    return false;
+}
+
 PlanState HashJoinStage::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
@@ -183,6 +439,21 @@ PlanState HashJoinStage::getNext() {
 
     if (_htIt == _htItEnd) {
         while (_htIt == _htItEnd) {
+            if (_spilled) {
+                if (!_spilledProbeIt || !_spilledProbeIt->more()) {
+                    if (!loadNextPartition()) {
+                        return trackPlanState(PlanState::IS_EOF);
+                    }
+                    continue;
+                }
+
+                _spilledProbeRow = _spilledProbeIt->next();
+                auto [low, hi] = _ht->equal_range(_spilledProbeRow.first);
+                _htIt = low;
+                _htItEnd = hi;
+                continue;
+            }
+
             auto state = _children[1]->getNext();
             if (state == PlanState::IS_EOF) {
                 // LEFT and OUTER joins should enumerate "non-returned" rows here.
@@ -196,6 +467,10 @@ PlanState HashJoinStage::getNext() {
                 _probeKey.reset(idx++, false, tag, val);
             }
 
+            if (!mayHaveOuterMatch(_probeKey)) {
+                continue;
+            }
+
             auto [low, hi] = _ht->equal_range(_probeKey);
             _htIt = low;
             _htItEnd = hi;
@@ -212,18 +487,35 @@ void HashJoinStage::close() {
 
     trackClose();
     _children[1]->close();
+    resetSpilledState();
     _ht = boost::none;
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spilledPartitions",
+                         static_cast<long long>(_specificStats.spilledPartitions));
+        bob.appendNumber("spilledRecords", static_cast<long long>(_specificStats.spilledRecords));
+        bob.appendNumber("spilledBytes", static_cast<long long>(_specificStats.spilledBytes));
+        bob.appendNumber("maxRecursionDepth",
+                         static_cast<long long>(_specificStats.maxRecursionDepth));
+        bob.appendNumber("rowsFilteredByBitmap",
+                         static_cast<long long>(_specificStats.rowsFilteredByBitmap));
+        ret->debugInfo = bob.obj();
+    }
+
     ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
     ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
@@ -233,6 +525,10 @@ std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
         DebugPrinter::addIdentifier(ret, *_collatorSlot);
     }
 
+    if (_allowDiskUse) {
+        ret.emplace_back("spill");
+    }
+
     ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
 
     DebugPrinter::addKeyword(ret, "left");
@@ -31,8 +31,12 @@
 
 #include <vector>
 
+#include "mongo/db/exec/record_id_bitmap.h"
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo::sbe {
 /**
@@ -51,9 +55,26 @@ namespace mongo::sbe {
  * for string equality. For example, this can be used to perform a case-insensitive join on string
  * values.
  *
+ * The hash table is limited in size by the
+ * 'internalQuerySlotBasedExecutionHashJoinApproxMemoryUseInBytesBeforeSpill' knob. If the outer
+ * side does not fit and 'allowDiskUse' is false, the hash table keeps growing in memory, unless the
+ * 'internalQuerySlotBasedExecutionHashJoinFailWithoutDiskUse' knob is set, in which case the stage
+ * fails the query. Otherwise the join falls back to a Grace hash join: rows of both sides are
+ * distributed by the hash of their keys into a number of partitions which are written to disk, and
+ * each pair of partitions is then joined separately. A partition whose outer side still does not
+ * fit in memory is partitioned again, up to
+ * 'internalQuerySlotBasedExecutionHashJoinMaxRecursionDepth' times. Once the stage has spilled, the
+ * inner side rows are materialized as well, so only the 'innerCond' and 'innerProjects' slots of
+ * the inner side remain visible to stages higher in the tree.
+ *
+ * When the join is on a single key and every outer key is a RecordId, as it is for an index
+ * intersection, the stage also collects the outer keys into a compact RecordId bitmap. Inner rows
+ * whose key is not in the bitmap are dropped without probing the hash table, and without being
+ * written to disk once the stage has spilled.
+ *
  * Debug string representation:
  *
- *   hj collatorSlot?
+ *   hj collatorSlot? spill?
  *     left [<outer cond>] [<outer projects>] childStage
  *     right [<inner cond>] [<inner projects>] childStage
  */
@@ -66,6 +87,7 @@ public:
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
                   boost::optional<value::SlotId> collatorSlot,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
     std::unique_ptr<PlanStage> clone() const final;
@@ -89,11 +111,82 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillFile = Sorter<value::MaterializedRow, value::MaterializedRow>::File;
+    using SpillWriter = SortedFileWriter<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
+    using SpilledKeyAccessor = value::MaterializedRowKeyAccessor<SpilledRow*>;
+    using SpilledProjectAccessor = value::MaterializedRowValueAccessor<SpilledRow*>;
+
+    /**
+     * One side of a spilled partition. Rows are appended through 'writer' until the side is
+     * finished, after which they can be read back through 'iterator'.
+     */
+    struct SpilledSide {
+        std::shared_ptr<SpillFile> file;
+        std::unique_ptr<SpillWriter> writer;
+        std::shared_ptr<SpillIterator> iterator;
+        size_t numRows{0};
+    };
+
+    struct Partition {
+        SpilledSide build;
+        SpilledSide probe;
+        size_t depth{0};
+    };
+
+    /**
+     * Creates a set of empty partitions at the given recursion depth.
+     */
+    std::vector<Partition> makePartitions(size_t depth);
+
+    /**
+     * Appends a row to the build or probe side of the partition selected by the hash of 'key'.
+     */
+    void addToPartition(std::vector<Partition>& partitions,
+                        bool build,
+                        const value::MaterializedRow& key,
+                        const value::MaterializedRow& project);
+
+    /**
+     * Writes the contents of the hash table to the build sides of 'partitions' and empties the hash
+     * table.
+     */
+    void spillHashTable(std::vector<Partition>& partitions);
+
+    /**
+     * Closes the writers of all 'partitions' and queues those which can produce results for
+     * processing.
+     */
+    void finishPartitions(std::vector<Partition>& partitions);
+
+    /**
+     * Loads the build side of the next queued partition into the hash table and positions
+     * '_spilledProbeIt' on its probe side. Partitions whose build side does not fit in memory are
+     * partitioned again. Returns false once all partitions have been processed.
+     */
+    bool loadNextPartition();
+
+    void resetSpilledState();
+
+    /**
+     * Returns false if the inner row with the given key certainly has no match on the outer side.
+     */
+    bool mayHaveOuterMatch(const value::MaterializedRow& key);
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
+
+    const long long _approxMemoryUseInBytesBeforeSpill =
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    const size_t _numPartitions = internalQuerySBEHashJoinNumPartitions.load();
+    const size_t _maxRecursionDepth = internalQuerySBEHashJoinMaxRecursionDepth.load();
+    const bool _failWithoutDiskUse = internalQuerySBEHashJoinFailWithoutDiskUse.load();
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -113,6 +206,14 @@ private:
     // Accessors of input condition values (keys) that are being inserted into the hash table.
     std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
 
+    // Accessors of inner projection values, which are materialized once the stage has spilled.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // Accessors of the inner keys and projections. They switch between the inner child and the
+    // current spilled inner row, depending on whether the stage has spilled.
+    value::SlotMap<std::unique_ptr<value::SwitchAccessor>> _outInnerAccessors;
+    std::vector<std::unique_ptr<value::SlotAccessor>> _spilledInnerAccessors;
+
     // Accessor for collator. Only set if collatorSlot provided during construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
 
@@ -123,8 +224,21 @@ private:
     TableType::iterator _htIt;
     TableType::iterator _htItEnd;
 
+    // Partitions waiting to be joined once the stage has spilled.
+    std::vector<Partition> _pendingPartitions;
+    std::shared_ptr<SpillIterator> _spilledProbeIt;
+    SpilledRow _spilledProbeRow;
+    SpilledRow* _spilledProbeRowIt{&_spilledProbeRow};
+    bool _spilled{false};
+
+    // Keys of the outer side, while all of them are RecordIds of a single key join.
+    RecordIdBitmap _outerRecordIds;
+    bool _useRecordIdBitmap{false};
+
     vm::ByteCode _bytecode;
 
+    HashJoinStats _specificStats;
+
     bool _compiled{false};
 };
 }  // namespace mongo::sbe
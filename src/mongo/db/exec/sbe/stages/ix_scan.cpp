@@ -331,7 +331,9 @@ PlanState IndexScanStage::getNext() {
 
     if (_firstGetNext) {
         _firstGetNext = false;
-        _nextRecord = _cursor->seekForKeyString(getSeekKeyLow());
+        // When the stage is reopened with the next interval of the index bounds, the storage
+        // cursor is usually positioned shortly before the new seek key.
+        _nextRecord = _cursor->seekForKeyStringNearby(getSeekKeyLow());
         ++_specificStats.seeks;
     } else {
         _nextRecord = _cursor->nextKeyString();
@@ -196,6 +196,66 @@ struct TraverseStats : public SpecificStats {
     size_t innerCloses{0};
 };
 
+struct HashAggStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashAggStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    bool usedDisk{false};
+    size_t spills{0};
+    size_t spilledRecords{0};
+};
+
+struct StreamingAggStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<StreamingAggStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    size_t groups{0};
+};
+
+struct HashJoinStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashJoinStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    bool usedDisk{false};
+    size_t spilledPartitions{0};
+    size_t spilledRecords{0};
+    uint64_t spilledBytes{0};
+    size_t maxRecursionDepth{0};
+    // Inner rows dropped because their RecordId key is not among the outer keys.
+    size_t rowsFilteredByBitmap{0};
+};
+
+struct WindowStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<WindowStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    size_t partitions{0};
+    size_t maxBufferedRows{0};
+    // The number of times the state of a window had to be rebuilt from the rows of its frame
+    // because the window function cannot remove a row from its state.
+    size_t recomputations{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
@@ -680,29 +680,19 @@ void ParallelScanStage::open(bool reOpen) {
         {
             stdx::unique_lock lock(_state->mutex);
             if (_state->ranges.empty()) {
-                auto ranges = _coll->getRecordStore()->numRecords(_opCtx) / 10240;
-                if (ranges < 2) {
-                    _state->ranges.emplace_back(Range{RecordId{}, RecordId{}});
-                } else {
-                    if (ranges > 1024) {
-                        ranges = 1024;
-                    }
-                    auto randomCursor = _coll->getRecordStore()->getRandomCursor(_opCtx);
-                    invariant(randomCursor);
-                    std::set<RecordId> rids;
-                    while (ranges--) {
-                        auto nextRecord = randomCursor->next();
-                        if (nextRecord) {
-                            rids.emplace(nextRecord->id);
-                        }
-                    }
-                    RecordId lastid{};
-                    for (auto id : rids) {
-                        _state->ranges.emplace_back(Range{lastid, id});
-                        lastid = id;
-                    }
-                    _state->ranges.emplace_back(Range{lastid, RecordId{}});
+                // Split the collection into many more ranges than there are producers. The ranges
+                // are handed out on demand, which balances the work between the producers.
+                auto numRanges = std::min<long long>(
+                    _coll->getRecordStore()->numRecords(_opCtx) / kRecordsPerRange, kMaxRanges);
+                auto boundaries = _coll->getRecordStore()->getScanRangeBoundaries(
+                    _opCtx, static_cast<size_t>(std::max(numRanges, 1LL)));
+
+                RecordId lastid{};
+                for (auto&& id : boundaries) {
+                    _state->ranges.emplace_back(Range{lastid, id});
+                    lastid = id;
                 }
+                _state->ranges.emplace_back(Range{lastid, RecordId{}});
             }
         }
 
@@ -718,7 +708,17 @@ boost::optional<Record> ParallelScanStage::nextRange() {
     if (_currentRange < _state->ranges.size()) {
         _range = _state->ranges[_currentRange];
 
-        return _range.begin.isNull() ? _cursor->next() : _cursor->seekExact(_range.begin);
+        if (_range.begin.isNull()) {
+            return _cursor->next();
+        }
+
+        // The boundary may have been deleted since the ranges were chosen, in which case the
+        // nearest record may precede the range.
+        auto record = _cursor->seekNear(_range.begin);
+        if (record && record->id < _range.begin) {
+            record = _cursor->next();
+        }
+        return record;
     } else {
         return boost::none;
     }
@@ -760,7 +760,7 @@ PlanState ParallelScanStage::getNext() {
             return trackPlanState(PlanState::IS_EOF);
         }
 
-        if (!_range.end.isNull() && nextRecord->id == _range.end) {
+        if (!_range.end.isNull() && nextRecord->id >= _range.end) {
             setNeedsRange();
             nextRecord = boost::none;
             continue;
@@ -179,6 +179,11 @@ private:
 };
 
 class ParallelScanStage final : public PlanStage {
+    // The target number of records in every range of the collection, and the maximum number of
+    // ranges the collection is split into.
+    static constexpr long long kRecordsPerRange = 10240;
+    static constexpr long long kMaxRanges = 1024;
+
     struct Range {
         RecordId begin;
         RecordId end;
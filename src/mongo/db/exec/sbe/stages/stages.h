@@ -343,7 +343,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -407,6 +407,21 @@ public:
      */
     virtual void close() = 0;
 
+    /**
+     * Replaces the yield policy of every stage in this tree which has yielding enabled. Stages
+     * capture the yield policy of the query they were built for, so a tree re-used by another
+     * query, e.g. a plan recovered from the SBE plan cache, must be attached to the yield policy
+     * of that query before it is executed.
+     */
+    void attachNewYieldPolicy(PlanYieldPolicy* yieldPolicy) {
+        if (_yieldPolicy) {
+            _yieldPolicy = yieldPolicy;
+        }
+        for (auto&& child : _children) {
+            child->attachNewYieldPolicy(yieldPolicy);
+        }
+    }
+
     virtual std::vector<DebugPrinter::Block> debugPrint() const {
         auto stats = getCommonStats();
         std::string str = str::stream() << '[' << stats->nodeId << "] " << stats->stageType;
@@ -0,0 +1,245 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/streaming_agg.h"
+
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace sbe {
+StreamingAggStage::StreamingAggStage(std::unique_ptr<PlanStage> input,
+                                     value::SlotVector gbs,
+                                     value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                                     boost::optional<value::SlotId> collatorSlot,
+                                     PlanNodeId planNodeId)
+    : PlanStage("sgroup"_sd, planNodeId),
+      _gbs(std::move(gbs)),
+      _aggs(std::move(aggs)),
+      _collatorSlot(collatorSlot) {
+    _children.emplace_back(std::move(input));
+}
+
+std::unique_ptr<PlanStage> StreamingAggStage::clone() const {
+    value::SlotMap<std::unique_ptr<EExpression>> aggs;
+    for (auto& [k, v] : _aggs) {
+        aggs.emplace(k, v->clone());
+    }
+    return std::make_unique<StreamingAggStage>(
+        _children[0]->clone(), _gbs, std::move(aggs), _collatorSlot, _commonStats.nodeId);
+}
+
+void StreamingAggStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    if (_collatorSlot) {
+        _collatorAccessor = getAccessor(ctx, *_collatorSlot);
+        tassert(6001000,
+                "collator accessor should exist if collator slot provided to StreamingAggStage",
+                _collatorAccessor != nullptr);
+    }
+
+    value::SlotSet dupCheck;
+    _currentKey.resize(_gbs.size());
+    size_t counter = 0;
+    for (auto& slot : _gbs) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        uassert(6001001, str::stream() << "duplicate field: " << slot, inserted);
+
+        _inKeyAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+        _outKeyAccessors.emplace_back(
+            std::make_unique<value::MaterializedSingleRowAccessor>(_currentKey, counter++));
+        _outAccessors[slot] = _outKeyAccessors.back().get();
+    }
+
+    for (auto& [slot, expr] : _aggs) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        const auto slotId = slot;
+        uassert(6001002, str::stream() << "duplicate field: " << slotId, inserted);
+
+        _outAggAccessors.emplace_back(std::make_unique<value::OwnedValueAccessor>());
+        _outAccessors[slot] = _outAggAccessors.back().get();
+
+        ctx.root = this;
+        ctx.aggExpression = true;
+        ctx.accumulator = _outAggAccessors.back().get();
+
+        _aggCodes.emplace_back(expr->compile(ctx));
+        ctx.aggExpression = false;
+    }
+    _compiled = true;
+}
+
+value::SlotAccessor* StreamingAggStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (_compiled) {
+        if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
+            return it->second;
+        }
+    } else {
+        return _children[0]->getAccessor(ctx, slot);
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+void StreamingAggStage::open(bool reOpen) {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+
+    if (_collatorAccessor) {
+        auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
+        uassert(6001003, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
+        _collator = value::getCollatorView(collatorVal);
+    }
+
+    // Read ahead the first row of the first group.
+    _childState = _children[0]->getNext();
+}
+
+bool StreamingAggStage::inputBelongsToCurrentGroup() const {
+    for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+        auto [lhsTag, lhsVal] = _inKeyAccessors[idx]->getViewOfValue();
+        auto [rhsTag, rhsVal] = _currentKey.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal, _collator);
+
+        if (tag != value::TypeTags::NumberInt32 || value::bitcastTo<int32_t>(val) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+PlanState StreamingAggStage::getNext() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    if (_childState != PlanState::ADVANCED) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    // The child holds the first row of a new group. Copy its keys, since the child slots are about
+    // to move on to the next rows, and reset the accumulators.
+    for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+        auto [tag, val] = _inKeyAccessors[idx]->getViewOfValue();
+        auto [copyTag, copyVal] = value::copyValue(tag, val);
+        _currentKey.reset(idx, true, copyTag, copyVal);
+    }
+    for (auto& accessor : _outAggAccessors) {
+        accessor->reset();
+    }
+
+    // Accumulate the rows until the end of the input, or until a row from the next group shows up.
+    do {
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, tag, val);
+        }
+
+        _childState = _children[0]->getNext();
+    } while (_childState == PlanState::ADVANCED && inputBelongsToCurrentGroup());
+
+    ++_specificStats.groups;
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void StreamingAggStage::close() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    trackClose();
+    _childState = PlanState::IS_EOF;
+    _children[0]->close();
+}
+
+std::unique_ptr<PlanStageStats> StreamingAggStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<StreamingAggStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        DebugPrinter printer;
+        BSONObjBuilder bob;
+        bob.append("groupBySlots", _gbs.begin(), _gbs.end());
+        if (!_aggs.empty()) {
+            BSONObjBuilder childrenBob(bob.subobjStart("expressions"));
+            for (auto&& [slot, expr] : _aggs) {
+                childrenBob.append(str::stream() << slot, printer.print(expr->debugPrint()));
+            }
+        }
+        bob.appendNumber("groups", static_cast<long long>(_specificStats.groups));
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* StreamingAggStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
+std::vector<DebugPrinter::Block> StreamingAggStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _gbs.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+
+        DebugPrinter::addIdentifier(ret, _gbs[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    bool first = true;
+    value::orderedSlotMapTraverse(_aggs, [&](auto slot, auto&& expr) {
+        if (!first) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+
+        DebugPrinter::addIdentifier(ret, slot);
+        ret.emplace_back("=");
+        DebugPrinter::addBlocks(ret, expr->debugPrint());
+        first = false;
+    });
+    ret.emplace_back("`]");
+
+    if (_collatorSlot) {
+        DebugPrinter::addIdentifier(ret, *_collatorSlot);
+    }
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo {
+namespace sbe {
+/**
+ * Performs an aggregation over an input which arrives grouped by the provided vector of group-by
+ * slots, 'gbs'. That is, all of the rows belonging to the same group must be contiguous in the
+ * input, as is the case when the input is ordered by the group-by keys. Appears as the "sgroup"
+ * stage in debug output. The 'aggs' parameter is a map from 'SlotId' to aggregate expression, in
+ * the same form as for the HashAggStage. Each group produces a single output, consisting of the
+ * values of the group-by keys and the results of the aggregate functions.
+ *
+ * Unlike the HashAggStage, this stage only ever keeps the state of a single group and returns it
+ * as soon as the first row of the next group is seen, so it neither blocks nor needs a hash table.
+ * When 'gbs' is empty, the entire input forms a single group. An empty input produces no groups.
+ *
+ * This is a "binding reflector": stages higher in the tree can only see the slots holding the
+ * group-by keys and those holding the corresponding aggregate values.
+ *
+ * The optional 'collatorSlot', if provided, changes the definition of string equality used when
+ * determining whether two group-by keys are equal. Note that the input must then be grouped
+ * according to the collation as well.
+ *
+ * Debug string representation:
+ *
+ *  sgroup [<group by slots>] [slot_1 = expr_1, ..., slot_n = expr_n] collatorSlot? childStage
+ */
+class StreamingAggStage final : public PlanStage {
+public:
+    StreamingAggStage(std::unique_ptr<PlanStage> input,
+                      value::SlotVector gbs,
+                      value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                      boost::optional<value::SlotId> collatorSlot,
+                      PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats(bool includeDebugInfo) const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    /**
+     * Returns true if the group-by keys of the current input row are equal to those of the group
+     * being accumulated.
+     */
+    bool inputBelongsToCurrentGroup() const;
+
+    const value::SlotVector _gbs;
+    const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
+    const boost::optional<value::SlotId> _collatorSlot;
+
+    value::SlotAccessorMap _outAccessors;
+    std::vector<value::SlotAccessor*> _inKeyAccessors;
+
+    // The group-by keys of the group being accumulated (or returned), along with the accessors
+    // exposing them.
+    value::MaterializedRow _currentKey;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _outKeyAccessors;
+
+    std::vector<std::unique_ptr<value::OwnedValueAccessor>> _outAggAccessors;
+    std::vector<std::unique_ptr<vm::CodeFragment>> _aggCodes;
+
+    // Only set if collator slot provided on construction.
+    value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
+
+    // The state of the child after the last call to its getNext(). When ADVANCED, the child slots
+    // hold the first row of the next group.
+    PlanState _childState{PlanState::IS_EOF};
+
+    vm::ByteCode _bytecode;
+
+    StreamingAggStats _specificStats;
+
+    bool _compiled{false};
+};
+}  // namespace sbe
+}  // namespace mongo
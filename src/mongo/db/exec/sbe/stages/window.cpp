@@ -0,0 +1,473 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/window.h"
+
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace sbe {
+WindowStage::Window WindowStage::Window::clone() const {
+    return Window{windowSlot,
+                  initExpr ? initExpr->clone() : nullptr,
+                  addExpr->clone(),
+                  removeExpr ? removeExpr->clone() : nullptr,
+                  lowerBound,
+                  upperBound,
+                  removeSeesNextRow};
+}
+
+WindowStage::WindowStage(std::unique_ptr<PlanStage> input,
+                         value::SlotVector currSlots,
+                         size_t partitionSlotCount,
+                         std::vector<Window> windows,
+                         boost::optional<value::SlotId> collatorSlot,
+                         PlanNodeId planNodeId)
+    : PlanStage("window"_sd, planNodeId),
+      _currSlots(std::move(currSlots)),
+      _partitionSlotCount(partitionSlotCount),
+      _windows(std::move(windows)),
+      _collatorSlot(collatorSlot) {
+    _children.emplace_back(std::move(input));
+    tassert(6000500,
+            "Window stage was given more partition slots than current slots",
+            _partitionSlotCount <= _currSlots.size());
+    for (auto& window : _windows) {
+        tassert(6000501,
+                "Window stage was given a window without an add expression",
+                window.addExpr != nullptr);
+        tassert(6000502,
+                "Window stage was given a frame whose lower bound exceeds its upper bound",
+                !window.lowerBound || !window.upperBound ||
+                    *window.lowerBound <= *window.upperBound);
+    }
+}
+
+std::unique_ptr<PlanStage> WindowStage::clone() const {
+    std::vector<Window> windows;
+    windows.reserve(_windows.size());
+    for (auto& window : _windows) {
+        windows.emplace_back(window.clone());
+    }
+    return std::make_unique<WindowStage>(_children[0]->clone(),
+                                         _currSlots,
+                                         _partitionSlotCount,
+                                         std::move(windows),
+                                         _collatorSlot,
+                                         _commonStats.nodeId);
+}
+
+void WindowStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    if (_collatorSlot) {
+        _collatorAccessor = getAccessor(ctx, *_collatorSlot);
+        tassert(6000503,
+                "collator accessor should exist if collator slot provided to WindowStage",
+                _collatorAccessor != nullptr);
+    }
+
+    value::SlotSet dupCheck;
+    for (auto& slot : _currSlots) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        uassert(6000504, str::stream() << "duplicate field: " << slot, inserted);
+
+        _inAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+        _outAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+        _outAccessorsMap[slot] = _outAccessors.back().get();
+        _frameAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+        _frameAccessorsMap[slot] = _frameAccessors.back().get();
+    }
+
+    for (auto& window : _windows) {
+        auto [it, inserted] = dupCheck.emplace(window.windowSlot);
+        // Some compilers do not allow to capture local bindings by lambda functions (the one
+        // is used implicitly in uassert below), so we need a local variable to construct an
+        // error message.
+        const auto slotId = window.windowSlot;
+        uassert(6000505, str::stream() << "duplicate field: " << slotId, inserted);
+
+        _windowAccessors.emplace_back(std::make_unique<value::OwnedValueAccessor>());
+        _windowAccessorsMap[window.windowSlot] = _windowAccessors.back().get();
+    }
+
+    // The window expressions see the row entering or leaving the frame through the 'currSlots', so
+    // they must be compiled before the accessors of the returned row become visible.
+    for (auto& window : _windows) {
+        ctx.root = this;
+        _initCodes.emplace_back(window.initExpr ? window.initExpr->compile(ctx) : nullptr);
+        _addCodes.emplace_back(window.addExpr->compile(ctx));
+        _removeCodes.emplace_back(window.removeExpr ? window.removeExpr->compile(ctx) : nullptr);
+    }
+    _frames.resize(_windows.size());
+    _compiled = true;
+}
+
+value::SlotAccessor* WindowStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _windowAccessorsMap.find(slot); it != _windowAccessorsMap.end()) {
+        return it->second;
+    }
+
+    const auto& accessors = _compiled ? _outAccessorsMap : _frameAccessorsMap;
+    if (auto it = accessors.find(slot); it != accessors.end()) {
+        return it->second;
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+void WindowStage::open(bool reOpen) {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+    _childOpened = true;
+
+    if (_collatorAccessor) {
+        auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
+        uassert(6000506, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
+        _collator = value::getCollatorView(collatorVal);
+    }
+
+    _nextPartitionRow = boost::none;
+    startNextPartition();
+}
+
+bool WindowStage::samePartition(const value::MaterializedRow& row) const {
+    for (size_t idx = 0; idx < _partitionSlotCount; ++idx) {
+        auto [lhsTag, lhsVal] = _partitionKey.getViewOfValue(idx);
+        auto [rhsTag, rhsVal] = row.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal, _collator);
+        if (tag != value::TypeTags::NumberInt32 || value::bitcastTo<int32_t>(val) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WindowStage::fetchNextRow() {
+    if (_partitionComplete) {
+        return false;
+    }
+
+    if (_children[0]->getNext() == PlanState::IS_EOF) {
+        _partitionComplete = true;
+        return false;
+    }
+
+    value::MaterializedRow row{_inAccessors.size()};
+    for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
+        auto [tag, val] = _inAccessors[idx]->copyOrMoveValue();
+        row.reset(idx, true, tag, val);
+    }
+
+    if (_partitionSize > 0 && !samePartition(row)) {
+        _nextPartitionRow = std::move(row);
+        _partitionComplete = true;
+        return false;
+    }
+
+    appendRow(std::move(row));
+    return true;
+}
+
+void WindowStage::appendRow(value::MaterializedRow row) {
+    if (_partitionSize == 0) {
+        _partitionKey.resize(_partitionSlotCount);
+        for (size_t idx = 0; idx < _partitionSlotCount; ++idx) {
+            auto [tag, val] = row.getViewOfValue(idx);
+            _partitionKey.reset(idx, false, tag, val);
+        }
+        _partitionKey.makeOwned();
+        _specificStats.partitions++;
+    }
+
+    _memoryUsageBytes += row.memUsageForSorter();
+    uassert(ErrorCodes::ExceededMemoryLimit,
+            str::stream() << "Exceeded memory limit in window stage, used " << _memoryUsageBytes
+                          << " bytes but max allowed is " << _maxMemoryUsageBytes,
+            _memoryUsageBytes <= _maxMemoryUsageBytes);
+
+    _rows.emplace_back(std::move(row));
+    ++_partitionSize;
+    _specificStats.maxBufferedRows = std::max(_specificStats.maxBufferedRows, _rows.size());
+}
+
+void WindowStage::startNextPartition() {
+    _rows.clear();
+    _rowsBase = 0;
+    _memoryUsageBytes = 0;
+    _partitionSize = 0;
+    _partitionComplete = false;
+    _currIdx = 0;
+
+    for (size_t idx = 0; idx < _windows.size(); ++idx) {
+        _frames[idx] = Frame{};
+        resetWindowState(idx);
+    }
+
+    if (_nextPartitionRow) {
+        auto row = std::move(*_nextPartitionRow);
+        _nextPartitionRow = boost::none;
+        appendRow(std::move(row));
+    }
+}
+
+void WindowStage::resetWindowState(size_t idx) {
+    if (_initCodes[idx]) {
+        auto [owned, tag, val] = _bytecode.run(_initCodes[idx].get());
+        _windowAccessors[idx]->reset(owned, tag, val);
+    } else {
+        _windowAccessors[idx]->reset();
+    }
+}
+
+void WindowStage::setFrameRow(int64_t rowIdx) {
+    auto& row = rowAt(rowIdx);
+    for (size_t idx = 0; idx < _frameAccessors.size(); ++idx) {
+        auto [tag, val] = row.getViewOfValue(idx);
+        _frameAccessors[idx]->reset(tag, val);
+    }
+}
+
+void WindowStage::runWindowCode(size_t idx, const vm::CodeFragment* code, int64_t rowIdx) {
+    setFrameRow(rowIdx);
+    auto [owned, tag, val] = _bytecode.run(code);
+    if (!owned) {
+        // The result may be a view of the current state (e.g. when the state is left unchanged),
+        // which is about to be released.
+        std::tie(tag, val) = value::copyValue(tag, val);
+    }
+    _windowAccessors[idx]->reset(true, tag, val);
+}
+
+void WindowStage::updateFrame(size_t idx, int64_t lo, int64_t hi) {
+    auto& frame = _frames[idx];
+    if (lo > frame.lo) {
+        if (lo >= frame.hi || !_removeCodes[idx]) {
+            // Either no row of the current frame survives, or the window function cannot remove
+            // rows from its state, so the state is rebuilt from the rows of the new frame.
+            if (lo < frame.hi) {
+                _specificStats.recomputations++;
+            }
+            resetWindowState(idx);
+            frame.lo = frame.hi = lo;
+        } else {
+            // The row following the one leaving the frame is still part of it, hence buffered.
+            for (; frame.lo < lo; ++frame.lo) {
+                runWindowCode(idx,
+                              _removeCodes[idx].get(),
+                              _windows[idx].removeSeesNextRow ? frame.lo + 1 : frame.lo);
+            }
+        }
+    }
+
+    for (; frame.hi < hi; ++frame.hi) {
+        runWindowCode(idx, _addCodes[idx].get(), frame.hi);
+    }
+}
+
+void WindowStage::trimBuffer() {
+    // Rows before the current one are only needed by windows which remove them from their frames
+    // later on. A frame without a lower bound never loses any row.
+    auto keepFrom = _currIdx;
+    for (size_t idx = 0; idx < _windows.size(); ++idx) {
+        if (_windows[idx].lowerBound) {
+            keepFrom = std::min(keepFrom, _frames[idx].lo);
+        }
+    }
+
+    while (_rowsBase < keepFrom && !_rows.empty()) {
+        _memoryUsageBytes -= _rows.front().memUsageForSorter();
+        _rows.pop_front();
+        ++_rowsBase;
+    }
+}
+
+PlanState WindowStage::getNext() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    trimBuffer();
+
+    // Make sure that the row to return is buffered, moving on to the next partition if the current
+    // one has been fully returned.
+    while (_currIdx >= _partitionSize && !fetchNextRow()) {
+        if (!_nextPartitionRow) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+        startNextPartition();
+    }
+
+    // Read ahead as many rows as required by the upper bounds of the frames.
+    for (auto& window : _windows) {
+        while (!_partitionComplete &&
+               (!window.upperBound || _partitionSize <= _currIdx + *window.upperBound)) {
+            fetchNextRow();
+        }
+    }
+
+    for (size_t idx = 0; idx < _windows.size(); ++idx) {
+        auto& window = _windows[idx];
+        auto lo = window.lowerBound
+            ? std::clamp(_currIdx + *window.lowerBound, int64_t{0}, _partitionSize)
+            : int64_t{0};
+        auto hi = window.upperBound
+            ? std::clamp(_currIdx + *window.upperBound + 1, int64_t{0}, _partitionSize)
+            : _partitionSize;
+        updateFrame(idx, lo, std::max(lo, hi));
+    }
+
+    auto& row = rowAt(_currIdx);
+    for (size_t idx = 0; idx < _outAccessors.size(); ++idx) {
+        auto [tag, val] = row.getViewOfValue(idx);
+        _outAccessors[idx]->reset(tag, val);
+    }
+    ++_currIdx;
+
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void WindowStage::close() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    trackClose();
+    _rows.clear();
+    _nextPartitionRow = boost::none;
+    for (auto& accessor : _windowAccessors) {
+        accessor->reset();
+    }
+
+    if (_childOpened) {
+        _children[0]->close();
+        _childOpened = false;
+    }
+}
+
+std::unique_ptr<PlanStageStats> WindowStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<WindowStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        DebugPrinter printer;
+        BSONObjBuilder bob;
+        bob.append("currSlots", _currSlots.begin(), _currSlots.end());
+        bob.appendNumber("partitionSlotCount", static_cast<long long>(_partitionSlotCount));
+        {
+            BSONObjBuilder windowsBob(bob.subobjStart("windows"));
+            for (auto& window : _windows) {
+                BSONObjBuilder windowBob(windowsBob.subobjStart(str::stream()
+                                                                << window.windowSlot));
+                if (window.initExpr) {
+                    windowBob.append("init", printer.print(window.initExpr->debugPrint()));
+                }
+                windowBob.append("add", printer.print(window.addExpr->debugPrint()));
+                if (window.removeExpr) {
+                    windowBob.append(window.removeSeesNextRow ? "removeNext" : "remove",
+                                     printer.print(window.removeExpr->debugPrint()));
+                }
+            }
+        }
+        bob.appendNumber("partitions", static_cast<long long>(_specificStats.partitions));
+        bob.appendNumber("maxBufferedRows",
+                         static_cast<long long>(_specificStats.maxBufferedRows));
+        bob.appendNumber("recomputations", static_cast<long long>(_specificStats.recomputations));
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* WindowStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
+std::vector<DebugPrinter::Block> WindowStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _currSlots.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addIdentifier(ret, _currSlots[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    ret.emplace_back(std::to_string(_partitionSlotCount));
+
+    auto printBound = [&](const boost::optional<int64_t>& bound) {
+        ret.emplace_back(bound ? std::to_string(*bound) : std::string{"unbounded"});
+    };
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _windows.size(); ++idx) {
+        auto& window = _windows[idx];
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addIdentifier(ret, window.windowSlot);
+        ret.emplace_back("=");
+        ret.emplace_back(DebugPrinter::Block("{`"));
+        if (window.initExpr) {
+            ret.emplace_back("init:");
+            DebugPrinter::addBlocks(ret, window.initExpr->debugPrint());
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        ret.emplace_back("add:");
+        DebugPrinter::addBlocks(ret, window.addExpr->debugPrint());
+        if (window.removeExpr) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+            ret.emplace_back(window.removeSeesNextRow ? "removeNext:" : "remove:");
+            DebugPrinter::addBlocks(ret, window.removeExpr->debugPrint());
+        }
+        ret.emplace_back(DebugPrinter::Block("`,"));
+        ret.emplace_back("frame:");
+        ret.emplace_back(DebugPrinter::Block("[`"));
+        printBound(window.lowerBound);
+        ret.emplace_back(DebugPrinter::Block("`,"));
+        printBound(window.upperBound);
+        ret.emplace_back(DebugPrinter::Block("`]"));
+        ret.emplace_back(DebugPrinter::Block("`}"));
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    if (_collatorSlot) {
+        DebugPrinter::addIdentifier(ret, *_collatorSlot);
+    }
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,216 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo {
+namespace sbe {
+/**
+ * Evaluates window functions over a stream of rows which arrives grouped into contiguous partitions
+ * and sorted within each partition. Appears as the "window" stage in debug output.
+ *
+ * The stage buffers the values of 'currSlots' for the rows of the current partition. The first
+ * 'partitionSlotCount' slots of 'currSlots' hold the partition key: a row whose partition key
+ * differs from that of the previous row starts a new partition. The optional 'collatorSlot', if
+ * provided, is used when comparing the partition keys.
+ *
+ * Each entry of 'windows' describes a window function over a document-based frame. The frame of
+ * the i-th row of a partition spans the rows [i + lowerBound, i + upperBound] of the partition,
+ * where a missing bound stands for the start (or the end) of the partition. The state of a window
+ * function is kept in the 'windowSlot' and is maintained incrementally by the following
+ * expressions, which are compiled and evaluated by the VM:
+ *  - 'initExpr' produces the state of an empty frame. If not provided, the state is Nothing.
+ *  - 'addExpr' produces the new state after a row enters the frame.
+ *  - 'removeExpr' produces the new state after a row leaves the frame. If not provided, the state
+ *    is recomputed from the rows still in the frame instead, which is how functions like $min
+ *    that cannot undo an addition are handled.
+ * Both 'addExpr' and 'removeExpr' may refer to the 'windowSlot', which holds the current state,
+ * and to any of the 'currSlots', which then hold the values of the row entering (or leaving) the
+ * frame. A window with 'removeSeesNextRow' set instead sees the row which becomes the first row of
+ * the frame in 'removeExpr': functions over consecutive rows like $integral keep the first row of
+ * the frame in their state, and need the one following it to take it out. Stages higher in the
+ * tree see the 'currSlots' of the row being returned, along with the 'windowSlot' holding the state
+ * of its frame. Any finalization of the state (e.g. dividing a sum by a count) is left to the
+ * parent stages.
+ *
+ * Rows are returned as soon as the frames of all windows are known, so only as many rows as are
+ * covered by the frames are buffered. A frame with no upper bound requires the whole partition to
+ * be buffered. The size of the buffer is limited by the
+ * 'internalDocumentSourceSetWindowFieldsMaxMemoryBytes' knob.
+ *
+ * Debug string representation:
+ *
+ *  window [<current slots>] <partition slot count> [slot_1 = {init: expr, add: expr, remove: expr,
+ *  frame: [lower, upper]}, ..., slot_n = {...}] collatorSlot? childStage
+ *
+ * where 'remove' is printed as 'removeNext' for a window with 'removeSeesNextRow' set.
+ */
+class WindowStage final : public PlanStage {
+public:
+    struct Window {
+        Window clone() const;
+
+        value::SlotId windowSlot;
+        std::unique_ptr<EExpression> initExpr;
+        std::unique_ptr<EExpression> addExpr;
+        std::unique_ptr<EExpression> removeExpr;
+        // A missing bound means that the frame is unbounded on that side.
+        boost::optional<int64_t> lowerBound;
+        boost::optional<int64_t> upperBound;
+        bool removeSeesNextRow{false};
+    };
+
+    WindowStage(std::unique_ptr<PlanStage> input,
+                value::SlotVector currSlots,
+                size_t partitionSlotCount,
+                std::vector<Window> windows,
+                boost::optional<value::SlotId> collatorSlot,
+                PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats(bool includeDebugInfo) const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    // The rows of the current partition which are included in a frame, as a half-open interval of
+    // positions within the partition.
+    struct Frame {
+        int64_t lo{0};
+        int64_t hi{0};
+    };
+
+    /**
+     * Reads the next row of the current partition from the child and appends it to the buffer.
+     * Returns false if the current partition has no more rows, either because the input is
+     * exhausted or because the row which was read belongs to the next partition. In the latter
+     * case the row is stashed away until the current partition is fully returned.
+     */
+    bool fetchNextRow();
+
+    /**
+     * Appends a row to the buffer of the current partition. The first row of a partition sets the
+     * partition key.
+     */
+    void appendRow(value::MaterializedRow row);
+
+    /**
+     * Empties the buffer and the state of all windows and starts the next partition from the
+     * stashed row.
+     */
+    void startNextPartition();
+
+    /**
+     * Moves the frame of the window at index 'idx' to cover the rows [lo, hi) of the partition.
+     */
+    void updateFrame(size_t idx, int64_t lo, int64_t hi);
+
+    void resetWindowState(size_t idx);
+    void runWindowCode(size_t idx, const vm::CodeFragment* code, int64_t rowIdx);
+    void setFrameRow(int64_t rowIdx);
+
+    /**
+     * Drops buffered rows which can no longer be part of any frame.
+     */
+    void trimBuffer();
+
+    bool samePartition(const value::MaterializedRow& row) const;
+
+    const value::MaterializedRow& rowAt(int64_t rowIdx) const {
+        return _rows[rowIdx - _rowsBase];
+    }
+
+    const value::SlotVector _currSlots;
+    const size_t _partitionSlotCount;
+    const std::vector<Window> _windows;
+    const boost::optional<value::SlotId> _collatorSlot;
+    const long long _maxMemoryUsageBytes =
+        internalDocumentSourceSetWindowFieldsMaxMemoryBytes.load();
+
+    // Accessors of the child's 'currSlots'.
+    std::vector<value::SlotAccessor*> _inAccessors;
+    // Accessors exposing the row being returned to the parent stages.
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outAccessors;
+    value::SlotMap<value::SlotAccessor*> _outAccessorsMap;
+    // Accessors exposing the row entering or leaving a frame to the window expressions.
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _frameAccessors;
+    value::SlotMap<value::SlotAccessor*> _frameAccessorsMap;
+    // Accessors holding the state of each window.
+    std::vector<std::unique_ptr<value::OwnedValueAccessor>> _windowAccessors;
+    value::SlotMap<value::SlotAccessor*> _windowAccessorsMap;
+
+    std::vector<std::unique_ptr<vm::CodeFragment>> _initCodes;
+    std::vector<std::unique_ptr<vm::CodeFragment>> _addCodes;
+    std::vector<std::unique_ptr<vm::CodeFragment>> _removeCodes;
+
+    // Only set if collator slot provided on construction.
+    value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
+
+    // The buffered rows of the current partition. The first buffered row is at position
+    // '_rowsBase' within the partition.
+    std::deque<value::MaterializedRow> _rows;
+    int64_t _rowsBase{0};
+    long long _memoryUsageBytes{0};
+    // The partition key of the current partition.
+    value::MaterializedRow _partitionKey;
+    // The number of rows of the current partition read so far.
+    int64_t _partitionSize{0};
+    // Set when all of the rows of the current partition have been read.
+    bool _partitionComplete{false};
+    // The first row of the next partition, read while looking for the end of the current one.
+    boost::optional<value::MaterializedRow> _nextPartitionRow;
+    // The position of the next row to return within the current partition.
+    int64_t _currIdx{0};
+    std::vector<Frame> _frames;
+
+    vm::ByteCode _bytecode;
+
+    WindowStats _specificStats;
+
+    bool _compiled{false};
+    bool _childOpened{false};
+};
+}  // namespace sbe
+}  // namespace mongo
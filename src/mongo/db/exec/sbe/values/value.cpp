@@ -277,6 +277,9 @@ void releaseValue(TypeTags tag, Value val) noexcept {
         case TypeTags::sortSpec:
             delete getSortSpecView(val);
             break;
+        case TypeTags::valueBlock:
+            delete getValueBlockView(val);
+            break;
         default:
             break;
     }
@@ -399,6 +402,9 @@ void writeTagToStream(T& stream, const TypeTags tag) {
         case TypeTags::sortSpec:
             stream << "sortSpec";
             break;
+        case TypeTags::valueBlock:
+            stream << "valueBlock";
+            break;
         default:
             stream << "unknown tag";
             break;
@@ -681,6 +687,23 @@ void writeValueToStream(T& stream, TypeTags tag, Value val, size_t depth = 1) {
             writeCollatorToStream(stream, getSortSpecView(val)->getCollator());
             stream << ')';
             break;
+        case TypeTags::valueBlock: {
+            auto block = getValueBlockView(val);
+            stream << "Block[";
+            for (size_t idx = 0; idx < block->size(); ++idx) {
+                if (idx) {
+                    stream << ", ";
+                }
+                if (idx == kArrayObjectOrNestingMaxDepth) {
+                    stream << "...";
+                    break;
+                }
+                auto [blockTag, blockVal] = block->getAt(idx);
+                writeValueToStream(stream, blockTag, blockVal, depth + 1);
+            }
+            stream << ']';
+            break;
+        }
         default:
             MONGO_UNREACHABLE;
     }
@@ -152,6 +152,9 @@ enum class TypeTags : uint8_t {
 
     // Pointer to a SortSpec object.
     sortSpec,
+
+    // Pointer to a ValueBlock holding a batch of values for block-at-a-time execution.
+    valueBlock,
 };
 
 inline constexpr bool isNumber(TypeTags tag) noexcept {
@@ -571,6 +574,69 @@ private:
     std::vector<Value> _values;
 };
 
+/**
+ * A batch of values processed together in block-at-a-time (vectorized) execution. Unlike 'Array', a
+ * block preserves Nothing values so that the i-th entry of every block built from the same batch
+ * of rows belongs to the same row. A block owns all the values it holds.
+ */
+class ValueBlock {
+public:
+    ValueBlock() = default;
+    ValueBlock(const ValueBlock& other) {
+        reserve(other._vals.size());
+        for (size_t idx = 0; idx < other._vals.size(); ++idx) {
+            const auto [tag, val] = copyValue(other._tags[idx], other._vals[idx]);
+            _tags.push_back(tag);
+            _vals.push_back(val);
+        }
+    }
+    ValueBlock(ValueBlock&&) = default;
+    ~ValueBlock() {
+        for (size_t idx = 0; idx < _tags.size(); ++idx) {
+            releaseValue(_tags[idx], _vals[idx]);
+        }
+    }
+
+    /**
+     * Appends the value to the end of the block taking ownership of it. Nothing is a valid entry.
+     */
+    void push_back(TypeTags tag, Value val) {
+        ValueGuard guard{tag, val};
+        _tags.push_back(tag);
+        _vals.push_back(val);
+        guard.reset();
+    }
+
+    auto size() const noexcept {
+        return _vals.size();
+    }
+
+    std::pair<TypeTags, Value> getAt(std::size_t idx) const {
+        if (idx >= _vals.size()) {
+            return {TypeTags::Nothing, 0};
+        }
+
+        return {_tags[idx], _vals[idx]};
+    }
+
+    const TypeTags* tags() const noexcept {
+        return _tags.data();
+    }
+
+    const Value* vals() const noexcept {
+        return _vals.data();
+    }
+
+    void reserve(size_t s) {
+        _tags.reserve(s);
+        _vals.reserve(s);
+    }
+
+private:
+    std::vector<TypeTags> _tags;
+    std::vector<Value> _vals;
+};
+
 /**
  * This is a set of unique values with the same interface as Array.
  */
@@ -911,6 +977,20 @@ inline Array* getArrayView(Value val) noexcept {
     return reinterpret_cast<Array*>(val);
 }
 
+inline std::pair<TypeTags, Value> makeNewValueBlock() {
+    auto b = new ValueBlock;
+    return {TypeTags::valueBlock, reinterpret_cast<Value>(b)};
+}
+
+inline std::pair<TypeTags, Value> makeCopyValueBlock(const ValueBlock& inB) {
+    auto b = new ValueBlock(inB);
+    return {TypeTags::valueBlock, reinterpret_cast<Value>(b)};
+}
+
+inline ValueBlock* getValueBlockView(Value val) noexcept {
+    return reinterpret_cast<ValueBlock*>(val);
+}
+
 inline ArraySet* getArraySetView(Value val) noexcept {
     return reinterpret_cast<ArraySet*>(val);
 }
@@ -1178,6 +1258,8 @@ inline std::pair<TypeTags, Value> copyValue(TypeTags tag, Value val) {
             return makeCopyFtsMatcher(*getFtsMatcherView(val));
         case TypeTags::sortSpec:
             return makeCopySortSpec(*getSortSpecView(val));
+        case TypeTags::valueBlock:
+            return makeCopyValueBlock(*getValueBlockView(val));
         default:
             break;
     }
@@ -51,6 +51,7 @@
 #include "mongo/db/storage/key_string.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/summation.h"
 
@@ -93,6 +94,13 @@ int Instruction::stackOffset[Instruction::Tags::lastInstruction] = {
     -1,  // neq
     -1,  // cmp3w
 
+    0,  // lessConst
+    0,  // lessEqConst
+    0,  // greaterConst
+    0,  // greaterEqConst
+    0,  // eqConst
+    0,  // neqConst
+
     -2,  // collLess
     -2,  // collLessEq
     -2,  // collGreater
@@ -103,6 +111,7 @@ int Instruction::stackOffset[Instruction::Tags::lastInstruction] = {
 
     -1,  // fillEmpty
     -1,  // getField
+    0,   // getFieldImm
     -1,  // getElement
     -1,  // collComparisonKey
     -1,  // getFieldOrElement
@@ -346,6 +355,39 @@ void CodeFragment::appendGetField() {
     appendSimpleInstruction(Instruction::getField);
 }
 
+void CodeFragment::appendGetField(StringData fieldName) {
+    invariant(fieldName.size() <= kMaxImmFieldNameSize);
+
+    Instruction i;
+    i.tag = Instruction::getFieldImm;
+    adjustStackSimple(i);
+
+    auto size = static_cast<uint8_t>(fieldName.size());
+    auto offset = allocateSpace(sizeof(Instruction) + sizeof(size) + size);
+
+    offset += writeToMemory(offset, i);
+    offset += writeToMemory(offset, size);
+    memcpy(offset, fieldName.rawData(), size);
+}
+
+void CodeFragment::appendCompareConst(Instruction::Tags tag,
+                                      value::TypeTags constTag,
+                                      value::Value constVal) {
+    invariant(tag == Instruction::lessConst || tag == Instruction::lessEqConst ||
+              tag == Instruction::greaterConst || tag == Instruction::greaterEqConst ||
+              tag == Instruction::eqConst || tag == Instruction::neqConst);
+
+    Instruction i;
+    i.tag = tag;
+    adjustStackSimple(i);
+
+    auto offset = allocateSpace(sizeof(Instruction) + sizeof(constTag) + sizeof(constVal));
+
+    offset += writeToMemory(offset, i);
+    offset += writeToMemory(offset, constTag);
+    offset += writeToMemory(offset, constVal);
+}
+
 void CodeFragment::appendGetElement() {
     appendSimpleInstruction(Instruction::getElement);
 }
@@ -524,8 +566,12 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::getField(value::TypeTa
         return {false, value::TypeTags::Nothing, 0};
     }
 
-    auto fieldStr = value::getStringView(fieldTag, fieldValue);
+    return getField(objTag, objValue, value::getStringView(fieldTag, fieldValue));
+}
 
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::getField(value::TypeTags objTag,
+                                                                   value::Value objValue,
+                                                                   StringData fieldStr) {
     if (MONGO_unlikely(failOnPoisonedFieldLookup.shouldFail())) {
         uassert(4623399, "Lookup of $POISON", fieldStr != "POISON");
     }
@@ -1464,26 +1510,26 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinNewKeyString(Ar
     auto orderingBits = value::numericCast<int32_t>(tagInOrdering, valInOrdering);
     BSONObjBuilder bb;
     for (size_t i = 0; i < Ordering::kMaxCompoundIndexKeys; ++i) {
-        bb.append(""_sd, (orderingBits & (1 << i)) ? 1 : 0);
+        // A set bit marks a descending field, which 'Ordering::make()' expects as a negative value.
+        bb.append(""_sd, (orderingBits & (1 << i)) ? -1 : 1);
     }
 
     KeyString::HeapBuilder kb{version, Ordering::make(bb.done())};
 
     for (size_t idx = 2; idx < arity - 1u; ++idx) {
         auto [_, tag, val] = getFromStack(idx);
-        if (value::isNumber(tag)) {
+        if (tag == value::TypeTags::NumberInt32 || tag == value::TypeTags::NumberInt64) {
             auto num = value::numericCast<int64_t>(tag, val);
             kb.appendNumberLong(num);
         } else if (value::isString(tag)) {
             auto str = value::getStringView(tag, val);
             kb.appendString(str);
-        } else if (tag == value::TypeTags::MinKey || tag == value::TypeTags::MaxKey) {
+        } else if (tag != value::TypeTags::Nothing && tag != value::TypeTags::RecordId &&
+                   tag <= value::TypeTags::bsonCodeWScope) {
+            // Round-trip any other value with a BSON representation (including MinKey and MaxKey)
+            // through a BSON element so that it is encoded exactly as an index would encode it.
             BSONObjBuilder bob;
-            if (tag == value::TypeTags::MinKey) {
-                bob.appendMinKey("");
-            } else {
-                bob.appendMaxKey("");
-            }
+            bson::appendValueToBsonObj(bob, ""_sd, tag, val);
             kb.appendBSONElement(bob.obj().firstElement(), nullptr);
         } else {
             uasserted(4822802, "unsuppored key string type");
@@ -3598,6 +3644,226 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinTsIncrement(Ari
     return {false, value::TypeTags::NumberInt64, value::bitcastFrom<uint64_t>(timestamp.getInc())};
 }
 
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::removableSumUpdate(int64_t quantity) {
+    auto [stateOwned, stateTag, stateVal] = getFromStack(0);
+    // Not a structured binding, as the value is captured by the lambda below.
+    value::TypeTags fieldTag;
+    value::Value fieldVal;
+    std::tie(std::ignore, fieldTag, fieldVal) = getFromStack(1);
+
+    // Non-numeric values are skipped, as by $sum.
+    if (!value::isNumber(fieldTag)) {
+        auto [tag, val] = value::copyValue(stateTag, stateVal);
+        return {true, tag, val};
+    }
+
+    // Read the current state, starting from an empty sum if there is none yet.
+    value::TypeTags accTag = value::TypeTags::Nothing;
+    value::Value accVal = 0;
+    std::array<int64_t, RemovableSumElems::kRemovableSumSizeOfArray> counts{};
+    if (stateTag == value::TypeTags::Array) {
+        auto state = value::getArrayView(stateVal);
+        tassert(6000516,
+                str::stream() << "The removable sum state must have "
+                              << RemovableSumElems::kRemovableSumSizeOfArray
+                              << " elements but got: " << state->size(),
+                state->size() == RemovableSumElems::kRemovableSumSizeOfArray);
+        std::tie(accTag, accVal) = state->getAt(RemovableSumElems::kSumAcc);
+        for (size_t idx = RemovableSumElems::kNanCount;
+             idx < RemovableSumElems::kRemovableSumSizeOfArray;
+             ++idx) {
+            auto [countTag, countVal] = state->getAt(idx);
+            counts[idx] = value::bitcastTo<int64_t>(countVal);
+        }
+    }
+
+    // Accumulates 'val' into a new sum, or only copies the current one if 'tag' is Nothing.
+    auto accumulate = [&](value::TypeTags tag, value::Value val) {
+        if (accTag == value::TypeTags::Nothing) {
+            auto [owned, sumTag, sumVal] = aggDoubleDoubleSum(accTag,
+                                                              accVal,
+                                                              value::TypeTags::NumberInt32,
+                                                              value::bitcastFrom<int32_t>(0));
+            value::ValueGuard sumGuard{sumTag, sumVal};
+            auto [newOwned, newTag, newVal] = aggDoubleDoubleSum(sumTag, sumVal, tag, val);
+            return std::make_pair(newTag, newVal);
+        }
+        auto [owned, newTag, newVal] = aggDoubleDoubleSum(accTag, accVal, tag, val);
+        return std::make_pair(newTag, newVal);
+    };
+
+    auto [newAccTag, newAccVal] = [&]() {
+        switch (fieldTag) {
+            case value::TypeTags::NumberInt32:
+                return accumulate(value::TypeTags::NumberInt64,
+                                  value::bitcastFrom<int64_t>(
+                                      quantity * value::bitcastTo<int32_t>(fieldVal)));
+            case value::TypeTags::NumberInt64: {
+                auto longVal = value::bitcastTo<int64_t>(fieldVal);
+                if (longVal == std::numeric_limits<int64_t>::min() && quantity == -1) {
+                    // Avoid overflow by removing the value in two parts.
+                    auto [partTag, partVal] = accumulate(
+                        value::TypeTags::NumberInt64,
+                        value::bitcastFrom<int64_t>(std::numeric_limits<int64_t>::max()));
+                    value::ValueGuard partGuard{partTag, partVal};
+                    auto [owned, tag, val] = aggDoubleDoubleSum(partTag,
+                                                                partVal,
+                                                                value::TypeTags::NumberInt64,
+                                                                value::bitcastFrom<int64_t>(1));
+                    return std::make_pair(tag, val);
+                }
+                return accumulate(value::TypeTags::NumberInt64,
+                                  value::bitcastFrom<int64_t>(quantity * longVal));
+            }
+            case value::TypeTags::NumberDouble: {
+                counts[RemovableSumElems::kDoubleCount] += quantity;
+                auto doubleVal = value::bitcastTo<double>(fieldVal);
+                if (std::isnan(doubleVal)) {
+                    counts[RemovableSumElems::kNanCount] += quantity;
+                } else if (doubleVal == std::numeric_limits<double>::infinity()) {
+                    counts[RemovableSumElems::kPosInfinityCount] += quantity;
+                } else if (doubleVal == -std::numeric_limits<double>::infinity()) {
+                    counts[RemovableSumElems::kNegInfinityCount] += quantity;
+                } else {
+                    return accumulate(value::TypeTags::NumberDouble,
+                                      value::bitcastFrom<double>(quantity * doubleVal));
+                }
+                return accumulate(value::TypeTags::Nothing, 0);
+            }
+            case value::TypeTags::NumberDecimal: {
+                counts[RemovableSumElems::kDecimalCount] += quantity;
+                auto decimalVal = value::bitcastTo<Decimal128>(fieldVal);
+                if (decimalVal.isNaN()) {
+                    counts[RemovableSumElems::kNanCount] += quantity;
+                } else if (decimalVal.isInfinite()) {
+                    counts[decimalVal.isNegative() ? RemovableSumElems::kNegInfinityCount
+                                                   : RemovableSumElems::kPosInfinityCount] +=
+                        quantity;
+                } else {
+                    auto [tag, val] = value::makeCopyDecimal(quantity == -1 ? decimalVal.negate()
+                                                                            : decimalVal);
+                    value::ValueGuard decimalGuard{tag, val};
+                    return accumulate(tag, val);
+                }
+                return accumulate(value::TypeTags::Nothing, 0);
+            }
+            default:
+                MONGO_UNREACHABLE_TASSERT(6000517);
+        }
+    }();
+    value::ValueGuard accGuard{newAccTag, newAccVal};
+
+    auto [resTag, resVal] = value::makeNewArray();
+    value::ValueGuard resGuard{resTag, resVal};
+    auto res = value::getArrayView(resVal);
+    res->reserve(RemovableSumElems::kRemovableSumSizeOfArray);
+    accGuard.reset();
+    res->push_back(newAccTag, newAccVal);
+    for (size_t idx = RemovableSumElems::kNanCount;
+         idx < RemovableSumElems::kRemovableSumSizeOfArray;
+         ++idx) {
+        res->push_back(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(counts[idx]));
+    }
+
+    resGuard.reset();
+    return {true, resTag, resVal};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinRemovableSumAdd(ArityType arity) {
+    invariant(arity == 2);
+    return removableSumUpdate(1);
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinRemovableSumRemove(
+    ArityType arity) {
+    invariant(arity == 2);
+    return removableSumUpdate(-1);
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinRemovableSumFinalize(
+    ArityType arity) {
+    invariant(arity == 1);
+
+    // The sum of no values is 0.
+    auto [stateOwned, stateTag, stateVal] = getFromStack(0);
+    if (stateTag != value::TypeTags::Array) {
+        return {false, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(0)};
+    }
+
+    auto state = value::getArrayView(stateVal);
+    auto getCount = [&](RemovableSumElems elem) {
+        return value::bitcastTo<int64_t>(state->getAt(elem).second);
+    };
+    auto hasDecimal = getCount(RemovableSumElems::kDecimalCount) > 0;
+    auto hasDouble = getCount(RemovableSumElems::kDoubleCount) > 0;
+
+    // NaN and infinite values dominate the sum, and are returned as decimals if any decimal value
+    // was summed up.
+    auto makeSpecialValue = [&](const Decimal128& decimalVal, double doubleVal) {
+        if (hasDecimal) {
+            auto [tag, val] = value::makeCopyDecimal(decimalVal);
+            return std::make_tuple(true, tag, val);
+        }
+        return std::make_tuple(
+            false, value::TypeTags::NumberDouble, value::bitcastFrom<double>(doubleVal));
+    };
+    auto posInfinityCount = getCount(RemovableSumElems::kPosInfinityCount);
+    auto negInfinityCount = getCount(RemovableSumElems::kNegInfinityCount);
+    if (getCount(RemovableSumElems::kNanCount) > 0 ||
+        (posInfinityCount > 0 && negInfinityCount > 0)) {
+        return makeSpecialValue(Decimal128::kPositiveNaN,
+                                std::numeric_limits<double>::quiet_NaN());
+    } else if (posInfinityCount > 0) {
+        return makeSpecialValue(Decimal128::kPositiveInfinity,
+                                std::numeric_limits<double>::infinity());
+    } else if (negInfinityCount > 0) {
+        return makeSpecialValue(Decimal128::kNegativeInfinity,
+                                -std::numeric_limits<double>::infinity());
+    }
+
+    auto makeIntOrLong = [](int64_t longVal) {
+        if (int32_t intVal = longVal; intVal == longVal) {
+            return std::make_tuple(
+                false, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(intVal));
+        }
+        return std::make_tuple(
+            false, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(longVal));
+    };
+
+    // The type of the sum is the widest type ever summed up, which may be wider than the values
+    // still in the frame, so narrow it down to the widest type of those.
+    auto [sumAccTag, sumAccVal] = state->getAt(RemovableSumElems::kSumAcc);
+    auto [owned, tag, val] = doubleDoubleSumFinalize(sumAccTag, sumAccVal);
+    value::ValueGuard guard{tag, val};
+    if (tag == value::TypeTags::NumberDecimal && !hasDecimal) {
+        auto decimalVal = value::bitcastTo<Decimal128>(val);
+        if (hasDouble) {
+            return {false,
+                    value::TypeTags::NumberDouble,
+                    value::bitcastFrom<double>(decimalVal.toDouble())};
+        }
+        std::uint32_t signalingFlags = Decimal128::SignalingFlag::kNoFlag;
+        auto longVal = decimalVal.toLong(&signalingFlags);
+        if (signalingFlags == Decimal128::SignalingFlag::kNoFlag) {
+            return makeIntOrLong(longVal);
+        }
+        return {false,
+                value::TypeTags::NumberDouble,
+                value::bitcastFrom<double>(decimalVal.toDouble())};
+    } else if (tag == value::TypeTags::NumberDouble && !hasDouble) {
+        auto doubleVal = value::bitcastTo<double>(val);
+        if (doubleVal >= std::numeric_limits<long long>::min() &&
+            doubleVal < static_cast<double>(std::numeric_limits<long long>::max())) {
+            return makeIntOrLong(llround(doubleVal));
+        }
+    } else if (tag == value::TypeTags::NumberInt64) {
+        return makeIntOrLong(value::bitcastTo<int64_t>(val));
+    }
+
+    guard.reset();
+    return {owned, tag, val};
+}
+
 std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinHash(ArityType arity) {
     auto hashVal = value::hashInit();
     for (ArityType idx = 0; idx < arity; ++idx) {
@@ -3608,6 +3874,245 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinHash(ArityType
     return {false, value::TypeTags::NumberInt64, value::bitcastFrom<decltype(hashVal)>(hashVal)};
 }
 
+namespace {
+/**
+ * Returns the block at the given stack position, or nullptr if the value is not a 'valueBlock'.
+ */
+value::ValueBlock* getBlockArg(value::TypeTags tag, value::Value val) {
+    return tag == value::TypeTags::valueBlock ? value::getValueBlockView(val) : nullptr;
+}
+
+bool isSelected(const value::ValueBlock* bitmap, size_t idx) {
+    if (!bitmap) {
+        return true;
+    }
+    auto [tag, val] = bitmap->getAt(idx);
+    return tag == value::TypeTags::Boolean && value::bitcastTo<bool>(val);
+}
+}  // namespace
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockFillEmpty(
+    ArityType arity) {
+    invariant(arity == 2);
+
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [fillOwned, fillTag, fillVal] = getFromStack(1);
+
+    auto block = getBlockArg(blockTag, blockVal);
+    if (!block) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard guard{resTag, resVal};
+    auto res = value::getValueBlockView(resVal);
+    res->reserve(block->size());
+
+    for (size_t idx = 0; idx < block->size(); ++idx) {
+        auto [tag, val] = block->getAt(idx);
+        if (tag == value::TypeTags::Nothing) {
+            std::tie(tag, val) = value::copyValue(fillTag, fillVal);
+        } else {
+            std::tie(tag, val) = value::copyValue(tag, val);
+        }
+        res->push_back(tag, val);
+    }
+
+    guard.reset();
+    return {true, resTag, resVal};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockGetField(
+    ArityType arity) {
+    invariant(arity == 2);
+
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [fieldOwned, fieldTag, fieldVal] = getFromStack(1);
+
+    auto block = getBlockArg(blockTag, blockVal);
+    if (!block || !value::isString(fieldTag)) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard guard{resTag, resVal};
+    auto res = value::getValueBlockView(resVal);
+    res->reserve(block->size());
+
+    for (size_t idx = 0; idx < block->size(); ++idx) {
+        auto [objTag, objVal] = block->getAt(idx);
+        auto [owned, tag, val] = getField(objTag, objVal, fieldTag, fieldVal);
+        if (!owned) {
+            // The field is a view into the object held by the input block, so it must be copied.
+            std::tie(tag, val) = value::copyValue(tag, val);
+        }
+        res->push_back(tag, val);
+    }
+
+    guard.reset();
+    return {true, resTag, resVal};
+}
+
+template <typename Op>
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockCmpScalar(
+    ArityType arity) {
+    invariant(arity == 2);
+
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [scalarOwned, scalarTag, scalarVal] = getFromStack(1);
+
+    auto block = getBlockArg(blockTag, blockVal);
+    if (!block) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard guard{resTag, resVal};
+    auto res = value::getValueBlockView(resVal);
+    res->reserve(block->size());
+
+    const auto tags = block->tags();
+    const auto vals = block->vals();
+    for (size_t idx = 0; idx < block->size(); ++idx) {
+        // The result of a comparison is always a shallow value (Boolean or Nothing).
+        if constexpr (std::is_same_v<Op, std::not_equal_to<>>) {
+            // Mirror the 'neq' instruction which is defined as the negation of 'eq'.
+            auto [tag, val] =
+                genericCompare<std::equal_to<>>(tags[idx], vals[idx], scalarTag, scalarVal);
+            std::tie(tag, val) = genericNot(tag, val);
+            res->push_back(tag, val);
+        } else {
+            auto [tag, val] = genericCompare<Op>(tags[idx], vals[idx], scalarTag, scalarVal);
+            res->push_back(tag, val);
+        }
+    }
+
+    guard.reset();
+    return {true, resTag, resVal};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockLogicalAnd(
+    ArityType arity) {
+    invariant(arity == 2);
+
+    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+    auto [rhsOwned, rhsTag, rhsVal] = getFromStack(1);
+
+    auto lhs = getBlockArg(lhsTag, lhsVal);
+    auto rhs = getBlockArg(rhsTag, rhsVal);
+    if (!lhs || !rhs || lhs->size() != rhs->size()) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard guard{resTag, resVal};
+    auto res = value::getValueBlockView(resVal);
+    res->reserve(lhs->size());
+
+    for (size_t idx = 0; idx < lhs->size(); ++idx) {
+        auto [lTag, lVal] = lhs->getAt(idx);
+        auto [rTag, rVal] = rhs->getAt(idx);
+        const bool lBool = lTag == value::TypeTags::Boolean;
+        const bool rBool = rTag == value::TypeTags::Boolean;
+        if ((lBool && !value::bitcastTo<bool>(lVal)) || (rBool && !value::bitcastTo<bool>(rVal))) {
+            res->push_back(value::TypeTags::Boolean, value::bitcastFrom<bool>(false));
+        } else if (lBool && rBool) {
+            res->push_back(value::TypeTags::Boolean, value::bitcastFrom<bool>(true));
+        } else {
+            res->push_back(value::TypeTags::Nothing, 0);
+        }
+    }
+
+    guard.reset();
+    return {true, resTag, resVal};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::valueBlockAggregate(ArityType arity,
+                                                                              AggFn aggFn) {
+    invariant(arity == 2 || arity == 3);
+
+    auto [ownAgg, tagAgg, valAgg] = getFromStack(0);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(1);
+
+    // Take ownership of the accumulator.
+    value::TypeTags accTag = tagAgg;
+    value::Value accVal = valAgg;
+    if (ownAgg) {
+        topStack(false, value::TypeTags::Nothing, 0);
+    } else {
+        std::tie(accTag, accVal) = value::copyValue(tagAgg, valAgg);
+    }
+    ScopeGuard accGuard([&] { value::releaseValue(accTag, accVal); });
+
+    auto block = getBlockArg(blockTag, blockVal);
+    const value::ValueBlock* bitmap = nullptr;
+    if (arity == 3) {
+        auto [bitmapOwned, bitmapTag, bitmapVal] = getFromStack(2);
+        bitmap = getBlockArg(bitmapTag, bitmapVal);
+    }
+
+    if (block && (arity == 2 || (bitmap && bitmap->size() == block->size()))) {
+        const auto tags = block->tags();
+        const auto vals = block->vals();
+        for (size_t idx = 0; idx < block->size(); ++idx) {
+            if (tags[idx] == value::TypeTags::Nothing || !isSelected(bitmap, idx)) {
+                continue;
+            }
+
+            auto [owned, tag, val] = (this->*aggFn)(accTag, accVal, tags[idx], vals[idx]);
+            if (!owned) {
+                std::tie(tag, val) = value::copyValue(tag, val);
+            }
+
+            value::releaseValue(accTag, accVal);
+            accTag = tag;
+            accVal = val;
+        }
+    }
+
+    accGuard.dismiss();
+    return {true, accTag, accVal};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockSum(ArityType arity) {
+    return valueBlockAggregate(arity, &ByteCode::aggSum);
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMin(ArityType arity) {
+    return valueBlockAggregate(arity, &ByteCode::aggMin);
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMax(ArityType arity) {
+    return valueBlockAggregate(arity, &ByteCode::aggMax);
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockCount(ArityType arity) {
+    invariant(arity == 2 || arity == 3);
+
+    auto [accOwned, accTag, accVal] = getFromStack(0);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(1);
+
+    int64_t count = accTag == value::TypeTags::NumberInt64 ? value::bitcastTo<int64_t>(accVal) : 0;
+
+    auto block = getBlockArg(blockTag, blockVal);
+    const value::ValueBlock* bitmap = nullptr;
+    if (arity == 3) {
+        auto [bitmapOwned, bitmapTag, bitmapVal] = getFromStack(2);
+        bitmap = getBlockArg(bitmapTag, bitmapVal);
+    }
+
+    if (block && (arity == 2 || (bitmap && bitmap->size() == block->size()))) {
+        const auto tags = block->tags();
+        for (size_t idx = 0; idx < block->size(); ++idx) {
+            if (tags[idx] != value::TypeTags::Nothing && isSelected(bitmap, idx)) {
+                ++count;
+            }
+        }
+    }
+
+    return {false, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(count)};
+}
+
 std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builtin f,
                                                                           ArityType arity) {
     switch (f) {
@@ -3781,6 +4286,38 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinTsSecond(arity);
         case Builtin::tsIncrement:
             return builtinTsIncrement(arity);
+        case Builtin::removableSumAdd:
+            return builtinRemovableSumAdd(arity);
+        case Builtin::removableSumRemove:
+            return builtinRemovableSumRemove(arity);
+        case Builtin::removableSumFinalize:
+            return builtinRemovableSumFinalize(arity);
+        case Builtin::valueBlockFillEmpty:
+            return builtinValueBlockFillEmpty(arity);
+        case Builtin::valueBlockGetField:
+            return builtinValueBlockGetField(arity);
+        case Builtin::valueBlockGtScalar:
+            return builtinValueBlockCmpScalar<std::greater<>>(arity);
+        case Builtin::valueBlockGteScalar:
+            return builtinValueBlockCmpScalar<std::greater_equal<>>(arity);
+        case Builtin::valueBlockLtScalar:
+            return builtinValueBlockCmpScalar<std::less<>>(arity);
+        case Builtin::valueBlockLteScalar:
+            return builtinValueBlockCmpScalar<std::less_equal<>>(arity);
+        case Builtin::valueBlockEqScalar:
+            return builtinValueBlockCmpScalar<std::equal_to<>>(arity);
+        case Builtin::valueBlockNeqScalar:
+            return builtinValueBlockCmpScalar<std::not_equal_to<>>(arity);
+        case Builtin::valueBlockLogicalAnd:
+            return builtinValueBlockLogicalAnd(arity);
+        case Builtin::valueBlockSum:
+            return builtinValueBlockSum(arity);
+        case Builtin::valueBlockMin:
+            return builtinValueBlockMin(arity);
+        case Builtin::valueBlockMax:
+            return builtinValueBlockMax(arity);
+        case Builtin::valueBlockCount:
+            return builtinValueBlockCount(arity);
     }
 
     MONGO_UNREACHABLE;
@@ -3821,6 +4358,24 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::runLambdaInternal(
     return {retOwn, retTag, retVal};
 }
 
+template <typename Op>
+void ByteCode::runCompareConst(const uint8_t*& pcPointer) {
+    auto constTag = readFromMemory<value::TypeTags>(pcPointer);
+    pcPointer += sizeof(constTag);
+    auto constVal = readFromMemory<value::Value>(pcPointer);
+    pcPointer += sizeof(constVal);
+
+    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+    auto [tag, val] = compareWithConstant<Op>(lhsTag, lhsVal, constTag, constVal);
+
+    topStack(false, tag, val);
+
+    if (lhsOwned) {
+        value::releaseValue(lhsTag, lhsVal);
+    }
+}
+
 void ByteCode::runInternal(const CodeFragment* code, int64_t position) {
     auto pcPointer = code->instrs().data() + position;
     auto pcEnd = pcPointer + code->instrs().size();
@@ -4230,6 +4785,34 @@ void ByteCode::runInternal(const CodeFragment* code, int64_t position) {
                     }
                     break;
                 }
+                case Instruction::lessConst: {
+                    runCompareConst<std::less<>>(pcPointer);
+                    break;
+                }
+                case Instruction::lessEqConst: {
+                    runCompareConst<std::less_equal<>>(pcPointer);
+                    break;
+                }
+                case Instruction::greaterConst: {
+                    runCompareConst<std::greater<>>(pcPointer);
+                    break;
+                }
+                case Instruction::greaterEqConst: {
+                    runCompareConst<std::greater_equal<>>(pcPointer);
+                    break;
+                }
+                case Instruction::eqConst: {
+                    runCompareConst<std::equal_to<>>(pcPointer);
+                    break;
+                }
+                case Instruction::neqConst: {
+                    runCompareConst<std::equal_to<>>(pcPointer);
+
+                    auto [owned, tag, val] = getFromStack(0);
+                    std::tie(tag, val) = genericNot(tag, val);
+                    topStack(false, tag, val);
+                    break;
+                }
                 case Instruction::collEq: {
                     auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
                     popStack();
@@ -4370,6 +4953,23 @@ void ByteCode::runInternal(const CodeFragment* code, int64_t position) {
                     }
                     break;
                 }
+                case Instruction::getFieldImm: {
+                    auto size = readFromMemory<uint8_t>(pcPointer);
+                    pcPointer += sizeof(size);
+                    StringData fieldName(reinterpret_cast<const char*>(pcPointer), size);
+                    pcPointer += size;
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [owned, tag, val] = getField(lhsTag, lhsVal, fieldName);
+
+                    topStack(owned, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
                 case Instruction::getElement: {
                     auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
                     popStack();
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -197,6 +198,50 @@ std::pair<value::TypeTags, value::Value> genericCompare(value::TypeTags lhsTag,
     return genericCompare(lhsTag, lhsValue, rhsTag, rhsValue, comparator, op);
 }
 
+/**
+ * Compares a value against a constant without a collation. This is the common case of a simple
+ * predicate, so values of the same type as the constant are compared directly and only other
+ * combinations of types take the general path of genericCompare().
+ */
+template <typename Op>
+std::pair<value::TypeTags, value::Value> compareWithConstant(value::TypeTags lhsTag,
+                                                             value::Value lhsValue,
+                                                             value::TypeTags constTag,
+                                                             value::Value constValue,
+                                                             Op op = {}) {
+    if (lhsTag == constTag) {
+        switch (constTag) {
+            case value::TypeTags::NumberInt32: {
+                auto result = op(value::bitcastTo<int32_t>(lhsValue),
+                                 value::bitcastTo<int32_t>(constValue));
+                return {value::TypeTags::Boolean, value::bitcastFrom<bool>(result)};
+            }
+            case value::TypeTags::NumberInt64:
+            case value::TypeTags::Date: {
+                auto result = op(value::bitcastTo<int64_t>(lhsValue),
+                                 value::bitcastTo<int64_t>(constValue));
+                return {value::TypeTags::Boolean, value::bitcastFrom<bool>(result)};
+            }
+            case value::TypeTags::NumberDouble: {
+                auto result =
+                    op(value::bitcastTo<double>(lhsValue), value::bitcastTo<double>(constValue));
+                return {value::TypeTags::Boolean, value::bitcastFrom<bool>(result)};
+            }
+            default:
+                break;
+        }
+    }
+
+    if (value::isString(lhsTag) && value::isString(constTag)) {
+        auto result = op(value::getStringView(lhsTag, lhsValue)
+                             .compare(value::getStringView(constTag, constValue)),
+                         0);
+        return {value::TypeTags::Boolean, value::bitcastFrom<bool>(result)};
+    }
+
+    return genericCompare(lhsTag, lhsValue, constTag, constValue, nullptr, op);
+}
+
 struct Instruction {
     enum Tags {
         pushConstVal,
@@ -229,6 +274,14 @@ struct Instruction {
         // 3 way comparison (spaceship) with bson woCompare semantics.
         cmp3w,
 
+        // Comparisons with a constant encoded in the instruction.
+        lessConst,
+        lessEqConst,
+        greaterConst,
+        greaterEqConst,
+        eqConst,
+        neqConst,
+
         // collation-aware comparison instructions
         collLess,
         collLessEq,
@@ -240,6 +293,7 @@ struct Instruction {
 
         fillEmpty,
         getField,
+        getFieldImm,  // the field name is encoded in the instruction
         getElement,
         collComparisonKey,
         getFieldOrElement,
@@ -381,6 +435,28 @@ enum class Builtin : uint8_t {
     generateSortKey,
     tsSecond,
     tsIncrement,
+
+    // Maintain the state of a $sum window function whose frame can lose values as well as gain
+    // them. See 'RemovableSumElems'.
+    removableSumAdd,
+    removableSumRemove,
+    removableSumFinalize,
+
+    // Block-at-a-time variants of the hot instructions. They operate on 'valueBlock' arguments
+    // and process the whole batch of values in a single dispatch.
+    valueBlockFillEmpty,
+    valueBlockGetField,
+    valueBlockGtScalar,
+    valueBlockGteScalar,
+    valueBlockLtScalar,
+    valueBlockLteScalar,
+    valueBlockEqScalar,
+    valueBlockNeqScalar,
+    valueBlockLogicalAnd,
+    valueBlockSum,    // agg function to sum the selected values of a block
+    valueBlockMin,    // agg function to find the minimum of the selected values of a block
+    valueBlockMax,    // agg function to find the maximum of the selected values of a block
+    valueBlockCount,  // agg function to count the selected values of a block
 };
 
 /**
@@ -406,11 +482,39 @@ enum AggSumValueElems {
     kMaxSizeOfArray
 };
 
+/**
+ * This enum defines indices into an 'Array' that holds the state of a removable $sum, which mirrors
+ * the classic 'RemovableSum' window function state.
+ *
+ * The array contains the following elements:
+ * - The element at index `kSumAcc` is the sum of all finite values, accumulated by
+ * 'aggDoubleDoubleSum()'.
+ * - The elements at indices `kNanCount`, `kPosInfinityCount` and `kNegInfinityCount` count the NaN
+ * and infinite values, which could not be taken out of the sum again once added to it.
+ * - The elements at indices `kDoubleCount` and `kDecimalCount` count the double and decimal values,
+ * which determine the type of the result.
+ *
+ * See 'removableSumUpdate()'/'builtinRemovableSumFinalize()' for more details.
+ */
+enum RemovableSumElems {
+    kSumAcc,
+    kNanCount,
+    kPosInfinityCount,
+    kNegInfinityCount,
+    kDoubleCount,
+    kDecimalCount,
+    // This is actually not an index but represents the number of elements.
+    kRemovableSumSizeOfArray
+};
+
 using SmallArityType = uint8_t;
 using ArityType = uint32_t;
 
 class CodeFragment {
 public:
+    // The longest field name that can be encoded in a getFieldImm instruction.
+    static constexpr size_t kMaxImmFieldNameSize = std::numeric_limits<uint8_t>::max();
+
     auto& instrs() {
         return _instrs;
     }
@@ -465,6 +569,7 @@ public:
     void appendCmp3w() {
         appendSimpleInstruction(Instruction::cmp3w);
     }
+    void appendCompareConst(Instruction::Tags tag, value::TypeTags constTag, value::Value constVal);
     void appendCollLess() {
         appendSimpleInstruction(Instruction::collLess);
     }
@@ -490,6 +595,7 @@ public:
         appendSimpleInstruction(Instruction::fillEmpty);
     }
     void appendGetField();
+    void appendGetField(StringData fieldName);
     void appendGetElement();
     void appendCollComparisonKey();
     void appendGetFieldOrElement();
@@ -667,6 +773,12 @@ private:
                                                              value::Value objValue,
                                                              value::TypeTags fieldTag,
                                                              value::Value fieldValue);
+    std::tuple<bool, value::TypeTags, value::Value> getField(value::TypeTags objTag,
+                                                             value::Value objValue,
+                                                             StringData fieldStr);
+
+    template <typename Op>
+    void runCompareConst(const uint8_t*& pcPointer);
 
     std::tuple<bool, value::TypeTags, value::Value> getElement(value::TypeTags objTag,
                                                                value::Value objValue,
@@ -880,6 +992,33 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinGenerateSortKey(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinTsSecond(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinTsIncrement(ArityType arity);
+    // Adds ('quantity' is 1) or removes ('quantity' is -1) a value to or from the state of a
+    // removable $sum.
+    std::tuple<bool, value::TypeTags, value::Value> removableSumUpdate(int64_t quantity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinRemovableSumAdd(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinRemovableSumRemove(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinRemovableSumFinalize(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockFillEmpty(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockGetField(ArityType arity);
+    template <typename Op>
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockCmpScalar(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockLogicalAnd(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockSum(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMin(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMax(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockCount(ArityType arity);
+
+    using AggFn = std::tuple<bool, value::TypeTags, value::Value> (ByteCode::*)(value::TypeTags,
+                                                                               value::Value,
+                                                                               value::TypeTags,
+                                                                               value::Value);
+    /**
+     * Folds the values of the block at stack position 1 into the accumulator at stack position 0
+     * using 'aggFn'. If the optional selection bitmap block is present at stack position 2 then
+     * only the values whose bitmap entry is Boolean true are folded.
+     */
+    std::tuple<bool, value::TypeTags, value::Value> valueBlockAggregate(ArityType arity,
+                                                                        AggFn aggFn);
 
     std::tuple<bool, value::TypeTags, value::Value> dispatchBuiltin(Builtin f, ArityType arity);
 
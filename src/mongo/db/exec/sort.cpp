@@ -32,6 +32,7 @@
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/sort.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
 
 namespace mongo {
@@ -113,9 +114,19 @@ SortStageDefault::SortStageDefault(boost::intrusive_ptr<ExpressionContext> expCt
                     limit,
                     maxMemoryUsageBytes,
                     expCtx->tempDir,
-                    expCtx->allowDiskUse) {}
+                    expCtx->allowDiskUse,
+                    internalQueryEncodeSortKeysAsKeyString.load()) {}
 
 void SortStageDefault::spool(WorkingSetID wsid) {
+    auto member = _ws->get(wsid);
+    if (member->hasObj() && _sortExecutor.rejectByLeadingComponent([&] {
+            return _sortKeyGen.computeLeadingSortKeyComponent(member->doc.value(),
+                                                              member->metadata());
+        })) {
+        _ws->free(wsid);
+        return;
+    }
+
     SortableWorkingSetMember extractedMember{_ws->extract(wsid)};
     auto sortKey = _sortKeyGen.computeSortKey(*extractedMember);
     _sortExecutor.add(sortKey, extractedMember);
@@ -126,13 +137,16 @@ PlanStage::StageState SortStageDefault::unspool(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (!_addSortKeyMetadata) {
+        *out = _ws->emplace(_sortExecutor.getNextData().extract());
+        return PlanStage::ADVANCED;
+    }
+
     auto&& [key, nextWsm] = _sortExecutor.getNext();
     *out = _ws->emplace(nextWsm.extract());
 
-    if (_addSortKeyMetadata) {
-        auto member = _ws->get(*out);
-        member->metadata().setSortKey(std::move(key), _sortKeyGen.isSingleElementKey());
-    }
+    auto member = _ws->get(*out);
+    member->metadata().setSortKey(std::move(key), _sortKeyGen.isSingleElementKey());
 
     return PlanStage::ADVANCED;
 }
@@ -149,7 +163,8 @@ SortStageSimple::SortStageSimple(boost::intrusive_ptr<ExpressionContext> expCtx,
                     limit,
                     maxMemoryUsageBytes,
                     expCtx->tempDir,
-                    expCtx->allowDiskUse) {}
+                    expCtx->allowDiskUse,
+                    internalQueryEncodeSortKeysAsKeyString.load()) {}
 
 void SortStageSimple::spool(WorkingSetID wsid) {
     auto member = _ws->get(wsid);
@@ -157,6 +172,14 @@ void SortStageSimple::spool(WorkingSetID wsid) {
     invariant(!member->doc.value().metadata());
     invariant(member->hasObj());
 
+    if (_sortExecutor.rejectByLeadingComponent([&] {
+            return _sortKeyGen.computeLeadingSortKeyComponent(member->doc.value(),
+                                                              member->doc.value().metadata());
+        })) {
+        _ws->free(wsid);
+        return;
+    }
+
     auto sortKey = _sortKeyGen.computeSortKeyFromDocument(member->doc.value());
 
     _sortExecutor.add(std::move(sortKey), member->doc.value().toBson());
@@ -168,7 +191,13 @@ PlanStage::StageState SortStageSimple::unspool(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
-    auto&& [key, nextObj] = _sortExecutor.getNext();
+    BSONObj nextObj;
+    Value key;
+    if (_addSortKeyMetadata) {
+        std::tie(key, nextObj) = _sortExecutor.getNext();
+    } else {
+        nextObj = _sortExecutor.getNextData();
+    }
 
     *out = _ws->allocate();
     auto member = _ws->get(*out);
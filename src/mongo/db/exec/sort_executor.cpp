@@ -50,6 +50,37 @@ std::string nextFileName() {
     return "extsort-sort-executor." + std::to_string(sortExecutorFileCounter.fetchAndAdd(1));
 }
 }  // namespace
+
+namespace sort_key_encoding {
+Ordering makeOrdering(const SortPattern& sortPattern) {
+    BSONObjBuilder orderingBuilder;
+    for (auto&& part : sortPattern) {
+        orderingBuilder.append(""_sd, part.isAscending ? 1 : -1);
+    }
+    return Ordering::make(orderingBuilder.obj());
+}
+
+KeyString::Value encode(const Value& sortKey, bool isSingleElementKey, Ordering ordering) {
+    // The sort key generator substitutes null for missing fields, so every component of the key
+    // is appended.
+    BSONObjBuilder keyBuilder;
+    if (isSingleElementKey) {
+        sortKey.addToBsonObj(&keyBuilder, ""_sd);
+    } else {
+        for (auto&& component : sortKey.getArray()) {
+            component.addToBsonObj(&keyBuilder, ""_sd);
+        }
+    }
+
+    return KeyString::HeapBuilder(KeyString::Version::kLatestVersion, keyBuilder.obj(), ordering)
+        .release();
+}
+
+Value decode(const KeyString::Value& encodedKey, bool isSingleElementKey, Ordering ordering) {
+    return DocumentMetadataFields::deserializeSortKey(isSingleElementKey,
+                                                      KeyString::toBson(encodedKey, ordering));
+}
+}  // namespace sort_key_encoding
 }  // namespace mongo
 
 #include "mongo/db/sorter/sorter.cpp"
@@ -61,3 +92,12 @@ MONGO_CREATE_SORTER(mongo::Value,
                     mongo::SortableWorkingSetMember,
                     mongo::SortExecutor<mongo::SortableWorkingSetMember>::Comparator);
 MONGO_CREATE_SORTER(mongo::Value, mongo::BSONObj, mongo::SortExecutor<mongo::BSONObj>::Comparator);
+MONGO_CREATE_SORTER(mongo::KeyString::Value,
+                    mongo::Document,
+                    mongo::SortExecutor<mongo::Document>::KeyStringComparator);
+MONGO_CREATE_SORTER(mongo::KeyString::Value,
+                    mongo::SortableWorkingSetMember,
+                    mongo::SortExecutor<mongo::SortableWorkingSetMember>::KeyStringComparator);
+MONGO_CREATE_SORTER(mongo::KeyString::Value,
+                    mongo::BSONObj,
+                    mongo::SortExecutor<mongo::BSONObj>::KeyStringComparator);
@@ -29,15 +29,37 @@
 
 #pragma once
 
+#include "mongo/bson/ordering.h"
 #include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/sort_key_comparator.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string.h"
 
 namespace mongo {
+namespace sort_key_encoding {
+/**
+ * Returns the Ordering under which KeyString-encoded sort keys for 'sortPattern' compare in the
+ * same order as SortKeyComparator compares the original keys. The pattern must not have more than
+ * Ordering::kMaxCompoundIndexKeys components.
+ */
+Ordering makeOrdering(const SortPattern& sortPattern);
+
+/**
+ * Encodes 'sortKey', as produced by SortKeyGenerator, into a KeyString using 'ordering'.
+ */
+KeyString::Value encode(const Value& sortKey, bool isSingleElementKey, Ordering ordering);
+
+/**
+ * Reverses encode(), returning the original sort key.
+ */
+Value decode(const KeyString::Value& encodedKey, bool isSingleElementKey, Ordering ordering);
+}  // namespace sort_key_encoding
+
 /**
  * The SortExecutor class is the internal implementation of sorting for query execution. The
  * caller should provide input documents by repeated calls to the add() function, and then
@@ -47,6 +69,10 @@ namespace mongo {
  * The template parameter is the type of data being sorted. In DocumentSource execution, we sort
  * Document objects directly, but in the PlanStage layer we may sort WorkingSetMembers. The type of
  * the sort key, on the other hand, is always Value.
+ *
+ * If requested, each sort key is encoded into a KeyString once when it is added. The sorter then
+ * compares keys with a binary comparison and spills the compact encoded form, and keys are decoded
+ * back into Values as they are returned.
  */
 template <typename T>
 class SortExecutor {
@@ -64,17 +90,34 @@ public:
         SortKeyComparator _sortKeyComparator;
     };
 
+    using KeyStringSorter = Sorter<KeyString::Value, T>;
+    class KeyStringComparator {
+    public:
+        int operator()(const typename KeyStringSorter::Data& lhs,
+                       const typename KeyStringSorter::Data& rhs) const {
+            // The sort directions are already encoded into the keys by their Ordering.
+            return lhs.first.compare(rhs.first);
+        }
+    };
+
     /**
-     * If the passed in limit is 0, this is treated as no limit.
+     * If the passed in limit is 0, this is treated as no limit. If 'encodeSortKeysAsKeyString' is
+     * true, sort keys are KeyString-encoded unless the sort pattern has too many components for
+     * an Ordering.
      */
     SortExecutor(SortPattern sortPattern,
                  uint64_t limit,
                  uint64_t maxMemoryUsageBytes,
                  std::string tempDir,
-                 bool allowDiskUse)
+                 bool allowDiskUse,
+                 bool encodeSortKeysAsKeyString = false)
         : _sortPattern(std::move(sortPattern)),
           _tempDir(std::move(tempDir)),
           _diskUseAllowed(allowDiskUse) {
+        if (encodeSortKeysAsKeyString &&
+            _sortPattern.size() <= Ordering::kMaxCompoundIndexKeys) {
+            _keyStringOrdering.emplace(sort_key_encoding::makeOrdering(_sortPattern));
+        }
         _stats.sortPattern =
             _sortPattern.serialize(SortPattern::SortKeySerialization::kForExplain).toBson();
         _stats.limit = limit;
@@ -102,6 +145,10 @@ public:
         return _stats.limit > 0;
     }
 
+    bool isEncodingSortKeysAsKeyString() const {
+        return static_cast<bool>(_keyStringOrdering);
+    }
+
     bool wasDiskUsed() const {
         return _stats.spills > 0;
     }
@@ -123,24 +170,84 @@ public:
      * Should only be called before 'loadingDone()' is called.
      */
     void add(const Value& sortKey, const T& data) {
+        if (_keyStringOrdering) {
+            if (!_keyStringSorter) {
+                _keyStringSorter.reset(makeKeyStringSorter());
+            }
+            _keyStringSorter->add(sort_key_encoding::encode(sortKey,
+                                                            _sortPattern.isSingleElementKey(),
+                                                            *_keyStringOrdering),
+                                  data);
+            return;
+        }
+
         if (!_sorter) {
             _sorter.reset(DocumentSorter::make(makeSortOptions(), Comparator(_sortPattern)));
         }
         _sorter->add(sortKey, data);
     }
 
+    /**
+     * Attempts to reject an input to a top-k sort by comparing only the first component of its
+     * sort key against the worst input kept so far. 'computeLeadingComponent' is invoked only
+     * once such a bound exists, and must return the first component of the input's sort key or
+     * boost::none if it cannot be determined cheaply. Returns true if the input sorts strictly
+     * after the bound, in which case the caller should drop it without generating its full sort
+     * key. Dropped inputs are still counted in 'keysSorted'.
+     */
+    template <typename LeadingComponentFn>
+    bool rejectByLeadingComponent(LeadingComponentFn&& computeLeadingComponent) {
+        // With a single-component pattern the leading component is the whole key, so there is
+        // nothing to save over letting the sorter reject the input itself. KeyString-encoded keys
+        // are cheap enough to compare in full that decoding the cutoff would not pay off.
+        if (!hasLimit() || !_sorter || _sortPattern.isSingleElementKey()) {
+            return false;
+        }
+
+        auto cutoffKey = _sorter->getCutoffKey();
+        if (!cutoffKey) {
+            return false;
+        }
+
+        boost::optional<Value> leadingComponent = computeLeadingComponent();
+        if (!leadingComponent) {
+            return false;
+        }
+
+        // Sort keys are collation comparison keys, so they are always compared as binary.
+        int cmp = ValueComparator().compare(*leadingComponent, (*cutoffKey)[0]);
+        if (!_sortPattern[0].isAscending) {
+            cmp = -cmp;
+        }
+        if (cmp <= 0) {
+            return false;
+        }
+
+        ++_stats.keysSorted;
+        return true;
+    }
+
     /**
      * Signals to the sort executor that there will be no more input documents.
      */
     void loadingDone() {
+        if (_keyStringOrdering) {
+            // This conditional should only pass if no documents were added to the sorter.
+            if (!_keyStringSorter) {
+                _keyStringSorter.reset(makeKeyStringSorter());
+            }
+            _keyStringOutput.reset(_keyStringSorter->done());
+            recordSorterStats(*_keyStringSorter);
+            _keyStringSorter.reset();
+            return;
+        }
+
         // This conditional should only pass if no documents were added to the sorter.
         if (!_sorter) {
             _sorter.reset(DocumentSorter::make(makeSortOptions(), Comparator(_sortPattern)));
         }
         _output.reset(_sorter->done());
-        _stats.keysSorted += _sorter->numSorted();
-        _stats.spills += _sorter->numSpills();
-        _stats.totalDataSizeBytes += _sorter->totalDataSizeSorted();
+        recordSorterStats(*_sorter);
         _sorter.reset();
     }
 
@@ -153,8 +260,9 @@ public:
             return false;
         }
 
-        if (!_output->more()) {
+        if (_keyStringOrdering ? !_keyStringOutput->more() : !_output->more()) {
             _output.reset();
+            _keyStringOutput.reset();
             _isEOF = true;
             return false;
         }
@@ -168,9 +276,26 @@ public:
      * end-of-stream must be detected with 'hasNext()'.
      */
     std::pair<Value, T> getNext() {
+        if (_keyStringOrdering) {
+            auto next = _keyStringOutput->next();
+            return {sort_key_encoding::decode(
+                        next.first, _sortPattern.isSingleElementKey(), *_keyStringOrdering),
+                    std::move(next.second)};
+        }
         return _output->next();
     }
 
+    /**
+     * Same as 'getNext()', but returns only the item being sorted. Callers which do not need the
+     * sort key should prefer this, since it avoids decoding KeyString-encoded sort keys.
+     */
+    T getNextData() {
+        if (_keyStringOrdering) {
+            return _keyStringOutput->next().second;
+        }
+        return _output->next().second;
+    }
+
 private:
     SortOptions makeSortOptions() const {
         SortOptions opts;
@@ -187,6 +312,25 @@ private:
         return opts;
     }
 
+    KeyStringSorter* makeKeyStringSorter() const {
+        return KeyStringSorter::make(
+            makeSortOptions(),
+            KeyStringComparator(),
+            {KeyString::Value::SorterDeserializeSettings(KeyString::Version::kLatestVersion), {}});
+    }
+
+    template <typename SorterType>
+    void recordSorterStats(const SorterType& sorter) {
+        _stats.keysSorted += sorter.numSorted();
+        _stats.spills += sorter.numSpills();
+        _stats.totalDataSizeBytes += sorter.totalDataSizeSorted();
+
+        const auto spillStats = sorter.spillStats();
+        _stats.spilledDataSizeUncompressed += spillStats.bytesSpilledUncompressed;
+        _stats.spilledDataStorageSize += spillStats.bytesSpilled;
+        _stats.spillTime += spillStats.spillTime;
+    }
+
     const SortPattern _sortPattern;
     const std::string _tempDir;
     const bool _diskUseAllowed;
@@ -194,6 +338,12 @@ private:
     std::unique_ptr<DocumentSorter> _sorter;
     std::unique_ptr<typename DocumentSorter::Iterator> _output;
 
+    // Engaged if sort keys are KeyString-encoded, in which case '_keyStringSorter' and
+    // '_keyStringOutput' are used in place of '_sorter' and '_output'.
+    boost::optional<Ordering> _keyStringOrdering;
+    std::unique_ptr<KeyStringSorter> _keyStringSorter;
+    std::unique_ptr<typename KeyStringSorter::Iterator> _keyStringOutput;
+
     SortStats _stats;
 
     bool _isEOF = false;
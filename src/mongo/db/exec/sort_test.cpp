@@ -36,12 +36,14 @@
 #include <boost/optional.hpp>
 #include <memory>
 
+#include "mongo/db/exec/document_value/document_value_test_util.h"
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 
@@ -287,6 +289,122 @@ TEST_F(SortStageDefaultTest, SortDescendingWithLimitOfOne) {
     testWork("{a: -1}", nullptr, 1, "{input: [{a: 2}, {a: 1}, {a: 3}]}", "{output: [{a: 3}]}");
 }
 
+//
+// Sorting on a compound pattern with a limit
+// Implementation may discard inputs by comparing the leading
+// sort key component only, which must not change the results.
+//
+
+TEST_F(SortStageDefaultTest, SortCompoundWithLimit) {
+    testWork("{a: 1, b: -1}",
+             nullptr,
+             2,
+             "{input: [{a: 2, b: 1}, {a: 1, b: 1}, {a: 1, b: 2}, {a: 3, b: 0}, {a: 1, b: 3}, "
+             "{a: 0, b: [5, 1]}]}",
+             "{output: [{a: 0, b: [5, 1]}, {a: 1, b: 3}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortCompoundWithLimitAndArrayInLeadingField) {
+    testWork("{a: -1, b: 1}",
+             nullptr,
+             2,
+             "{input: [{a: 1, b: 1}, {a: 2, b: 2}, {a: 0, b: 0}, {a: [0, 5], b: 3}, {a: 2, b: 1}]}",
+             "{output: [{a: [0, 5], b: 3}, {a: 2, b: 1}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortCompoundWithLimitAndMissingLeadingField) {
+    testWork("{a: 1, b: 1}",
+             nullptr,
+             2,
+             "{input: [{a: 1, b: 1}, {a: 2, b: 2}, {b: 3}, {a: 0, b: 0}]}",
+             "{output: [{b: 3}, {a: 0, b: 0}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortCompoundWithLimitOfOne) {
+    testWork("{a: 1, b: 1}",
+             nullptr,
+             1,
+             "{input: [{a: 2, b: 0}, {a: 1, b: 5}, {a: 3, b: 0}, {a: 1, b: 4}]}",
+             "{output: [{a: 1, b: 4}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortCompoundWithLimitAndCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    testWork("{a: 1, b: 1}",
+             &collator,
+             2,
+             "{input: [{a: 'ba', b: 1}, {a: 'ab', b: 1}, {a: 'aa', b: 2}, {a: 'aa', b: 1}]}",
+             "{output: [{a: 'aa', b: 1}, {a: 'aa', b: 2}]}");
+}
+
+//
+// Sorting with KeyString-encoded sort keys
+// Implementation should produce the same order as when comparing
+// the sort keys as Values.
+//
+
+TEST_F(SortStageDefaultTest, SortCompoundWithKeyStringSortKeys) {
+    RAIIServerParameterControllerForTest controller{"internalQueryEncodeSortKeysAsKeyString",
+                                                    true};
+    testWork("{a: 1, b: -1}",
+             nullptr,
+             0,
+             "{input: [{a: 2, b: 'x'}, {a: 1.5, b: null}, {a: 1, b: 'y'}, {a: 2, b: 'z'}, "
+             "{b: 1}, {a: [3, 0.5], b: 2}]}",
+             "{output: [{b: 1}, {a: [3, 0.5], b: 2}, {a: 1, b: 'y'}, {a: 1.5, b: null}, "
+             "{a: 2, b: 'z'}, {a: 2, b: 'x'}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortWithLimitAndKeyStringSortKeys) {
+    RAIIServerParameterControllerForTest controller{"internalQueryEncodeSortKeysAsKeyString",
+                                                    true};
+    testWork("{a: -1, b: 1}",
+             nullptr,
+             2,
+             "{input: [{a: 1, b: 1}, {a: 3, b: 2}, {a: 2, b: 0}, {a: 3, b: 1}]}",
+             "{output: [{a: 3, b: 1}, {a: 3, b: 2}]}");
+}
+
+TEST_F(SortStageDefaultTest, SortWithCollationAndKeyStringSortKeys) {
+    RAIIServerParameterControllerForTest controller{"internalQueryEncodeSortKeysAsKeyString",
+                                                    true};
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    testWork("{a: 1, b: 1}",
+             &collator,
+             0,
+             "{input: [{a: 'ba', b: 2}, {a: 'aa', b: 1}, {a: 'ab', b: 0}, {a: 'ba', b: 1}]}",
+             "{output: [{a: 'aa', b: 1}, {a: 'ba', b: 1}, {a: 'ba', b: 2}, {a: 'ab', b: 0}]}");
+}
+
+TEST_F(SortStageDefaultTest, KeyStringEncodedSortKeysDecodeToOriginalKeys) {
+    auto expCtx = make_intrusive<ExpressionContext>(opCtx(), nullptr, kNss);
+    SortExecutor<BSONObj> executor(SortPattern{BSON("a" << 1 << "b" << -1), expCtx},
+                                   0,  // limit
+                                   kMaxMemoryUsageBytes,
+                                   "",     // tempDir
+                                   false,  // allowDiskUse
+                                   true);  // encodeSortKeysAsKeyString
+    ASSERT_TRUE(executor.isEncodingSortKeysAsKeyString());
+
+    const std::vector<Value> keys{Value(std::vector<Value>{Value(2), Value("x"_sd)}),
+                                  Value(std::vector<Value>{Value(1.5), Value(BSONNULL)}),
+                                  Value(std::vector<Value>{Value(Decimal128("1")),
+                                                           Value(BSON("c" << 1LL))})};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        executor.add(keys[i], BSON("i" << static_cast<int>(i)));
+    }
+    executor.loadingDone();
+
+    for (size_t expected : {2, 1, 0}) {
+        ASSERT_TRUE(executor.hasNext());
+        auto&& [key, obj] = executor.getNext();
+        ASSERT_EQ(obj["i"].numberInt(), static_cast<int>(expected));
+        ASSERT_VALUE_EQ(key, keys[expected]);
+        ASSERT_EQ(key[0].getType(), keys[expected][0].getType());
+    }
+    ASSERT_FALSE(executor.hasNext());
+}
+
 TEST_F(SortStageDefaultTest, SortAscendingWithCollation) {
     CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
     testWork("{a: 1}",
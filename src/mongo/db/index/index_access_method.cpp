@@ -517,6 +517,8 @@ public:
 
     int64_t getKeysInserted() const final;
 
+    SorterFileStats getSpillStats() const final;
+
     Sorter::PersistedState persistDataForShutdown() final;
 
 private:
@@ -665,6 +667,10 @@ int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
     return _keysInserted;
 }
 
+SorterFileStats AbstractIndexAccessMethod::BulkBuilderImpl::getSpillStats() const {
+    return _sorter->spillStats();
+}
+
 AbstractIndexAccessMethod::BulkBuilder::Sorter::PersistedState
 AbstractIndexAccessMethod::BulkBuilderImpl::persistDataForShutdown() {
     _insertMultikeyMetadataKeysIntoSorter();
@@ -749,6 +755,7 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
     auto ns = _indexCatalogEntry->getNSSFromCatalog(opCtx);
 
     std::unique_ptr<BulkBuilder::Sorter::Iterator> it(bulk->done());
+    const auto spillStats = bulk->getSpillStats();
 
     static constexpr char message[] = "Index Build: inserting keys from external sorter into index";
     ProgressMeterHolder pm;
@@ -756,6 +763,16 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
         stdx::unique_lock<Client> lk(*opCtx->getClient());
         pm.set(CurOp::get(opCtx)->setProgress_inlock(
             message, bulk->getKeysInserted(), 3 /* secondsBetween */));
+
+        // Accumulate across all of the indexes being built, so that currentOp reports the spills of
+        // the whole build.
+        if (spillStats.bytesSpilled > 0) {
+            auto& opSpillStats = CurOp::get(opCtx)->debug().indexBuildSpillStats;
+            if (!opSpillStats) {
+                opSpillStats.emplace();
+            }
+            *opSpillStats += spillStats;
+        }
     }
 
     auto builder = _newInterface->makeBulkBuilder(opCtx, dupsAllowed);
@@ -860,6 +877,9 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
           logAttrs(ns),
           "index"_attr = _descriptor->indexName(),
           "keysInserted"_attr = bulk->getKeysInserted(),
+          "bytesSpilledUncompressed"_attr = spillStats.bytesSpilledUncompressed,
+          "bytesSpilled"_attr = spillStats.bytesSpilled,
+          "spillDuration"_attr = duration_cast<Milliseconds>(spillStats.spillTime),
           "duration"_attr = Milliseconds(Seconds(timer.seconds())));
     return Status::OK();
 }
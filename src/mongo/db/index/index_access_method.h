@@ -274,6 +274,11 @@ public:
          */
         virtual int64_t getKeysInserted() const = 0;
 
+        /**
+         * Returns statistics about the keys that the underlying Sorter has spilled to disk.
+         */
+        virtual SorterFileStats getSpillStats() const = 0;
+
         /**
          * Persists on disk the keys that have been inserted using this BulkBuilder. Returns the
          * state of the underlying Sorter.
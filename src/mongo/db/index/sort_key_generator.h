@@ -75,6 +75,18 @@ public:
         return _sortPattern.isSingleElementKey();
     }
 
+    /**
+     * Returns the first component of the sort key for 'doc' without generating the remaining
+     * components, or boost::none if 'doc' has an array along the path of the first sort pattern
+     * component. Otherwise, the result is equal to the first component of the full sort key.
+     *
+     * Any $meta sort component is read from 'metadata' rather than from 'doc'.
+     */
+    boost::optional<Value> computeLeadingSortKeyComponent(
+        const Document& doc, const DocumentMetadataFields& metadata) const {
+        return extractKeyPart(doc, metadata, _sortPattern[0]);
+    }
+
 private:
     // Returns the sort key for the input 'doc' as a Value.
     //
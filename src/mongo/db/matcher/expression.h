@@ -140,6 +140,13 @@ public:
         INTERNAL_SCHEMA_XOR,
     };
 
+    /**
+     * Identifies a literal in the match expression tree which has been lifted out as an input
+     * parameter, so that plans built for one set of literals can be re-used for another. Ids are
+     * assigned by 'match_expression_parameterization::parameterize()'.
+     */
+    using InputParamId = int32_t;
+
     /**
      * An iterator to walk through the children expressions of the given MatchExpressions. Along
      * with the defined 'begin()' and 'end()' functions, which take a reference to a
@@ -234,6 +234,21 @@ public:
     virtual ~ComparisonMatchExpression() = default;
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
+
+    /**
+     * Marks the RHS of this comparison as an input parameter of the query, so that the SBE stage
+     * builder reads it from a runtime environment slot rather than baking it into the plan.
+     */
+    void setInputParamId(InputParamId paramId) {
+        _inputParamId = paramId;
+    }
+
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
+protected:
+    boost::optional<InputParamId> _inputParamId;
 };
 
 class EqualityMatchExpression final : public ComparisonMatchExpression {
@@ -262,6 +277,9 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        if (_inputParamId) {
+            e->setInputParamId(*_inputParamId);
+        }
         return e;
     }
 
@@ -298,6 +316,9 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        if (_inputParamId) {
+            e->setInputParamId(*_inputParamId);
+        }
         return e;
     }
 
@@ -334,6 +355,9 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        if (_inputParamId) {
+            e->setInputParamId(*_inputParamId);
+        }
         return e;
     }
 
@@ -375,6 +399,9 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        if (_inputParamId) {
+            e->setInputParamId(*_inputParamId);
+        }
         return e;
     }
 
@@ -415,6 +442,9 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        if (_inputParamId) {
+            e->setInputParamId(*_inputParamId);
+        }
         return e;
     }
 
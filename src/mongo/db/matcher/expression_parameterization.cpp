@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_parameterization.h"
+
+#include <cmath>
+
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo::match_expression {
+namespace {
+/**
+ * Returns true if the children of 'expr' can be visited when assigning input parameters. These
+ * are the nodes which carry no state apart from their path and children, so that a query shape
+ * can be encoded from the parameterized children alone.
+ */
+bool canDescendInto(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+        case MatchExpression::ELEM_MATCH_OBJECT:
+        case MatchExpression::ELEM_MATCH_VALUE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void parameterize(MatchExpression* expr, MatchExpression::InputParamId* nextParamId) {
+    if (canParameterize(expr)) {
+        static_cast<ComparisonMatchExpression*>(expr)->setInputParamId((*nextParamId)++);
+        return;
+    }
+
+    if (!canDescendInto(expr)) {
+        return;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        parameterize(expr->getChild(i), nextParamId);
+    }
+}
+}  // namespace
+
+bool canParameterize(const MatchExpression* expr) {
+    if (!ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        return false;
+    }
+
+    const auto& rhs = static_cast<const ComparisonMatchExpression*>(expr)->getData();
+    switch (rhs.type()) {
+        case BSONType::NumberInt:
+        case BSONType::NumberLong:
+            return true;
+        case BSONType::NumberDouble:
+            return !std::isnan(rhs.numberDouble());
+        case BSONType::NumberDecimal:
+            return !rhs.numberDecimal().isNaN();
+        case BSONType::String:
+        case BSONType::jstOID:
+        case BSONType::Bool:
+        case BSONType::Date:
+        case BSONType::bsonTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t parameterize(MatchExpression* root) {
+    MatchExpression::InputParamId nextParamId = 0;
+    parameterize(root, &nextParamId);
+    return static_cast<size_t>(nextParamId);
+}
+
+}  // namespace mongo::match_expression
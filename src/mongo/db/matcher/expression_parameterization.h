@@ -0,0 +1,54 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo::match_expression {
+
+/**
+ * Returns true if the right-hand side of 'expr' can be lifted out of the tree as an input
+ * parameter. Only scalar literals whose SBE translation does not depend on the value itself
+ * qualify. For example, comparisons to null, MinKey, MaxKey or NaN are special-cased by the stage
+ * builder and therefore stay baked into the plan.
+ */
+bool canParameterize(const MatchExpression* expr);
+
+/**
+ * Walks the 'root' tree in pre-order and assigns sequential input parameter ids, starting from
+ * zero, to every parameterizable comparison. Only comparisons reachable through $and, $or, $nor,
+ * $not and $elemMatch nodes are considered. Since 'root' is expected to be normalized, two queries
+ * of the same shape which differ only in their literals are assigned the same ids.
+ *
+ * Returns the number of input parameters assigned.
+ */
+size_t parameterize(MatchExpression* root);
+
+}  // namespace mongo::match_expression
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_parameterization.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parseAndNormalize(const BSONObj& filter) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto swExpr = MatchExpressionParser::parse(filter, std::move(expCtx));
+    ASSERT_OK(swExpr.getStatus());
+    return MatchExpression::normalize(std::move(swExpr.getValue()));
+}
+
+/**
+ * Collects the input parameter ids of all comparison nodes in 'expr' in pre-order. Comparisons
+ * without an id are recorded as -1.
+ */
+void collectParamIds(const MatchExpression* expr, std::vector<int>* ids) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto paramId = static_cast<const ComparisonMatchExpression*>(expr)->getInputParamId();
+        ids->push_back(paramId ? *paramId : -1);
+    }
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        collectParamIds(expr->getChild(i), ids);
+    }
+}
+
+std::vector<int> parameterizeAndCollect(const BSONObj& filter) {
+    auto expr = parseAndNormalize(filter);
+    match_expression::parameterize(expr.get());
+    std::vector<int> ids;
+    collectParamIds(expr.get(), &ids);
+    return ids;
+}
+
+TEST(MatchExpressionParameterizationTest, AssignsIdsToScalarComparisons) {
+    auto expr = parseAndNormalize(fromjson("{a: 1, b: {$gt: 'x'}, c: {$lte: 2.5}}"));
+    ASSERT_EQ(3U, match_expression::parameterize(expr.get()));
+
+    std::vector<int> ids;
+    collectParamIds(expr.get(), &ids);
+    ASSERT((std::vector<int>{0, 1, 2}) == ids);
+}
+
+TEST(MatchExpressionParameterizationTest, DoesNotParameterizeSpecialCasedLiterals) {
+    ASSERT((std::vector<int>{-1}) == parameterizeAndCollect(fromjson("{a: null}")));
+    ASSERT((std::vector<int>{-1}) == parameterizeAndCollect(fromjson("{a: {$gt: NaN}}")));
+    ASSERT((std::vector<int>{-1}) == parameterizeAndCollect(fromjson("{a: {$gt: {$minKey: 1}}}")));
+    ASSERT((std::vector<int>{-1}) == parameterizeAndCollect(fromjson("{a: [1, 2]}")));
+    ASSERT((std::vector<int>{-1}) == parameterizeAndCollect(fromjson("{a: {b: 1}}")));
+}
+
+TEST(MatchExpressionParameterizationTest, DescendsIntoLogicalAndElemMatchNodes) {
+    auto ids = parameterizeAndCollect(
+        fromjson("{$or: [{a: 1}, {b: {$not: {$gt: 2}}}], c: {$elemMatch: {$lt: 3}}}"));
+    ASSERT((std::vector<int>{0, 1, 2}) == ids);
+}
+
+TEST(MatchExpressionParameterizationTest, SameShapeGetsSameIds) {
+    auto first = parseAndNormalize(fromjson("{b: 2, a: {$gte: 10}}"));
+    auto second = parseAndNormalize(fromjson("{a: {$gte: 20}, b: 5}"));
+    match_expression::parameterize(first.get());
+    match_expression::parameterize(second.get());
+
+    std::vector<int> firstIds, secondIds;
+    collectParamIds(first.get(), &firstIds);
+    collectParamIds(second.get(), &secondIds);
+    ASSERT(firstIds == secondIds);
+
+    // The ids must refer to the same paths in both trees.
+    ASSERT_EQ(first->getChild(0)->path(), second->getChild(0)->path());
+}
+
+TEST(MatchExpressionParameterizationTest, ShallowClonePreservesParamId) {
+    auto expr = parseAndNormalize(fromjson("{a: {$lt: 5}}"));
+    match_expression::parameterize(expr.get());
+
+    auto clone = expr->shallowClone();
+    auto paramId = static_cast<const ComparisonMatchExpression*>(clone.get())->getInputParamId();
+    ASSERT(paramId);
+    ASSERT_EQ(0, *paramId);
+}
+
+}  // namespace
+}  // namespace mongo
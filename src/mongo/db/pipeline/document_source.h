@@ -389,6 +389,13 @@ public:
 
     virtual void reattachToOperationContext(OperationContext* opCtx) {}
 
+    /**
+     * Called on the first stage of a pipeline which will only be iterated later, so that a stage
+     * which retrieves its results from other hosts can request them in the background while the
+     * caller does other work. Stages which cannot do so ignore this.
+     */
+    virtual void prefetch() {}
+
     virtual bool usedDisk() {
         return false;
     };
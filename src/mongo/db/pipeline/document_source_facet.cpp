@@ -161,16 +161,23 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
     };
 
     vector<vector<Value>> results(_facets.size());
+    // Pipelines which have reached EOF are not asked for more results.
+    vector<bool> pipelineEOF(_facets.size(), false);
     bool allPipelinesEOF = false;
     while (!allPipelinesEOF) {
         allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
         for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
-            const auto& pipeline = _facets[facetId].pipeline;
-            auto next = pipeline->getSources().back()->getNext();
-            for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+            if (pipelineEOF[facetId]) {
+                continue;
+            }
+
+            const auto& lastStage = _facets[facetId].pipeline->getSources().back();
+            auto next = lastStage->getNext();
+            for (; next.isAdvanced(); next = lastStage->getNext()) {
                 ensureUnderMemoryLimit(next.getDocument().getApproximateSize());
                 results[facetId].emplace_back(next.releaseDocument());
             }
+            pipelineEOF[facetId] = next.isEOF();
             allPipelinesEOF = allPipelinesEOF && next.isEOF();
         }
     }
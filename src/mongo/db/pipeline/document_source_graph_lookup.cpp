@@ -47,6 +47,7 @@
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/stats/resource_consumption_metrics.h"
 #include "mongo/db/views/resolved_view.h"
 #include "mongo/logv2/log.h"
 
@@ -54,6 +55,17 @@ namespace mongo {
 
 namespace {
 
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number. Each user of the Sorter must implement this function to ensure that all temporary files
+ * that the Sorter instances produce are uniquely identified.
+ */
+std::string nextFileName() {
+    static AtomicWord<unsigned> documentSourceGraphLookUpFileCounter;
+    return "extsort-doc-graph-lookup." +
+        std::to_string(documentSourceGraphLookUpFileCounter.fetchAndAdd(1));
+}
+
 // Parses $graphLookup 'from' field. The 'from' field must be a string with the exception of
 // 'local.system.tenantMigration.oplogView'.
 //
@@ -134,6 +146,8 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::doGetNext() {
 
     performSearch();
 
+    // Only a search for an absorbed $unwind spills, so every document found is in '_visited'.
+    invariant(_spilledVisitedRuns.empty());
     std::vector<Value> results;
     while (!_visited.empty()) {
         // Remove elements one at a time to avoid consuming more memory.
@@ -158,7 +172,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        if (!haveVisitedDocuments()) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -174,7 +188,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (!haveVisitedDocuments()) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -188,13 +202,11 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(popVisitedDocument()));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
@@ -205,6 +217,61 @@ void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    _spilledVisitedIds.clear();
+    _spilledVisitedRuns.clear();
+    _file.reset();
+}
+
+bool DocumentSourceGraphLookUp::haveVisitedDocuments() {
+    while (!_spilledVisitedRuns.empty() && !_spilledVisitedRuns.front()->more()) {
+        _spilledVisitedRuns.pop_front();
+    }
+    return !_visited.empty() || !_spilledVisitedRuns.empty();
+}
+
+Document DocumentSourceGraphLookUp::popVisitedDocument() {
+    if (!_visited.empty()) {
+        auto it = _visited.begin();
+        Document result = std::move(it->second);
+        _visited.erase(it);
+        return result;
+    }
+
+    invariant(!_spilledVisitedRuns.empty());
+    return _spilledVisitedRuns.front()->next().second.getDocument();
+}
+
+void DocumentSourceGraphLookUp::spillVisited() {
+    if (!_file) {
+        _file = std::make_shared<Sorter<Value, Value>::File>(pExpCtx->tempDir + "/" +
+                                                             nextFileName());
+    }
+
+    // The run is only ever read back sequentially, so the documents are written in whatever order
+    // '_visited' holds them.
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir), _file);
+    const size_t numSpilled = _visited.size();
+    while (!_visited.empty()) {
+        auto it = _visited.begin();
+        const size_t idSize = it->first.getApproximateSize();
+        const size_t visitedSize = idSize + it->second.getApproximateSize();
+        invariant(visitedSize <= _visitedUsageBytes);
+        _visitedUsageBytes -= visitedSize;
+
+        writer.addAlreadySorted(it->first, Value(it->second));
+
+        // The '_id' stays in memory until the end of the search, so it still counts towards the
+        // memory limit.
+        _spilledVisitedIds.insert(it->first);
+        _visitedUsageBytes += idSize;
+        _visited.erase(it);
+    }
+    _spilledVisitedRuns.emplace_back(writer.done());
+    _usedDisk = true;
+
+    auto& metricsCollector = ResourceConsumption::MetricsCollector::get(pExpCtx->opCtx);
+    metricsCollector.incrementKeysSorted(numSpilled);
+    metricsCollector.incrementSorterSpills(1);
 }
 
 bool DocumentSourceGraphLookUp::foreignShardedGraphLookupAllowed() const {
@@ -317,8 +384,8 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
                 shouldPerformAnotherQuery =
                     addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
                 addToCache(std::move(*next), queried);
+                checkMemoryUsage();
             }
-            checkMemoryUsage();
         }
 
         ++depth;
@@ -327,12 +394,14 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
 
     _frontier.clear();
     _frontierUsageBytes = 0;
+    _spilledVisitedIds.clear();
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (_visited.find(id) != _visited.end() ||
+        _spilledVisitedIds.find(id) != _spilledVisitedIds.end()) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -432,6 +501,11 @@ void DocumentSourceGraphLookUp::performSearch() {
     // Make sure _input is set before calling performSearch().
     invariant(_input);
 
+    // Documents spilled for the previous input have all been returned. Spill to a new file, since
+    // the old one has been read from.
+    _spilledVisitedRuns.clear();
+    _file.reset();
+
     Value startingValue = _startWith->evaluate(*_input, &pExpCtx->variables);
 
     // If _startWith evaluates to an array, treat each value as a separate starting point.
@@ -497,7 +571,13 @@ Pipeline::SourceContainer::iterator DocumentSourceGraphLookUp::doOptimizeAt(
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    // Without an absorbed $unwind, every document found is returned in a single array which must be
+    // built in memory, so spilling them would not help.
+    if ((_visitedUsageBytes + _frontierUsageBytes) >= _maxMemoryUsageBytes && !_visited.empty() &&
+        _unwind && pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
+        spillVisited();
+    }
+
     uassert(40099,
             "$graphLookup reached maximum memory consumption",
             (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
@@ -575,8 +655,11 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _maxMemoryUsageBytes(
+          static_cast<size_t>(internalDocumentSourceGraphLookupMaxMemoryBytes.load())),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledVisitedIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc),
       _variables(expCtx->variables),
@@ -727,3 +810,6 @@ void DocumentSourceGraphLookUp::addInvolvedCollections(
     }
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -29,11 +29,15 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
+
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
@@ -111,7 +115,7 @@ public:
         StageConstraints constraints(StreamType::kStreaming,
                                      PositionRequirement::kNone,
                                      hostRequirement,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     DiskUseRequirement::kWritesTmpData,
                                      FacetRequirement::kAllowed,
                                      TransactionRequirement::kAllowed,
                                      LookupRequirement::kAllowed,
@@ -123,6 +127,13 @@ public:
 
     boost::optional<DistributedPlanLogic> distributedPlanLogic() final;
 
+    /**
+     * Returns true if this $graphLookup stage spilled visited documents to disk.
+     */
+    bool usedDisk() final {
+        return _usedDisk;
+    }
+
     DepsTracker::State getDependencies(DepsTracker* deps) const final {
         _startWith->addDependencies(deps);
         return DepsTracker::State::SEE_NEXT;
@@ -213,11 +224,31 @@ private:
     void addToCache(const Document& result, const ValueUnorderedSet& queried);
 
     /**
-     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
-     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, spilling
+     * the documents in '_visited' first if disk use is allowed and a $unwind has been absorbed, and
+     * then evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
      */
     void checkMemoryUsage();
 
+    /**
+     * Writes the documents in '_visited' to disk. Only their '_id' values are kept in memory, in
+     * '_spilledVisitedIds', so that the search can still tell which documents it has visited. These
+     * remain charged to '_visitedUsageBytes'.
+     */
+    void spillVisited();
+
+    /**
+     * Returns true if any document found by the last search has yet to be returned, either from
+     * '_visited' or from disk.
+     */
+    bool haveVisitedDocuments();
+
+    /**
+     * Removes and returns a document found by the last search. Must only be called when
+     * haveVisitedDocuments() returns true.
+     */
+    Document popVisitedDocument();
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -248,7 +279,7 @@ private:
     // The aggregation pipeline to perform against the '_from' namespace.
     std::vector<BSONObj> _fromPipeline;
 
-    size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
+    const size_t _maxMemoryUsageBytes;
 
     // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
     size_t _visitedUsageBytes = 0;
@@ -262,6 +293,16 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // The '_id' values of the visited documents which have been spilled to disk, compared using
+    // the simple collation like the keys of '_visited'. Only needed during the search.
+    ValueUnorderedSet _spilledVisitedIds;
+
+    // Runs of spilled documents which have yet to be returned for the current input document, and
+    // the file they are written to. A new file is used for each input document.
+    std::deque<std::shared_ptr<Sorter<Value, Value>::Iterator>> _spilledVisitedRuns;
+    std::shared_ptr<Sorter<Value, Value>::File> _file;
+    bool _usedDisk = false;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <set>
 
 #include "mongo/bson/unordered_fields_bsonobj_comparator.h"
 #include "mongo/db/exec/document_value/document.h"
@@ -39,6 +40,8 @@
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/str.h"
@@ -713,5 +716,127 @@ TEST_F(DocumentSourceGraphLookUpTest, ShouldNotExpandArraysWithinArraysAtEndOfCo
     ASSERT(graphLookupStage->getNext().isEOF());
 }
 
+/**
+ * Returns the documents of a chain of 'length' nodes, each connecting to the next, padded so that
+ * they do not all fit within a small memory limit. The padding goes in the '_id' values if
+ * 'padIds' is true.
+ */
+std::deque<DocumentSource::GetNextResult> makeLargeChain(int length, bool padIds = false) {
+    const std::string padding(500, 'x');
+    std::deque<DocumentSource::GetNextResult> chain;
+    for (int i = 0; i < length; ++i) {
+        if (padIds) {
+            chain.emplace_back(
+                Document{{"_id", padding + std::to_string(i)}, {"to", i}, {"from", i + 1}});
+        } else {
+            chain.emplace_back(
+                Document{{"_id", i}, {"to", i}, {"from", i + 1}, {"padding", padding}});
+        }
+    }
+    return chain;
+}
+
+boost::intrusive_ptr<DocumentSourceGraphLookUp> makeChainGraphLookup(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::deque<DocumentSource::GetNextResult> chain,
+    boost::optional<boost::intrusive_ptr<DocumentSourceUnwind>> unwindStage = boost::none) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(std::move(chain));
+    return DocumentSourceGraphLookUp::create(
+        expCtx,
+        fromNs,
+        "results",
+        "from",
+        "to",
+        ExpressionFieldPath::deprecatedCreate(expCtx.get(), "startPoint"),
+        boost::none,
+        boost::none,
+        boost::none,
+        unwindStage);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldReturnSpilledDocumentsWhileUnwinding) {
+    RAIIServerParameterControllerForTest controller{
+        "internalDocumentSourceGraphLookupMaxMemoryBytes", 2000};
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int length = 20;
+    auto unwindStage = DocumentSourceUnwind::create(expCtx, "results", false, boost::none);
+    auto graphLookupStage = makeChainGraphLookup(expCtx, makeLargeChain(length), unwindStage);
+    auto inputMock = DocumentSourceMock::createForTest(
+        {Document{{"startPoint", 0}}, Document{{"startPoint", length - 2}}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    // The mock returns every node for any query, so each search finds them all. The documents of
+    // the second search are spilled to a new file.
+    for (int input = 0; input < 2; ++input) {
+        std::set<int> ids;
+        for (int i = 0; i < length; ++i) {
+            auto next = graphLookupStage->getNext();
+            ASSERT_TRUE(next.isAdvanced());
+            ids.insert(next.releaseDocument()["results"]["_id"].getInt());
+        }
+        ASSERT_EQ(ids.size(), static_cast<size_t>(length));
+    }
+    ASSERT_TRUE(graphLookupStage->getNext().isEOF());
+    ASSERT_TRUE(graphLookupStage->usedDisk());
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldCountSpilledIdsTowardsTheMemoryLimit) {
+    RAIIServerParameterControllerForTest controller{
+        "internalDocumentSourceGraphLookupMaxMemoryBytes", 2000};
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    // The '_id' values kept in memory after spilling their documents exceed the limit on their own.
+    auto unwindStage = DocumentSourceUnwind::create(expCtx, "results", false, boost::none);
+    auto graphLookupStage =
+        makeChainGraphLookup(expCtx, makeLargeChain(20, /*padIds=*/true), unwindStage);
+    auto inputMock = DocumentSourceMock::createForTest(Document{{"startPoint", 0}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+    ASSERT_TRUE(graphLookupStage->usedDisk());
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldNotSpillWhenResultsAreReturnedInOneArray) {
+    RAIIServerParameterControllerForTest controller{
+        "internalDocumentSourceGraphLookupMaxMemoryBytes", 2000};
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    // Without an absorbed $unwind, the results must all be held in memory to build the output.
+    auto graphLookupStage = makeChainGraphLookup(expCtx, makeLargeChain(20));
+    auto inputMock = DocumentSourceMock::createForTest(Document{{"startPoint", 0}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+    ASSERT_FALSE(graphLookupStage->usedDisk());
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldFailWhenMemoryLimitIsExceededWithoutDiskUse) {
+    RAIIServerParameterControllerForTest controller{
+        "internalDocumentSourceGraphLookupMaxMemoryBytes", 2000};
+    auto expCtx = getExpCtx();
+    expCtx->allowDiskUse = false;
+
+    auto unwindStage = DocumentSourceUnwind::create(expCtx, "results", false, boost::none);
+    auto graphLookupStage = makeChainGraphLookup(expCtx, makeLargeChain(20), unwindStage);
+    auto inputMock = DocumentSourceMock::createForTest(Document{{"startPoint", 0}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+    ASSERT_FALSE(graphLookupStage->usedDisk());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -29,19 +29,25 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
+#include <set>
 
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/field_ref.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -61,6 +67,16 @@ std::string nextFileName() {
     return "extsort-doc-group." + std::to_string(documentSourceGroupFileCounter.fetchAndAdd(1));
 }
 
+// The accumulators which the slot-based execution engine implements.
+const StringDataSet kSbeCompatibleAccumulators = {AccumulatorAddToSet::kName,
+                                                  AccumulatorAvg::kName,
+                                                  AccumulatorFirst::kName,
+                                                  AccumulatorLast::kName,
+                                                  AccumulatorMax::kName,
+                                                  AccumulatorMin::kName,
+                                                  AccumulatorPush::kName,
+                                                  AccumulatorSum::kName};
+
 }  // namespace
 
 using boost::intrusive_ptr;
@@ -145,7 +161,6 @@ bool DocumentSourceGroup::shouldSpillWithAttemptToSaveMemory() {
                 "Exceeded memory limit for $group, but didn't allow external sort."
                 " Pass allowDiskUse:true to opt in.",
                 _memoryTracker._allowDiskUse);
-        _memoryTracker.resetCurrent();
         return true;
     }
     return false;
@@ -154,20 +169,35 @@ bool DocumentSourceGroup::shouldSpillWithAttemptToSaveMemory() {
 void DocumentSourceGroup::freeMemory() {
     invariant(_groups);
     for (auto&& group : *_groups) {
+        long long groupMemoryDelta = 0;
         for (size_t i = 0; i < group.second.size(); i++) {
             // Subtract the current usage.
+            groupMemoryDelta -= group.second[i]->getMemUsage();
             _memoryTracker.update(_accumulatedFields[i].fieldName,
                                   -1 * group.second[i]->getMemUsage());
 
             group.second[i]->reduceMemoryConsumptionIfAble();
 
             // Update the memory usage for this AccumulationStatement.
+            groupMemoryDelta += group.second[i]->getMemUsage();
             _memoryTracker.update(_accumulatedFields[i].fieldName, group.second[i]->getMemUsage());
         }
+
+        if (_numSpillPartitions > 0) {
+            _partitionMemoryBytes[partitionOf(group.first)] += groupMemoryDelta;
+        }
     }
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
+    if (_streamingInput) {
+        auto result = getNextStreamed();
+        if (!result.isEOF()) {
+            return result;
+        }
+        // Streaming is over. Fall through to return the groups which could not be streamed.
+    }
+
     if (!_initialized) {
         const auto initializationResult = initialize();
         if (initializationResult.isPaused()) {
@@ -222,7 +252,14 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         }
 
         if (!_sorterIterator->more()) {
-            dispose();
+            if (_spilledPartitions.empty()) {
+                dispose();
+            } else {
+                // Move on to the next spilled partition.
+                _sorterIterator.reset();
+                _spilled = false;
+                groupsIterator = _groups->end();
+            }
             break;
         }
 
@@ -234,21 +271,157 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
-    if (_groups->empty())
-        return GetNextResult::makeEOF();
+    while (groupsIterator == _groups->end()) {
+        if (_spilledPartitions.empty())
+            return GetNextResult::makeEOF();
+
+        loadSpilledPartition();
+        if (_spilled)
+            return getNextSpilled();
+    }
 
     Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (++groupsIterator == _groups->end() && _spilledPartitions.empty())
         dispose();
 
     return out;
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStreamed() {
+    GetNextResult input = pSource->getNext();
+
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        auto rootDocument = input.releaseDocument();
+        Value id = computeId(rootDocument);
+
+        if (!isStreamableGroupKey(id)) {
+            addToGroupsMap(id, rootDocument);
+            continue;
+        }
+
+        boost::optional<Document> finishedGroup;
+        if (!_haveStreamedGroup || !pExpCtx->getValueComparator().evaluate(id == _currentId)) {
+            if (_haveStreamedGroup) {
+                finishedGroup =
+                    makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            }
+            startStreamedGroup(std::move(id));
+        }
+
+        for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+            _currentAccumulators[i]->process(
+                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
+                _doingMerge);
+        }
+
+        if (finishedGroup) {
+            return std::move(*finishedGroup);
+        }
+    }
+
+    if (input.isPaused()) {
+        return input;
+    }
+
+    // The input is exhausted. Return the last streamed group now, and the groups in '_groups' on
+    // the following calls.
+    _streamingInput = false;
+    boost::optional<Document> lastGroup;
+    if (_haveStreamedGroup) {
+        lastGroup = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+        _haveStreamedGroup = false;
+    }
+    readyGroupsForOutput();
+
+    if (lastGroup) {
+        return std::move(*lastGroup);
+    }
+    return input;
+}
+
+void DocumentSourceGroup::startStreamedGroup(Value id) {
+    if (_currentAccumulators.size() != _accumulatedFields.size()) {
+        _currentAccumulators.clear();
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+        }
+    }
+
+    _currentId = std::move(id);
+    _haveStreamedGroup = true;
+
+    Value expandedId = expandId(_currentId);
+    Document idDoc =
+        expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+    for (size_t i = 0; i < _accumulatedFields.size(); ++i) {
+        _currentAccumulators[i]->reset();
+        _currentAccumulators[i]->startNewGroup(
+            _accumulatedFields[i].expr.initializer->evaluate(idDoc, &pExpCtx->variables));
+    }
+}
+
+bool DocumentSourceGroup::isStreamableGroupKey(const Value& id) const {
+    auto isStreamable = [](const Value& component) {
+        return !component.isArray() && !component.nullish();
+    };
+
+    if (_idExpressions.size() == 1) {
+        return isStreamable(id);
+    }
+    const auto& components = id.getArray();
+    return std::all_of(components.begin(), components.end(), isStreamable);
+}
+
+bool DocumentSourceGroup::setInputSortedBy(const SortPattern& sortPattern) {
+    if (_initialized || _doingMerge || _idExpressions.size() > sortPattern.size()) {
+        return false;
+    }
+
+    std::set<std::string> groupPaths;
+    for (auto&& idExpression : _idExpressions) {
+        auto fieldPathExpression = dynamic_cast<ExpressionFieldPath*>(idExpression.get());
+        if (!fieldPathExpression || fieldPathExpression->isVariableReference() ||
+            fieldPathExpression->getFieldPath().getPathLength() == 1) {
+            return false;
+        }
+
+        // A numeric path component would name a field here but may refer to an array element in
+        // the sort.
+        auto path = fieldPathExpression->getFieldPath().tail();
+        for (size_t i = 0; i < path.getPathLength(); ++i) {
+            if (FieldRef::isNumericPathComponentLenient(path.getFieldName(i))) {
+                return false;
+            }
+        }
+        groupPaths.insert(path.fullPath());
+    }
+
+    std::set<std::string> sortPaths;
+    for (size_t i = 0; i < _idExpressions.size(); ++i) {
+        const auto& part = sortPattern[i];
+        if (!part.fieldPath) {
+            return false;
+        }
+        sortPaths.insert(part.fieldPath->fullPath());
+    }
+
+    if (groupPaths != sortPaths) {
+        return false;
+    }
+
+    _streamingInput = true;
+    return true;
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _spilledPartitions.clear();
+    for (auto&& runs : _partitionRuns) {
+        runs.clear();
+    }
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -357,15 +530,16 @@ DocumentSource::GetModPathsReturn DocumentSourceGroup::getModifiedPaths() const
             std::move(renames)};
 }
 
-StringMap<boost::intrusive_ptr<Expression>> DocumentSourceGroup::getIdFields() const {
+std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>>
+DocumentSourceGroup::getIdFields() const {
     if (_idFieldNames.empty()) {
         invariant(_idExpressions.size() == 1);
         return {{"_id", _idExpressions[0]}};
     } else {
         invariant(_idFieldNames.size() == _idExpressions.size());
-        StringMap<boost::intrusive_ptr<Expression>> result;
+        std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> result;
         for (std::size_t i = 0; i < _idFieldNames.size(); ++i) {
-            result["_id." + _idFieldNames[i]] = _idExpressions[i];
+            result.emplace_back("_id." + _idFieldNames[i], _idExpressions[i]);
         }
         return result;
     }
@@ -406,7 +580,10 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
               : nullptr),
       _initialized(false),
       _groups(expCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
-      _spilled(false) {}
+      _spilled(false),
+      _numSpillPartitions(static_cast<size_t>(internalDocumentSourceGroupSpillPartitions.load())),
+      _partitionMemoryBytes(_numSpillPartitions, 0),
+      _partitionRuns(_numSpillPartitions) {}
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
@@ -467,6 +644,13 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
 
     intrusive_ptr<DocumentSourceGroup> groupStage(new DocumentSourceGroup(expCtx));
 
+    // The expressions of this stage clear the 'sbeCompatible' flag of 'expCtx' when SBE cannot
+    // translate them. As the flag accounts for the whole pipeline, it is raised while parsing this
+    // stage alone and restored afterwards.
+    const bool pipelineSbeCompatible = expCtx->sbeCompatible;
+    expCtx->sbeCompatible = true;
+    bool accumulatorsSbeCompatible = true;
+
     BSONObj groupObj(elem.Obj());
     BSONObjIterator groupIterator(groupObj);
     VariablesParseState vps = expCtx->variablesParseState;
@@ -485,14 +669,20 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
             groupStage->setDoingMerge(true);
         } else {
             // Any other field will be treated as an accumulator specification.
-            groupStage->addAccumulator(
-                AccumulationStatement::parseAccumulationStatement(expCtx.get(), groupField, vps));
+            auto accStmt =
+                AccumulationStatement::parseAccumulationStatement(expCtx.get(), groupField, vps);
+            accumulatorsSbeCompatible =
+                accumulatorsSbeCompatible && kSbeCompatibleAccumulators.count(accStmt.expr.name);
+            groupStage->addAccumulator(std::move(accStmt));
             groupStage->_memoryTracker.set(pFieldName, 0);
         }
     }
 
     uassert(
         15955, "a group specification must include an _id", !groupStage->_idExpressions.empty());
+
+    groupStage->_sbeCompatible = expCtx->sbeCompatible && accumulatorsSbeCompatible;
+    expCtx->sbeCompatible = pipelineSbeCompatible && expCtx->sbeCompatible;
     return groupStage;
 }
 
@@ -528,73 +718,15 @@ private:
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
-    const size_t numAccumulators = _accumulatedFields.size();
-
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
 
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (shouldSpillWithAttemptToSaveMemory()) {
-            _sortedFiles.push_back(spill());
-        }
-
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        vector<uint64_t> oldAccumMemUsage(numAccumulators, 0);
-        if (inserted) {
-            _memoryTracker.set(_memoryTracker.currentMemoryBytes() + id.getApproximateSize());
-
-            // Initialize and add the accumulators
-            Value expandedId = expandId(id);
-            Document idDoc =
-                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                auto accum = accumulatedField.makeAccumulator();
-                Value initializerValue =
-                    accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-                accum->startNewGroup(initializerValue);
-                group.push_back(accum);
-            }
-        } else {
-            for (size_t i = 0; i < group.size(); i++) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryTracker.update(_accumulatedFields[i].fieldName,
-                                      -1 * group[i]->getMemUsage());
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
-            _memoryTracker.update(_accumulatedFields[i].fieldName, group[i]->getMemUsage());
-        }
-
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&           // is a dup
-                !pExpCtx->inMongos &&  // can't spill to disk in mongos
-                !_memoryTracker
-                     ._allowDiskUse &&       // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+        addToGroupsMap(id, rootDocument);
     }
 
     switch (input.getStatus()) {
@@ -605,50 +737,159 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             return input;  // Propagate pause.
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
+            // Do any final steps necessary to prepare to output results. This must happen last so
+            // that, unless control gets here, we will re-enter initialization after getting a
+            // GetNextResult::ResultState::kPauseExecution.
+            readyGroupsForOutput();
+            return input;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
 
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+void DocumentSourceGroup::readyGroupsForOutput() {
+    // Prepare current to accumulate data, in case spilled groups need merging.
+    _currentAccumulators.clear();
+    _currentAccumulators.reserve(_accumulatedFields.size());
+    for (auto&& accumulatedField : _accumulatedFields) {
+        _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+    }
 
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+    if (!_sortedFiles.empty()) {
+        _spilled = true;
+        if (!_groups->empty()) {
+            _sortedFiles.push_back(spill());
+        }
 
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator());
-                }
+        // We won't be using groups again so free its memory.
+        _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
 
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
+        _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+            _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+
+        verify(_sorterIterator->more());  // we put data in, we should get something out.
+        _firstPartOfNextGroup = _sorterIterator->next();
+    } else {
+        // The groups left in memory for a partition which has spilled are incomplete, so spill
+        // them too. The groups in memory are then complete and are returned before the spilled
+        // partitions are loaded back one at a time.
+        for (size_t partition = 0; partition < _numSpillPartitions; ++partition) {
+            if (!_partitionRuns[partition].empty()) {
+                _spilledPartitions.push_back(partition);
+            }
+        }
+        spillPartitions({_spilledPartitions.begin(), _spilledPartitions.end()});
+
+        // start the group iterator
+        groupsIterator = _groups->begin();
+    }
+
+    _initialized = true;
+}
+
+void DocumentSourceGroup::addToGroupsMap(const Value& id, const Document& root) {
+    if (shouldSpillWithAttemptToSaveMemory()) {
+        if (_numSpillPartitions > 0) {
+            spillLargestPartitions();
+        } else {
+            _sortedFiles.push_back(spill());
+        }
+    }
+
+    const bool inserted = processGroup(
+        id,
+        [&](size_t i) {
+            return _accumulatedFields[i].expr.argument->evaluate(root, &pExpCtx->variables);
+        },
+        _doingMerge);
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                      // is a dup
+            !pExpCtx->inMongos &&             // can't spill to disk in mongos
+            !_memoryTracker._allowDiskUse &&  // don't change behavior when testing external sort
+            _stats.spills < 20) {             // don't open too many FDs
+            if (_numSpillPartitions > 0) {
+                spillPartitions({partitionOf(id)});
             } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
+                _sortedFiles.push_back(spill());
             }
+        }
+    }
+}
 
-            // This must happen last so that, unless control gets here, we will re-enter
-            // initialization after getting a GetNextResult::ResultState::kPauseExecution.
-            _initialized = true;
-            return input;
+template <typename InputFn>
+bool DocumentSourceGroup::processGroup(const Value& id, const InputFn& getInput, bool merging) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    long long groupMemoryDelta = 0;
+    if (inserted) {
+        groupMemoryDelta += id.getApproximateSize();
+        _memoryTracker.set(_memoryTracker.currentMemoryBytes() + id.getApproximateSize());
+
+        // Initialize and add the accumulators
+        Value expandedId = expandId(id);
+        Document idDoc =
+            expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            auto accum = accumulatedField.makeAccumulator();
+            Value initializerValue =
+                accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+            accum->startNewGroup(initializerValue);
+            group.push_back(accum);
+        }
+    } else {
+        for (size_t i = 0; i < group.size(); i++) {
+            // subtract old mem usage. New usage added back after processing.
+            groupMemoryDelta -= group[i]->getMemUsage();
+            _memoryTracker.update(_accumulatedFields[i].fieldName, -1 * group[i]->getMemUsage());
         }
     }
-    MONGO_UNREACHABLE;
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(getInput(i), merging);
+        groupMemoryDelta += group[i]->getMemUsage();
+        _memoryTracker.update(_accumulatedFields[i].fieldName, group[i]->getMemUsage());
+    }
+
+    if (_numSpillPartitions > 0) {
+        _partitionMemoryBytes[partitionOf(id)] += groupMemoryDelta;
+    }
+    return inserted;
 }
 
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    _stats.spills++;
-
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
     for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
         ptrs.push_back(&*it);
     }
 
+    auto iterator = writeSortedRun(std::move(ptrs));
+
+    _groups->clear();
+    // Zero out the current memory consumption, as the memory has been freed by spilling.
+    _memoryTracker.resetCurrent();
+    std::fill(_partitionMemoryBytes.begin(), _partitionMemoryBytes.end(), 0);
+
+    return iterator;
+}
+
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::writeSortedRun(
+    vector<const GroupsMap::value_type*> ptrs) {
+    _stats.spills++;
+
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir), _file);
@@ -681,15 +922,124 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     metricsCollector.incrementKeysSorted(ptrs.size());
     metricsCollector.incrementSorterSpills(1);
 
+    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
+    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+}
+
+size_t DocumentSourceGroup::partitionOf(const Value& id) const {
+    return _groups->hash_function()(id) % _numSpillPartitions;
+}
+
+void DocumentSourceGroup::spillLargestPartitions() {
+    vector<size_t> partitions(_numSpillPartitions);
+    std::iota(partitions.begin(), partitions.end(), 0);
+    std::sort(partitions.begin(), partitions.end(), [&](size_t lhs, size_t rhs) {
+        return _partitionMemoryBytes[lhs] > _partitionMemoryBytes[rhs];
+    });
+
+    // Spilling down to half of the limit leaves room for the groups of the partitions that stay
+    // in memory to grow before the next spill.
+    const auto targetBytes = static_cast<long long>(_memoryTracker._maxAllowedMemoryUsageBytes / 2);
+    long long bytesToSpill = _memoryTracker.currentMemoryBytes() - targetBytes;
+    vector<size_t> spilledPartitions;
+    for (auto partition : partitions) {
+        if (bytesToSpill <= 0 || _partitionMemoryBytes[partition] == 0) {
+            break;
+        }
+        spilledPartitions.push_back(partition);
+        bytesToSpill -= _partitionMemoryBytes[partition];
+    }
+    spillPartitions(spilledPartitions);
+}
+
+void DocumentSourceGroup::spillPartitions(const vector<size_t>& partitions) {
+    if (partitions.empty()) {
+        return;
+    }
+
+    // Bucket the groups of every partition to spill in a single pass over '_groups'.
+    vector<bool> isSpilled(_numSpillPartitions, false);
+    for (auto partition : partitions) {
+        isSpilled[partition] = true;
+    }
+    vector<vector<GroupsMap::iterator>> spilledGroups(_numSpillPartitions);
+    for (auto it = _groups->begin(); it != _groups->end(); ++it) {
+        const size_t partition = partitionOf(it->first);
+        if (isSpilled[partition]) {
+            spilledGroups[partition].push_back(it);
+        }
+    }
+
+    for (auto partition : partitions) {
+        auto& groups = spilledGroups[partition];
+        if (groups.empty()) {
+            continue;
+        }
+
+        vector<const GroupsMap::value_type*> ptrs;
+        ptrs.reserve(groups.size());
+        for (auto&& it : groups) {
+            ptrs.push_back(&*it);
+        }
+        _partitionRuns[partition].push_back(writeSortedRun(std::move(ptrs)));
+
+        // Erasing a group does not invalidate the iterators to the other groups.
+        for (auto&& it : groups) {
+            for (size_t i = 0; i < it->second.size(); i++) {
+                _memoryTracker.update(_accumulatedFields[i].fieldName,
+                                      -1 * it->second[i]->getMemUsage());
+            }
+            _memoryTracker.set(_memoryTracker.currentMemoryBytes() -
+                               it->first.getApproximateSize());
+            _groups->erase(it);
+        }
+        _partitionMemoryBytes[partition] = 0;
+    }
+}
+
+void DocumentSourceGroup::loadSpilledPartition() {
+    const size_t partition = _spilledPartitions.front();
+    _spilledPartitions.pop_front();
+    auto runs = std::move(_partitionRuns[partition]);
+    _partitionRuns[partition].clear();
+
     _groups->clear();
-    // Zero out the current per-accumulation statement memory consumption, as the memory has been
-    // freed by spilling.
-    for (auto accum : _accumulatedFields) {
-        _memoryTracker.set(accum.fieldName, 0);
+    _memoryTracker.resetCurrent();
+    std::fill(_partitionMemoryBytes.begin(), _partitionMemoryBytes.end(), 0);
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    for (size_t run = 0; run < runs.size(); ++run) {
+        while (runs[run]->more()) {
+            if (_memoryTracker._allowDiskUse &&
+                _memoryTracker.currentMemoryBytes() >
+                    static_cast<long long>(_memoryTracker._maxAllowedMemoryUsageBytes)) {
+                // The groups of this partition do not fit in memory. Spill what has been merged so
+                // far and merge it with the rest of the runs by sorting instead. The groups go to
+                // a new file, since the current one has already been read from.
+                _file = std::make_shared<Sorter<Value, Value>::File>(pExpCtx->tempDir + "/" +
+                                                                     nextFileName());
+                vector<shared_ptr<Sorter<Value, Value>::Iterator>> remainingRuns(
+                    runs.begin() + run, runs.end());
+                remainingRuns.push_back(spill());
+
+                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+                    remainingRuns, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+                _spilled = true;
+                _firstPartOfNextGroup = _sorterIterator->next();
+                return;
+            }
+
+            auto entry = runs[run]->next();
+            processGroup(
+                entry.first,
+                [&](size_t i) {  // mirrors switch in writeSortedRun()
+                    return numAccumulators == 1 ? entry.second : entry.second.getArray()[i];
+                },
+                /*merging=*/true);
+        }
     }
 
-    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
-    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+    groupsIterator = _groups->begin();
 }
 
 Value DocumentSourceGroup::computeId(const Document& root) {
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
 
@@ -41,6 +42,8 @@
 
 namespace mongo {
 
+class SortPattern;
+
 /**
  * GroupFromFirstTransformation consists of a list of (field name, expression pairs). It returns a
  * document synthesized by assigning each field name in the output document to the result of
@@ -99,7 +102,11 @@ public:
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
     const char* getSourceName() const final;
     GetModPathsReturn getModifiedPaths() const final;
-    StringMap<boost::intrusive_ptr<Expression>> getIdFields() const;
+    /**
+     * Returns the expressions of the '_id' fields keyed by their path ("_id" or "_id.<field>"), in
+     * the order in which the '_id' spells them out.
+     */
+    std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> getIdFields() const;
     const std::vector<AccumulationStatement>& getAccumulatedFields() const;
 
     /**
@@ -157,6 +164,22 @@ public:
         _doingMerge = doingMerge;
     }
 
+    /**
+     * Returns true if this stage was parsed from expressions and accumulators which the slot-based
+     * execution engine implements, in which case it may be pushed down into the query layer.
+     */
+    bool sbeCompatible() const {
+        return _sbeCompatible;
+    }
+
+    /**
+     * Tells this stage that its input arrives sorted by 'sortPattern'. If the group key is made up
+     * of field paths that are exactly the leading fields of that sort, the documents of a group are
+     * adjacent in the input, so each group is returned as soon as the input moves past it instead
+     * of after the whole input has been consumed. Returns whether groups will be streamed.
+     */
+    bool setInputSortedBy(const SortPattern& sortPattern);
+
     /**
      * Returns true if this $group stage used disk during execution and false otherwise.
      */
@@ -205,6 +228,26 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Used instead of initialize() when the input is sorted on the group key. Consumes input until
+     * the group key changes and returns the group that just ended. Documents whose group key may
+     * not be adjacent to the rest of its group in the sort order are accumulated in '_groups'
+     * instead, and those groups are returned once the input is exhausted.
+     */
+    GetNextResult getNextStreamed();
+
+    /**
+     * Resets '_currentAccumulators' to begin accumulating the group with key 'id'.
+     */
+    void startStreamedGroup(Value id);
+
+    /**
+     * Returns true if every document with group key 'id' is guaranteed to be adjacent in input that
+     * is sorted on the group fields. That is not the case for keys with arrays, which sort by
+     * one of their elements, or with nullish values, which sort together with missing fields.
+     */
+    bool isStreamableGroupKey(const Value& id) const;
+
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
      * initialize() requests the first document from the previous source, and uses it to prepare the
@@ -217,6 +260,26 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Called once the input is exhausted to prepare the groups in '_groups' and any spilled groups
+     * for output. Marks this stage as initialized.
+     */
+    void readyGroupsForOutput();
+
+    /**
+     * Accumulates 'root' into its group in '_groups', first spilling to disk if the memory limit
+     * has been exceeded.
+     */
+    void addToGroupsMap(const Value& id, const Document& root);
+
+    /**
+     * Finds or creates the group with key 'id' in '_groups', and processes into its i-th
+     * accumulator the value 'getInput(i)' returns. Tracks the memory used by the group. Returns
+     * true if the group was created.
+     */
+    template <typename InputFn>
+    bool processGroup(const Value& id, const InputFn& getInput, bool merging);
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -224,6 +287,35 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Sorts the given groups by key, writes them to '_file' and returns an iterator over the run.
+     */
+    std::shared_ptr<Sorter<Value, Value>::Iterator> writeSortedRun(
+        std::vector<const GroupsMap::value_type*> groups);
+
+    /**
+     * When spilling by partition, returns the partition which the group with key 'id' belongs to.
+     */
+    size_t partitionOf(const Value& id) const;
+
+    /**
+     * Spills the partitions using the most memory until at most half of the memory limit is in use.
+     * Groups of the other partitions stay in memory.
+     */
+    void spillLargestPartitions();
+
+    /**
+     * Spills the groups of each of 'partitions' to its own run and removes them from '_groups'.
+     */
+    void spillPartitions(const std::vector<size_t>& partitions);
+
+    /**
+     * Replaces the contents of '_groups' with the next spilled partition, merging the runs spilled
+     * for it into one entry per group. If the partition does not fit in memory, the runs are
+     * instead merged by sorting as when not spilling by partition, and '_spilled' is set.
+     */
+    void loadSpilledPartition();
+
     /**
      * If we ran out of memory, finish all the pending operations so that some memory
      * can be freed.
@@ -260,6 +352,8 @@ private:
 
     bool _doingMerge;
 
+    bool _sbeCompatible = false;
+
     MemoryUsageTracker _memoryTracker;
 
     GroupStats _stats;
@@ -289,6 +383,20 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // Set while the input, which is sorted on the group key, is streamed by getNextStreamed().
+    // '_currentId' and '_currentAccumulators' then hold the group being streamed, if
+    // '_haveStreamedGroup' is true.
+    bool _streamingInput = false;
+    bool _haveStreamedGroup = false;
+
+    // If non-zero, groups are assigned to this many partitions by the hash of their key, and only
+    // the partitions using the most memory are spilled when the memory limit is exceeded. The
+    // groups of each spilled partition are merged in memory after the others have been returned.
+    const size_t _numSpillPartitions;
+    std::vector<long long> _partitionMemoryBytes;
+    std::vector<std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>>> _partitionRuns;
+    std::deque<size_t> _spilledPartitions;  // Partitions waiting to be loaded back into memory.
 };
 
 }  // namespace mongo
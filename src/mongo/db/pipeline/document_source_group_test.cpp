@@ -50,8 +50,11 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
@@ -245,6 +248,166 @@ TEST_F(DocumentSourceGroupTest, ShouldNotReportDottedGroupKeyAsARename) {
     ASSERT_EQ(modifiedPathsRet.renames.size(), 0UL);
 }
 
+/**
+ * Groups documents which have 'numGroups' distinct values of "_id", interleaved so that every group
+ * keeps growing until the end of the input, and returns the number of documents in each group.
+ */
+std::map<int, int> countGroupsWithSpillPartitions(const intrusive_ptr<ExpressionContext>& expCtx,
+                                                  int numPartitions,
+                                                  size_t maxMemoryUsageBytes,
+                                                  int numGroups) {
+    RAIIServerParameterControllerForTest controller{"internalDocumentSourceGroupSpillPartitions",
+                                                    numPartitions};
+    auto&& parser = AccumulationStatement::getParser("$sum", boost::none);
+    auto accumulatorArg = BSON("" << 1);
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement countStatement{"count", accExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx.get(), "$_id", expCtx->variablesParseState);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {countStatement}, maxMemoryUsageBytes);
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int round = 0; round < 3; ++round) {
+        for (int id = 0; id < numGroups; ++id) {
+            inputs.emplace_back(Document{{"_id", id}});
+        }
+    }
+    auto mock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+    group->setSource(mock.get());
+
+    std::map<int, int> counts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        auto inserted = counts.emplace(doc["_id"].coerceToInt(), doc["count"].coerceToInt());
+        ASSERT_TRUE(inserted.second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->usedDisk());
+    return counts;
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldMergeSpilledPartitionsInMemory) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int numGroups = 100;
+    auto counts = countGroupsWithSpillPartitions(expCtx, 16, 2000, numGroups);
+    ASSERT_EQ(counts.size(), static_cast<size_t>(numGroups));
+    for (auto&& [id, count] : counts) {
+        ASSERT_EQ(count, 3) << "group " << id;
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldSortMergeSpilledPartitionThatDoesNotFitInMemory) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int numGroups = 100;
+    auto counts = countGroupsWithSpillPartitions(expCtx, 2, 200, numGroups);
+    ASSERT_EQ(counts.size(), static_cast<size_t>(numGroups));
+    for (auto&& [id, count] : counts) {
+        ASSERT_EQ(count, 3) << "group " << id;
+    }
+}
+
+intrusive_ptr<DocumentSourceGroup> makeCountGroup(const intrusive_ptr<ExpressionContext>& expCtx,
+                                                  const BSONObj& id) {
+    auto spec = BSON("$group" << BSON("_id" << id.firstElement() << "count"
+                                            << BSON("$sum" << 1)));
+    return static_cast<DocumentSourceGroup*>(
+        DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx).get());
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldStreamOnlyWhenGroupedByLeadingSortFields) {
+    auto expCtx = getExpCtx();
+    auto sortedBy = [&](const BSONObj& sortSpec) { return SortPattern(sortSpec, expCtx); };
+
+    ASSERT_TRUE(
+        makeCountGroup(expCtx, BSON("" << "$a"))->setInputSortedBy(sortedBy(BSON("a" << 1))));
+    ASSERT_TRUE(makeCountGroup(expCtx, BSON("" << "$a.b"))
+                    ->setInputSortedBy(sortedBy(BSON("a.b" << -1 << "c" << 1))));
+    ASSERT_TRUE(makeCountGroup(expCtx, BSON("" << BSON("x" << "$a" << "y" << "$b")))
+                    ->setInputSortedBy(sortedBy(BSON("b" << 1 << "a" << -1 << "c" << 1))));
+
+    ASSERT_FALSE(
+        makeCountGroup(expCtx, BSON("" << "$a"))->setInputSortedBy(sortedBy(BSON("b" << 1))));
+    ASSERT_FALSE(makeCountGroup(expCtx, BSON("" << "$a"))
+                     ->setInputSortedBy(sortedBy(BSON("b" << 1 << "a" << 1))));
+    ASSERT_FALSE(makeCountGroup(expCtx, BSON("" << BSON("x" << "$a" << "y" << "$b")))
+                     ->setInputSortedBy(sortedBy(BSON("a" << 1))));
+    ASSERT_FALSE(makeCountGroup(expCtx, BSON("" << "$a.0"))
+                     ->setInputSortedBy(sortedBy(BSON("a.0" << 1))));
+    ASSERT_FALSE(makeCountGroup(expCtx, BSON("" << BSON("$toUpper" << "$a")))
+                     ->setInputSortedBy(sortedBy(BSON("a" << 1))));
+    ASSERT_FALSE(makeCountGroup(expCtx, BSON("" << "$$ROOT"))
+                     ->setInputSortedBy(sortedBy(BSON("a" << 1))));
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldReturnGroupsBeforeEndOfSortedInput) {
+    auto expCtx = getExpCtx();
+    auto group = makeCountGroup(expCtx, BSON("" << "$a"));
+    ASSERT_TRUE(group->setInputSortedBy(SortPattern(BSON("a" << 1), expCtx)));
+
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                           Document{{"a", 1}},
+                                           Document{{"a", 2}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 3}}},
+                                          expCtx);
+    group->setSource(mock.get());
+
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 1}, {"count", 2}}));
+    ASSERT_TRUE(group->getNext().isPaused());
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 2}, {"count", 1}}));
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 3}, {"count", 1}}));
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldGroupArrayAndNullKeysOfSortedInputInMemory) {
+    auto expCtx = getExpCtx();
+    auto group = makeCountGroup(expCtx, BSON("" << "$a"));
+    ASSERT_TRUE(group->setInputSortedBy(SortPattern(BSON("a" << 1), expCtx)));
+
+    // An array sorts by its smallest element, so it can separate documents of the same group.
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", BSONNULL}},
+                                                   Document{},
+                                                   Document{{"a", 1}},
+                                                   Document{{"a", {1, 2}}},
+                                                   Document{{"a", 1}},
+                                                   Document{{"a", {1, 2}}},
+                                                   Document{{"a", 2}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    std::vector<Document> results;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        results.push_back(result.releaseDocument());
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    auto byId = [&](const Document& lhs, const Document& rhs) {
+        return ValueComparator().evaluate(lhs["_id"] < rhs["_id"]);
+    };
+    std::sort(results.begin(), results.end(), byId);
+    ASSERT_EQ(results.size(), 4UL);
+    ASSERT_DOCUMENT_EQ(results[0], (Document{{"_id", BSONNULL}, {"count", 2}}));
+    ASSERT_DOCUMENT_EQ(results[1], (Document{{"_id", 1}, {"count", 2}}));
+    ASSERT_DOCUMENT_EQ(results[2], (Document{{"_id", 2}, {"count", 1}}));
+    ASSERT_DOCUMENT_EQ(results[3], (Document{{"_id", {1, 2}}, {"count", 2}}));
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -187,6 +187,22 @@ public:
         return _localField;
     }
 
+    const NamespaceString& getFromNs() const {
+        return _fromNs;
+    }
+
+    const FieldPath& getAsField() const {
+        return _as;
+    }
+
+    /**
+     * Returns true if this $lookup has absorbed a subsequent $unwind or $match stage, in which case
+     * its output is no longer a plain left outer join of the local and foreign collections.
+     */
+    bool hasAbsorbedStages() const {
+        return _unwindSrc || _matchSrc || _additionalFilter;
+    }
+
     const std::vector<LetVariable>& getLetVariables() const {
         return _letVariables;
     }
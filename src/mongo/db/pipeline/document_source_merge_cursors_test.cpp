@@ -32,6 +32,7 @@
 #include "mongo/s/query/document_source_merge_cursors.h"
 
 #include <memory>
+#include <set>
 
 #include "mongo/client/remote_command_targeter_factory_mock.h"
 #include "mongo/client/remote_command_targeter_mock.h"
@@ -46,6 +47,7 @@
 #include "mongo/db/query/getmore_command_gen.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_request_helper.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/executor/network_interface_mock.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
@@ -334,6 +336,90 @@ TEST_F(DocumentSourceMergeCursorsTest, ShouldKillCursorIfPartiallyIterated) {
     future.default_timed_get();
 }
 
+TEST_F(DocumentSourceMergeCursorsTest, ShouldSendGetMoresBeforeBeingIteratedWhenPrefetched) {
+    auto expCtx = getExpCtx();
+    AsyncResultsMergerParams armParams;
+    armParams.setNss(kTestNss);
+    std::vector<RemoteCursor> cursors;
+    cursors.emplace_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(expCtx->ns, 1, {})));
+    cursors.emplace_back(
+        makeRemoteCursor(kTestShardIds[1], kTestShardHosts[1], CursorResponse(expCtx->ns, 2, {})));
+    armParams.setRemotes(std::move(cursors));
+    auto pipeline = Pipeline::create({}, expCtx);
+    pipeline->addInitialSource(DocumentSourceMergeCursors::create(expCtx, std::move(armParams)));
+
+    // Prefetching does not wait for the remotes, so it can be called from this thread.
+    pipeline->getSources().front()->prefetch();
+
+    // Both getMores have been sent although the pipeline has not been iterated yet.
+    std::set<CursorId> getMoreCursors;
+    for (int i = 0; i < 2; ++i) {
+        onCommand([&](const auto& request) {
+            ASSERT(request.cmdObj["getMore"]);
+            getMoreCursors.insert(request.cmdObj["getMore"].Long());
+            return cursorResponseObj(expCtx->ns, kExhaustedCursorID, {BSON("x" << 1)});
+        });
+    }
+    ASSERT(getMoreCursors == std::set<CursorId>({1, 2}));
+
+    // The results were fetched in the background, so iterating needs no further requests.
+    auto future = launchAsync([&pipeline]() {
+        ASSERT_DOCUMENT_EQ(*pipeline->getNext(), (Document{{"x", 1}}));
+        ASSERT_DOCUMENT_EQ(*pipeline->getNext(), (Document{{"x", 1}}));
+        ASSERT_FALSE(static_cast<bool>(pipeline->getNext()));
+    });
+    future.default_timed_get();
+
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+}
+
+TEST_F(DocumentSourceMergeCursorsTest, ShouldKillCursorsIfDisposedAfterPrefetchWithoutIterating) {
+    auto expCtx = getExpCtx();
+    AsyncResultsMergerParams armParams;
+    armParams.setNss(kTestNss);
+    std::vector<RemoteCursor> cursors;
+    cursors.emplace_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(expCtx->ns, 1, {})));
+    cursors.emplace_back(
+        makeRemoteCursor(kTestShardIds[1], kTestShardHosts[1], CursorResponse(expCtx->ns, 2, {})));
+    armParams.setRemotes(std::move(cursors));
+    auto pipeline = Pipeline::create({}, expCtx);
+    pipeline->addInitialSource(DocumentSourceMergeCursors::create(expCtx, std::move(armParams)));
+    pipeline->getSources().front()->prefetch();
+
+    // Delete the pipeline while its getMores are outstanding. This waits for them to be canceled,
+    // so it happens on a different thread.
+    AtomicWord<bool> disposed{false};
+    auto future = launchAsync([&]() {
+        pipeline.reset();
+        disposed.store(true);
+    });
+
+    // Here we're looking for a killCursors request to be scheduled for each remote cursor.
+    std::set<CursorId> killedCursors;
+    for (int i = 0; i < 2; ++i) {
+        onCommand([&](const auto& request) {
+            ASSERT(request.cmdObj["killCursors"]);
+            auto cursorsArray = request.cmdObj["cursors"].Array();
+            ASSERT_EQ(cursorsArray.size(), 1UL);
+            killedCursors.insert(cursorsArray[0].Long());
+            return BSON("ok" << 1);
+        });
+    }
+    ASSERT(killedCursors == std::set<CursorId>({1, 2}));
+
+    // Deliver the cancellations of the getMores, which are never answered.
+    while (!disposed.load()) {
+        network()->enterNetwork();
+        network()->runReadyNetworkOperations();
+        network()->exitNetwork();
+    }
+    future.default_timed_get();
+}
+
 TEST_F(DocumentSourceMergeCursorsTest, ShouldEnforceSortSpecifiedViaARMParams) {
     auto expCtx = getExpCtx();
     auto pipeline = Pipeline::create({}, expCtx);
@@ -97,6 +97,13 @@ list<intrusive_ptr<DocumentSource>> document_source_set_window_fields::createFro
 
     auto spec =
         SetWindowFieldsSpec::parse(IDLParserErrorContext(kStageName), elem.embeddedObject());
+
+    // The expressions of this stage clear the 'sbeCompatible' flag of 'expCtx' when SBE cannot
+    // translate them. As the flag accounts for the whole pipeline, it is raised while parsing this
+    // stage alone and restored afterwards.
+    const bool pipelineSbeCompatible = expCtx->sbeCompatible;
+    expCtx->sbeCompatible = true;
+
     auto partitionBy = [&]() -> boost::optional<boost::intrusive_ptr<Expression>> {
         if (auto partitionBy = spec.getPartitionBy())
             return Expression::parseOperand(
@@ -115,8 +122,17 @@ list<intrusive_ptr<DocumentSource>> document_source_set_window_fields::createFro
         outputFields.push_back(WindowFunctionStatement::parse(outputElem, sortBy, expCtx.get()));
     }
 
-    return create(
+    const bool sbeCompatible = expCtx->sbeCompatible;
+    expCtx->sbeCompatible = pipelineSbeCompatible && sbeCompatible;
+
+    auto result = create(
         std::move(expCtx), std::move(partitionBy), std::move(sortBy), std::move(outputFields));
+    for (auto&& source : result) {
+        if (auto windowStage = dynamic_cast<DocumentSourceInternalSetWindowFields*>(source.get())) {
+            windowStage->setSbeCompatible(sbeCompatible);
+        }
+    }
+    return result;
 }
 
 WindowFunctionStatement WindowFunctionStatement::parse(BSONElement elem,
@@ -311,6 +327,11 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalSetWindowFields::crea
 
     auto spec =
         SetWindowFieldsSpec::parse(IDLParserErrorContext(kStageName), elem.embeddedObject());
+
+    // See document_source_set_window_fields::createFromBson().
+    const bool pipelineSbeCompatible = expCtx->sbeCompatible;
+    expCtx->sbeCompatible = true;
+
     auto partitionBy = [&]() -> boost::optional<boost::intrusive_ptr<Expression>> {
         if (auto partitionBy = spec.getPartitionBy())
             return Expression::parseOperand(
@@ -329,12 +350,15 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalSetWindowFields::crea
         outputFields.push_back(WindowFunctionStatement::parse(elem, sortBy, expCtx.get()));
     }
 
-    return make_intrusive<DocumentSourceInternalSetWindowFields>(
+    auto windowStage = make_intrusive<DocumentSourceInternalSetWindowFields>(
         expCtx,
         partitionBy,
         sortBy,
         outputFields,
         internalDocumentSourceSetWindowFieldsMaxMemoryBytes.load());
+    windowStage->setSbeCompatible(expCtx->sbeCompatible);
+    expCtx->sbeCompatible = pipelineSbeCompatible && expCtx->sbeCompatible;
+    return windowStage;
 }
 
 void DocumentSourceInternalSetWindowFields::initialize() {
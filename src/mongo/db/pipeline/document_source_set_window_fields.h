@@ -179,6 +179,31 @@ public:
         return _iterator.usedDisk();
     };
 
+    const boost::optional<boost::intrusive_ptr<Expression>>& getPartitionBy() const {
+        return _partitionBy;
+    }
+
+    const boost::optional<SortPattern>& getSortBy() const {
+        return _sortBy;
+    }
+
+    const std::vector<WindowFunctionStatement>& getOutputFields() const {
+        return _outputFields;
+    }
+
+    /**
+     * Returns true if the expressions of this stage were parsed from expressions which the
+     * slot-based execution engine implements. Whether the window functions themselves are
+     * implemented is left to the caller.
+     */
+    bool sbeCompatible() const {
+        return _sbeCompatible;
+    }
+
+    void setSbeCompatible(bool sbeCompatible) {
+        _sbeCompatible = sbeCompatible;
+    }
+
 private:
     void initialize();
 
@@ -190,6 +215,7 @@ private:
     StringMap<std::unique_ptr<WindowFunctionExec>> _executableOutputs;
     bool _init = false;
     bool _eof = false;
+    bool _sbeCompatible = false;
 };
 
 }  // namespace mongo
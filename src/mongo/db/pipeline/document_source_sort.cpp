@@ -61,8 +61,12 @@ DocumentSourceSort::DocumentSourceSort(const boost::intrusive_ptr<ExpressionCont
                                        uint64_t limit,
                                        uint64_t maxMemoryUsageBytes)
     : DocumentSource(kStageName, pExpCtx),
-      _sortExecutor(
-          {sortOrder, limit, maxMemoryUsageBytes, pExpCtx->tempDir, pExpCtx->allowDiskUse}),
+      _sortExecutor({sortOrder,
+                     limit,
+                     maxMemoryUsageBytes,
+                     pExpCtx->tempDir,
+                     pExpCtx->allowDiskUse,
+                     internalQueryEncodeSortKeysAsKeyString.load()}),
       // The SortKeyGenerator expects the expressions to be serialized in order to detect a sort
       // by a metadata field.
       _sortKeyGen({sortOrder, pExpCtx->getCollator()}) {
@@ -89,7 +93,7 @@ DocumentSource::GetNextResult DocumentSourceSort::doGetNext() {
         return GetNextResult::makeEOF();
     }
 
-    return GetNextResult{_sortExecutor->getNext().second};
+    return GetNextResult{_sortExecutor->getNextData()};
 }
 
 void DocumentSourceSort::serializeToArray(
@@ -124,6 +128,11 @@ void DocumentSourceSort::serializeToArray(
             Value(static_cast<long long>(stats.totalDataSizeBytes));
         mutDoc["usedDisk"] = Value(stats.spills > 0);
         mutDoc["spills"] = Value(static_cast<long long>(stats.spills));
+        mutDoc["spilledDataSizeUncompressed"] =
+            Value(static_cast<long long>(stats.spilledDataSizeUncompressed));
+        mutDoc["spilledDataStorageSize"] =
+            Value(static_cast<long long>(stats.spilledDataStorageSize));
+        mutDoc["spillTimeMillis"] = Value(durationCount<Milliseconds>(stats.spillTime));
     }
 
     array.push_back(Value(mutDoc.freeze()));
@@ -216,6 +225,13 @@ DocumentSource::GetNextResult DocumentSourceSort::populate() {
 void DocumentSourceSort::loadDocument(Document&& doc) {
     invariant(!_populated);
 
+    // A top-k sort can often rule out the document from the first component of its sort key
+    // alone, without generating the full key.
+    if (_sortExecutor->rejectByLeadingComponent(
+            [&] { return _sortKeyGen->computeLeadingSortKeyComponent(doc, doc.metadata()); })) {
+        return;
+    }
+
     Value sortKey;
     Document docForSorter;
     // We always need to extract the sort key if we've reached this point. If the query system had
@@ -333,6 +333,31 @@ TEST_F(DocumentSourceSortExecutionTest, CompoundSortSpecAlternateOrderSecondFiel
                  "[{_id:2,a:0,b:4},{_id:0,a:1,b:3},{_id:1,a:1,b:2}]");
 }
 
+TEST_F(DocumentSourceSortExecutionTest, CompoundTopKSortCountsInputsRejectedByLeadingField) {
+    auto sortStage = DocumentSourceSort::create(
+        getExpCtx(), {BSON("a" << 1 << "b" << -1), getExpCtx()}, 2);
+    auto source = DocumentSourceMock::createForTest({"{_id: 0, a: 2, b: 0}",
+                                                     "{_id: 1, a: 1, b: 0}",
+                                                     "{_id: 2, a: 3, b: 9}",
+                                                     "{_id: 3, a: 1, b: 1}",
+                                                     "{_id: 4, a: 4, b: 9}",
+                                                     "{_id: 5, a: [0, 5], b: 0}"},
+                                                    getExpCtx());
+    sortStage->setSource(source.get());
+
+    auto next = sortStage->getNext();
+    ASSERT(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{fromjson("{_id: 5, a: [0, 5], b: 0}")}));
+    next = sortStage->getNext();
+    ASSERT(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{fromjson("{_id: 3, a: 1, b: 1}")}));
+    ASSERT(sortStage->getNext().isEOF());
+
+    // Inputs which were dropped before their full sort key was generated are still reported.
+    auto stats = static_cast<const SortStats*>(sortStage->getSpecificStats());
+    ASSERT_EQ(stats->keysSorted, 6U);
+}
+
 /** Sorting different types is not supported. */
 TEST_F(DocumentSourceSortExecutionTest, InconsistentTypeSort) {
     checkResults({Document{{"_id", 0}, {"a", 1}}, Document{{"_id", 1}, {"a", "foo"_sd}}},
@@ -493,6 +518,40 @@ TEST_F(DocumentSourceSortExecutionTest, ShouldBeAbleToPauseLoadingWhileSpilled)
     ASSERT_VALUE_EQ(next.releaseDocument()["_id"], Value(0));
 }
 
+TEST_F(DocumentSourceSortExecutionTest, ExplainReportsSizeOfSpilledData) {
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceSortTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    auto sort =
+        DocumentSourceSort::create(expCtx, {BSON("_id" << -1), expCtx}, 0, maxMemoryUsageBytes);
+
+    // The repeated characters compress well, so less is written to disk than was spilled.
+    string largeStr(maxMemoryUsageBytes, 'x');
+    auto mock = DocumentSourceMock::createForTest({Document{{"_id", 0}, {"largeStr", largeStr}},
+                                                   Document{{"_id", 1}, {"largeStr", largeStr}},
+                                                   Document{{"_id", 2}, {"largeStr", largeStr}}},
+                                                  expCtx);
+    sort->setSource(mock.get());
+    while (sort->getNext().isAdvanced()) {
+    }
+
+    vector<Value> explain;
+    sort->serializeToArray(explain, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_EQ(explain.size(), 1U);
+    auto sortExplain = explain[0].getDocument();
+    ASSERT_VALUE_EQ(sortExplain["usedDisk"], Value(true));
+
+    const auto uncompressedSize = sortExplain["spilledDataSizeUncompressed"].getLong();
+    const auto storageSize = sortExplain["spilledDataStorageSize"].getLong();
+    ASSERT_GT(uncompressedSize, static_cast<long long>(3 * maxMemoryUsageBytes));
+    ASSERT_GT(storageSize, 0LL);
+    ASSERT_LT(storageSize, uncompressedSize);
+    ASSERT_EQ(sortExplain["spillTimeMillis"].getType(), BSONType::NumberLong);
+}
+
 TEST_F(DocumentSourceSortExecutionTest,
        ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
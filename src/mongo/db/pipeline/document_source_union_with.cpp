@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_union_with.h"
 #include "mongo/db/pipeline/document_source_union_with_gen.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/views/resolved_view.h"
 #include "mongo/logv2/log.h"
 
@@ -188,6 +189,18 @@ DocumentSource::GetNextResult DocumentSourceUnionWith::doGetNext() {
 
     if (_executionState == ExecutionProgress::kIteratingSource) {
         auto nextInput = pSource->getNext();
+
+        // Attaching the sub-pipeline while the input is still being returned lets any remote
+        // cursors it opens produce results in the meantime. This waits for the first result of the
+        // input, since the stages before this one may set $$SEARCH_META when they start.
+        if (!_subPipelineAttached && !pExpCtx->explain &&
+            internalQueryUnionWithPrefetchSubPipeline.load()) {
+            attachSubPipeline();
+            if (!_pipeline->getSources().empty()) {
+                _pipeline->getSources().front()->prefetch();
+            }
+        }
+
         if (!nextInput.isEOF()) {
             return nextInput;
         }
@@ -197,28 +210,10 @@ DocumentSource::GetNextResult DocumentSourceUnionWith::doGetNext() {
     }
 
     if (_executionState == ExecutionProgress::kStartingSubPipeline) {
-        auto serializedPipe = _pipeline->serializeToBson();
-        logStartingSubPipeline(serializedPipe);
-        // $$SEARCH_META can be set during runtime earlier in the pipeline, and therefore must be
-        // copied to the subpipeline manually.
-        if (pExpCtx->variables.hasConstantValue(Variables::kSearchMetaId)) {
-            _pipeline->getContext()->variables.setReservedValue(
-                Variables::kSearchMetaId,
-                pExpCtx->variables.getValue(Variables::kSearchMetaId, Document()),
-                true);
-        }
-        try {
-            _pipeline =
-                pExpCtx->mongoProcessInterface->attachCursorSourceToPipeline(_pipeline.release());
-            _executionState = ExecutionProgress::kIteratingSubPipeline;
-        } catch (const ExceptionFor<ErrorCodes::CommandOnShardedViewNotSupportedOnMongod>& e) {
-            _pipeline = buildPipelineFromViewDefinition(
-                pExpCtx,
-                ExpressionContext::ResolvedNamespace{e->getNamespace(), e->getPipeline()},
-                serializedPipe);
-            logShardedViewFound(e);
-            return doGetNext();
+        if (!_subPipelineAttached) {
+            attachSubPipeline();
         }
+        _executionState = ExecutionProgress::kIteratingSubPipeline;
     }
 
     auto res = _pipeline->getNext();
@@ -232,6 +227,31 @@ DocumentSource::GetNextResult DocumentSourceUnionWith::doGetNext() {
     return GetNextResult::makeEOF();
 }
 
+void DocumentSourceUnionWith::attachSubPipeline() {
+    auto serializedPipe = _pipeline->serializeToBson();
+    logStartingSubPipeline(serializedPipe);
+    // $$SEARCH_META can be set during runtime earlier in the pipeline, and therefore must be
+    // copied to the subpipeline manually.
+    if (pExpCtx->variables.hasConstantValue(Variables::kSearchMetaId)) {
+        _pipeline->getContext()->variables.setReservedValue(
+            Variables::kSearchMetaId,
+            pExpCtx->variables.getValue(Variables::kSearchMetaId, Document()),
+            true);
+    }
+    try {
+        _pipeline =
+            pExpCtx->mongoProcessInterface->attachCursorSourceToPipeline(_pipeline.release());
+        _subPipelineAttached = true;
+    } catch (const ExceptionFor<ErrorCodes::CommandOnShardedViewNotSupportedOnMongod>& e) {
+        _pipeline = buildPipelineFromViewDefinition(
+            pExpCtx,
+            ExpressionContext::ResolvedNamespace{e->getNamespace(), e->getPipeline()},
+            serializedPipe);
+        logShardedViewFound(e);
+        attachSubPipeline();
+    }
+}
+
 // The use of these logging macros is done in separate NOINLINE functions to reduce the stack space
 // used on the hot getNext() path. This is done to avoid stack overflows.
 MONGO_COMPILER_NOINLINE void DocumentSourceUnionWith::logStartingSubPipeline(
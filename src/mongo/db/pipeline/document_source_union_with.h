@@ -164,6 +164,12 @@ private:
 
     void addViewDefinition(NamespaceString nss, std::vector<BSONObj> viewPipeline);
 
+    /**
+     * Attaches a cursor source to '_pipeline', resolving a sharded view if the sub-pipeline turns
+     * out to read from one.
+     */
+    void attachSubPipeline();
+
     void recordPlanSummaryStats(const Pipeline& pipeline);
 
     void logStartingSubPipeline(const std::vector<BSONObj>& serializedPipeline);
@@ -173,6 +179,10 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     Pipeline::SourceContainer _cachedPipeline;
     ExecutionProgress _executionState = ExecutionProgress::kIteratingSource;
+
+    // Set once a cursor source has been attached to '_pipeline', which happens while iterating
+    // 'pSource' if the sub-pipeline is prefetched.
+    bool _subPipelineAttached = false;
     UnionWithStats _stats;
 };
 
@@ -48,7 +48,9 @@
 #include "mongo/db/pipeline/document_source_union_with.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/process_interface/stub_lookup_single_document_process_interface.h"
+#include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/intrusive_counter.h"
 
@@ -57,6 +59,53 @@ namespace {
 
 using MockMongoInterface = StubLookupSingleDocumentProcessInterface;
 
+/**
+ * A DocumentSourceMock which counts how many times it has been asked to prefetch its results.
+ */
+class PrefetchCountingMock final : public DocumentSourceMock {
+public:
+    PrefetchCountingMock(std::deque<GetNextResult> results,
+                         const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                         int* prefetchCount)
+        : DocumentSourceMock(std::move(results), expCtx), _prefetchCount(prefetchCount) {}
+
+    void prefetch() final {
+        ++*_prefetchCount;
+    }
+
+private:
+    int* _prefetchCount;
+};
+
+/**
+ * A MongoProcessInterface which attaches a PrefetchCountingMock returning 'results' to each
+ * pipeline, and counts how many pipelines it has attached a cursor source to.
+ */
+class AttachCountingMongoInterface final : public StubMongoProcessInterface {
+public:
+    AttachCountingMongoInterface(std::deque<DocumentSource::GetNextResult> results,
+                                 int* attachCount,
+                                 int* prefetchCount)
+        : _results(std::move(results)), _attachCount(attachCount), _prefetchCount(prefetchCount) {}
+
+    std::unique_ptr<Pipeline, PipelineDeleter> attachCursorSourceToPipeline(
+        Pipeline* ownedPipeline,
+        ShardTargetingPolicy shardTargetingPolicy = ShardTargetingPolicy::kAllowed,
+        boost::optional<BSONObj> readConcern = boost::none) final {
+        ++*_attachCount;
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline(
+            ownedPipeline, PipelineDeleter(ownedPipeline->getContext()->opCtx));
+        pipeline->addInitialSource(
+            new PrefetchCountingMock(_results, pipeline->getContext(), _prefetchCount));
+        return pipeline;
+    }
+
+private:
+    std::deque<DocumentSource::GetNextResult> _results;
+    int* _attachCount;
+    int* _prefetchCount;
+};
+
 // This provides access to getExpCtx(), but we'll use a different name for this test suite.
 using DocumentSourceUnionWithTest = AggregationContextFixture;
 
@@ -326,6 +375,70 @@ TEST_F(DocumentSourceUnionWithTest, PropagatePauses) {
     ASSERT_TRUE(unionWithTwo.getNext().isEOF());
 }
 
+TEST_F(DocumentSourceUnionWithTest, AttachesSubPipelineOnceInputIsExhausted) {
+    const auto mock = DocumentSourceMock::createForTest(
+        {Document{{"a", 1}}, Document{{"a", 2}}}, getExpCtx());
+    int attachCount = 0;
+    int prefetchCount = 0;
+    const auto mockCtx = getExpCtx()->copyWith({});
+    mockCtx->mongoProcessInterface = std::make_unique<AttachCountingMongoInterface>(
+        std::deque<DocumentSource::GetNextResult>{Document{{"b", 1}}},
+        &attachCount,
+        &prefetchCount);
+    auto unionWith = DocumentSourceUnionWith(
+        mockCtx, Pipeline::create(std::list<boost::intrusive_ptr<DocumentSource>>{}, getExpCtx()));
+    unionWith.setSource(mock.get());
+
+    ASSERT_TRUE(unionWith.getNext().isAdvanced());
+    ASSERT_TRUE(unionWith.getNext().isAdvanced());
+    ASSERT_EQ(attachCount, 0);
+
+    auto next = unionWith.getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 1}}));
+    ASSERT_EQ(attachCount, 1);
+    ASSERT_EQ(prefetchCount, 0);
+    ASSERT_TRUE(unionWith.getNext().isEOF());
+}
+
+TEST_F(DocumentSourceUnionWithTest, PrefetchAttachesSubPipelineWithFirstInput) {
+    RAIIServerParameterControllerForTest controller{"internalQueryUnionWithPrefetchSubPipeline",
+                                                    true};
+    const auto mock =
+        DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 2}}},
+                                          getExpCtx());
+    int attachCount = 0;
+    int prefetchCount = 0;
+    const auto mockCtx = getExpCtx()->copyWith({});
+    mockCtx->mongoProcessInterface = std::make_unique<AttachCountingMongoInterface>(
+        std::deque<DocumentSource::GetNextResult>{Document{{"b", 1}}},
+        &attachCount,
+        &prefetchCount);
+    auto unionWith = DocumentSourceUnionWith(
+        mockCtx, Pipeline::create(std::list<boost::intrusive_ptr<DocumentSource>>{}, getExpCtx()));
+    unionWith.setSource(mock.get());
+
+    auto next = unionWith.getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 1}}));
+    ASSERT_EQ(attachCount, 1);
+    ASSERT_EQ(prefetchCount, 1);
+
+    // The input is still returned in full before the sub-pipeline, which is attached only once.
+    ASSERT_TRUE(unionWith.getNext().isPaused());
+    next = unionWith.getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 2}}));
+    next = unionWith.getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 1}}));
+    ASSERT_TRUE(unionWith.getNext().isEOF());
+    ASSERT_EQ(attachCount, 1);
+    ASSERT_EQ(prefetchCount, 1);
+}
+
 TEST_F(DocumentSourceUnionWithTest, ReturnEOFAfterBeingDisposed) {
     const auto mockInput = DocumentSourceMock::createForTest({Document(), Document()}, getExpCtx());
     const auto mockUnionInput = std::deque<DocumentSource::GetNextResult>{};
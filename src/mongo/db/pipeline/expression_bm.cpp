@@ -31,6 +31,9 @@
 
 #include <benchmark/benchmark.h>
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
@@ -503,5 +506,91 @@ BENCHMARK(BM_SetDifference);
 BENCHMARK(BM_SetEquals);
 BENCHMARK(BM_SetUnion);
 
+std::vector<BSONObj> makeComparisonInputs() {
+    std::vector<BSONObj> inputs;
+    for (int i = 0; i < 1000; ++i) {
+        inputs.push_back(BSON("x" << i << "y" << std::to_string(i) << "a" << (i % 100)));
+    }
+    return inputs;
+}
+
+/**
+ * Tests performance of evaluate() of a comparison of a top-level field with a constant.
+ */
+void BM_FieldEqConstant(benchmark::State& state) {
+    std::vector<Document> documents;
+    for (auto&& input : makeComparisonInputs()) {
+        documents.emplace_back(input);
+    }
+    benchmarkExpression(BSON("$eq" << BSON_ARRAY("$a" << 42LL)), state, documents);
+}
+
+/**
+ * Tests performance of the SBE equivalent of BM_FieldEqConstant. When 'fusible' is false, the field
+ * name and the constant are bound to local variables, which keeps them from being encoded in the
+ * getField and comparison instructions and makes the VM dispatch every step separately.
+ */
+void benchmarkSbeFieldEqConstant(benchmark::State& state, bool fusible) {
+    sbe::CoScanStage emptyStage{kEmptyPlanNodeId};
+    sbe::CompileCtx ctx{std::make_unique<sbe::RuntimeEnvironment>()};
+    ctx.root = &emptyStage;
+
+    sbe::value::SlotIdGenerator slotIdGenerator;
+    sbe::value::ViewOfValueAccessor inputAccessor;
+    auto inputSlot = slotIdGenerator.generate();
+    ctx.pushCorrelated(inputSlot, &inputAccessor);
+
+    auto makeComparison = [&](std::unique_ptr<sbe::EExpression> fieldName,
+                              std::unique_ptr<sbe::EExpression> constant) {
+        return sbe::makeE<sbe::EPrimBinary>(
+            sbe::EPrimBinary::eq,
+            sbe::makeE<sbe::EFunction>("getField",
+                                       sbe::makeEs(sbe::makeE<sbe::EVariable>(inputSlot),
+                                                   std::move(fieldName))),
+            std::move(constant));
+    };
+
+    std::unique_ptr<sbe::EExpression> expr;
+    if (fusible) {
+        expr = makeComparison(
+            sbe::makeE<sbe::EConstant>("a"),
+            sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::NumberInt64,
+                                       sbe::value::bitcastFrom<int64_t>(42)));
+    } else {
+        sbe::FrameId frameId = 1;
+        expr = sbe::makeE<sbe::ELocalBind>(
+            frameId,
+            sbe::makeEs(sbe::makeE<sbe::EConstant>("a"),
+                        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::NumberInt64,
+                                                   sbe::value::bitcastFrom<int64_t>(42))),
+            makeComparison(sbe::makeE<sbe::EVariable>(frameId, 0),
+                           sbe::makeE<sbe::EVariable>(frameId, 1)));
+    }
+    auto code = expr->compile(ctx);
+
+    auto inputs = makeComparisonInputs();
+    sbe::vm::ByteCode vm;
+    for (auto keepRunning : state) {
+        for (auto&& input : inputs) {
+            inputAccessor.reset(sbe::value::TypeTags::bsonObject,
+                                sbe::value::bitcastFrom<const char*>(input.objdata()));
+            benchmark::DoNotOptimize(vm.runPredicate(code.get()));
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_SbeFieldEqConstant(benchmark::State& state) {
+    benchmarkSbeFieldEqConstant(state, true /* fusible */);
+}
+
+void BM_SbeFieldEqConstantUnfused(benchmark::State& state) {
+    benchmarkSbeFieldEqConstant(state, false /* fusible */);
+}
+
+BENCHMARK(BM_FieldEqConstant);
+BENCHMARK(BM_SbeFieldEqConstant);
+BENCHMARK(BM_SbeFieldEqConstantUnfused);
+
 }  // namespace
 }  // namespace mongo
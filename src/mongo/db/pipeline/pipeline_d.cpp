@@ -66,15 +66,20 @@
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
+#include "mongo/db/pipeline/document_source_set_window_fields.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/skip_and_limit.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/sbe_stage_builder_accumulator.h"
+#include "mongo/db/query/sbe_stage_builder_window_function.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/service_context.h"
@@ -285,7 +290,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     boost::optional<std::string> groupIdForDistinctScan,
     const AggregateCommandRequest* aggRequest,
     const size_t plannerOpts,
-    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures) {
+    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures,
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline = {}) {
     auto findCommand = std::make_unique<FindCommandRequest>(nss);
     query_request_helper::setTailableMode(expCtx->tailableMode, findCommand.get());
     findCommand->setFilter(queryObj.getOwned());
@@ -322,7 +328,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
                                            expCtx,
                                            extensionsCallback,
                                            matcherFeatures,
-                                           ProjectionPolicies::aggregateProjectionPolicies());
+                                           ProjectionPolicies::aggregateProjectionPolicies(),
+                                           std::move(pipeline));
 
     if (!cq.isOK()) {
         // Return an error instead of uasserting, since there are cases where the combination of
@@ -336,6 +343,15 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     // Mark the metadata that's requested by the pipeline on the CQ.
     cq.getValue()->requestAdditionalMetadata(metadataRequested);
 
+    // Only the slot-based execution engine can run the pipeline stages pushed down along with the
+    // query, so let the caller retry without them when the query is not eligible for it.
+    if (!cq.getValue()->pipeline().empty() &&
+        !(cq.getValue()->getEnableSlotBasedExecutionEngine() &&
+          isQuerySbeCompatible(expCtx->opCtx, cq.getValue().get(), plannerOpts))) {
+        return {ErrorCodes::NoQueryExecutionPlans,
+                "Unable to push down pipeline stages into the slot-based execution engine"};
+    }
+
     if (groupIdForDistinctScan) {
         // When the pipeline includes a $group that groups by a single field
         // (groupIdForDistinctScan), we use getExecutorDistinct() to attempt to get an executor that
@@ -655,6 +671,68 @@ SkipThenLimit extractSkipAndLimitForPushdown(Pipeline* pipeline) {
     return skipThenLimit;
 }
 
+/**
+ * Returns true if the slot-based execution engine can compute 'groupStage' as part of the query. A
+ * $group which may need to spill to disk only qualifies if its partial aggregates can be combined
+ * once they are read back.
+ */
+bool canPushDownGroup(const intrusive_ptr<ExpressionContext>& expCtx,
+                      const DocumentSourceGroup& groupStage) {
+    if (!groupStage.sbeCompatible() || groupStage.doingMerge()) {
+        return false;
+    }
+    const auto& accumulators = groupStage.getAccumulatedFields();
+    return !expCtx->allowDiskUse ||
+        std::all_of(accumulators.begin(), accumulators.end(), [](const auto& acc) {
+               return stage_builder::canCombinePartialAggs(acc);
+           });
+}
+
+/**
+ * Returns true if the slot-based execution engine can compute 'windowStage' as part of the query.
+ * The stage must write its window functions to top-level fields. As the slot-based engine cannot
+ * spill the rows of a partition to disk, a stage which may need to spill does not qualify.
+ */
+bool canPushDownWindow(const intrusive_ptr<ExpressionContext>& expCtx,
+                       const DocumentSourceInternalSetWindowFields& windowStage) {
+    if (!windowStage.sbeCompatible() || expCtx->allowDiskUse) {
+        return false;
+    }
+    const auto& outputFields = windowStage.getOutputFields();
+    return std::all_of(outputFields.begin(), outputFields.end(), [](const auto& outputField) {
+        return outputField.fieldName.find('.') == std::string::npos &&
+            stage_builder::canBuildWindowFunction(*outputField.expr);
+    });
+}
+
+/**
+ * Collects the $group and $_internalSetWindowFields stages at the front of 'pipeline' which the
+ * slot-based execution engine can execute as part of the query, and wraps them to be pushed down
+ * into the query layer. A $_internalSetWindowFields stage relies on the $sort in front of it, which
+ * has already been absorbed into the query by then. Nothing is pushed down when the results are
+ * merged later on, since the slot-based engine only produces final $group results. Returns an
+ * empty vector if no stage can be pushed down.
+ */
+std::vector<std::unique_ptr<InnerPipelineStageInterface>> findSbeCompatibleStagesForPushdown(
+    const intrusive_ptr<ExpressionContext>& expCtx, const Pipeline* pipeline) {
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> stages;
+    if (!feature_flags::gFeatureFlagSBEGroupAndLookup.isEnabledAndIgnoreFCV() ||
+        expCtx->tailableMode != TailableModeEnum::kNormal || expCtx->needsMerge) {
+        return stages;
+    }
+
+    for (auto&& source : pipeline->getSources()) {
+        auto groupStage = dynamic_cast<DocumentSourceGroup*>(source.get());
+        auto windowStage = dynamic_cast<DocumentSourceInternalSetWindowFields*>(source.get());
+        if (!(groupStage && canPushDownGroup(expCtx, *groupStage)) &&
+            !(windowStage && canPushDownWindow(expCtx, *windowStage))) {
+            break;
+        }
+        stages.push_back(std::make_unique<InnerPipelineStageImpl>(source));
+    }
+    return stages;
+}
+
 /**
  * Given a dependency set and a pipeline, builds a projection BSON object to push down into the
  * PlanStage layer. The rules to push down the projection are as follows:
@@ -913,6 +991,12 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         // Since the limit from $sort is going before the extracted $skip stages, we construct
         // 'LimitThenSkip' object and then convert it 'SkipThenLimit'.
         skipThenLimit = LimitThenSkip(sortStage->getLimit(), skip).flip();
+
+        // A $group that now reads the sorted output of the query layer directly can return each
+        // group as soon as its last document has been read, if it groups by the sorted fields.
+        if (auto groupStage = dynamic_cast<DocumentSourceGroup*>(pipeline->peekFront())) {
+            groupStage->setInputSortedBy(sortStage->getSortKeyPattern());
+        }
     }
 
     // Perform dependency analysis. In order to minimize the dependency set, we only analyze the
@@ -989,6 +1073,40 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         }
     }
 
+    auto sbeStages = *hasNoRequirements
+        ? std::vector<std::unique_ptr<InnerPipelineStageInterface>>{}
+        : findSbeCompatibleStagesForPushdown(expCtx, pipeline);
+    if (!sbeStages.empty()) {
+        // The stages at the front of the pipeline read the documents of the query directly, so no
+        // projection is pushed down along with them.
+        std::vector<std::string> sbeStageNames;
+        for (auto&& stage : sbeStages) {
+            sbeStageNames.emplace_back(stage->documentSource()->getSourceName());
+        }
+        auto swExecutorPushedDown = attemptToGetExecutor(expCtx,
+                                                         collection,
+                                                         nss,
+                                                         queryObj,
+                                                         BSONObj{},
+                                                         deps.metadataDeps(),
+                                                         sortObj,
+                                                         skipThenLimit,
+                                                         boost::none, /* groupIdForDistinctScan */
+                                                         aggRequest,
+                                                         plannerOpts,
+                                                         matcherFeatures,
+                                                         std::move(sbeStages));
+        if (swExecutorPushedDown.isOK()) {
+            for (auto&& stageName : sbeStageNames) {
+                pipeline->popFrontWithName(stageName);
+            }
+            return swExecutorPushedDown;
+        } else if (swExecutorPushedDown != ErrorCodes::NoQueryExecutionPlans) {
+            return swExecutorPushedDown.getStatus().withContext(
+                "Failed to push down stages into the slot-based execution engine");
+        }
+    }
+
     return attemptToGetExecutor(expCtx,
                                 collection,
                                 nss,
@@ -700,6 +700,80 @@ TEST(PipelineOptimizationTest, SortSortSkipLimitBecomesTopKSortSkip) {
     assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
 }
 
+TEST(PipelineOptimizationTest, SortUnwindPreservingEmptyArraysLimitBecomesTopKSort) {
+    std::string inputPipe =
+        "[{$sort: {a: 1}}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string outputPipe =
+        "[{$sort: {sortKey: {a: 1}, limit: 5}}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string serializedPipe =
+        "[{$sort: {a: 1}}"
+        ",{$limit: 5}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$limit: 5}"
+        "]";
+
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, SortProjectUnwindSkipLimitBecomesTopKSortWithSkipAndLimit) {
+    std::string inputPipe =
+        "[{$sort: {a: 1}}"
+        ",{$project: {a: 1, b: 1}}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$skip: 3}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string outputPipe =
+        "[{$sort: {sortKey: {a: 1}, limit: 8}}"
+        ",{$project: {_id: true, a: true, b: true}}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$skip: 3}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string serializedPipe =
+        "[{$sort: {a: 1}}"
+        ",{$limit: 8}"
+        ",{$project: {_id: true, a: true, b: true}}"
+        ",{$unwind: {path: '$b', preserveNullAndEmptyArrays: true}}"
+        ",{$skip: 3}"
+        ",{$limit: 5}"
+        "]";
+
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, SortUnwindLimitDoesNotBecomeTopKSort) {
+    std::string inputPipe =
+        "[{$sort: {a: 1}}"
+        ",{$unwind: {path: '$b'}}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string outputPipe =
+        "[{$sort: {sortKey: {a: 1}}}"
+        ",{$unwind: {path: '$b'}}"
+        ",{$limit: 5}"
+        "]";
+
+    std::string serializedPipe =
+        "[{$sort: {a: 1}}"
+        ",{$unwind: {path: '$b'}}"
+        ",{$limit: 5}"
+        "]";
+
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
 TEST(PipelineOptimizationTest, SortLimitSortLimitBecomesTopKSort) {
     std::string inputPipe =
         "[{$sort: {a: 1}}"
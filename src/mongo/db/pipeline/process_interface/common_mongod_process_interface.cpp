@@ -262,12 +262,19 @@ Status CommonMongodProcessInterface::appendQueryExecStats(OperationContext* opCt
             static_cast<unsigned long long>(std::numeric_limits<long long>::max()));
     dassert(collectionScanStats.collectionScansNonTailable <=
             static_cast<unsigned long long>(std::numeric_limits<long long>::max()));
+    const auto planCacheMetrics =
+        CollectionQueryInfo::get(collection.getCollection()).getPlanCache()->getMetrics();
     builder->append("queryExecStats",
-                    BSON("collectionScans" << BSON(
-                             "total" << static_cast<long long>(collectionScanStats.collectionScans)
-                                     << "nonTailable"
-                                     << static_cast<long long>(
-                                            collectionScanStats.collectionScansNonTailable))));
+                    BSON("collectionScans"
+                         << BSON("total"
+                                 << static_cast<long long>(collectionScanStats.collectionScans)
+                                 << "nonTailable"
+                                 << static_cast<long long>(
+                                        collectionScanStats.collectionScansNonTailable))
+                         << "planCache"
+                         << BSON("hits" << planCacheMetrics.hits << "misses"
+                                        << planCacheMetrics.misses << "evictions"
+                                        << planCacheMetrics.evictions)));
 
     return Status::OK();
 }
@@ -32,6 +32,7 @@
 #include "mongo/base/exact_cast.h"
 #include "mongo/db/pipeline/document_source_limit.h"
 #include "mongo/db/pipeline/document_source_skip.h"
+#include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/skip_and_limit.h"
 #include "mongo/platform/overflow_arithmetic.h"
 
@@ -80,12 +81,23 @@ Pipeline::SourceContainer::iterator eraseAndStich(Pipeline::SourceContainer::ite
     return itr;
 }
 
+/**
+ * Returns true if 'stage' is an $unwind which outputs at least one document for every input.
+ */
+bool isNonShrinkingUnwind(DocumentSource* stage) {
+    auto unwind = exact_pointer_cast<DocumentSourceUnwind*>(stage);
+    return unwind && unwind->preserveNullAndEmptyArrays();
+}
+
 }  // namespace
 
 boost::optional<long long> extractLimitForPushdown(Pipeline::SourceContainer::iterator itr,
                                                    Pipeline::SourceContainer* container) {
     int64_t skipSum = 0;
     boost::optional<long long> minLimit;
+    // Set once we have looked past a stage which can increase the number of documents. Any $limit
+    // after that point must stay in the pipeline.
+    bool mustKeepLimitStages = false;
     while (itr != container->end()) {
         auto nextStage = itr->get();
         auto nextSkip = exact_pointer_cast<DocumentSourceSkip*>(nextStage);
@@ -104,7 +116,10 @@ boost::optional<long long> extractLimitForPushdown(Pipeline::SourceContainer::it
                 minLimit = std::min(static_cast<long long>(safeSum), *minLimit);
             }
 
-            itr = eraseAndStich(itr, container);
+            itr = mustKeepLimitStages ? std::next(itr) : eraseAndStich(itr, container);
+        } else if (isNonShrinkingUnwind(nextStage)) {
+            mustKeepLimitStages = true;
+            ++itr;
         } else if (!nextStage->constraints().canSwapWithSkippingOrLimitingStage) {
             break;
         } else {
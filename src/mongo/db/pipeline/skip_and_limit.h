@@ -84,6 +84,11 @@ public:
  *
  * This method also implements the ability to swap a $limit before a $skip, by adding the value of
  * the $skip to the value of the $limit.
+ *
+ * A $limit can also be swapped before an $unwind with 'preserveNullAndEmptyArrays' set, since such
+ * an $unwind produces at least one document for each input document. The $limit stages past such
+ * an $unwind still bound the number of unwound documents, so they are kept in the Pipeline while
+ * their value still contributes to the returned limit.
  */
 boost::optional<long long> extractLimitForPushdown(Pipeline::SourceContainer::iterator itr,
                                                    Pipeline::SourceContainer* container);
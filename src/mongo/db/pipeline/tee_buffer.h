@@ -44,7 +44,9 @@ namespace mongo {
  * This stage takes a stream of input documents and makes them available to multiple consumers. To
  * do so, it will batch incoming documents and allow each consumer to consume one batch at a time.
  * As a consequence, consumers must be able to pause their execution to allow other consumers to
- * process the batch before moving to the next batch.
+ * process the batch before moving to the next batch. The last consumer to read a document of the
+ * batch is handed the buffered document itself rather than a copy, so that each document is
+ * released as soon as every consumer is done with it.
  */
 class TeeBuffer : public RefCountable {
 public:
@@ -64,6 +66,9 @@ public:
      * consumer will not consume all input.
      */
     void dispose(size_t consumerId) {
+        if (_consumers[consumerId].nLeftToReturn > 0) {
+            --_nConsumersStillProcessingBatch;
+        }
         _consumers[consumerId].stillInUse = false;
         _consumers[consumerId].nLeftToReturn = 0;
         if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
@@ -103,5 +108,8 @@ private:
         int nLeftToReturn = 0;
     };
     std::vector<ConsumerInfo> _consumers;
+
+    // The number of consumers which have not yet reached the end of '_buffer'.
+    size_t _nConsumersStillProcessingBatch = 0;
 };
 }  // namespace mongo
@@ -170,5 +170,36 @@ TEST_F(TeeBufferTest, ShouldAllowOtherConsumersToAdvanceOnceTrailingConsumerIsDi
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
 }
+TEST_F(TeeBufferTest, ShouldProvideAllResultsToEachConsumerWhenConsumersFinishBatchesInTurn) {
+    std::deque<DocumentSource::GetNextResult> inputs{
+        Document{{"a", 1}}, Document{{"a", 2}}, Document{{"a", 3}}};
+    auto mock = DocumentSourceMock::createForTest(inputs, getExpCtx());
+
+    const size_t nConsumers = 3;
+    const size_t bufferBytes = 1;  // Each batch holds a single document.
+    auto teeBuffer = TeeBuffer::create(nConsumers, bufferBytes);
+    teeBuffer->setSource(mock.get());
+
+    for (auto&& input : inputs) {
+        // The last consumer to read each document is handed the buffered document itself, which
+        // must not affect what the other consumers see, whatever order they read it in.
+        for (size_t consumerId : {2, 0, 1}) {
+            auto next = teeBuffer->getNext(consumerId);
+            ASSERT_TRUE(next.isAdvanced());
+            ASSERT_DOCUMENT_EQ(next.getDocument(), input.getDocument());
+
+            // Consumers #2 and #0 must wait for consumer #1 to finish the batch.
+            if (consumerId != 1) {
+                ASSERT_TRUE(teeBuffer->getNext(consumerId).isPaused());
+            }
+        }
+    }
+
+    // Consumer #1 was the last one to finish the final batch, so everyone is now exhausted.
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        ASSERT_TRUE(teeBuffer->getNext(consumerId).isEOF());
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/bind_input_params.h"
+
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+#include "mongo/db/query/sbe_stage_builder_index_scan.h"
+
+namespace mongo::input_params {
+namespace {
+using InputParamMap =
+    stdx::unordered_map<MatchExpression::InputParamId, const ComparisonMatchExpression*>;
+
+void collectInputParams(const MatchExpression* expr, InputParamMap* params) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<const ComparisonMatchExpression*>(expr);
+        if (auto paramId = comparison->getInputParamId()) {
+            params->emplace(*paramId, comparison);
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        collectInputParams(expr->getChild(i), params);
+    }
+}
+
+void collectIndexScans(const QuerySolutionNode* node,
+                       std::vector<const IndexScanNode*>* indexScans) {
+    if (node->getType() == STAGE_IXSCAN) {
+        indexScans->push_back(static_cast<const IndexScanNode*>(node));
+    }
+
+    for (auto&& child : node->children) {
+        collectIndexScans(child, indexScans);
+    }
+}
+
+bool bindInputParams(const CanonicalQuery& cq, stage_builder::PlanStageData* data) {
+    InputParamMap params;
+    collectInputParams(cq.root(), &params);
+
+    for (auto&& [paramId, slot] : data->inputParamToSlotMap) {
+        auto it = params.find(paramId);
+        if (it == params.end()) {
+            return false;
+        }
+
+        const auto& rhs = it->second->getData();
+        auto [tag, val] = sbe::bson::convertFrom<false>(
+            rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+        data->env->resetSlot(slot, tag, val, true);
+    }
+    return true;
+}
+
+bool bindIndexBounds(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const QuerySolution& solution,
+                     stage_builder::PlanStageData* data) {
+    std::vector<const IndexScanNode*> indexScans;
+    collectIndexScans(solution.root(), &indexScans);
+    if (indexScans.size() != data->indexBoundsSlots.size()) {
+        return false;
+    }
+
+    for (auto&& ixn : indexScans) {
+        auto slotsIt = data->indexBoundsSlots.find(ixn->nodeId());
+        if (slotsIt == data->indexBoundsSlots.end()) {
+            return false;
+        }
+        const auto& slots = slotsIt->second;
+
+        auto descriptor = collection->getIndexCatalog()->findIndexByName(
+            opCtx, ixn->index.identifier.catalogName);
+        if (!descriptor) {
+            return false;
+        }
+        auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+        auto intervals = stage_builder::makeIntervalsFromIndexBounds(
+            ixn->bounds,
+            ixn->direction == 1,
+            accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+            accessMethod->getSortedDataInterface()->getOrdering());
+
+        if (slots.singleInterval && intervals.size() == 1) {
+            auto&& [lowKey, highKey] = intervals[0];
+            auto [lowKeySlot, highKeySlot] = *slots.singleInterval;
+            data->env->resetSlot(lowKeySlot,
+                                 sbe::value::TypeTags::ksValue,
+                                 sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()),
+                                 true);
+            data->env->resetSlot(highKeySlot,
+                                 sbe::value::TypeTags::ksValue,
+                                 sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()),
+                                 true);
+        } else if (slots.intervals && intervals.size() > 1) {
+            auto [boundsTag, boundsVal] =
+                stage_builder::packIndexIntervalsInSbeArray(std::move(intervals));
+            data->env->resetSlot(*slots.intervals, boundsTag, boundsVal, true);
+        } else {
+            // The bounds of this query decompose into a different number of intervals than the
+            // cached plan was built for.
+            return false;
+        }
+    }
+    return true;
+}
+
+void bindVariables(const CanonicalQuery& cq, stage_builder::PlanStageData* data) {
+    const auto& variables = cq.getExpCtx()->variables;
+    for (auto&& [id, slot] : data->variableIdToSlotMap) {
+        auto [tag, val] = stage_builder::makeValue(variables.getValue(id));
+        data->env->resetSlot(slot, tag, val, true);
+    }
+
+    for (auto&& [id, name] : Variables::kIdToBuiltinVarName) {
+        auto slot = data->env->getSlotIfExists(name);
+        if (slot && variables.hasValue(id)) {
+            auto [tag, val] = stage_builder::makeValue(variables.getValue(id));
+            data->env->resetSlot(*slot, tag, val, true);
+        }
+    }
+
+    if (auto slot = data->env->getSlotIfExists("collator"_sd)) {
+        auto collator = cq.getCollator();
+        tassert(6000900, "Cached SBE plan expects a collator but the query has none", collator);
+        data->env->resetSlot(*slot,
+                             sbe::value::TypeTags::collator,
+                             sbe::value::bitcastFrom<const CollatorInterface*>(collator),
+                             false);
+    }
+}
+
+bool bindIndexAccessMethods(OperationContext* opCtx,
+                            const CollectionPtr& collection,
+                            stage_builder::PlanStageData* data) {
+    for (auto&& [indexName, accessMethod] : data->iamMap) {
+        auto descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
+        if (!descriptor) {
+            return false;
+        }
+        accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+    }
+    return true;
+}
+}  // namespace
+
+bool bind(OperationContext* opCtx,
+          const CanonicalQuery& cq,
+          const CollectionPtr& collection,
+          const QuerySolution& solution,
+          stage_builder::PlanStageData* data) {
+    invariant(data);
+
+    if (data->hasNonParameterizedIndexBounds) {
+        return false;
+    }
+
+    if (!bindInputParams(cq, data) || !bindIndexBounds(opCtx, collection, solution, data) ||
+        !bindIndexAccessMethods(opCtx, collection, data)) {
+        return false;
+    }
+
+    bindVariables(cq, data);
+    return true;
+}
+
+}  // namespace mongo::input_params
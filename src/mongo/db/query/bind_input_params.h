@@ -0,0 +1,60 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+
+namespace mongo::input_params {
+
+/**
+ * Rebinds the RuntimeEnvironment of a plan recovered from the SBE plan cache to the query 'cq',
+ * whose plan is described by 'solution'. This resets the slots holding:
+ *  - the values of the parameterized MatchExpression literals;
+ *  - the index bounds of each index scan, recomputed from 'solution';
+ *  - the values of the builtin and user-defined variables and the collator of the query.
+ *
+ * Also refreshes the index access methods recorded in 'data', as the cached plan may outlive the
+ * catalog objects it was built against.
+ *
+ * Returns false if the plan cannot be rebound, e.g. if the bounds of some index scan in 'solution'
+ * cannot be expressed in the same form the cached plan expects. The caller should then build a new
+ * plan from 'solution'.
+ */
+bool bind(OperationContext* opCtx,
+          const CanonicalQuery& cq,
+          const CollectionPtr& collection,
+          const QuerySolution& solution,
+          stage_builder::PlanStageData* data);
+
+}  // namespace mongo::input_params
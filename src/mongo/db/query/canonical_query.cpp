@@ -38,12 +38,14 @@
 #include "mongo/db/cst/cst_parser.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_array.h"
+#include "mongo/db/matcher/expression_parameterization.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/indexability.h"
 #include "mongo/db/query/projection_parser.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
 #include "mongo/db/query/query_planner_common.h"
 
 namespace mongo {
@@ -210,6 +212,14 @@ Status CanonicalQuery::init(OperationContext* opCtx,
         return status;
     }
 
+    // Lift the filter's literals out into input parameters, so that the SBE plan cache can re-use
+    // a cached plan for any query of the same shape. This must happen after normalization, as the
+    // parameter ids depend on the order of nodes in the tree.
+    if (_enableSlotBasedExecutionEngine &&
+        feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV()) {
+        match_expression::parameterize(_root.get());
+    }
+
     // Validate the projection if there is one.
     if (!_findCommand->getProjection().isEmpty()) {
         try {
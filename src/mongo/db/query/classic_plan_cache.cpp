@@ -35,6 +35,12 @@ namespace mongo {
 namespace {
 ServerStatusMetricField<Counter64> totalPlanCacheSizeEstimateBytesMetric(
     "query.planCacheTotalSizeEstimateBytes", &PlanCacheEntry::planCacheTotalSizeEstimateBytes);
+ServerStatusMetricField<Counter64> planCacheHitsMetric("query.planCache.hits",
+                                                      &PlanCache::planCacheHits);
+ServerStatusMetricField<Counter64> planCacheMissesMetric("query.planCache.misses",
+                                                        &PlanCache::planCacheMisses);
+ServerStatusMetricField<Counter64> planCacheEvictionsMetric("query.planCache.evictions",
+                                                           &PlanCache::planCacheEvictions);
 }  // namespace
 
 
@@ -121,6 +127,10 @@ std::string SolutionCacheData::toString() const {
                                  << "tree=" << this->tree->toString() << ")";
         case COLLSCAN_SOLN:
             return "(collection scan)";
+        case SKIP_SCAN_SOLN:
+            verify(this->tree.get());
+            return str::stream() << "(skip scan solution: "
+                                 << "tree=" << this->tree->toString() << ")";
         case USE_INDEX_TAGS_SOLN:
             verify(this->tree.get());
             return str::stream() << "(index-tagged expression tree: "
@@ -233,6 +233,7 @@ struct SolutionCacheData {
 
     // If 'wholeIXSoln' is false, then 'tree' can be used to tag an isomorphic match expression.
     // If 'wholeIXSoln' is true, then 'tree' is used to store the relevant IndexEntry.
+    // If 'skipScanSoln' is true, then 'tree' is used to store the relevant IndexEntry.
     // If 'collscanSoln' is true, then 'tree' should be NULL.
     std::unique_ptr<PlanCacheIndexTree> tree;
 
@@ -245,6 +246,10 @@ struct SolutionCacheData {
         // The cached plan is a collection scan.
         COLLSCAN_SOLN,
 
+        // The cached plan is a skip scan over
+        // the index stored in 'tree'.
+        SKIP_SCAN_SOLN,
+
         // Build the solution by using 'tree'
         // to tag the match expression.
         USE_INDEX_TAGS_SOLN
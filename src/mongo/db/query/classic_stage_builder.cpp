@@ -414,6 +414,8 @@ std::unique_ptr<PlanStage> ClassicStageBuilder::build(const QuerySolutionNode* r
         case STAGE_UNKNOWN:
         case STAGE_UNPACK_TIMESERIES_BUCKET:
         case STAGE_GROUP:
+        case STAGE_EQ_LOOKUP:
+        case STAGE_WINDOW:
         case STAGE_SENTINEL:
         case STAGE_UPDATE: {
             LOGV2_WARNING(4615604, "Can't build exec tree for node", "node"_attr = *root);
@@ -61,6 +61,7 @@
 #include "mongo/db/index_names.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/bind_input_params.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/classic_plan_cache.h"
@@ -84,8 +85,10 @@
 #include "mongo/db/query/query_settings_decoration.h"
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 #include "mongo/db/query/sbe_multi_planner.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/db/query/sbe_sub_planner.h"
 #include "mongo/db/query/stage_builder_util.h"
+#include "mongo/db/query/stats_catalog.h"
 #include "mongo/db/query/util/make_data_structure.h"
 #include "mongo/db/query/wildcard_multikey_paths.h"
 #include "mongo/db/query/yield_policy_callbacks_impl.h"
@@ -357,6 +360,13 @@ void fillOutPlannerParams(OperationContext* opCtx,
     if (collection->isClustered()) {
         plannerParams->allowRIDRange = true;
     }
+
+    // Statistics are never collected on system collections, which also avoids looking up the
+    // statistics of the statistics collections themselves.
+    if (internalQueryPlannerEnableStatisticsPreFilter.load() && !collection->ns().isSystem() &&
+        !collection->ns().isOnInternalDb()) {
+        plannerParams->collectionStats = StatsCatalog::get(opCtx).getStatistics(opCtx, collection);
+    }
 }
 
 bool shouldWaitForOplogVisibility(OperationContext* opCtx,
@@ -524,11 +534,22 @@ public:
         _decisionWorks = decisionWorks;
     }
 
+    std::unique_ptr<QuerySolutionNode> postMultiPlan() {
+        return std::move(_postMultiPlan);
+    }
+
+    void setPostMultiPlan(std::unique_ptr<QuerySolutionNode> postMultiPlan) {
+        _postMultiPlan = std::move(postMultiPlan);
+    }
+
 private:
     QuerySolutionVector _solutions;
     PlanStageVector _roots;
     boost::optional<size_t> _decisionWorks;
     bool _needSubplanning{false};
+    // The stages pushed down from the pipeline, to be grafted onto the winning solution once the
+    // runtime planning is done.
+    std::unique_ptr<QuerySolutionNode> _postMultiPlan;
 };
 
 /**
@@ -588,8 +609,9 @@ public:
 
         const IndexDescriptor* idIndexDesc = _collection->getIndexCatalog()->findIdIndex(_opCtx);
 
-        // If we have an _id index we can use an idhack plan.
-        if (idIndexDesc && isIdHackEligibleQuery(_collection, *_cq)) {
+        // If we have an _id index we can use an idhack plan. The stages pushed down from the
+        // pipeline are only ever added on top of the solutions of the query planner.
+        if (idIndexDesc && isIdHackEligibleQuery(_collection, *_cq) && _cq->pipeline().empty()) {
             LOGV2_DEBUG(
                 20922, 2, "Using idhack", "canonicalQuery"_attr = redact(_cq->toStringShort()));
             // If an IDHACK plan is not supported, we will use the normal plan generation process
@@ -613,8 +635,11 @@ public:
         CurOp::get(_opCtx)->debug().queryHash =
             canonical_query_encoder::computeHash(planCacheKey.getStableKeyStringData());
 
-        // Check that the query should be cached.
-        if (CollectionQueryInfo::get(_collection).getPlanCache()->shouldCacheQuery(*_cq)) {
+        // Check that the query should be cached. A plan cache entry only holds the data access part
+        // of a plan, so a query carrying pushed-down pipeline stages is always planned from
+        // scratch.
+        if (CollectionQueryInfo::get(_collection).getPlanCache()->shouldCacheQuery(*_cq) &&
+            _cq->pipeline().empty()) {
             // Fill in the 'planCacheKey' too if the query is actually being cached.
             CurOp::get(_opCtx)->debug().planCacheKey =
                 canonical_query_encoder::computeHash(planCacheKey.toString());
@@ -644,7 +669,7 @@ public:
 
 
         if (internalQueryPlanOrChildrenIndependently.load() &&
-            SubplanStage::canUseSubplanning(*_cq)) {
+            SubplanStage::canUseSubplanning(*_cq) && _cq->pipeline().empty()) {
             LOGV2_DEBUG(20924,
                         2,
                         "Running query as sub-queries",
@@ -652,9 +677,10 @@ public:
             return buildSubPlan(plannerParams);
         }
 
-        // We discard the post-multi-planned solution, but it will eventually be used to support
-        // '$group' pushdown.
-        auto&& [statusWithMultiPlanSolns, _] = QueryPlanner::plan(*_cq, plannerParams);
+        // The post-multi-planned tree holds the stages pushed down from the pipeline, if any. It is
+        // grafted onto the winning solution, so that the candidate plans are compared on their
+        // data access part only.
+        auto&& [statusWithMultiPlanSolns, postMultiPlan] = QueryPlanner::plan(*_cq, plannerParams);
         if (!statusWithMultiPlanSolns.isOK()) {
             return statusWithMultiPlanSolns.getStatus().withContext(
                 str::stream() << "error processing query: " << _cq->toString()
@@ -683,6 +709,10 @@ public:
         }
 
         if (1 == solutions.size()) {
+            if (postMultiPlan) {
+                solutions[0]->extendWith(std::move(postMultiPlan));
+            }
+
             auto result = makeResult();
             // Only one possible plan. Run it. Build the stages from the solution.
             auto root = buildExecutableTree(*solutions[0]);
@@ -697,7 +727,7 @@ public:
             return std::move(result);
         }
 
-        return buildMultiPlan(std::move(solutions), plannerParams);
+        return buildMultiPlan(std::move(solutions), plannerParams, std::move(postMultiPlan));
     }
 
 protected:
@@ -751,10 +781,14 @@ protected:
      *      plan in runtime.
      *    * Or builds a PlanStage tree for each of the 'solutions' and stores them in the result
      *      object, if multi-planning is implemented as a standalone component.
+     *
+     * The 'postMultiPlan' tree, if not null, holds the stages pushed down from the pipeline, which
+     * are to be added on top of the winning plan.
      */
     virtual std::unique_ptr<ResultType> buildMultiPlan(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
-        const QueryPlannerParams& plannerParams) = 0;
+        const QueryPlannerParams& plannerParams,
+        std::unique_ptr<QuerySolutionNode> postMultiPlan) = 0;
 
     OperationContext* _opCtx;
     const CollectionPtr& _collection;
@@ -880,7 +914,8 @@ protected:
 
     std::unique_ptr<ClassicPrepareExecutionResult> buildMultiPlan(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
-        const QueryPlannerParams& plannerParams) final {
+        const QueryPlannerParams& plannerParams,
+        std::unique_ptr<QuerySolutionNode> postMultiPlan) final {
         // Many solutions. Create a MultiPlanStage to pick the best, update the cache,
         // and so on. The working set will be shared by all candidate plans.
         auto multiPlanStage =
@@ -923,6 +958,42 @@ protected:
             _opCtx, _collection, *_cq, solution, _yieldPolicy);
     }
 
+    /**
+     * Builds an executable tree for the 'solution' recovered from the classic plan cache. If the
+     * SBE plan cache is enabled, a plan previously compiled for a query of the same shape is
+     * re-used and rebound to the literals of this query, bypassing the stage builder. Otherwise,
+     * the plan is built from scratch and, if possible, added to the SBE plan cache.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+    buildCachedExecutableTree(const QuerySolution& solution) const {
+        if (!feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV()) {
+            return buildExecutableTree(solution);
+        }
+
+        auto key = sbe::makePlanCacheKey(*_cq, _collection, solution);
+        if (!key) {
+            return buildExecutableTree(solution);
+        }
+
+        auto& planCache = sbe::getPlanCache(_opCtx);
+        if (auto cachedPlan = planCache.getClone(*key)) {
+            if (input_params::bind(
+                    _opCtx, *_cq, _collection, solution, &cachedPlan->planStageData)) {
+                stage_builder::attachSlotBasedExecutableTree(
+                    _opCtx, *_cq, cachedPlan->root.get(), _yieldPolicy);
+                return {std::move(cachedPlan->root), std::move(cachedPlan->planStageData)};
+            }
+        }
+
+        auto execTree = buildExecutableTree(solution);
+        auto&& [root, data] = execTree;
+        if (!data.hasNonParameterizedIndexBounds) {
+            planCache.set(*key,
+                          std::make_unique<sbe::CachedSbePlan>(root->clone(), data.makeDeepCopy()));
+        }
+        return execTree;
+    }
+
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildIdHackPlan(
         const IndexDescriptor* descriptor, QueryPlannerParams* plannerParams) final {
         invariant(descriptor);
@@ -990,7 +1061,7 @@ protected:
         const QueryPlannerParams& plannerParams,
         size_t decisionWorks) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution);
+        auto execTree = buildCachedExecutableTree(*solution);
         result->emplace(std::move(execTree), std::move(solution));
         result->setDecisionWorks(decisionWorks);
         return result;
@@ -1006,8 +1077,10 @@ protected:
 
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildMultiPlan(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
-        const QueryPlannerParams& plannerParams) final {
+        const QueryPlannerParams& plannerParams,
+        std::unique_ptr<QuerySolutionNode> postMultiPlan) final {
         auto result = makeResult();
+        result->setPostMultiPlan(std::move(postMultiPlan));
         for (size_t ix = 0; ix < solutions.size(); ++ix) {
             if (solutions[ix]->cacheData.get()) {
                 solutions[ix]->cacheData->indexFilterApplied = plannerParams.indexFiltersApplied;
@@ -1026,6 +1099,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getClassicExecu
     std::unique_ptr<CanonicalQuery> canonicalQuery,
     PlanYieldPolicy::YieldPolicy yieldPolicy,
     size_t plannerOptions) {
+    tassert(6001009,
+            "Pipeline stages can only be pushed down to the slot-based execution engine",
+            canonicalQuery->pipeline().empty());
+
     auto ws = std::make_unique<WorkingSet>();
     ClassicPrepareExecutionHelper helper{
         opCtx, *collection, ws.get(), canonicalQuery.get(), nullptr, plannerOptions};
@@ -1116,6 +1193,34 @@ std::unique_ptr<PlanYieldPolicySBE> makeSbeYieldPolicy(
                                                 std::make_unique<YieldPolicyCallbacksImpl>(nss));
 }
 
+/**
+ * Grafts the stages pushed down from the pipeline, held by 'postMultiPlan', onto the solution of
+ * the winning candidate plan and rebuilds its execution tree. The trial period of the candidates
+ * only ran their data access part, so any results the winner has produced so far are discarded.
+ */
+void extendWinningPlan(OperationContext* opCtx,
+                       const CollectionPtr& collection,
+                       const CanonicalQuery& cq,
+                       std::unique_ptr<QuerySolutionNode> postMultiPlan,
+                       PlanYieldPolicySBE* yieldPolicy,
+                       sbe::CandidatePlans* candidates) {
+    auto& winner = candidates->winner();
+    winner.root->close();
+    // The current tree of the winner is about to be replaced and must no longer be yielded.
+    yieldPolicy->clearRegisteredPlans();
+
+    winner.solution->extendWith(std::move(postMultiPlan));
+    auto [root, data] = stage_builder::buildSlotBasedExecutableTree(
+        opCtx, collection, cq, *winner.solution, yieldPolicy);
+    root->prepare(data.ctx);
+    root->open(false);
+
+    winner.root = std::move(root);
+    winner.data = std::move(data);
+    winner.exitedEarly = false;
+    winner.results = decltype(winner.results){};
+}
+
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExecutor(
     OperationContext* opCtx,
     const CollectionPtr* collection,
@@ -1146,6 +1251,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExe
                                                   plannerOptions)) {
         // Do the runtime planning and pick the best candidate plan.
         auto candidates = planner->plan(std::move(solutions), std::move(roots));
+        if (auto postMultiPlan = result->postMultiPlan()) {
+            extendWinningPlan(
+                opCtx, *collection, *cq, std::move(postMultiPlan), yieldPolicy.get(), &candidates);
+        }
         return plan_executor_factory::make(opCtx,
                                            std::move(cq),
                                            std::move(candidates),
@@ -1165,11 +1274,11 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExe
                                        std::move(nss),
                                        std::move(yieldPolicy));
 }
+}  // namespace
 
-// Checks if the given query can be executed with the SBE engine.
-inline bool isQuerySbeCompatible(OperationContext* opCtx,
-                                 const CanonicalQuery* const cq,
-                                 size_t plannerOptions) {
+bool isQuerySbeCompatible(OperationContext* opCtx,
+                          const CanonicalQuery* const cq,
+                          size_t plannerOptions) {
     invariant(cq);
     auto expCtx = cq->getExpCtxRaw();
     const auto& sortPattern = cq->getSortPattern();
@@ -1189,7 +1298,6 @@ inline bool isQuerySbeCompatible(OperationContext* opCtx,
         isQueryNotAgainstTimeseriesCollection && doesNotSortOnMetaOrPathWithNumericComponents &&
         isNotOplog;
 }
-}  // namespace
 
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutor(
     OperationContext* opCtx,
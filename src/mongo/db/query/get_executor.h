@@ -80,6 +80,14 @@ void fillOutPlannerParams(OperationContext* opCtx,
                           CanonicalQuery* canonicalQuery,
                           QueryPlannerParams* plannerParams);
 
+/**
+ * Returns true if the query described by 'cq' can be executed with the slot-based execution engine,
+ * given the planner options in 'plannerOptions'.
+ */
+bool isQuerySbeCompatible(OperationContext* opCtx,
+                          const CanonicalQuery* cq,
+                          size_t plannerOptions);
+
 /**
  * Return whether or not any component of the path 'path' is multikey given an index key pattern
  * and multikeypaths. If no multikey metdata is available for the index, and the index is marked
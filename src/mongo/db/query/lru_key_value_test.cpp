@@ -195,4 +195,24 @@ TEST(LRUKeyValueTest, IterationTest) {
     ASSERT(i == cache.end());
 }
 
+/**
+ * Test explicit removal of the least recently used entry.
+ */
+TEST(LRUKeyValueTest, RemoveLeastRecentlyUsedTest) {
+    LRUKeyValue<int, int> cache(10);
+    ASSERT(cache.removeLeastRecentlyUsed() == nullptr);
+
+    cache.add(1, new int(1));
+    cache.add(2, new int(2));
+    assertInKVStore(cache, 1, 1);
+
+    // Key 2 is now the least recently used.
+    auto evicted = cache.removeLeastRecentlyUsed();
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 2);
+    assertNotInKVStore(cache, 2);
+    assertInKVStore(cache, 1, 1);
+    ASSERT_EQUALS(cache.size(), 1U);
+}
+
 }  // namespace
@@ -123,6 +123,21 @@ void logPromoteCacheEntry(std::string&& query,
                 "oldWorks"_attr = works,
                 "newWorks"_attr = newWorks);
 }
+
+void logCacheEntryRegression(std::string&& query,
+                             std::string&& queryHash,
+                             std::string&& planCacheKey,
+                             size_t works,
+                             size_t medianWorks) {
+    LOGV2_DEBUG(6001300,
+                1,
+                "Deactivating cache entry whose recent trial runs regressed",
+                "query"_attr = redact(query),
+                "queryHash"_attr = queryHash,
+                "planCacheKey"_attr = planCacheKey,
+                "works"_attr = works,
+                "medianWorks"_attr = medianWorks);
+}
 }  // namespace log_detail
 
 namespace plan_cache_detail {
@@ -29,9 +29,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/optional/optional.hpp>
+#include <deque>
 #include <set>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/lru_key_value.h"
@@ -86,6 +89,11 @@ void logPromoteCacheEntry(std::string&& query,
                           std::string&& planCacheKey,
                           size_t works,
                           size_t newWorks);
+void logCacheEntryRegression(std::string&& query,
+                             std::string&& queryHash,
+                             std::string&& planCacheKey,
+                             size_t works,
+                             size_t medianWorks);
 }  // namespace log_detail
 
 class QuerySolution;
@@ -270,7 +278,7 @@ public:
             debugInfoCopy.emplace(*debugInfo);
         }
 
-        return std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>(
+        auto entry = std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>(
             new PlanCacheEntryBase<CachedPlanType>(cachedPlan->clone(),
                                                    timeOfCreation,
                                                    queryHash,
@@ -278,6 +286,8 @@ public:
                                                    isActive,
                                                    works,
                                                    std::move(debugInfoCopy)));
+        entry->recentTrialWorks = recentTrialWorks;
+        return entry;
     }
 
     std::string debugString() const {
@@ -315,6 +325,11 @@ public:
     // cause this value to be increased.
     size_t works = 0;
 
+    // The number of works (or reads, for SBE plans) taken by the trial periods of the most
+    // recent executions of this entry's plan, oldest first. Bounded by
+    // 'internalQueryCacheFeedbackWindowSize'.
+    std::deque<size_t> recentTrialWorks;
+
     // Optional debug info containing detailed statistics. Includes a description of the query which
     // resulted in this plan cache's creation as well as runtime stats from the multi-planner trial
     // period that resulted in this cache entry.
@@ -413,6 +428,21 @@ public:
         std::unique_ptr<CachedPlanHolder<CachedPlanType>> cachedPlanHolder;
     };
 
+    /**
+     * Counters describing how a plan cache has been used. Lookups which find an inactive entry
+     * are counted as misses.
+     */
+    struct Metrics {
+        long long hits = 0;
+        long long misses = 0;
+        long long evictions = 0;
+    };
+
+    // Counters aggregated across all the plan caches of this type, reported by serverStatus.
+    inline static Counter64 planCacheHits;
+    inline static Counter64 planCacheMisses;
+    inline static Counter64 planCacheEvictions;
+
     /**
      * We don't want to cache every possible query. This function
      * encapsulates the criteria for what makes a canonical query
@@ -465,9 +495,22 @@ public:
     /**
      * If omitted, namespace set to empty string.
      */
-    PlanCacheBase() : PlanCacheBase(internalQueryCacheMaxEntriesPerCollection.load()) {}
+    PlanCacheBase()
+        : PlanCacheBase(internalQueryCacheMaxEntriesPerCollection.load(),
+                        internalQueryCacheNumPartitions.load()) {}
 
-    PlanCacheBase(size_t size) : _cache(size) {}
+    /**
+     * Creates a plan cache holding at most 'size' entries, split evenly across 'numPartitions'
+     * independently locked partitions. Query shapes are assigned to partitions by the hash of
+     * their key.
+     */
+    PlanCacheBase(size_t size, size_t numPartitions = 1) {
+        invariant(numPartitions > 0);
+        const size_t partitionSize = (size + numPartitions - 1) / numPartitions;
+        for (size_t i = 0; i < numPartitions; ++i) {
+            _partitions.push_back(std::make_unique<Partition>(partitionSize));
+        }
+    }
 
     ~PlanCacheBase() = default;
 
@@ -526,7 +569,8 @@ public:
                                      }},
             why->stats);
         const auto key = computeKey(query);
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+        auto& partition = getPartition(key);
+        stdx::unique_lock<Latch> cacheLock(partition.mutex);
         bool isNewEntryActive = false;
         uint32_t queryHash;
         uint32_t planCacheKey;
@@ -537,7 +581,7 @@ public:
             queryHash = key.queryHash();
         } else {
             PlanCacheEntryBase<CachedPlanType>* oldEntry = nullptr;
-            Status cacheStatus = _cache.get(key, &oldEntry);
+            Status cacheStatus = partition.cache.get(key, &oldEntry);
             invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
             if (oldEntry) {
                 queryHash = oldEntry->queryHash;
@@ -571,12 +615,13 @@ public:
                                                                  isNewEntryActive,
                                                                  newWorks));
 
-        auto evictedEntry = _cache.add(key, newEntry.release());
-
+        auto evictedEntry = partition.cache.add(key, newEntry.release());
+        cacheLock.unlock();
         if (nullptr != evictedEntry.get()) {
-            log_detail::logCacheEviction(query.nss(), evictedEntry->debugString());
+            recordEviction(query.nss(), std::move(evictedEntry));
         }
 
+        enforceTotalSizeBudget(query.nss(), partition);
         return Status::OK();
     }
 
@@ -592,9 +637,10 @@ public:
         }
 
         KeyType key = computeKey(query);
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+        auto& partition = getPartition(key);
+        stdx::lock_guard<Latch> cacheLock(partition.mutex);
         PlanCacheEntryBase<CachedPlanType>* entry = nullptr;
-        Status cacheStatus = _cache.get(key, &entry);
+        Status cacheStatus = partition.cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
             invariant(cacheStatus == ErrorCodes::NoSuchKey);
             return;
@@ -603,6 +649,69 @@ public:
         entry->isActive = false;
     }
 
+    /**
+     * Records that a trial period of the cached plan for 'query' took 'trialWorks' works. Once
+     * 'internalQueryCacheFeedbackWindowSize' trial periods were recorded, if their median exceeds
+     * the works of the entry by 'internalQueryCacheFeedbackRegressionRatio', the plan is deemed to
+     * have regressed for this shape. The entry is then deactivated, with the median as its new
+     * works value, so that the next query of this shape is multi-planned again and a plan doing
+     * better than the regressed one takes its place.
+     *
+     * Returns true if the entry was deactivated.
+     */
+    bool recordTrialWorks(const CanonicalQuery& query, size_t trialWorks) {
+        const size_t windowSize = internalQueryCacheFeedbackWindowSize.load();
+        if (windowSize == 0) {
+            return false;
+        }
+
+        KeyType key = computeKey(query);
+        auto& partition = getPartition(key);
+        stdx::lock_guard<Latch> cacheLock(partition.mutex);
+        PlanCacheEntryBase<CachedPlanType>* entry = nullptr;
+        Status cacheStatus = partition.cache.get(key, &entry);
+        if (!cacheStatus.isOK()) {
+            invariant(cacheStatus == ErrorCodes::NoSuchKey);
+            return false;
+        }
+        invariant(entry);
+        if (!entry->isActive) {
+            return false;
+        }
+
+        auto& recent = entry->recentTrialWorks;
+        recent.push_back(trialWorks);
+        while (recent.size() > windowSize) {
+            recent.pop_front();
+        }
+        if (recent.size() < windowSize) {
+            return false;
+        }
+
+        std::vector<size_t> sorted(recent.begin(), recent.end());
+        auto median = sorted.begin() + sorted.size() / 2;
+        std::nth_element(sorted.begin(), median, sorted.end());
+        const double regressionRatio = internalQueryCacheFeedbackRegressionRatio.load();
+        if (*median <= regressionRatio * entry->works) {
+            return false;
+        }
+
+        log_detail::logCacheEntryRegression(query.toStringShort(),
+                                            zeroPaddedHex(entry->queryHash),
+                                            zeroPaddedHex(entry->planCacheKey),
+                                            entry->works,
+                                            *median);
+        if (internalQueryCacheDisableInactiveEntries.load()) {
+            // Without inactive entries the only way to trigger replanning is to drop the entry.
+            invariant(partition.cache.remove(key).isOK());
+            return true;
+        }
+        entry->isActive = false;
+        entry->works = *median;
+        recent.clear();
+        return true;
+    }
+
     /**
      * Look up the cached data access for the provided 'query'.  Used by the query planner
      * to shortcut planning.
@@ -623,14 +732,17 @@ public:
      * for the query (if there is one).
      */
     GetResult get(const KeyType& key) const {
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+        auto& partition = getPartition(key);
+        stdx::lock_guard<Latch> cacheLock(partition.mutex);
         PlanCacheEntryBase<CachedPlanType>* entry = nullptr;
-        Status cacheStatus = _cache.get(key, &entry);
+        Status cacheStatus = partition.cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
             invariant(cacheStatus == ErrorCodes::NoSuchKey);
+            recordLookup(false);
             return {CacheEntryState::kNotPresent, nullptr};
         }
         invariant(entry);
+        recordLookup(entry->isActive);
 
         auto state =
             entry->isActive ? CacheEntryState::kPresentActive : CacheEntryState::kPresentInactive;
@@ -657,16 +769,20 @@ public:
      * was present and removed and an error status otherwise.
      */
     Status remove(const CanonicalQuery& cq) {
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-        return _cache.remove(computeKey(cq));
+        const auto key = computeKey(cq);
+        auto& partition = getPartition(key);
+        stdx::lock_guard<Latch> cacheLock(partition.mutex);
+        return partition.cache.remove(key);
     }
 
     /**
      * Remove *all* cached plans.  Does not clear index information.
      */
     void clear() {
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-        _cache.clear();
+        for (auto&& partition : _partitions) {
+            stdx::lock_guard<Latch> cacheLock(partition->mutex);
+            partition->cache.clear();
+        }
     }
 
     /**
@@ -698,9 +814,10 @@ public:
         const CanonicalQuery& cq) const {
         KeyType key = computeKey(cq);
 
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+        auto& partition = getPartition(key);
+        stdx::lock_guard<Latch> cacheLock(partition.mutex);
         PlanCacheEntryBase<CachedPlanType>* entry;
-        Status cacheStatus = _cache.get(key, &entry);
+        Status cacheStatus = partition.cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
             return cacheStatus;
         }
@@ -714,12 +831,15 @@ public:
      * Used by planCacheListQueryShapes and index_filter_commands_test.cpp.
      */
     std::vector<std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>> getAllEntries() const {
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
         std::vector<std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>> entries;
 
-        for (auto&& cacheEntry : _cache) {
-            auto entry = cacheEntry.second;
-            entries.push_back(std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>(entry->clone()));
+        for (auto&& partition : _partitions) {
+            stdx::lock_guard<Latch> cacheLock(partition->mutex);
+            for (auto&& cacheEntry : partition->cache) {
+                auto entry = cacheEntry.second;
+                entries.push_back(
+                    std::unique_ptr<PlanCacheEntryBase<CachedPlanType>>(entry->clone()));
+            }
         }
 
         return entries;
@@ -730,8 +850,21 @@ public:
      * Used for testing.
      */
     size_t size() const {
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-        return _cache.size();
+        size_t size = 0;
+        for (auto&& partition : _partitions) {
+            stdx::lock_guard<Latch> cacheLock(partition->mutex);
+            size += partition->cache.size();
+        }
+        return size;
+    }
+
+    /**
+     * Returns the lookup and eviction counters of this plan cache.
+     */
+    Metrics getMetrics() const {
+        return {static_cast<long long>(_hits.get()),
+                static_cast<long long>(_misses.get()),
+                static_cast<long long>(_evictions.get())};
     }
 
     /**
@@ -752,13 +885,15 @@ public:
         const std::function<BSONObj(const PlanCacheEntryBase<CachedPlanType>&)>& serializationFunc,
         const std::function<bool(const BSONObj&)>& filterFunc) const {
         std::vector<BSONObj> results;
-        stdx::lock_guard<Latch> cacheLock(_cacheMutex);
 
-        for (auto&& cacheEntry : _cache) {
-            const auto entry = cacheEntry.second;
-            auto serializedEntry = serializationFunc(*entry);
-            if (filterFunc(serializedEntry)) {
-                results.push_back(serializedEntry);
+        for (auto&& partition : _partitions) {
+            stdx::lock_guard<Latch> cacheLock(partition->mutex);
+            for (auto&& cacheEntry : partition->cache) {
+                const auto entry = cacheEntry.second;
+                auto serializedEntry = serializationFunc(*entry);
+                if (filterFunc(serializedEntry)) {
+                    results.push_back(serializedEntry);
+                }
             }
         }
 
@@ -766,6 +901,87 @@ public:
     }
 
 private:
+    /**
+     * A slice of the cache holding the entries whose keys hash to it, along with the mutex which
+     * protects them.
+     */
+    struct Partition {
+        explicit Partition(size_t size) : cache(size) {}
+
+        LRUKeyValue<KeyType, PlanCacheEntryBase<CachedPlanType>, KeyHasher> cache;
+        mutable Mutex mutex = MONGO_MAKE_LATCH("PlanCache::Partition::mutex");
+    };
+
+    Partition& getPartition(const KeyType& key) const {
+        return *_partitions[KeyHasher{}(key) % _partitions.size()];
+    }
+
+    void recordLookup(bool hit) const {
+        if (hit) {
+            _hits.increment();
+            planCacheHits.increment();
+        } else {
+            _misses.increment();
+            planCacheMisses.increment();
+        }
+    }
+
+    void recordEviction(const NamespaceString& nss,
+                        std::unique_ptr<PlanCacheEntryBase<CachedPlanType>> evictedEntry) {
+        _evictions.increment();
+        planCacheEvictions.increment();
+        log_detail::logCacheEviction(nss, evictedEntry->debugString());
+    }
+
+    /**
+     * Evicts entries of this cache while the total size of all plan caches exceeds the budget. The
+     * least recently used entry of the partition holding the most entries goes first, so that the
+     * eviction is spread across partitions in proportion to their size. The entry just added to
+     * 'newEntryPartition' is never evicted. The caches of other collections shrink when entries are
+     * added to them.
+     */
+    void enforceTotalSizeBudget(const NamespaceString& nss, const Partition& newEntryPartition) {
+        auto isOverBudget = [] {
+            return static_cast<long long>(
+                       PlanCacheEntryBase<CachedPlanType>::planCacheTotalSizeEstimateBytes.get()) >
+                internalQueryCacheMaxTotalSizeBytes.load();
+        };
+
+        while (isOverBudget()) {
+            // The partition mutexes are taken one at a time, so the sizes may change in between.
+            // This only affects which partition loses an entry.
+            Partition* largest = nullptr;
+            size_t largestSize = 0;
+            for (auto&& partition : _partitions) {
+                stdx::lock_guard<Latch> cacheLock(partition->mutex);
+                size_t evictableSize = partition->cache.size();
+                if (partition.get() == &newEntryPartition && evictableSize > 0) {
+                    // Leave out the entry just added.
+                    --evictableSize;
+                }
+                if (evictableSize > largestSize) {
+                    largest = partition.get();
+                    largestSize = evictableSize;
+                }
+            }
+            if (!largest) {
+                return;
+            }
+
+            std::unique_ptr<PlanCacheEntryBase<CachedPlanType>> evictedEntry;
+            {
+                stdx::lock_guard<Latch> cacheLock(largest->mutex);
+                const size_t minSize = largest == &newEntryPartition ? 1 : 0;
+                if (largest->cache.size() > minSize) {
+                    evictedEntry = largest->cache.removeLeastRecentlyUsed();
+                }
+            }
+            if (evictedEntry) {
+                recordEviction(nss, std::move(evictedEntry));
+            }
+        }
+    }
+
     struct NewEntryState {
         bool shouldBeCreated = false;
         bool shouldBeActive = false;
@@ -851,10 +1067,12 @@ private:
         return res;
     }
 
-    LRUKeyValue<KeyType, PlanCacheEntryBase<CachedPlanType>, KeyHasher> _cache;
+    // The partitions of the cache. The vector itself is immutable after construction.
+    std::vector<std::unique_ptr<Partition>> _partitions;
 
-    // Protects _cache.
-    mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("PlanCache::_cacheMutex");
+    mutable Counter64 _hits;
+    mutable Counter64 _misses;
+    Counter64 _evictions;
 
     // Holds computed information about the collection's indexes.  Used for generating plan
     // cache keys.
@@ -604,6 +604,99 @@ TEST(PlanCacheTest, PlanCacheLRUPolicyRemovesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
 }
 
+TEST(PlanCacheTest, PlanCacheCountsHitsMissesAndEvictions) {
+    RAIIServerParameterControllerForTest controller{"internalQueryCacheDisableInactiveEntries",
+                                                    true};
+    PlanCache planCache(1);
+    QueryTestServiceContext serviceContext;
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kNotPresent);
+    addCacheEntryForShape(*cqA.get(), &planCache);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kPresentActive);
+
+    // The cache only has room for one entry, so adding {b: 1} evicts {a: 1}.
+    addCacheEntryForShape(*cqB.get(), &planCache);
+    ASSERT_EQ(planCache.get(*cqB).state, PlanCache::CacheEntryState::kPresentActive);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kNotPresent);
+
+    auto metrics = planCache.getMetrics();
+    ASSERT_EQ(metrics.hits, 2);
+    ASSERT_EQ(metrics.misses, 2);
+    ASSERT_EQ(metrics.evictions, 1);
+}
+
+TEST(PlanCacheTest, PartitionedPlanCacheKeepsEntriesOfAllPartitions) {
+    PlanCache planCache(1000, 8);
+    QueryTestServiceContext serviceContext;
+
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (auto&& field : {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"}) {
+        queries.push_back(canonicalize(BSON(field << 1)));
+        addCacheEntryForShape(*queries.back(), &planCache);
+    }
+    ASSERT_EQ(planCache.size(), queries.size());
+    ASSERT_EQ(planCache.getAllEntries().size(), queries.size());
+    for (auto&& cq : queries) {
+        ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+    }
+
+    ASSERT_OK(planCache.remove(*queries[0]));
+    ASSERT_EQ(planCache.size(), queries.size() - 1);
+    planCache.clear();
+    ASSERT_EQ(planCache.size(), 0U);
+}
+
+TEST(PlanCacheTest, PlanCacheEvictsEntriesAboveTotalSizeBudget) {
+    PlanCache planCache(100);
+    QueryTestServiceContext serviceContext;
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+    addCacheEntryForShape(*cqA.get(), &planCache);
+    addCacheEntryForShape(*cqB.get(), &planCache);
+    ASSERT_EQ(planCache.size(), 2U);
+
+    // Lower the budget to the current total, so that adding another entry evicts the least
+    // recently used entry.
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryCacheMaxTotalSizeBytes",
+        static_cast<long long>(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get())};
+    addCacheEntryForShape(*cqC.get(), &planCache);
+
+    ASSERT_LTE(planCache.size(), 2U);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_GTE(planCache.getMetrics().evictions, 1);
+}
+
+TEST(PlanCacheTest, PartitionedPlanCacheEvictsFromEveryPartitionAboveTotalSizeBudget) {
+    PlanCache planCache(1000, 8);
+    QueryTestServiceContext serviceContext;
+
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (auto&& field : {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"}) {
+        queries.push_back(canonicalize(BSON(field << 1)));
+        addCacheEntryForShape(*queries.back(), &planCache);
+    }
+    ASSERT_EQ(planCache.size(), queries.size());
+
+    // Lower the budget to half of the current total. Whichever partition the new entry falls into,
+    // entries of the other partitions have to be evicted as well to make room for it.
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryCacheMaxTotalSizeBytes",
+        static_cast<long long>(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get() / 2)};
+    unique_ptr<CanonicalQuery> cqK(canonicalize("{k: 1}"));
+    addCacheEntryForShape(*cqK.get(), &planCache);
+
+    ASSERT_LTE(planCache.size(), queries.size() / 2);
+    ASSERT_EQ(planCache.get(*cqK).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.getMetrics().evictions,
+              static_cast<long long>(queries.size() + 1 - planCache.size()));
+}
+
 TEST(PlanCacheTest, PlanCacheRemoveDeletesInactiveEntries) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -668,6 +761,72 @@ TEST(PlanCacheTest, AddActiveCacheEntry) {
     ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
 }
 
+TEST(PlanCacheTest, RecordTrialWorksDeactivatesRegressedEntry) {
+    RAIIServerParameterControllerForTest controller{"internalQueryCacheFeedbackWindowSize", 3};
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, qs->cacheData->clone(), solns, createDecision(1U, 20), Date_t{}));
+    ASSERT_OK(planCache.set(*cq, qs->cacheData->clone(), solns, createDecision(1U, 10), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    // A single slow trial period does not move the median.
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 10));
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 10));
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 100));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    // Once most of the recent trial periods are slow, the entry is deactivated and the median
+    // becomes its works value.
+    ASSERT_TRUE(planCache.recordTrialWorks(*cq, 100));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->works, 100U);
+    ASSERT_TRUE(entry->recentTrialWorks.empty());
+
+    // Inactive entries do not record feedback.
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 1000));
+
+    // A replanned solution doing better than the regressed plan becomes active right away.
+    ASSERT_OK(planCache.set(*cq, qs->cacheData->clone(), solns, createDecision(1U, 40), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+}
+
+TEST(PlanCacheTest, RecordTrialWorksRemovesRegressedEntryWhenInactiveEntriesDisabled) {
+    RAIIServerParameterControllerForTest windowController{"internalQueryCacheFeedbackWindowSize",
+                                                          1};
+    RAIIServerParameterControllerForTest inactiveController{
+        "internalQueryCacheDisableInactiveEntries", true};
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, qs->cacheData->clone(), solns, createDecision(1U, 10), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 30));
+    ASSERT_TRUE(planCache.recordTrialWorks(*cq, 31));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
+}
+
+TEST(PlanCacheTest, RecordTrialWorksCanBeDisabled) {
+    RAIIServerParameterControllerForTest controller{"internalQueryCacheFeedbackWindowSize", 0};
+    RAIIServerParameterControllerForTest inactiveController{
+        "internalQueryCacheDisableInactiveEntries", true};
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QueryTestServiceContext serviceContext;
+    addCacheEntryForShape(*cq, &planCache);
+
+    ASSERT_FALSE(planCache.recordTrialWorks(*cq, 1000));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+}
+
 TEST(PlanCacheTest, WorksValueIncreases) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
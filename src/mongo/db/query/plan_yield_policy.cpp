@@ -51,7 +51,7 @@ PlanYieldPolicy::PlanYieldPolicy(YieldPolicy policy,
       _elapsedTracker(cs, yieldIterations, yieldPeriod) {}
 
 bool PlanYieldPolicy::shouldYieldOrInterrupt(OperationContext* opCtx) {
-    if (_policy == YieldPolicy::INTERRUPT_ONLY) {
+    if (_policy == YieldPolicy::INTERRUPT_ONLY || _autoYieldsDisabled > 0) {
         return _elapsedTracker.intervalHasElapsed();
     }
     if (!canAutoYield())
@@ -70,7 +70,7 @@ Status PlanYieldPolicy::yieldOrInterrupt(OperationContext* opCtx,
                                          std::function<void()> whileYieldingFn) {
     invariant(opCtx);
 
-    if (_policy == YieldPolicy::INTERRUPT_ONLY) {
+    if (_policy == YieldPolicy::INTERRUPT_ONLY || _autoYieldsDisabled > 0) {
         ON_BLOCK_EXIT([this]() { resetTimer(); });
         invariant(opCtx);
         if (_callbacks) {
@@ -226,6 +226,20 @@ public:
         _forceYield = true;
     }
 
+    /**
+     * Keeps an auto-yielding plan from yielding its locks and storage snapshot until the matching
+     * call to 'enableAutoYields()', while interrupts are still checked. This is used while other
+     * threads, such as the producers of an exchange, read through the snapshot of the plan.
+     */
+    void disableAutoYields() {
+        ++_autoYieldsDisabled;
+    }
+
+    void enableAutoYields() {
+        invariant(_autoYieldsDisabled > 0);
+        --_autoYieldsDisabled;
+    }
+
     /**
      * Returns true if there is a possibility that a collection lock will be yielded at some point
      * during this PlanExecutor's lifetime.
@@ -299,6 +313,7 @@ private:
     std::unique_ptr<const YieldPolicyCallbacks> _callbacks;
 
     bool _forceYield = false;
+    size_t _autoYieldsDisabled = 0;
     ElapsedTracker _elapsedTracker;
 };
 
@@ -1617,6 +1617,88 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::scanWholeIndex(
     return solnRoot;
 }
 
+std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeSkipScan(const IndexEntry& index,
+                                                                    const CanonicalQuery& query,
+                                                                    size_t* prefixLengthOut) {
+    // Multikey, sparse and partial indexes would each require extra care to know which predicates
+    // can be turned into bounds, so they are not considered.
+    if (index.type != INDEX_BTREE || index.multikey || index.sparse || index.filterExpr ||
+        !CollatorInterface::collatorsMatch(index.collator, query.getCollator())) {
+        return nullptr;
+    }
+
+    // Only the top-level conjuncts of the query are used to build the bounds.
+    std::vector<const MatchExpression*> predicates;
+    const MatchExpression* root = query.root();
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            predicates.push_back(root->getChild(i));
+        }
+    } else {
+        predicates.push_back(root);
+    }
+
+    auto isUsable = [](const MatchExpression* expr) {
+        switch (expr->matchType()) {
+            case MatchExpression::EQ:
+            case MatchExpression::LT:
+            case MatchExpression::LTE:
+            case MatchExpression::GT:
+            case MatchExpression::GTE:
+            case MatchExpression::MATCH_IN:
+                return true;
+            default:
+                return false;
+        }
+    };
+
+    unique_ptr<IndexScanNode> isn = std::make_unique<IndexScanNode>(index);
+    isn->addKeyMetadata = query.metadataDeps()[DocumentMetadataFields::kIndexKey];
+    isn->queryCollator = query.getCollator();
+    isn->bounds.fields.resize(index.keyPattern.nFields());
+
+    boost::optional<size_t> constrainedField;
+    size_t fieldNo = 0;
+    for (auto&& elt : index.keyPattern) {
+        OrderedIntervalList* oil = &isn->bounds.fields[fieldNo];
+        bool translated = false;
+        for (auto&& pred : predicates) {
+            if (constrainedField || !isUsable(pred) || pred->path() != elt.fieldNameStringData()) {
+                continue;
+            }
+            IndexBoundsBuilder::BoundsTightness tightness;
+            if (translated) {
+                IndexBoundsBuilder::translateAndIntersect(pred, elt, index, oil, &tightness);
+            } else {
+                IndexBoundsBuilder::translate(pred, elt, index, oil, &tightness);
+                translated = true;
+            }
+        }
+
+        if (translated) {
+            if (fieldNo == 0) {
+                return nullptr;
+            }
+            oil->name = elt.fieldName();
+            constrainedField = fieldNo;
+        } else {
+            IndexBoundsBuilder::allValuesForField(elt, oil);
+        }
+        ++fieldNo;
+    }
+
+    if (!constrainedField) {
+        return nullptr;
+    }
+    *prefixLengthOut = *constrainedField;
+    IndexBoundsBuilder::alignBounds(&isn->bounds, index.keyPattern);
+
+    unique_ptr<FetchNode> fetch = std::make_unique<FetchNode>();
+    fetch->filter = query.root()->shallowClone();
+    fetch->children.push_back(isn.release());
+    return fetch;
+}
+
 void QueryPlannerAccess::addFilterToSolutionNode(QuerySolutionNode* node,
                                                  std::unique_ptr<MatchExpression> match,
                                                  MatchExpression::MatchType type) {
@@ -113,6 +113,21 @@ public:
                                                              const QueryPlannerParams& params,
                                                              int direction = 1);
 
+    /**
+     * Return a plan that skip scans the compound 'index'. The leading fields of the index which
+     * are not constrained by the query are left unbounded, so that the index scan enumerates their
+     * distinct values by seeking from one to the next, and the first field which is constrained is
+     * bounded by the top-level predicates of the query on that field. The whole query is applied
+     * by a FETCH above the scan.
+     *
+     * Returns nullptr if the index cannot be skip scanned, for instance because its leading field
+     * is constrained by the query (in which case the regular planning applies), or because none of
+     * its fields are. Otherwise, sets 'prefixLengthOut' to the number of skipped leading fields.
+     */
+    static std::unique_ptr<QuerySolutionNode> makeSkipScan(const IndexEntry& index,
+                                                           const CanonicalQuery& query,
+                                                           size_t* prefixLengthOut);
+
     /**
      * Return a plan that scans the provided index from [startKey to endKey).
      */
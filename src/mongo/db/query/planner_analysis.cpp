@@ -960,4 +960,53 @@ std::unique_ptr<QuerySolution> QueryPlannerAnalysis::analyzeDataAccess(
     return soln;
 }
 
+// static
+std::pair<EqLookupNode::LookupStrategy, boost::optional<IndexEntry>>
+QueryPlannerAnalysis::determineLookupStrategy(
+    const NamespaceString& foreignCollName,
+    const std::string& foreignField,
+    const std::map<NamespaceString, SecondaryCollectionInfo>& collectionsInfo,
+    const CollatorInterface* collator) {
+    auto foreignCollItr = collectionsInfo.find(foreignCollName);
+    tassert(6000400,
+            str::stream() << "Expected collection info, but found none; target collection: "
+                          << foreignCollName,
+            foreignCollItr != collectionsInfo.end());
+    const auto& foreignCollInfo = foreignCollItr->second;
+
+    // A missing foreign collection joins nothing, so the cheapest plan is to hash zero documents.
+    if (!foreignCollInfo.exists) {
+        return {EqLookupNode::LookupStrategy::kHashJoin, boost::none};
+    }
+
+    // Look for an index whose leading field is 'foreignField' and which holds an entry for every
+    // document, preferring the key pattern with the fewest fields. Sparse and partial indexes would
+    // miss documents matching a null or missing local value, and hashed indexes cannot be sought
+    // with the raw local value.
+    boost::optional<IndexEntry> foreignIndex;
+    for (const auto& index : foreignCollInfo.indexes) {
+        if (index.type != INDEX_BTREE || index.sparse || index.filterExpr ||
+            !CollatorInterface::collatorsMatch(collator, index.collator) ||
+            index.keyPattern.firstElement().fieldNameStringData() != foreignField) {
+            continue;
+        }
+        if (!foreignIndex || index.keyPattern.nFields() < foreignIndex->keyPattern.nFields()) {
+            foreignIndex = index;
+        }
+    }
+    if (foreignIndex) {
+        return {EqLookupNode::LookupStrategy::kIndexedLoopJoin, std::move(foreignIndex)};
+    }
+
+    // The hash join probes a HashAggStage with seek keys, which cannot spill, so only hash foreign
+    // collections which fit in memory whether or not 'allowDiskUse' is set.
+    if (foreignCollInfo.noOfRecords <=
+            internalQueryCollectionMaxNoOfDocumentsToChooseHashJoin.load() &&
+        foreignCollInfo.approximateDataSizeBytes <=
+            internalQueryCollectionMaxDataSizeBytesToChooseHashJoin.load()) {
+        return {EqLookupNode::LookupStrategy::kHashJoin, boost::none};
+    }
+    return {EqLookupNode::LookupStrategy::kNestedLoopJoin, boost::none};
+}
+
 }  // namespace mongo
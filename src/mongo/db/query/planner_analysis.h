@@ -112,6 +112,21 @@ public:
     static bool explodeForSort(const CanonicalQuery& query,
                                const QueryPlannerParams& params,
                                QuerySolutionNode** solnRoot);
+
+    /**
+     * Chooses how to execute an equality $lookup against 'foreignCollName' on 'foreignField':
+     *  - an indexed loop join, if the foreign collection has a usable index led by 'foreignField';
+     *  - otherwise a hash join, if the foreign collection is small enough to be hashed in memory;
+     *  - otherwise a nested loop join.
+     *
+     * The returned IndexEntry is set only for the indexed loop join.
+     */
+    static std::pair<EqLookupNode::LookupStrategy, boost::optional<IndexEntry>>
+    determineLookupStrategy(
+        const NamespaceString& foreignCollName,
+        const std::string& foreignField,
+        const std::map<NamespaceString, SecondaryCollectionInfo>& collectionsInfo,
+        const CollatorInterface* collator);
 };
 
 }  // namespace mongo
@@ -281,4 +281,48 @@ TEST(QueryPlannerAnalysis, GeoSkipValidation) {
     ASSERT_EQ(expr->getCanSkipValidation(), true);
 }
 
+TEST(QueryPlannerAnalysis, DetermineLookupStrategy) {
+    const NamespaceString foreignNss("test.foreign");
+    const auto largeCollSize = internalQueryCollectionMaxNoOfDocumentsToChooseHashJoin.load() + 1;
+    std::map<NamespaceString, SecondaryCollectionInfo> collectionsInfo;
+    auto& info = collectionsInfo[foreignNss];
+
+    // A small collection without a usable index is hashed.
+    info.noOfRecords = 10;
+    info.indexes = {buildSimpleIndexEntry(fromjson("{b: 1, a: 1}")),
+                    buildSimpleIndexEntry(fromjson("{a: 'hashed'}"))};
+    auto [strategy, idxEntry] = QueryPlannerAnalysis::determineLookupStrategy(
+        foreignNss, "a", collectionsInfo, nullptr /* collator */);
+    ASSERT(strategy == EqLookupNode::LookupStrategy::kHashJoin);
+    ASSERT_FALSE(idxEntry);
+
+    // A large collection is never hashed, as the join cannot spill.
+    info.noOfRecords = largeCollSize;
+    std::tie(strategy, idxEntry) = QueryPlannerAnalysis::determineLookupStrategy(
+        foreignNss, "a", collectionsInfo, nullptr /* collator */);
+    ASSERT(strategy == EqLookupNode::LookupStrategy::kNestedLoopJoin);
+
+    // Sparse indexes are not usable, but a regular index led by the foreign field is preferred
+    // regardless of the collection size.
+    auto sparseIndex = buildSimpleIndexEntry(fromjson("{a: 1}"));
+    sparseIndex.sparse = true;
+    info.indexes.push_back(sparseIndex);
+    std::tie(strategy, idxEntry) = QueryPlannerAnalysis::determineLookupStrategy(
+        foreignNss, "a", collectionsInfo, nullptr /* collator */);
+    ASSERT(strategy == EqLookupNode::LookupStrategy::kNestedLoopJoin);
+
+    info.indexes.push_back(buildSimpleIndexEntry(fromjson("{a: 1, c: 1}")));
+    std::tie(strategy, idxEntry) = QueryPlannerAnalysis::determineLookupStrategy(
+        foreignNss, "a", collectionsInfo, nullptr /* collator */);
+    ASSERT(strategy == EqLookupNode::LookupStrategy::kIndexedLoopJoin);
+    ASSERT(idxEntry);
+    ASSERT_BSONOBJ_EQ(idxEntry->keyPattern, fromjson("{a: 1, c: 1}"));
+
+    // A missing collection joins nothing and is trivially hashed.
+    info.exists = false;
+    std::tie(strategy, idxEntry) = QueryPlannerAnalysis::determineLookupStrategy(
+        foreignNss, "a", collectionsInfo, nullptr /* collator */);
+    ASSERT(strategy == EqLookupNode::LookupStrategy::kHashJoin);
+}
+
 }  // namespace
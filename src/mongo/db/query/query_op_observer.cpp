@@ -0,0 +1,157 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_op_observer.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
+#include "mongo/db/query/sbe_plan_cache.h"
+#include "mongo/db/query/stats_catalog.h"
+
+namespace mongo {
+namespace {
+/**
+ * Removes the SBE plan cache entries of the collection with the given UUID once the write unit of
+ * work of 'opCtx' commits.
+ */
+void removeSbePlanCacheEntriesOnCommit(OperationContext* opCtx, const UUID& collectionUuid) {
+    if (!feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV()) {
+        return;
+    }
+
+    opCtx->recoveryUnit()->onCommit(
+        [serviceCtx = opCtx->getServiceContext(), collectionUuid](boost::optional<Timestamp>) {
+            sbe::getPlanCache(serviceCtx).removeCollectionEntries(collectionUuid);
+        });
+}
+
+/**
+ * Drops the cached statistics of the collection 'nss', or of the collection whose statistics are
+ * stored in 'nss', once the write unit of work of 'opCtx' commits. Invalidating any earlier would
+ * let the statistics be reloaded from the state preceding the write.
+ */
+void invalidateStatisticsOnCommit(OperationContext* opCtx, const NamespaceString& nss) {
+    opCtx->recoveryUnit()->onCommit(
+        [serviceCtx = opCtx->getServiceContext(),
+         nss = StatsCatalog::getAnalyzedNamespace(nss).value_or(nss)](boost::optional<Timestamp>) {
+            StatsCatalog::get(serviceCtx).invalidate(nss);
+        });
+}
+}  // namespace
+
+void QueryOpObserver::onInserts(OperationContext* opCtx,
+                                const NamespaceString& nss,
+                                OptionalCollectionUUID uuid,
+                                std::vector<InsertStatement>::const_iterator first,
+                                std::vector<InsertStatement>::const_iterator last,
+                                bool fromMigrate) {
+    if (StatsCatalog::getAnalyzedNamespace(nss)) {
+        invalidateStatisticsOnCommit(opCtx, nss);
+    }
+}
+
+void QueryOpObserver::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArgs& args) {
+    if (StatsCatalog::getAnalyzedNamespace(args.nss)) {
+        invalidateStatisticsOnCommit(opCtx, args.nss);
+    }
+}
+
+void QueryOpObserver::onDelete(OperationContext* opCtx,
+                               const NamespaceString& nss,
+                               OptionalCollectionUUID uuid,
+                               StmtId stmtId,
+                               const OplogDeleteEntryArgs& args) {
+    if (StatsCatalog::getAnalyzedNamespace(nss)) {
+        invalidateStatisticsOnCommit(opCtx, nss);
+    }
+}
+
+void QueryOpObserver::onCollMod(OperationContext* opCtx,
+                                const NamespaceString& nss,
+                                const UUID& uuid,
+                                const BSONObj& collModCmd,
+                                const CollectionOptions& oldCollOptions,
+                                boost::optional<IndexCollModInfo> indexInfo) {
+    // Hiding an index must keep the cached plans from using it.
+    if (indexInfo && indexInfo->hidden) {
+        removeSbePlanCacheEntriesOnCommit(opCtx, uuid);
+    }
+}
+
+repl::OpTime QueryOpObserver::onDropCollection(OperationContext* opCtx,
+                                               const NamespaceString& collectionName,
+                                               OptionalCollectionUUID uuid,
+                                               std::uint64_t numRecords,
+                                               const CollectionDropType dropType) {
+    if (uuid) {
+        removeSbePlanCacheEntriesOnCommit(opCtx, *uuid);
+    }
+    invalidateStatisticsOnCommit(opCtx, collectionName);
+    return {};
+}
+
+void QueryOpObserver::onDropIndex(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  OptionalCollectionUUID uuid,
+                                  const std::string& indexName,
+                                  const BSONObj& idxDescriptor) {
+    // The cache keys name the indexes the plans scan, but an index can be re-created under the
+    // same name with different options.
+    if (uuid) {
+        removeSbePlanCacheEntriesOnCommit(opCtx, *uuid);
+    }
+}
+
+void QueryOpObserver::onRenameCollection(OperationContext* opCtx,
+                                         const NamespaceString& fromCollection,
+                                         const NamespaceString& toCollection,
+                                         OptionalCollectionUUID uuid,
+                                         OptionalCollectionUUID dropTargetUUID,
+                                         std::uint64_t numRecords,
+                                         bool stayTemp) {
+    if (dropTargetUUID) {
+        removeSbePlanCacheEntriesOnCommit(opCtx, *dropTargetUUID);
+    }
+    invalidateStatisticsOnCommit(opCtx, fromCollection);
+    invalidateStatisticsOnCommit(opCtx, toCollection);
+}
+
+void QueryOpObserver::onReplicationRollback(OperationContext* opCtx,
+                                            const RollbackObserverInfo& rbInfo) {
+    // A rollback can undo any catalog change, so none of the cached plans can be trusted. The
+    // same goes for the cached statistics.
+    if (feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV()) {
+        sbe::getPlanCache(opCtx).clear();
+    }
+    StatsCatalog::get(opCtx).invalidateAll();
+}
+
+}  // namespace mongo
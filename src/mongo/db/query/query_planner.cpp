@@ -45,6 +45,8 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_lookup.h"
+#include "mongo/db/pipeline/document_source_set_window_fields.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -98,6 +100,168 @@ Status tagOrChildAccordingToCache(PlanCacheIndexTree* compositeCacheData,
 
     return Status::OK();
 }
+
+/**
+ * Estimates the number of distinct combinations of values taken by the first 'prefixLength' fields
+ * of 'keyPattern' using the histograms in 'stats'. Returns boost::none if one of these fields has
+ * no histogram.
+ */
+boost::optional<double> estimatePrefixDistinctValues(const BSONObj& keyPattern,
+                                                     size_t prefixLength,
+                                                     const CollectionStatistics& stats) {
+    double distinct = 1;
+    BSONObjIterator it(keyPattern);
+    for (size_t i = 0; i < prefixLength && it.more(); ++i) {
+        auto histogram = stats.histograms.find(it.next().fieldNameStringData());
+        if (histogram == stats.histograms.end()) {
+            return boost::none;
+        }
+        distinct *= std::max(1.0, histogram->second.getDistinctCount());
+    }
+    return distinct;
+}
+
+/**
+ * An estimate of the number of index keys and documents examined by a plan.
+ */
+struct ScanEstimate {
+    double items = 0;
+
+    // False if some of the bounds of the scans could not be taken into account for lack of a
+    // histogram, in which case 'items' may overestimate the work of the plan.
+    bool complete = true;
+};
+
+/**
+ * Estimates the number of index keys and documents examined by the subtree rooted at 'node' using
+ * the histograms in 'stats'. Returns boost::none if any of the scans in the subtree cannot be
+ * estimated at all.
+ */
+boost::optional<ScanEstimate> estimateScannedItems(const QuerySolutionNode* node,
+                                                   const CollectionStatistics& stats) {
+    const double numRecords = static_cast<double>(stats.numRecords);
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            return ScanEstimate{numRecords};
+        case STAGE_IXSCAN: {
+            auto ixn = static_cast<const IndexScanNode*>(node);
+            // The histograms are built over the raw values of the field, which only correspond to
+            // the keys of plain btree indexes without a collation.
+            if (ixn->index.type != INDEX_BTREE || ixn->index.collator ||
+                ixn->bounds.isSimpleRange || ixn->bounds.fields.empty()) {
+                return boost::none;
+            }
+            // A scan whose leading fields are unbounded but which bounds a later field is a skip
+            // scan. It costs a seek per distinct value of the skipped fields, plus the keys
+            // within the bounds of the remaining fields.
+            auto isUnbounded = [](const OrderedIntervalList& oil) {
+                return oil.intervals.size() == 1 &&
+                    (oil.intervals[0].isMinToMax() || oil.intervals[0].isMaxToMin());
+            };
+            const auto& fields = ixn->bounds.fields;
+            size_t boundedField = 0;
+            while (boundedField < fields.size() && isUnbounded(fields[boundedField])) {
+                ++boundedField;
+            }
+            ScanEstimate estimate;
+            if (boundedField == fields.size()) {
+                estimate.items = numRecords;
+                return estimate;
+            }
+            if (boundedField > 0) {
+                auto prefixDistinct =
+                    estimatePrefixDistinctValues(ixn->index.keyPattern, boundedField, stats);
+                if (!prefixDistinct) {
+                    return boost::none;
+                }
+                estimate.items += *prefixDistinct;
+            }
+
+            // The values of the fields are assumed to be independent of each other, so that the
+            // scan returns the fraction of the keys which falls within the bounds of every field.
+            double selectivity = 1;
+            for (size_t i = boundedField; i < fields.size(); ++i) {
+                if (isUnbounded(fields[i])) {
+                    continue;
+                }
+                auto it = stats.histograms.find(fields[i].name);
+                if (it == stats.histograms.end()) {
+                    estimate.complete = false;
+                    continue;
+                }
+                double keys = 0;
+                for (auto&& interval : fields[i].intervals) {
+                    keys += it->second.estimateInterval(interval);
+                }
+                selectivity *= std::min(1.0, keys / std::max(1.0, it->second.getTotalCount()));
+            }
+            estimate.items += selectivity * numRecords;
+            return estimate;
+        }
+        default: {
+            // Every other stage is assumed to examine the sum of what its children produce.
+            if (node->children.empty()) {
+                return boost::none;
+            }
+            ScanEstimate estimate;
+            for (auto&& child : node->children) {
+                auto childEstimate = estimateScannedItems(child, stats);
+                if (!childEstimate) {
+                    return boost::none;
+                }
+                estimate.items += childEstimate->items;
+                estimate.complete = estimate.complete && childEstimate->complete;
+            }
+            return estimate;
+        }
+    }
+}
+
+/**
+ * Discards the solutions in 'out' which are estimated to examine many more keys or documents than
+ * the cheapest one, according to the statistics in 'params'. Only solutions whose every bound is
+ * covered by a histogram can be discarded, while the others may still serve as the cheapest one
+ * since they can only be overestimated. At least one solution is always kept.
+ */
+void discardSolutionsUsingStatistics(const QueryPlannerParams& params,
+                                     std::vector<std::unique_ptr<QuerySolution>>* out) {
+    if (!params.collectionStats || !internalQueryPlannerEnableStatisticsPreFilter.load() ||
+        out->size() <
+            static_cast<size_t>(internalQueryPlannerStatisticsPreFilterMinSolutions.load())) {
+        return;
+    }
+
+    std::vector<boost::optional<ScanEstimate>> estimates;
+    boost::optional<double> best;
+    for (auto&& soln : *out) {
+        estimates.push_back(estimateScannedItems(soln->root(), *params.collectionStats));
+        if (estimates.back() && (!best || estimates.back()->items < *best)) {
+            best = estimates.back()->items;
+        }
+    }
+    if (!best) {
+        return;
+    }
+
+    const double maxEstimate = *best * internalQueryPlannerStatisticsPreFilterRatio.load();
+    const double minWorks = internalQueryPlannerStatisticsPreFilterMinWorks.load();
+    std::vector<std::unique_ptr<QuerySolution>> kept;
+    for (size_t i = 0; i < out->size(); ++i) {
+        const auto& estimate = estimates[i];
+        if (estimate && estimate->complete && estimate->items > maxEstimate &&
+            estimate->items >= minWorks) {
+            LOGV2_DEBUG(6001106,
+                        5,
+                        "Planner: discarding solution using statistics",
+                        "estimate"_attr = estimate->items,
+                        "bestEstimate"_attr = *best,
+                        "solution"_attr = redact((*out)[i]->toString()));
+            continue;
+        }
+        kept.push_back(std::move((*out)[i]));
+    }
+    *out = std::move(kept);
+}
 }  // namespace
 
 using std::numeric_limits;
@@ -327,6 +491,77 @@ std::unique_ptr<QuerySolution> buildWholeIXSoln(const IndexEntry& index,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+std::unique_ptr<QuerySolution> buildSkipScanSoln(const IndexEntry& index,
+                                                 const CanonicalQuery& query,
+                                                 const QueryPlannerParams& params) {
+    size_t prefixLength;
+    std::unique_ptr<QuerySolutionNode> solnRoot(
+        QueryPlannerAccess::makeSkipScan(index, query, &prefixLength));
+    if (!solnRoot) {
+        return nullptr;
+    }
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+}
+
+/**
+ * Adds to 'out' a skip scan solution for each index in 'indices' whose leading fields are not
+ * constrained by 'query' but have few distinct values according to the collection statistics.
+ * When the statistics cover the bounded field too, the skip scan must also be estimated to examine
+ * a small enough fraction of the collection.
+ */
+void addSkipScanSolns(const CanonicalQuery& query,
+                      const QueryPlannerParams& params,
+                      const std::vector<IndexEntry>& indices,
+                      std::vector<std::unique_ptr<QuerySolution>>* out) {
+    if (!params.collectionStats || !internalQueryPlannerEnableSkipScan.load() ||
+        QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) ||
+        QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+        return;
+    }
+
+    const double maxPrefixDistinct = internalQueryPlannerSkipScanMaxPrefixDistinctValues.load();
+    for (auto&& index : indices) {
+        if (out->size() >= params.maxIndexedSolutions) {
+            return;
+        }
+
+        size_t prefixLength;
+        std::unique_ptr<QuerySolutionNode> solnRoot(
+            QueryPlannerAccess::makeSkipScan(index, query, &prefixLength));
+        if (!solnRoot) {
+            continue;
+        }
+        auto prefixDistinct =
+            estimatePrefixDistinctValues(index.keyPattern, prefixLength, *params.collectionStats);
+        if (!prefixDistinct || *prefixDistinct > maxPrefixDistinct) {
+            continue;
+        }
+        auto estimate = estimateScannedItems(solnRoot.get(), *params.collectionStats);
+        if (estimate && estimate->complete &&
+            estimate->items > internalQueryPlannerSkipScanMaxSelectivity.load() *
+                    static_cast<double>(params.collectionStats->numRecords)) {
+            continue;
+        }
+
+        auto soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+        if (!soln) {
+            continue;
+        }
+        LOGV2_DEBUG(6001500,
+                    5,
+                    "Planner: outputting skip scan solution",
+                    "prefixDistinctValues"_attr = *prefixDistinct,
+                    "solution"_attr = redact(soln->toString()));
+        PlanCacheIndexTree* indexTree = new PlanCacheIndexTree();
+        indexTree->setIndexEntry(index);
+        SolutionCacheData* scd = new SolutionCacheData();
+        scd->tree.reset(indexTree);
+        scd->solnType = SolutionCacheData::SKIP_SCAN_SOLN;
+        soln->cacheData.reset(scd);
+        out->push_back(std::move(soln));
+    }
+}
+
 bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
     return query.getFindCommandRequest().getSort().isPrefixOf(
         kp, SimpleBSONElementComparator::kInstance);
@@ -494,6 +729,14 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
         } else {
             return {std::move(soln)};
         }
+    } else if (SolutionCacheData::SKIP_SCAN_SOLN == winnerCacheData.solnType) {
+        auto soln = buildSkipScanSoln(*winnerCacheData.tree->entry, query, params);
+        if (!soln) {
+            return Status(ErrorCodes::NoQueryExecutionPlans,
+                          "plan cache error: skip scan soln");
+        } else {
+            return {std::move(soln)};
+        }
     } else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
         // The cached solution is a collection scan. We don't cache collscans
         // with tailable==true, hence the false below.
@@ -581,15 +824,49 @@ QueryPlanner::QueryPlannerResult QueryPlanner::plan(const CanonicalQuery& query,
 
     std::unique_ptr<QuerySolutionNode> postMultiPlannedQSN = std::make_unique<SentinelNode>();
     for (auto& innerStage : query.pipeline()) {
-        auto groupStage = dynamic_cast<DocumentSourceGroup*>(innerStage->documentSource());
-        tassert(5842400,
-                "Cannot support pushdown of a stage other than $group at the moment",
-                groupStage != nullptr);
+        if (auto groupStage = dynamic_cast<DocumentSourceGroup*>(innerStage->documentSource())) {
+            postMultiPlannedQSN = std::make_unique<GroupNode>(std::move(postMultiPlannedQSN),
+                                                              groupStage->getIdFields(),
+                                                              groupStage->getAccumulatedFields(),
+                                                              groupStage->doingMerge());
+            continue;
+        }
+
+        if (auto windowStage = dynamic_cast<DocumentSourceInternalSetWindowFields*>(
+                innerStage->documentSource())) {
+            postMultiPlannedQSN = std::make_unique<WindowNode>(std::move(postMultiPlannedQSN),
+                                                               windowStage->getPartitionBy(),
+                                                               windowStage->getSortBy(),
+                                                               windowStage->getOutputFields());
+            continue;
+        }
 
-        postMultiPlannedQSN = std::make_unique<GroupNode>(std::move(postMultiPlannedQSN),
-                                                          groupStage->getIdFields(),
-                                                          groupStage->getAccumulatedFields(),
-                                                          groupStage->doingMerge());
+        auto lookupStage = dynamic_cast<DocumentSourceLookUp*>(innerStage->documentSource());
+        tassert(5842400,
+                "Cannot support pushdown of a stage other than $group, $lookup or "
+                "$_internalSetWindowFields at the moment",
+                lookupStage != nullptr);
+        tassert(6000401,
+                "Only an equality $lookup on top-level fields without a sub-pipeline can be pushed "
+                "down",
+                lookupStage->hasLocalFieldForeignFieldJoin() && !lookupStage->hasPipeline() &&
+                    !lookupStage->hasAbsorbedStages() &&
+                    lookupStage->getLocalField()->getPathLength() == 1 &&
+                    lookupStage->getForeignField()->getPathLength() == 1 &&
+                    lookupStage->getAsField().getPathLength() == 1);
+
+        auto [strategy, idxEntry] = QueryPlannerAnalysis::determineLookupStrategy(
+            lookupStage->getFromNs(),
+            lookupStage->getForeignField()->fullPath(),
+            params.secondaryCollectionsInfo,
+            query.getCollator());
+        postMultiPlannedQSN = std::make_unique<EqLookupNode>(std::move(postMultiPlannedQSN),
+                                                             lookupStage->getFromNs(),
+                                                             *lookupStage->getLocalField(),
+                                                             *lookupStage->getForeignField(),
+                                                             lookupStage->getAsField(),
+                                                             strategy,
+                                                             std::move(idxEntry));
     }
     return {planForMultiPlanner(query, params), std::move(postMultiPlannedQSN)};
 }
@@ -1102,6 +1379,15 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::planForMul
         }
     }
 
+    // Skip scans are only considered when the query cannot be answered by a hinted index. They
+    // compete with the collection scan they are an alternative to, rather than replacing it.
+    const bool hasRegularIndexedSolns = !out.empty();
+    if (hintedIndex.isEmpty() && !isTailable) {
+        addSkipScanSolns(query, params, fullIndexList, &out);
+    }
+    const bool collscanAlongsideSkipScans =
+        !hasRegularIndexedSolns && !out.empty() && canTableScan;
+
     // The caller can explicitly ask for a collscan.
     bool collscanRequested = (params.options & QueryPlannerParams::INCLUDE_COLLSCAN);
 
@@ -1121,7 +1407,8 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::planForMul
         return Status(ErrorCodes::NoQueryExecutionPlans, "No query solutions");
     }
 
-    if (possibleToCollscan && (collscanRequested || collScanRequired)) {
+    if (possibleToCollscan &&
+        (collscanRequested || collScanRequired || collscanAlongsideSkipScans)) {
         auto collscan = buildCollscanSoln(query, isTailable, params);
         if (!collscan && collScanRequired) {
             return Status(ErrorCodes::NoQueryExecutionPlans,
@@ -1139,6 +1426,8 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::planForMul
         }
     }
 
+    discardSolutionsUsingStatistics(params, &out);
+
     invariant(out.size() > 0);
     return {std::move(out)};
 }
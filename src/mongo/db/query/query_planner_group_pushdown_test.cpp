@@ -35,6 +35,7 @@
 #include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
 #include "mongo/db/pipeline/inner_pipeline_stage_interface.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/db/query/query_planner_test_lib.h"
 
 namespace {
 using namespace mongo;
@@ -106,4 +107,22 @@ TEST_F(QueryPlannerGroupPushdownTest, PushdownOfOneGroupWithMultipleAccumulators
         "{sentinel: "
         "{}}}}");
 }
+
+TEST_F(QueryPlannerGroupPushdownTest, ExtendingTheWinningSolutionReplacesTheSentinel) {
+    addIndex(BSON("x" << 1));
+    const std::vector<BSONObj> rawPipeline = {
+        fromjson("{$group: {_id: '$y', count: {$sum: '$x'}}}"),
+    };
+    auto pipeline = buildTestPipeline(rawPipeline);
+
+    runQueryWithPipeline(fromjson("{x: 1}"), makeInnerPipelineStages(*pipeline.get()));
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    solns[0]->extendWith(std::move(postMultiPlanSoln));
+    ASSERT_OK(QueryPlannerTestLib::solutionMatches(
+        fromjson("{group: {key: {_id: '$y'}, accs: [{count: {$sum: '$x'}}], node: {fetch: "
+                 "{filter: null, node: {ixscan: {pattern: {x: 1}}}}}}}"),
+        solns[0]->root(),
+        relaxBoundsCheck));
+}
 }  //  namespace
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/document_source_lookup.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_interface.h"
+#include "mongo/db/query/query_planner_test_fixture.h"
+
+namespace {
+using namespace mongo;
+
+class QueryPlannerLookupPushdownTest : public QueryPlannerTest {
+protected:
+    void setUp() override {
+        QueryPlannerTest::setUp();
+        expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+            {kForeignNss.coll().toString(), {kForeignNss, std::vector<BSONObj>()}}});
+    }
+
+    /**
+     * Makes a vector of InnerPipelineStageInterface that carries the input DocumentSources.
+     */
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> makeInnerPipelineStages(
+        const Pipeline& pipeline) {
+        std::vector<std::unique_ptr<InnerPipelineStageInterface>> stages;
+        for (auto&& source : pipeline.getSources()) {
+            stages.emplace_back(std::make_unique<InnerPipelineStageImpl>(source));
+        }
+        return stages;
+    }
+
+    /**
+     * Plans the query {x: 1} followed by 'rawPipeline' against the main collection.
+     */
+    void runQueryWithRawPipeline(const std::vector<BSONObj>& rawPipeline) {
+        auto pipeline = Pipeline::parse(rawPipeline, expCtx);
+        runQueryWithPipeline(fromjson("{x: 1}"), makeInnerPipelineStages(*pipeline.get()));
+    }
+
+    /**
+     * Registers the foreign collection with the planner, with the given size and indexes.
+     */
+    void addForeignCollection(long long noOfRecords,
+                              std::vector<std::pair<BSONObj, std::string>> indexes = {}) {
+        SecondaryCollectionInfo info;
+        info.noOfRecords = noOfRecords;
+        info.approximateDataSizeBytes = noOfRecords * 100;
+        for (auto&& [keyPattern, name] : indexes) {
+            info.indexes.push_back({keyPattern,
+                                    IndexNames::nameToType(IndexNames::findPluginName(keyPattern)),
+                                    IndexDescriptor::kLatestIndexVersion,
+                                    false,  // multikey
+                                    {},
+                                    {},
+                                    false,  // sparse
+                                    false,  // unique
+                                    IndexEntry::Identifier{name},
+                                    nullptr,  // filterExpr
+                                    BSONObj(),
+                                    nullptr,
+                                    nullptr});
+        }
+        params.secondaryCollectionsInfo[kForeignNss] = std::move(info);
+    }
+
+    const NamespaceString kForeignNss{"test.foreign"};
+};
+
+TEST_F(QueryPlannerLookupPushdownTest, PushdownOfLookupOverSmallCollectionUsesHashJoin) {
+    addForeignCollection(10);
+    runQueryWithRawPipeline(
+        {fromjson("{$lookup: {from: 'foreign', localField: 'x', foreignField: 'y', as: 'out'}}")});
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertPostMultiPlanSolutionMatches(
+        "{eq_lookup: {foreignCollection: 'test.foreign', joinFieldLocal: 'x', joinFieldForeign: "
+        "'y', joinField: 'out', strategy: 'HashJoin', node: {sentinel: {}}}}");
+}
+
+TEST_F(QueryPlannerLookupPushdownTest, PushdownOfLookupPrefersIndexOnForeignField) {
+    addForeignCollection(10, {{BSON("z" << 1), "z_1"}, {BSON("y" << 1 << "z" << 1), "y_1_z_1"}});
+    runQueryWithRawPipeline(
+        {fromjson("{$lookup: {from: 'foreign', localField: 'x', foreignField: 'y', as: 'out'}}")});
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertPostMultiPlanSolutionMatches(
+        "{eq_lookup: {foreignCollection: 'test.foreign', joinFieldLocal: 'x', joinFieldForeign: "
+        "'y', joinField: 'out', strategy: 'IndexedLoopJoin', indexName: 'y_1_z_1', node: "
+        "{sentinel: {}}}}");
+}
+
+TEST_F(QueryPlannerLookupPushdownTest, PushdownOfLookupOverLargeCollectionUsesNestedLoopJoin) {
+    addForeignCollection(internalQueryCollectionMaxNoOfDocumentsToChooseHashJoin.load() + 1,
+                         {{BSON("z" << 1 << "y" << 1), "z_1_y_1"}});
+    runQueryWithRawPipeline(
+        {fromjson("{$lookup: {from: 'foreign', localField: 'x', foreignField: 'y', as: 'out'}}")});
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertPostMultiPlanSolutionMatches(
+        "{eq_lookup: {foreignCollection: 'test.foreign', joinFieldLocal: 'x', joinFieldForeign: "
+        "'y', joinField: 'out', strategy: 'NestedLoopJoin', node: {sentinel: {}}}}");
+}
+
+TEST_F(QueryPlannerLookupPushdownTest, PushdownOfGroupOverLookup) {
+    addForeignCollection(10);
+    runQueryWithRawPipeline(
+        {fromjson("{$lookup: {from: 'foreign', localField: 'x', foreignField: 'y', as: 'out'}}"),
+         fromjson("{$group: {_id: '$_id', count: {$sum: '$x'}}}")});
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertPostMultiPlanSolutionMatches(
+        "{group: {key: {_id: '$_id'}, accs: [{count: {$sum: '$x'}}], node: {eq_lookup: "
+        "{foreignCollection: 'test.foreign', joinFieldLocal: 'x', joinFieldForeign: 'y', "
+        "joinField: 'out', strategy: 'HashJoin', node: {sentinel: {}}}}}}");
+}
+}  //  namespace
@@ -29,14 +29,29 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/scalar_histogram.h"
 
 namespace mongo {
 
+/**
+ * Describes a collection other than the main collection of the query which the planner may need to
+ * access, such as the foreign collection of a $lookup pushed down into the query layer.
+ */
+struct SecondaryCollectionInfo {
+    std::vector<IndexEntry> indexes;
+    bool exists = true;
+    long long noOfRecords = 0;
+    long long approximateDataSizeBytes = 0;
+};
+
 struct QueryPlannerParams {
     QueryPlannerParams()
         : options(DEFAULT),
@@ -142,6 +157,15 @@ struct QueryPlannerParams {
     // Set if we allow optimization which converts "_id" predicates into range collection scan using
     // minRecord and maxRecord.
     bool allowRIDRange;
+
+    // Information about the secondary collections referenced by the pipeline stages pushed down
+    // into the query layer, keyed by namespace. Used to choose how to execute a pushed down
+    // $lookup.
+    std::map<NamespaceString, SecondaryCollectionInfo> secondaryCollectionsInfo;
+
+    // Statistics collected on the main collection by the 'analyze' command, if any. Used to
+    // discard candidate plans which are clearly worse than others before multi-planning.
+    std::shared_ptr<const CollectionStatistics> collectionStats;
 };
 
 }  // namespace mongo
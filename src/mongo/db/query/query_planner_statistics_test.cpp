@@ -0,0 +1,261 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/db/query/scalar_histogram.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+ScalarHistogram makeHistogram(const BSONObj& valuesObj,
+                              const std::vector<double>& counts,
+                              size_t numBuckets) {
+    std::vector<std::pair<BSONElement, double>> values;
+    size_t i = 0;
+    for (auto&& elem : valuesObj) {
+        values.emplace_back(elem, counts[i++]);
+    }
+    return ScalarHistogram::make(values, numBuckets);
+}
+
+class QueryPlannerStatisticsTest : public QueryPlannerTest {
+protected:
+    void setUp() override {
+        QueryPlannerTest::setUp();
+        params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+        addIndex(BSON("c" << 1));
+    }
+
+    /**
+     * Attaches statistics to the planner params in which the value 5 is rare for 'a', every
+     * value is positive for 'b' and the value 1 is very common for 'c'.
+     */
+    void setStatistics(bool includeC) {
+        auto stats = std::make_shared<CollectionStatistics>();
+        stats->numRecords = 100000;
+        stats->histograms["a"] = makeHistogram(BSON_ARRAY(1 << 5 << 10), {50000, 1, 49999}, 3);
+        stats->histograms["b"] = makeHistogram(BSON_ARRAY(1 << 2), {50000, 50000}, 2);
+        if (includeC) {
+            stats->histograms["c"] = makeHistogram(BSON_ARRAY(1 << 2), {50000, 50000}, 2);
+        }
+        params.collectionStats = std::move(stats);
+    }
+
+    const BSONObj kFilter = fromjson("{a: 5, b: {$gt: 0}, c: 1}");
+};
+
+TEST_F(QueryPlannerStatisticsTest, AllSolutionsKeptWithoutStatistics) {
+    runQuery(kFilter);
+    assertNumSolutions(3U);
+}
+
+TEST_F(QueryPlannerStatisticsTest, DiscardsSolutionsScanningManyMoreKeys) {
+    setStatistics(true);
+    runQuery(kFilter);
+    assertNumSolutions(1U);
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+}
+
+TEST_F(QueryPlannerStatisticsTest, KeepsSolutionsWhichCannotBeEstimated) {
+    setStatistics(false);
+    runQuery(kFilter);
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {c: 1}}}}}");
+}
+
+TEST_F(QueryPlannerStatisticsTest, CombinesTheBoundsOfEveryIndexedField) {
+    // The bounds of 'b' select every key, but those of 'a' are as selective on the compound index
+    // as on the index of 'a' alone.
+    addIndex(BSON("b" << 1 << "a" << 1));
+    setStatistics(true);
+    runQuery(kFilter);
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {b: 1, a: 1}}}}}");
+}
+
+TEST_F(QueryPlannerStatisticsTest, KeepsSolutionsWithBoundsWhichCannotBeEstimated) {
+    // Without a histogram for 'c', the scan of the compound index can only be overestimated from
+    // the bounds of 'b', so it is kept whereas the scan of the index of 'b' alone is not.
+    addIndex(BSON("b" << 1 << "c" << 1));
+    setStatistics(false);
+    runQuery(kFilter);
+    assertNumSolutions(3U);
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {c: 1}}}}}");
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {b: 1, c: 1}}}}}");
+}
+
+TEST_F(QueryPlannerStatisticsTest, PreFilterCanBeDisabled) {
+    setStatistics(true);
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryPlannerEnableStatisticsPreFilter", false};
+    runQuery(kFilter);
+    assertNumSolutions(3U);
+}
+
+TEST_F(QueryPlannerStatisticsTest, SmallEstimatesAreNotDiscarded) {
+    setStatistics(true);
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryPlannerStatisticsPreFilterMinWorks", 1000000LL};
+    runQuery(kFilter);
+    assertNumSolutions(3U);
+}
+
+class QueryPlannerSkipScanTest : public QueryPlannerTest {
+protected:
+    void setUp() override {
+        QueryPlannerTest::setUp();
+        params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+        addIndex(BSON("a" << 1 << "b" << 1));
+    }
+
+    /**
+     * Attaches statistics to the planner params in which 'a' takes three distinct values, along
+     * with the histogram 'bHistogram' of 'b' if given.
+     */
+    void setStatistics(boost::optional<ScalarHistogram> bHistogram = boost::none) {
+        auto stats = std::make_shared<CollectionStatistics>();
+        stats->numRecords = 30000;
+        stats->histograms["a"] = makeHistogram(BSON_ARRAY(1 << 2 << 3), {10000, 10000, 10000}, 3);
+        if (bHistogram) {
+            stats->histograms["b"] = std::move(*bHistogram);
+        }
+        params.collectionStats = std::move(stats);
+    }
+};
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWithoutStatistics) {
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanWhenPrefixHasFewDistinctValues) {
+    setStatistics();
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey', 'MaxKey', true, true]], b: [[5, 5, true, true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanIntersectsPredicatesOnBoundedField) {
+    setStatistics();
+    runQuery(fromjson("{b: {$gt: 1, $lt: 4}, c: 1}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: {$gt: 1, $lt: 4}, c: 1}, node: {ixscan: {pattern: {a: 1, b: 1}, "
+        "bounds: {a: [['MinKey', 'MaxKey', true, true]], b: [[1, 4, false, false]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanOverDescendingField) {
+    addIndex(BSON("a" << 1 << "b" << -1));
+    setStatistics();
+    runQuery(fromjson("{b: {$in: [2, 7]}}"));
+    assertNumSolutions(3U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: {$in: [2, 7]}}, node: {ixscan: {pattern: {a: 1, b: -1}, bounds: "
+        "{a: [['MinKey', 'MaxKey', true, true]], b: [[7, 7, true, true], [2, 2, true, true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanWhenBoundedFieldIsSelective) {
+    setStatistics(makeHistogram(BSON_ARRAY(5 << 6), {10, 29990}, 2));
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey', 'MaxKey', true, true]], b: [[5, 5, true, true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWhenBoundedFieldIsNotSelective) {
+    setStatistics(makeHistogram(BSON_ARRAY(5 << 6), {15000, 15000}, 2));
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoCollscanNextToSkipScanWithNoTableScan) {
+    params.options |= QueryPlannerParams::NO_TABLE_SCAN;
+    setStatistics();
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey', 'MaxKey', true, true]], b: [[5, 5, true, true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWhenPrefixHasManyDistinctValues) {
+    setStatistics();
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryPlannerSkipScanMaxPrefixDistinctValues", 2LL};
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWhenLeadingFieldIsConstrained) {
+    setStatistics();
+    runQuery(fromjson("{a: {$gt: 1}, b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [[1, Infinity, false, true]], b: [[5, 5, true, true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanOverMultikeyIndex) {
+    params.indices.clear();
+    addIndex(BSON("a" << 1 << "b" << 1), true);
+    setStatistics();
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanCanBeDisabled) {
+    setStatistics();
+    RAIIServerParameterControllerForTest controller{"internalQueryPlannerEnableSkipScan", false};
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+}  // namespace
+}  // namespace mongo
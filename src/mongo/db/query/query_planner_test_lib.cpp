@@ -37,6 +37,7 @@
 
 #include <ostream>
 
+#include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
@@ -1189,6 +1190,63 @@ Status QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
         }
         return solutionMatches(child.Obj(), actualGroupNode->children[0], relaxBoundsCheck)
             .withContext("mismatch below group stage");
+    } else if (STAGE_EQ_LOOKUP == trueSoln->getType()) {
+        const auto* actualEqLookupNode = static_cast<const EqLookupNode*>(trueSoln);
+        auto expectedElem = testSoln["eq_lookup"];
+        if (expectedElem.eoo() || !expectedElem.isABSONObj()) {
+            return {ErrorCodes::Error{6000402},
+                    "found an 'eq_lookup' object in the test solution but no corresponding "
+                    "'eq_lookup' object in the expected JSON"};
+        }
+
+        auto expectedObj = expectedElem.Obj();
+        invariant(bsonObjFieldsAreInSet(expectedObj,
+                                        {"foreignCollection",
+                                         "joinFieldLocal",
+                                         "joinFieldForeign",
+                                         "joinField",
+                                         "strategy",
+                                         "indexName",
+                                         "node"}));
+
+        auto actualObj =
+            BSON("foreignCollection"
+                 << actualEqLookupNode->foreignCollection.toString() << "joinFieldLocal"
+                 << actualEqLookupNode->joinFieldLocal.fullPath() << "joinFieldForeign"
+                 << actualEqLookupNode->joinFieldForeign.fullPath() << "joinField"
+                 << actualEqLookupNode->joinField.fullPath() << "strategy"
+                 << EqLookupNode::serializeLookupStrategy(actualEqLookupNode->lookupStrategy));
+        for (auto&& field : actualObj) {
+            if (!SimpleBSONElementComparator::kInstance.evaluate(
+                    field == expectedObj[field.fieldNameStringData()])) {
+                return {ErrorCodes::Error{6000403},
+                        str::stream() << "found an eq_lookup stage in the solution with "
+                                         "mismatching '"
+                                      << field.fieldNameStringData()
+                                      << "'. Expected: " << expectedObj << " Found: " << actualObj};
+            }
+        }
+
+        auto expectedIndexName = expectedObj["indexName"];
+        auto& actualIdxEntry = actualEqLookupNode->idxEntry;
+        if (expectedIndexName.eoo() != !actualIdxEntry ||
+            (actualIdxEntry && expectedIndexName.str() != actualIdxEntry->identifier.catalogName)) {
+            return {ErrorCodes::Error{6000404},
+                    str::stream() << "found an eq_lookup stage in the solution with mismatching "
+                                     "'indexName'. Expected: "
+                                  << expectedObj << " Found: "
+                                  << (actualIdxEntry ? actualIdxEntry->identifier.catalogName
+                                                     : "none")};
+        }
+
+        auto child = expectedObj["node"];
+        if (child.eoo() || !child.isABSONObj()) {
+            return {ErrorCodes::Error{6000405},
+                    "found an eq_lookup stage in the solution but no 'node' sub-object in the "
+                    "provided JSON"};
+        }
+        return solutionMatches(child.Obj(), actualEqLookupNode->children[0], relaxBoundsCheck)
+            .withContext("mismatch below eq_lookup stage");
     } else if (STAGE_SENTINEL == trueSoln->getType()) {
         const auto* actualSentinelNode = static_cast<const SentinelNode*>(trueSoln);
         auto expectedSentinelElem = testSoln["sentinel"];
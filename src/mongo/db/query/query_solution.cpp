@@ -40,6 +40,7 @@
 #include "mongo/db/field_ref.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/pipeline/document_source_set_window_fields.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -167,6 +168,31 @@ void QuerySolution::setRoot(std::unique_ptr<QuerySolutionNode> root) {
     assignNodeIds(idGenerator, *_root);
 }
 
+void QuerySolution::extendWith(std::unique_ptr<QuerySolutionNode> extensionRoot) {
+    invariant(_root);
+    invariant(extensionRoot);
+
+    QuerySolutionNode* parent = nullptr;
+    auto node = extensionRoot.get();
+    while (node->getType() != STAGE_SENTINEL) {
+        tassert(6001008,
+                "Expected the extension of a query solution to be a chain of stages over a "
+                "sentinel",
+                node->children.size() == 1);
+        parent = node;
+        node = node->children[0];
+    }
+
+    if (!parent) {
+        // The extension is the sentinel alone, so there is nothing to add to this solution.
+        return;
+    }
+
+    delete parent->children[0];
+    parent->children[0] = _root.release();
+    setRoot(std::move(extensionRoot));
+}
+
 //
 // CollectionScanNode
 //
@@ -1415,6 +1441,110 @@ QuerySolutionNode* GroupNode::clone() const {
     return copy.release();
 }
 
+/**
+ * EqLookupNode.
+ */
+StringData EqLookupNode::serializeLookupStrategy(LookupStrategy strategy) {
+    switch (strategy) {
+        case LookupStrategy::kHashJoin:
+            return "HashJoin"_sd;
+        case LookupStrategy::kIndexedLoopJoin:
+            return "IndexedLoopJoin"_sd;
+        case LookupStrategy::kNestedLoopJoin:
+            return "NestedLoopJoin"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void EqLookupNode::appendToString(str::stream* ss, int indent) const {
+    addIndent(ss, indent);
+    *ss << "EQ_LOOKUP\n";
+    addIndent(ss, indent + 1);
+    *ss << "from = " << foreignCollection.toString() << "\n";
+    addIndent(ss, indent + 1);
+    *ss << "as = " << joinField.fullPath() << "\n";
+    addIndent(ss, indent + 1);
+    *ss << "localField = " << joinFieldLocal.fullPath() << "\n";
+    addIndent(ss, indent + 1);
+    *ss << "foreignField = " << joinFieldForeign.fullPath() << "\n";
+    addIndent(ss, indent + 1);
+    *ss << "lookupStrategy = " << serializeLookupStrategy(lookupStrategy) << "\n";
+    if (idxEntry) {
+        addIndent(ss, indent + 1);
+        *ss << "indexName = " << idxEntry->identifier.catalogName << "\n";
+    }
+    addCommon(ss, indent);
+    addIndent(ss, indent + 1);
+    *ss << "Child:" << '\n';
+    children[0]->appendToString(ss, indent + 2);
+}
+
+QuerySolutionNode* EqLookupNode::clone() const {
+    auto copy =
+        std::make_unique<EqLookupNode>(std::unique_ptr<QuerySolutionNode>(children[0]->clone()),
+                                       foreignCollection,
+                                       joinFieldLocal,
+                                       joinFieldForeign,
+                                       joinField,
+                                       lookupStrategy,
+                                       idxEntry);
+    return copy.release();
+}
+
+/**
+ * WindowNode.
+ */
+WindowNode::WindowNode(std::unique_ptr<QuerySolutionNode> child,
+                       boost::optional<boost::intrusive_ptr<Expression>> partitionBy,
+                       boost::optional<SortPattern> sortBy,
+                       std::vector<WindowFunctionStatement> outputFields)
+    : QuerySolutionNode(std::move(child)),
+      partitionBy(std::move(partitionBy)),
+      sortBy(std::move(sortBy)),
+      outputFields(std::move(outputFields)) {}
+
+WindowNode::~WindowNode() = default;
+
+void WindowNode::appendToString(str::stream* ss, int indent) const {
+    addIndent(ss, indent);
+    *ss << "WINDOW\n";
+    if (partitionBy) {
+        addIndent(ss, indent + 1);
+        *ss << "partitionBy = " << (*partitionBy)->serialize(true).toString() << "\n";
+    }
+    if (sortBy) {
+        addIndent(ss, indent + 1);
+        *ss << "sortBy = "
+            << sortBy->serialize(SortPattern::SortKeySerialization::kForExplain).toString()
+            << "\n";
+    }
+    addIndent(ss, indent + 1);
+    *ss << "output = [";
+    for (size_t idx = 0; idx < outputFields.size(); ++idx) {
+        if (idx > 0) {
+            *ss << ", ";
+        }
+        auto& outputField = outputFields[idx];
+        *ss << "{" << outputField.fieldName << ": "
+            << outputField.expr->serialize(ExplainOptions::Verbosity::kQueryPlanner).toString()
+            << "}";
+    }
+    *ss << "]" << '\n';
+    addCommon(ss, indent);
+    addIndent(ss, indent + 1);
+    *ss << "Child:" << '\n';
+    children[0]->appendToString(ss, indent + 2);
+}
+
+QuerySolutionNode* WindowNode::clone() const {
+    auto copy =
+        std::make_unique<WindowNode>(std::unique_ptr<QuerySolutionNode>(children[0]->clone()),
+                                     partitionBy,
+                                     sortBy,
+                                     outputFields);
+    return copy.release();
+}
+
 /**
  * SentinelNode.
  */
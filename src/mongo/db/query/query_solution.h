@@ -36,16 +36,20 @@
 #include "mongo/db/fts/fts_query.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/query/classic_plan_cache.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/query/plan_enumerator_explain_info.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/query/stage_types.h"
 #include "mongo/util/id_generator.h"
 
 namespace mongo {
 
 class GeoNearExpression;
+struct WindowFunctionStatement;
 
 /**
  * Represents the granularity at which a field is available in a query solution node. Note that the
@@ -369,6 +373,13 @@ public:
      */
     void setRoot(std::unique_ptr<QuerySolutionNode> root);
 
+    /**
+     * Extends this solution with the tree rooted at 'extensionRoot', which must contain a single
+     * SentinelNode as its only leaf. The sentinel is replaced by the current root of this solution,
+     * and 'extensionRoot' becomes the new root. Node ids are reassigned for the whole tree.
+     */
+    void extendWith(std::unique_ptr<QuerySolutionNode> extensionRoot);
+
     // There are two known scenarios in which a query solution might potentially block:
     //
     // Sort stage:
@@ -1261,7 +1272,8 @@ struct TextMatchNode : public QuerySolutionNodeWithSortSet {
 
 struct GroupNode : public QuerySolutionNode {
     GroupNode(std::unique_ptr<QuerySolutionNode> child,
-              StringMap<boost::intrusive_ptr<Expression>> groupByExpressions,
+              std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>>
+                  groupByExpressions,
               std::vector<AccumulationStatement> accumulators,
               bool doingMerge)
         : QuerySolutionNode(std::move(child)),
@@ -1292,11 +1304,128 @@ struct GroupNode : public QuerySolutionNode {
 
     QuerySolutionNode* clone() const override;
 
-    StringMap<boost::intrusive_ptr<Expression>> groupByExpressions;
+    // The expressions of the '_id' fields, keyed by "_id" or "_id.<field>", in the order of the
+    // $group.
+    std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> groupByExpressions;
     std::vector<AccumulationStatement> accumulators;
     bool doingMerge;
 };
 
+/**
+ * Represents a left outer equality join between the documents produced by its child ("local") and
+ * the documents of 'foreignCollection', as specified by an equality $lookup. For every local
+ * document, the foreign documents whose 'joinFieldForeign' matches the local 'joinFieldLocal' are
+ * collected into an array stored under 'joinField'.
+ */
+struct EqLookupNode : public QuerySolutionNode {
+    /**
+     * How the join is executed.
+     */
+    enum class LookupStrategy {
+        // Build a hash table over the foreign collection keyed by 'joinFieldForeign' and probe it
+        // with the local values.
+        kHashJoin,
+
+        // Seek the foreign index described by 'idxEntry' once per local value.
+        kIndexedLoopJoin,
+
+        // Scan the entire foreign collection once per local document.
+        kNestedLoopJoin,
+    };
+
+    static StringData serializeLookupStrategy(LookupStrategy strategy);
+
+    EqLookupNode(std::unique_ptr<QuerySolutionNode> child,
+                 const NamespaceString& foreignCollection,
+                 const FieldPath& joinFieldLocal,
+                 const FieldPath& joinFieldForeign,
+                 const FieldPath& joinField,
+                 LookupStrategy lookupStrategy,
+                 boost::optional<IndexEntry> idxEntry)
+        : QuerySolutionNode(std::move(child)),
+          foreignCollection(foreignCollection),
+          joinFieldLocal(joinFieldLocal),
+          joinFieldForeign(joinFieldForeign),
+          joinField(joinField),
+          lookupStrategy(lookupStrategy),
+          idxEntry(std::move(idxEntry)) {}
+
+    StageType getType() const override {
+        return STAGE_EQ_LOOKUP;
+    }
+
+    void appendToString(str::stream* ss, int indent) const override;
+
+    bool fetched() const {
+        return true;
+    }
+
+    FieldAvailability getFieldAvailability(const std::string& field) const {
+        return FieldAvailability::kFullyProvided;
+    }
+
+    bool sortedByDiskLoc() const override {
+        return false;
+    }
+
+    const ProvidedSortSet& providedSorts() const final {
+        return children.back()->providedSorts();
+    }
+
+    QuerySolutionNode* clone() const override;
+
+    NamespaceString foreignCollection;
+    FieldPath joinFieldLocal;
+    FieldPath joinFieldForeign;
+    FieldPath joinField;
+    LookupStrategy lookupStrategy;
+
+    // The index on the foreign collection used by 'kIndexedLoopJoin'. Unset for other strategies.
+    boost::optional<IndexEntry> idxEntry;
+};
+
+/**
+ * Computes the window functions of a $_internalSetWindowFields stage. The documents produced by
+ * its child must arrive grouped by 'partitionBy' and sorted by 'sortBy' within each partition.
+ */
+struct WindowNode : public QuerySolutionNode {
+    // Defined out of line, as the window functions are only forward declared here.
+    WindowNode(std::unique_ptr<QuerySolutionNode> child,
+               boost::optional<boost::intrusive_ptr<Expression>> partitionBy,
+               boost::optional<SortPattern> sortBy,
+               std::vector<WindowFunctionStatement> outputFields);
+    ~WindowNode() override;
+
+    StageType getType() const override {
+        return STAGE_WINDOW;
+    }
+
+    void appendToString(str::stream* ss, int indent) const override;
+
+    bool fetched() const {
+        return true;
+    }
+
+    FieldAvailability getFieldAvailability(const std::string& field) const {
+        return FieldAvailability::kFullyProvided;
+    }
+
+    bool sortedByDiskLoc() const override {
+        return false;
+    }
+
+    // The output fields may overwrite the fields the child is sorted by.
+    const ProvidedSortSet& providedSorts() const final {
+        return kEmptySet;
+    }
+
+    QuerySolutionNode* clone() const override;
+
+    boost::optional<boost::intrusive_ptr<Expression>> partitionBy;
+    boost::optional<SortPattern> sortBy;
+    std::vector<WindowFunctionStatement> outputFields;
+};
+
 struct SentinelNode : public QuerySolutionNode {
 
     SentinelNode() {}
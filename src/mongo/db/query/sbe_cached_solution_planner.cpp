@@ -77,6 +77,9 @@ CandidatePlans CachedSolutionPlanner::plan(
     // If the cached plan hit EOF quickly enough, or still as efficient as before, then no need to
     // replan. Finalize the cached plan and return it.
     if (stats->common.isEOF || numReads <= maxReadsBeforeReplan) {
+        // Feed the cost of this trial period back into the plan cache, which deactivates the entry
+        // if its plan keeps performing much worse than when it was cached.
+        CollectionQueryInfo::get(_collection).getPlanCache()->recordTrialWorks(_cq, numReads);
         return {makeVector(finalizeExecutionPlan(std::move(stats), std::move(candidate))), 0};
     }
 
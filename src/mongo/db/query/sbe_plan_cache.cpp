@@ -29,11 +29,20 @@
 
 #include "mongo/db/query/sbe_plan_cache.h"
 
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/server_options.h"
 
 namespace mongo {
 namespace sbe {
 namespace {
+ServerStatusMetricField<Counter64> sbePlanCacheHitsMetric("query.sbePlanCache.hits",
+                                                         &PlanCache::sbePlanCacheHits);
+ServerStatusMetricField<Counter64> sbePlanCacheMissesMetric("query.sbePlanCache.misses",
+                                                           &PlanCache::sbePlanCacheMisses);
+
 const auto sbePlanCacheDecoration =
     ServiceContext::declareDecoration<std::unique_ptr<sbe::PlanCache>>();
 
@@ -45,8 +54,219 @@ ServiceContext::ConstructorActionRegisterer planCacheRegisterer{
         }
     }};
 
+// Fields of the find command which do not affect the plan built for the query and are therefore
+// left out of the plan cache key. The filter is encoded separately.
+const StringDataSet kFindFieldsIgnoredByKey{
+    FindCommandRequest::kAllowPartialResultsFieldName,
+    FindCommandRequest::kAllowSpeculativeMajorityReadFieldName,
+    FindCommandRequest::kAwaitDataFieldName,
+    FindCommandRequest::kBatchSizeFieldName,
+    FindCommandRequest::kDbNameFieldName,
+    FindCommandRequest::kFilterFieldName,
+    FindCommandRequest::kLegacyRuntimeConstantsFieldName,
+    FindCommandRequest::kLetFieldName,
+    FindCommandRequest::kMaxTimeMSFieldName,
+    FindCommandRequest::kNoCursorTimeoutFieldName,
+    FindCommandRequest::kOptionsFieldName,
+    FindCommandRequest::kReadConcernFieldName,
+    FindCommandRequest::kReadOnceFieldName,
+    FindCommandRequest::kSingleBatchFieldName,
+    FindCommandRequest::kTermFieldName,
+    FindCommandRequest::kUnwrappedReadPrefFieldName,
+};
+
+bool hasInputParams(const MatchExpression* expr) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr) &&
+        static_cast<const ComparisonMatchExpression*>(expr)->getInputParamId()) {
+        return true;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (hasInputParams(expr->getChild(i))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Encodes the shape of the filter 'expr'. Parameterized comparisons are encoded by their operator,
+ * path and the type of their literal. Subtrees without parameters are serialized as is, literals
+ * included, since their values are baked into the plan.
+ */
+BSONObj encodeFilterShape(const MatchExpression* expr) {
+    if (!hasInputParams(expr)) {
+        return expr->serialize();
+    }
+
+    BSONObjBuilder bob;
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<const ComparisonMatchExpression*>(expr);
+        bob.append("op", comparison->name());
+        bob.append("path", comparison->path());
+        bob.append("param", typeName(comparison->getData().type()));
+        return bob.obj();
+    }
+
+    bob.append("type", static_cast<int>(expr->matchType()));
+    bob.append("path", expr->path());
+    BSONArrayBuilder children(bob.subarrayStart("children"));
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        children.append(encodeFilterShape(expr->getChild(i)));
+    }
+    children.doneFast();
+    return bob.obj();
+}
+
+/**
+ * Appends the shape of the solution tree rooted at 'node' to 'builder'. Returns false if the tree
+ * contains a stage which bakes query-dependent values into the SBE plan that cannot be rebound.
+ */
+bool encodeSolutionShape(const QuerySolutionNode* node, BSONArrayBuilder* builder) {
+    BSONObjBuilder bob(builder->subobjStart());
+    bob.append("stage", static_cast<int>(node->getType()));
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            auto csn = static_cast<const CollectionScanNode*>(node);
+            if (csn->minRecord || csn->maxRecord || csn->resumeAfterRecordId || csn->tailable ||
+                csn->requestResumeToken || csn->shouldTrackLatestOplogTimestamp ||
+                csn->assertTsHasNotFallenOffOplog) {
+                return false;
+            }
+            bob.append("direction", csn->direction);
+            break;
+        }
+        case STAGE_IXSCAN: {
+            auto ixn = static_cast<const IndexScanNode*>(node);
+            bob.append("index", ixn->index.identifier.catalogName);
+            bob.append("keyPattern", ixn->index.keyPattern);
+            bob.append("direction", ixn->direction);
+            bob.append("dedup", ixn->shouldDedup);
+            break;
+        }
+        case STAGE_SORT_MERGE:
+            bob.append("sort", static_cast<const MergeSortNode*>(node)->sort);
+            break;
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_EOF:
+        case STAGE_FETCH:
+        case STAGE_LIMIT:
+        case STAGE_OR:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_RETURN_KEY:
+        case STAGE_SKIP:
+        case STAGE_SORT_DEFAULT:
+        case STAGE_SORT_KEY_GENERATOR:
+        case STAGE_SORT_SIMPLE:
+            break;
+        default:
+            return false;
+    }
+
+    if (node->filter) {
+        bob.append("filter", encodeFilterShape(node->filter.get()));
+    }
+
+    BSONArrayBuilder children(bob.subarrayStart("children"));
+    for (auto&& child : node->children) {
+        if (!encodeSolutionShape(child, &children)) {
+            return false;
+        }
+    }
+    return true;
+}
 }  // namespace
 
+PlanCache::PlanCache() : PlanCache(internalQuerySBEPlanCacheMaxEntries.load()) {}
+
+PlanCache::PlanCache(size_t size) : _cache(size) {}
+
+std::unique_ptr<CachedSbePlan> PlanCache::getClone(const PlanCacheKey& key) const {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    CachedSbePlan* entry = nullptr;
+    Status cacheStatus = _cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        invariant(cacheStatus == ErrorCodes::NoSuchKey);
+        sbePlanCacheMisses.increment();
+        return nullptr;
+    }
+    invariant(entry);
+    sbePlanCacheHits.increment();
+    return entry->clone();
+}
+
+void PlanCache::set(const PlanCacheKey& key, std::unique_ptr<CachedSbePlan> plan) {
+    invariant(plan);
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    _cache.add(key, plan.release());
+}
+
+Status PlanCache::remove(const PlanCacheKey& key) {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    return _cache.remove(key);
+}
+
+void PlanCache::removeCollectionEntries(const UUID& collectionUuid) {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    std::vector<PlanCacheKey> keys;
+    for (auto&& [key, _] : _cache) {
+        if (key.getCollectionUuid() == collectionUuid) {
+            keys.push_back(key);
+        }
+    }
+    for (auto&& key : keys) {
+        _cache.remove(key).ignore();
+    }
+}
+
+void PlanCache::clear() {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    _cache.clear();
+}
+
+size_t PlanCache::size() const {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    return _cache.size();
+}
+
+boost::optional<PlanCacheKey> makePlanCacheKey(const CanonicalQuery& cq,
+                                               const CollectionPtr& collection,
+                                               const QuerySolution& solution) {
+    BSONObjBuilder bob;
+    bob.append("filter", encodeFilterShape(cq.root()));
+
+    // The values of the 'let' variables are rebound along with the input parameters, only their
+    // names are part of the query shape.
+    const auto& findCommand = cq.getFindCommandRequest();
+    {
+        BSONObjBuilder findBob(bob.subobjStart("find"));
+        for (auto&& elem : findCommand.toBSON(BSONObj{})) {
+            if (!kFindFieldsIgnoredByKey.count(elem.fieldNameStringData())) {
+                findBob.append(elem);
+            }
+        }
+        if (auto let = findCommand.getLet()) {
+            BSONArrayBuilder letNames(findBob.subarrayStart(FindCommandRequest::kLetFieldName));
+            for (auto&& elem : *let) {
+                letNames.append(elem.fieldNameStringData());
+            }
+        }
+    }
+
+    collection->uuid().appendToBuilder(&bob, "collectionUuid");
+
+    {
+        BSONArrayBuilder solutionShape(bob.subarrayStart("solution"));
+        if (!encodeSolutionShape(solution.root(), &solutionShape)) {
+            return boost::none;
+        }
+    }
+    return PlanCacheKey{bob.obj(), collection->uuid()};
+}
+
 sbe::PlanCache& getPlanCache(ServiceContext* serviceCtx) {
     uassert(5933402,
             "Cannot getPlanCache() if gFeatureFlagSbePlanCache is disabled",
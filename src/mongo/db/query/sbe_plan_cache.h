@@ -29,12 +29,17 @@
 
 #pragma once
 
+#include "mongo/base/counter.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/hasher.h"
 #include "mongo/db/operation_context.h"
-#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/uuid.h"
 
 namespace mongo {
 namespace sbe {
@@ -44,7 +49,8 @@ namespace sbe {
  */
 class PlanCacheKey {
 public:
-    explicit PlanCacheKey(BSONObj filter) : _filter(filter.getOwned()) {}
+    PlanCacheKey(BSONObj filter, UUID collectionUuid)
+        : _filter(filter.getOwned()), _collectionUuid(std::move(collectionUuid)) {}
 
     bool operator==(const PlanCacheKey& other) const {
         return other._filter.binaryEqual(_filter);
@@ -62,8 +68,17 @@ public:
 
     uint32_t planCacheKeyHash() const;
 
+    /**
+     * Returns the UUID of the collection the cached plan reads from. The UUID is also encoded in
+     * the filter.
+     */
+    const UUID& getCollectionUuid() const {
+        return _collectionUuid;
+    }
+
 private:
     const BSONObj _filter;
+    const UUID _collectionUuid;
 };
 
 /**
@@ -85,7 +100,7 @@ struct CachedSbePlan {
         : root(std::move(root)), planStageData(std::move(data)) {}
 
     std::unique_ptr<CachedSbePlan> clone() const {
-        return std::make_unique<CachedSbePlan>(root->clone(), planStageData);
+        return std::make_unique<CachedSbePlan>(root->clone(), planStageData.makeDeepCopy());
     }
 
     uint64_t estimateObjectSizeInBytes() const {
@@ -97,7 +112,70 @@ struct CachedSbePlan {
     stage_builder::PlanStageData planStageData;
 };
 
-using PlanCache = PlanCacheBase<sbe::PlanCacheKey, CachedSbePlan, sbe::PlanCacheKeyHasher>;
+/**
+ * A cache of SBE plans shared by all collections. Unlike the classic plan cache, which stores the
+ * index tagging needed to re-plan a query, this cache stores compiled SBE plans. Values which
+ * depend on the literals of a query live in RuntimeEnvironment slots of the cached plan, so that a
+ * clone of the plan can be rebound to any query with the same key (see 'input_params::bind()').
+ *
+ * The cache is bounded by 'internalQuerySBEPlanCacheMaxEntries' and evicts the least recently used
+ * entries first. All methods are thread-safe.
+ */
+class PlanCache {
+public:
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    PlanCache();
+    explicit PlanCache(size_t size);
+
+    /**
+     * Returns a clone of the plan cached under 'key', or nullptr if there is no such entry. The
+     * clone does not share any RuntimeEnvironment values with the cached plan, so the caller is
+     * free to rebind its slots.
+     */
+    std::unique_ptr<CachedSbePlan> getClone(const PlanCacheKey& key) const;
+
+    /**
+     * Caches 'plan' under 'key', replacing any existing entry.
+     */
+    void set(const PlanCacheKey& key, std::unique_ptr<CachedSbePlan> plan);
+
+    /**
+     * Removes the entry cached under 'key'. Returns an error status if there is no such entry.
+     */
+    Status remove(const PlanCacheKey& key);
+
+    /**
+     * Removes all entries of plans which read from the collection with the given UUID.
+     */
+    void removeCollectionEntries(const UUID& collectionUuid);
+
+    /**
+     * Removes all entries.
+     */
+    void clear();
+
+    size_t size() const;
+
+    // Counters aggregated across all lookups, reported by serverStatus.
+    inline static Counter64 sbePlanCacheHits;
+    inline static Counter64 sbePlanCacheMisses;
+
+private:
+    mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("sbe::PlanCache::_cacheMutex");
+    LRUKeyValue<PlanCacheKey, CachedSbePlan, PlanCacheKeyHasher> _cache;
+};
+
+/**
+ * Computes the key under which the SBE plan built from 'solution' for the query 'cq' is cached.
+ * Parameterized literals of the query are encoded by their type only, so that queries which differ
+ * only in these literals share the key. Returns boost::none if the plan cannot be cached, e.g.
+ * because 'solution' contains stages which bake query-dependent values into the plan.
+ */
+boost::optional<PlanCacheKey> makePlanCacheKey(const CanonicalQuery& cq,
+                                               const CollectionPtr& collection,
+                                               const QuerySolution& solution);
 
 /**
  * A helper method to get the global SBE plan cache decorated in 'serviceCtx'.
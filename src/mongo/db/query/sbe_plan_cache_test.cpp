@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for the SBE plan cache.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_plan_cache.h"
+
+#include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::sbe {
+namespace {
+
+PlanCacheKey makeKey(StringData name, const UUID& collectionUuid) {
+    BSONObjBuilder bob;
+    bob.append("filter", name);
+    collectionUuid.appendToBuilder(&bob, "collectionUuid");
+    return PlanCacheKey{bob.obj(), collectionUuid};
+}
+
+std::unique_ptr<CachedSbePlan> makePlan() {
+    return std::make_unique<CachedSbePlan>(
+        makeS<CoScanStage>(kEmptyPlanNodeId),
+        stage_builder::PlanStageData(std::make_unique<RuntimeEnvironment>()));
+}
+
+TEST(SbePlanCacheTest, RemoveCollectionEntriesOnlyRemovesEntriesOfThatCollection) {
+    PlanCache cache(10);
+    auto uuid = UUID::gen();
+    auto otherUuid = UUID::gen();
+    cache.set(makeKey("a", uuid), makePlan());
+    cache.set(makeKey("b", uuid), makePlan());
+    cache.set(makeKey("a", otherUuid), makePlan());
+    ASSERT_EQ(3u, cache.size());
+
+    cache.removeCollectionEntries(uuid);
+    ASSERT_EQ(1u, cache.size());
+    ASSERT_FALSE(cache.getClone(makeKey("a", uuid)));
+    ASSERT_FALSE(cache.getClone(makeKey("b", uuid)));
+    ASSERT_TRUE(cache.getClone(makeKey("a", otherUuid)));
+
+    // Removing the entries of a collection without any is a no-op.
+    cache.removeCollectionEntries(uuid);
+    ASSERT_EQ(1u, cache.size());
+}
+
+TEST(SbePlanCacheTest, GetCloneCountsHitsAndMisses) {
+    PlanCache cache(10);
+    auto key = makeKey("a", UUID::gen());
+    const auto hits = PlanCache::sbePlanCacheHits.get();
+    const auto misses = PlanCache::sbePlanCacheMisses.get();
+
+    ASSERT_FALSE(cache.getClone(key));
+    cache.set(key, makePlan());
+    ASSERT_TRUE(cache.getClone(key));
+
+    ASSERT_EQ(hits + 1, PlanCache::sbePlanCacheHits.get());
+    ASSERT_EQ(misses + 1, PlanCache::sbePlanCacheMisses.get());
+}
+
+}  // namespace
+}  // namespace mongo::sbe
@@ -34,10 +34,12 @@
 #include "mongo/db/query/sbe_stage_builder.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
+#include "mongo/db/exec/sbe/stages/ix_scan.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
 #include "mongo/db/exec/sbe/stages/loop_join.h"
 #include "mongo/db/exec/sbe/stages/makeobj.h"
@@ -49,16 +51,25 @@
 #include "mongo/db/exec/sbe/stages/traverse.h"
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unique.h"
+#include "mongo/db/exec/sbe/stages/unwind.h"
+#include "mongo/db/exec/sbe/stages/window.h"
 #include "mongo/db/exec/sbe/values/sort_spec.h"
 #include "mongo/db/exec/shard_filterer.h"
 #include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/fts/fts_query_impl.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/fts_access_method.h"
+#include "mongo/db/pipeline/document_source_set_window_fields.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_request_helper.h"
+#include "mongo/db/query/sbe_stage_builder_accumulator.h"
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
+#include "mongo/db/query/sbe_stage_builder_expression.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/sbe_stage_builder_index_scan.h"
 #include "mongo/db/query/sbe_stage_builder_projection.h"
+#include "mongo/db/query/sbe_stage_builder_window_function.h"
 #include "mongo/db/query/util/make_data_structure.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/storage/execution_context.h"
@@ -669,6 +680,12 @@ SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
             break;
         }
     }
+
+    // $group and $lookup produce new documents which have no record id.
+    if (!getAllNodesByType(solution.root(), STAGE_GROUP).empty() ||
+        !getAllNodesByType(solution.root(), STAGE_EQ_LOOKUP).empty()) {
+        _shouldProduceRecordIdSlot = false;
+    }
 }
 
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolutionNode* root) {
@@ -692,18 +709,39 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolution
     invariant(!_shouldProduceRecordIdSlot || outputs.has(kRecordId));
 
     _data.outputs = std::move(outputs);
+    _data.inputParamToSlotMap = std::move(_state.inputParamToSlotMap);
+    _data.variableIdToSlotMap = std::move(_state.globalVariables);
+    _data.indexBoundsSlots = std::move(_state.indexBoundsSlots);
+    _data.hasNonParameterizedIndexBounds = _state.hasNonParameterizedIndexBounds;
 
     return std::move(stage);
 }
 
+namespace {
+/**
+ * A parallel scan does not preserve the natural order of the documents, so it cannot be used when
+ * the query asks for that order.
+ */
+bool allowsParallelCollScan(const CanonicalQuery& cq) {
+    const auto& findCommand = cq.getFindCommandRequest();
+    return !findCommand.getSort()[query_request_helper::kNaturalSortField] &&
+        !findCommand.getHint()[query_request_helper::kNaturalSortField];
+}
+}  // namespace
+
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildCollScan(
     const QuerySolutionNode* root, const PlanStageReqs& reqs) {
     invariant(!reqs.getIndexKeyBitset());
 
     auto csn = static_cast<const CollectionScanNode*>(root);
 
-    auto [stage, outputs] = generateCollScan(
-        _state, _collection, csn, _yieldPolicy, reqs.getIsTailableCollScanResumeBranch());
+    auto [stage, outputs] = generateCollScan(_state,
+                                             _collection,
+                                             csn,
+                                             _yieldPolicy,
+                                             reqs.getIsTailableCollScanResumeBranch(),
+                                             allowsParallelCollScan(_cq),
+                                             reqs.getExchangeProducers());
 
     if (reqs.has(kReturnKey)) {
         // Assign the 'returnKeySlot' to be the empty object.
@@ -1907,6 +1945,8 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
         outputs.set(kIndexKeyPattern, slot);
     }
 
+    // The children are joined on their record ids, so each HashJoinStage drops the inner rows
+    // which are not in the bitmap of its outer record ids without probing its hash table.
     auto hashJoinStage = sbe::makeS<sbe::HashJoinStage>(std::move(outerStage),
                                                         std::move(innerStage),
                                                         outerCondSlots,
@@ -1914,6 +1954,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                         innerCondSlots,
                                                         innerProjectSlots,
                                                         collatorSlot,
+                                                        _cq.getExpCtx()->allowDiskUse,
                                                         root->nodeId());
 
     // If there are more than 2 children, iterate all remaining children and hash
@@ -1936,6 +1977,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                        innerCondSlots,
                                                        innerProjectSlots,
                                                        collatorSlot,
+                                                       _cq.getExpCtx()->allowDiskUse,
                                                        root->nodeId());
     }
 
@@ -2381,6 +2423,800 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
             std::move(outputs)};
 }
 
+namespace {
+/**
+ * Returns an expression which is true if the 'foreignField' of the document in 'foreignRecordSlot'
+ * matches the local join key in 'localKeySlot', that is if it is equal to the key or is an array
+ * holding the key. A missing 'foreignField' matches a null key.
+ */
+std::unique_ptr<sbe::EExpression> makeLookupMatchExpr(const std::string& foreignField,
+                                                      sbe::value::SlotId foreignRecordSlot,
+                                                      sbe::value::SlotId localKeySlot,
+                                                      sbe::RuntimeEnvironment* env) {
+    auto foreignValue = [&]() {
+        return makeFillEmptyNull(makeFunction(
+            "getField", makeVariable(foreignRecordSlot), makeConstant(foreignField)));
+    };
+    return makeBinaryOp(
+        sbe::EPrimBinary::logicOr,
+        makeFillEmptyFalse(makeBinaryOp(
+            sbe::EPrimBinary::eq, foreignValue(), makeVariable(localKeySlot), env)),
+        makeFillEmptyFalse(makeIsMember(makeVariable(localKeySlot), foreignValue(), env)));
+}
+}  // namespace
+
+std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildLookupForKey(
+    const EqLookupNode* eqLookupNode,
+    const CollectionPtr& foreignColl,
+    sbe::value::SlotId localKeySlot,
+    sbe::value::SlotId foreignRecordSlot,
+    sbe::value::SlotId foreignRecordIdSlot) {
+    const auto nodeId = eqLookupNode->nodeId();
+    const auto foreignField = eqLookupNode->joinFieldForeign.fullPath();
+    auto collatorSlot = _data.env->getSlotIfExists("collator"_sd);
+
+    switch (eqLookupNode->lookupStrategy) {
+        case EqLookupNode::LookupStrategy::kNestedLoopJoin: {
+            //  filter {match(foreignRecordSlot, localKeySlot)}
+            //  scan foreignRecordSlot foreignRecordIdSlot @foreign
+            auto scanStage = sbe::makeS<sbe::ScanStage>(foreignColl->uuid(),
+                                                        foreignRecordSlot,
+                                                        foreignRecordIdSlot,
+                                                        boost::none,
+                                                        boost::none,
+                                                        boost::none,
+                                                        boost::none,
+                                                        boost::none,
+                                                        std::vector<std::string>{},
+                                                        sbe::makeSV(),
+                                                        boost::none,
+                                                        true /* forward */,
+                                                        _yieldPolicy,
+                                                        nodeId,
+                                                        sbe::ScanCallbacks{});
+            return sbe::makeS<sbe::FilterStage<false>>(
+                std::move(scanStage),
+                makeLookupMatchExpr(foreignField, foreignRecordSlot, localKeySlot, _data.env),
+                nodeId);
+        }
+        case EqLookupNode::LookupStrategy::kHashJoin: {
+            // The foreign collection is hashed once, on the first open, keyed by every value of
+            // 'foreignField'. Each lookup then seeks the hash table with the local key:
+            //
+            //  project [foreignRecordIdSlot = getElement(pairSlot, 0),
+            //           foreignRecordSlot = getElement(pairSlot, 1)]
+            //  unwind pairSlot matchesSlot
+            //  group [foreignKeySlot] [matchesSlot = addToArray([buildRidSlot, buildRecordSlot])]
+            //        seek [localKeySlot]
+            //  filter {exists(foreignKeySlot)}
+            //  unwind foreignKeySlot foreignValueSlot
+            //  project [foreignValueSlot = getField(buildRecordSlot, foreignField) ?: null]
+            //  scan buildRecordSlot buildRidSlot @foreign
+            auto buildRecordSlot = _slotIdGenerator.generate();
+            auto buildRidSlot = _slotIdGenerator.generate();
+            auto foreignValueSlot = _slotIdGenerator.generate();
+            auto foreignKeySlot = _slotIdGenerator.generate();
+            auto matchesSlot = _slotIdGenerator.generate();
+            auto pairSlot = _slotIdGenerator.generate();
+
+            std::unique_ptr<sbe::PlanStage> stage =
+                sbe::makeS<sbe::ScanStage>(foreignColl->uuid(),
+                                           buildRecordSlot,
+                                           buildRidSlot,
+                                           boost::none,
+                                           boost::none,
+                                           boost::none,
+                                           boost::none,
+                                           boost::none,
+                                           std::vector<std::string>{},
+                                           sbe::makeSV(),
+                                           boost::none,
+                                           true /* forward */,
+                                           _yieldPolicy,
+                                           nodeId,
+                                           sbe::ScanCallbacks{});
+            stage = sbe::makeProjectStage(
+                std::move(stage),
+                nodeId,
+                foreignValueSlot,
+                makeFillEmptyNull(makeFunction(
+                    "getField", makeVariable(buildRecordSlot), makeConstant(foreignField))));
+            stage = sbe::makeS<sbe::UnwindStage>(std::move(stage),
+                                                 foreignValueSlot,
+                                                 foreignKeySlot,
+                                                 _slotIdGenerator.generate(),
+                                                 true /* preserveNullAndEmptyArrays */,
+                                                 nodeId);
+            stage = sbe::makeS<sbe::FilterStage<false>>(
+                std::move(stage), makeFunction("exists", makeVariable(foreignKeySlot)), nodeId);
+
+            sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs;
+            aggs.emplace(matchesSlot,
+                         makeFunction("addToArray",
+                                      makeFunction("newArray",
+                                                   makeVariable(buildRidSlot),
+                                                   makeVariable(buildRecordSlot))));
+            stage = sbe::makeS<sbe::HashAggStage>(std::move(stage),
+                                                  sbe::makeSV(foreignKeySlot),
+                                                  std::move(aggs),
+                                                  sbe::makeSV(localKeySlot),
+                                                  true /* optimizedClose */,
+                                                  collatorSlot,
+                                                  false /* allowDiskUse */,
+                                                  sbe::HashAggStage::MergingExprMap{},
+                                                  nodeId);
+
+            stage = sbe::makeS<sbe::UnwindStage>(std::move(stage),
+                                                 matchesSlot,
+                                                 pairSlot,
+                                                 _slotIdGenerator.generate(),
+                                                 false /* preserveNullAndEmptyArrays */,
+                                                 nodeId);
+            return sbe::makeProjectStage(
+                std::move(stage),
+                nodeId,
+                foreignRecordIdSlot,
+                makeFunction("getElement",
+                             makeVariable(pairSlot),
+                             makeConstant(sbe::value::TypeTags::NumberInt32, 0)),
+                foreignRecordSlot,
+                makeFunction("getElement",
+                             makeVariable(pairSlot),
+                             makeConstant(sbe::value::TypeTags::NumberInt32, 1)));
+        }
+        case EqLookupNode::LookupStrategy::kIndexedLoopJoin: {
+            // Seek the foreign index for all the keys prefixed by the local key and fetch the
+            // matching documents. The join predicate is re-applied to the fetched documents so
+            // that they are only returned if they still match:
+            //
+            //  filter {match(foreignRecordSlot, localKeySlot)}
+            //  nlj [foreignRecordIdSlot] [foreignRecordIdSlot]
+            //    left
+            //      nlj [] [lowKeySlot, highKeySlot]
+            //        left
+            //          project [lowKeySlot = ks(localKey, kExclusiveBefore),
+            //                   highKeySlot = ks(localKey, kExclusiveAfter)]
+            //          limit 1
+            //          coscan
+            //        right
+            //          ixseek lowKeySlot highKeySlot foreignRecordIdSlot @foreign @index
+            //    right
+            //      limit 1
+            //      seek foreignRecordIdSlot foreignRecordSlot @foreign
+            tassert(6000407,
+                    "Indexed loop join $lookup requires an index",
+                    eqLookupNode->idxEntry.has_value());
+            const auto& indexName = eqLookupNode->idxEntry->identifier.catalogName;
+            auto descriptor = foreignColl->getIndexCatalog()->findIndexByName(_opCtx, indexName);
+            tassert(6000408,
+                    str::stream() << "Index " << indexName << " not found on "
+                                  << eqLookupNode->foreignCollection,
+                    descriptor);
+            auto sortedData = foreignColl->getIndexCatalog()
+                                  ->getEntry(descriptor)
+                                  ->accessMethod()
+                                  ->getSortedDataInterface();
+
+            auto makeKeyExpr = [&](KeyString::Discriminator discriminator) {
+                auto key = makeVariable(localKeySlot);
+                if (collatorSlot) {
+                    key = makeFunction(
+                        "collComparisonKey", std::move(key), makeVariable(*collatorSlot));
+                }
+                return makeFunction(
+                    "ks",
+                    makeConstant(sbe::value::TypeTags::NumberInt64,
+                                 static_cast<int64_t>(sortedData->getKeyStringVersion())),
+                    makeConstant(sbe::value::TypeTags::NumberInt32,
+                                 sortedData->getOrdering().get(0) == -1 ? 1 : 0),
+                    std::move(key),
+                    makeConstant(sbe::value::TypeTags::NumberInt64,
+                                 static_cast<int64_t>(discriminator)));
+            };
+
+            auto lowKeySlot = _slotIdGenerator.generate();
+            auto highKeySlot = _slotIdGenerator.generate();
+            auto boundsStage =
+                sbe::makeProjectStage(makeLimitCoScanTree(nodeId),
+                                      nodeId,
+                                      lowKeySlot,
+                                      makeKeyExpr(KeyString::Discriminator::kExclusiveBefore),
+                                      highKeySlot,
+                                      makeKeyExpr(KeyString::Discriminator::kExclusiveAfter));
+            auto ixScanStage = sbe::makeS<sbe::IndexScanStage>(foreignColl->uuid(),
+                                                               indexName,
+                                                               true /* forward */,
+                                                               boost::none,
+                                                               foreignRecordIdSlot,
+                                                               boost::none,
+                                                               sbe::IndexKeysInclusionSet{},
+                                                               sbe::makeSV(),
+                                                               lowKeySlot,
+                                                               highKeySlot,
+                                                               _yieldPolicy,
+                                                               nodeId);
+            auto seekStage = sbe::makeS<sbe::LoopJoinStage>(std::move(boundsStage),
+                                                            std::move(ixScanStage),
+                                                            sbe::makeSV(),
+                                                            sbe::makeSV(lowKeySlot, highKeySlot),
+                                                            nullptr,
+                                                            nodeId);
+
+            auto fetchStage = sbe::makeS<sbe::ScanStage>(foreignColl->uuid(),
+                                                         foreignRecordSlot,
+                                                         boost::none,
+                                                         boost::none,
+                                                         boost::none,
+                                                         boost::none,
+                                                         boost::none,
+                                                         boost::none,
+                                                         std::vector<std::string>{},
+                                                         sbe::makeSV(),
+                                                         foreignRecordIdSlot,
+                                                         true /* forward */,
+                                                         _yieldPolicy,
+                                                         nodeId,
+                                                         sbe::ScanCallbacks{});
+            auto stage = sbe::makeS<sbe::LoopJoinStage>(
+                std::move(seekStage),
+                sbe::makeS<sbe::LimitSkipStage>(std::move(fetchStage), 1, boost::none, nodeId),
+                sbe::makeSV(foreignRecordIdSlot),
+                sbe::makeSV(foreignRecordIdSlot),
+                nullptr,
+                nodeId);
+            return sbe::makeS<sbe::FilterStage<false>>(
+                std::move(stage),
+                makeLookupMatchExpr(foreignField, foreignRecordSlot, localKeySlot, _data.env),
+                nodeId);
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildEqLookup(
+    const QuerySolutionNode* root, const PlanStageReqs& reqs) {
+    const auto eqLookupNode = static_cast<const EqLookupNode*>(root);
+    const auto nodeId = root->nodeId();
+    tassert(6000406,
+            "$lookup can only produce result documents",
+            !reqs.has(kRecordId) && !reqs.has(kReturnKey) && !reqs.getIndexKeyBitset());
+
+    PlanStageReqs childReqs;
+    childReqs.set(kResult);
+    auto [stage, childOutputs] = build(eqLookupNode->children[0], childReqs);
+    auto localRecordSlot = childOutputs.get(kResult);
+
+    // The local join value. A missing value joins with null or missing foreign values.
+    auto localValueSlot = _slotIdGenerator.generate();
+    stage = sbe::makeProjectStage(
+        std::move(stage),
+        nodeId,
+        localValueSlot,
+        makeFillEmptyNull(makeFunction("getField",
+                                       makeVariable(localRecordSlot),
+                                       makeConstant(eqLookupNode->joinFieldLocal.fullPath()))));
+
+    // Every element of a local array is looked up separately, and a foreign document matching more
+    // than one of them must only be returned once:
+    //
+    //  group [] [matchesSlot = addToArray(foreignRecordSlot)]
+    //  unique [foreignRecordIdSlot]
+    //  nlj [] [localKeySlot]
+    //    left
+    //      filter {exists(localKeySlot)}
+    //      unwind localKeySlot localValueSlot
+    //      limit 1
+    //      coscan
+    //    right
+    //      <lookup for key>
+    auto localKeySlot = _slotIdGenerator.generate();
+    auto foreignRecordSlot = _slotIdGenerator.generate();
+    auto foreignRecordIdSlot = _slotIdGenerator.generate();
+    auto matchesSlot = _slotIdGenerator.generate();
+
+    auto foreignColl = CollectionCatalog::get(_opCtx)->lookupCollectionByNamespace(
+        _opCtx, eqLookupNode->foreignCollection);
+    auto lookupStage = [&]() -> std::unique_ptr<sbe::PlanStage> {
+        if (!foreignColl) {
+            // A missing foreign collection matches nothing.
+            return sbe::makeProjectStage(
+                makeLimitCoScanTree(nodeId, 0),
+                nodeId,
+                foreignRecordSlot,
+                makeConstant(sbe::value::TypeTags::Nothing, 0),
+                foreignRecordIdSlot,
+                makeConstant(sbe::value::TypeTags::Nothing, 0));
+        }
+        return buildLookupForKey(
+            eqLookupNode, foreignColl, localKeySlot, foreignRecordSlot, foreignRecordIdSlot);
+    }();
+
+    std::unique_ptr<sbe::PlanStage> keysStage =
+        sbe::makeS<sbe::UnwindStage>(makeLimitCoScanTree(nodeId),
+                                     localValueSlot,
+                                     localKeySlot,
+                                     _slotIdGenerator.generate(),
+                                     true /* preserveNullAndEmptyArrays */,
+                                     nodeId);
+    keysStage = sbe::makeS<sbe::FilterStage<false>>(
+        std::move(keysStage), makeFunction("exists", makeVariable(localKeySlot)), nodeId);
+
+    std::unique_ptr<sbe::PlanStage> innerStage =
+        sbe::makeS<sbe::LoopJoinStage>(std::move(keysStage),
+                                       std::move(lookupStage),
+                                       sbe::makeSV(),
+                                       sbe::makeSV(localKeySlot),
+                                       nullptr,
+                                       nodeId);
+    innerStage = sbe::makeS<sbe::UniqueStage>(
+        std::move(innerStage), sbe::makeSV(foreignRecordIdSlot), nodeId);
+
+    // The hash table built by a kHashJoin lookup must survive across local documents, so the group
+    // must not close its input once it is drained.
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs;
+    aggs.emplace(matchesSlot, makeFunction("addToArray", makeVariable(foreignRecordSlot)));
+    innerStage = sbe::makeS<sbe::HashAggStage>(std::move(innerStage),
+                                               sbe::makeSV(),
+                                               std::move(aggs),
+                                               sbe::makeSV(),
+                                               false /* optimizedClose */,
+                                               boost::none /* collatorSlot */,
+                                               false /* allowDiskUse */,
+                                               sbe::HashAggStage::MergingExprMap{},
+                                               nodeId);
+
+    // The traverse stage executes the inner side once per local document, and leaves 'joinSlot'
+    // empty when no foreign document matched, making this a left outer join.
+    auto joinSlot = _slotIdGenerator.generate();
+    stage = sbe::makeS<sbe::TraverseStage>(std::move(stage),
+                                           std::move(innerStage),
+                                           localRecordSlot,
+                                           joinSlot,
+                                           matchesSlot,
+                                           sbe::makeSV(localValueSlot),
+                                           nullptr,
+                                           nullptr,
+                                           nodeId,
+                                           boost::none);
+
+    auto asValueSlot = _slotIdGenerator.generate();
+    stage = sbe::makeProjectStage(
+        std::move(stage),
+        nodeId,
+        asValueSlot,
+        makeFunction("fillEmpty", makeVariable(joinSlot), makeFunction("newArray")));
+
+    const auto asField = eqLookupNode->joinField.fullPath();
+    PlanStageSlots outputs;
+    auto resultSlot = _slotIdGenerator.generate();
+    outputs.set(kResult, resultSlot);
+    stage = sbe::makeS<sbe::MakeBsonObjStage>(std::move(stage),
+                                              resultSlot,
+                                              localRecordSlot,
+                                              sbe::MakeBsonObjStage::FieldBehavior::drop,
+                                              std::vector<std::string>{asField},
+                                              std::vector<std::string>{asField},
+                                              sbe::makeSV(asValueSlot),
+                                              true /* forceNewObject */,
+                                              false /* returnOldObject */,
+                                              nodeId);
+
+    return {std::move(stage), std::move(outputs)};
+}
+
+namespace {
+/**
+ * Returns the index scan below 'groupNode' if the $group can be computed from the keys of this
+ * index alone, in which case 'fields' holds the fields the $group reads. This requires the child of
+ * the $group to be either the index scan itself or a FETCH without a filter over it, the index to
+ * hold every one of the 'fields', and none of these fields to be multikey. Returns nullptr
+ * otherwise.
+ */
+const IndexScanNode* getIndexScanCoveringGroup(const GroupNode* groupNode,
+                                               const StringSet& fields) {
+    auto child = groupNode->children[0];
+    if (child->getType() == STAGE_FETCH && !child->filter) {
+        child = child->children[0];
+    }
+    if (child->getType() != STAGE_IXSCAN) {
+        return nullptr;
+    }
+
+    auto ixn = static_cast<const IndexScanNode*>(child);
+    const auto& index = ixn->index;
+    // The keys of a collation-aware index hold collation keys in place of the strings themselves.
+    if (index.type != INDEX_BTREE || index.collator) {
+        return nullptr;
+    }
+
+    size_t numCoveredFields = 0;
+    size_t pos = 0;
+    for (auto&& elem : index.keyPattern) {
+        if (fields.count(elem.fieldName())) {
+            if (index.multikey &&
+                (index.multikeyPaths.empty() || !index.multikeyPaths[pos].empty())) {
+                return nullptr;
+            }
+            ++numCoveredFields;
+        }
+        ++pos;
+    }
+    return numCoveredFields == fields.size() ? ixn : nullptr;
+}
+
+/**
+ * Returns true if 'ixn' returns the index keys holding equal values of 'field' next to each other.
+ * This is the case when 'field' is the first field of the index, or when every field before it is
+ * bound to a single point.
+ */
+bool indexScanGroupsByField(const IndexScanNode* ixn, StringData field) {
+    if (ixn->bounds.isSimpleRange) {
+        return ixn->index.keyPattern.firstElementFieldNameStringData() == field;
+    }
+
+    for (auto&& oil : ixn->bounds.fields) {
+        if (oil.name == field) {
+            return true;
+        }
+        if (oil.intervals.size() != 1 || !oil.intervals[0].isPoint()) {
+            return false;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildGroup(
+    const QuerySolutionNode* root, const PlanStageReqs& reqs) {
+    const auto groupNode = static_cast<const GroupNode*>(root);
+    const auto nodeId = root->nodeId();
+    tassert(6001006,
+            "$group can only produce result documents",
+            !reqs.has(kRecordId) && !reqs.has(kReturnKey) && !reqs.getIndexKeyBitset());
+    tassert(6001007, "Merging partial $group results is not supported", !groupNode->doingMerge);
+
+    const auto& groupByExprs = groupNode->groupByExpressions;
+    const bool isSingleId = groupByExprs.size() == 1 && groupByExprs[0].first == "_id"_sd;
+
+    // All of the rows belong to the same group when the group-by expressions are constants (e.g.
+    // '_id: null'), in which case there is no need to hash them.
+    bool isStreaming =
+        std::all_of(groupByExprs.begin(), groupByExprs.end(), [](const auto& groupByExpr) {
+            return dynamic_cast<const ExpressionConstant*>(groupByExpr.second.get()) != nullptr;
+        });
+
+    EvalStage stage;
+    size_t degreeOfParallelism = 1;
+    std::vector<std::unique_ptr<sbe::EExpression>> groupByKeyExprs;
+    std::vector<std::unique_ptr<sbe::EExpression>> argExprs;
+    auto coveredFields = getGroupFieldsCoverableByIndexKeys(groupNode->groupByExpressions,
+                                                            groupNode->accumulators);
+    if (auto ixn = coveredFields ? getIndexScanCoveringGroup(groupNode, *coveredFields) : nullptr) {
+        // Compute the $group directly from the slots of the index key fields it reads, skipping
+        // the FETCH of the documents altogether.
+        PlanStageReqs childReqs;
+        auto [indexKeyBitset, keyFieldNames] =
+            makeIndexKeyInclusionSet(ixn->index.keyPattern, *coveredFields);
+        childReqs.getIndexKeyBitset() = std::move(indexKeyBitset);
+        auto [ixStage, outputs] = build(ixn, childReqs);
+        stage.stage = std::move(ixStage);
+
+        auto indexKeySlots = *outputs.extractIndexKeySlots();
+        StringMap<sbe::value::SlotId> fieldSlots;
+        for (size_t idx = 0; idx < keyFieldNames.size(); ++idx) {
+            fieldSlots.emplace(keyFieldNames[idx], indexKeySlots[idx]);
+        }
+
+        // The index returns the rows of a group contiguously when it is ordered by the group-by
+        // field, unless the groups are formed according to a collation the index is unaware of.
+        if (auto groupByExpr =
+                dynamic_cast<const ExpressionFieldPath*>(groupByExprs[0].second.get());
+            groupByExpr && !_cq.getCollator()) {
+            isStreaming = isStreaming ||
+                indexScanGroupsByField(ixn,
+                                       groupByExpr->getFieldPathWithoutCurrentPrefix().fullPath());
+        }
+
+        for (auto&& [_, expr] : groupByExprs) {
+            groupByKeyExprs.push_back(buildExpressionFromFieldSlots(expr.get(), fieldSlots));
+        }
+        for (auto&& acc : groupNode->accumulators) {
+            argExprs.push_back(buildExpressionFromFieldSlots(acc.expr.argument.get(), fieldSlots));
+        }
+    } else {
+        PlanStageReqs childReqs;
+        childReqs.set(kResult);
+
+        // A $group directly over a large collection scan is computed in two phases. Every producer
+        // of an exchange aggregates its share of the documents, and the partial aggregates are
+        // merged above the exchange.
+        const auto child = groupNode->children[0];
+        if (!isStreaming && child->getType() == STAGE_COLLSCAN &&
+            std::all_of(groupNode->accumulators.begin(),
+                        groupNode->accumulators.end(),
+                        [](const auto& acc) { return canCombinePartialAggs(acc); })) {
+            degreeOfParallelism =
+                getCollScanDegreeOfParallelism(_state.opCtx,
+                                               _collection,
+                                               static_cast<const CollectionScanNode*>(child),
+                                               false /* isTailableResumeBranch */,
+                                               allowsParallelCollScan(_cq));
+
+            // Every producer fills a hash table of its own, and together they must stay within the
+            // memory a single $group may use.
+            const long long maxGroupBytes = internalDocumentSourceGroupMaxMemoryBytes.load();
+            const long long hashTableBytes = std::min(
+                internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load(), maxGroupBytes);
+            if (static_cast<long long>(degreeOfParallelism) * hashTableBytes > maxGroupBytes) {
+                degreeOfParallelism = 1;
+            }
+            if (degreeOfParallelism > 1) {
+                childReqs.setExchangeProducers(degreeOfParallelism);
+            }
+        }
+
+        auto [childStage, outputs] = build(child, childReqs);
+        stage.stage = std::move(childStage);
+        auto resultSlot = outputs.get(kResult);
+
+        for (auto&& [_, expr] : groupByExprs) {
+            auto [groupByExpr, outStage] =
+                generateExpression(_state, expr.get(), std::move(stage), resultSlot, nodeId);
+            stage = std::move(outStage);
+            groupByKeyExprs.push_back(groupByExpr.extractExpr());
+        }
+        for (auto&& acc : groupNode->accumulators) {
+            auto [argExpr, outStage] =
+                buildArgument(_state, acc, std::move(stage), resultSlot, nodeId);
+            stage = std::move(outStage);
+            argExprs.push_back(std::move(argExpr));
+        }
+    }
+
+    // A missing '_id' groups along with null, as the classic engine turns it into null. The fields
+    // of a compound '_id' are left missing instead: such a field is dropped from the '_id' document
+    // and groups apart from a null one.
+    sbe::value::SlotVector groupBySlots;
+    for (auto&& keyExpr : groupByKeyExprs) {
+        auto [slot, outStage] =
+            projectEvalExpr(isSingleId ? makeFillEmptyNull(std::move(keyExpr)) : std::move(keyExpr),
+                            std::move(stage),
+                            nodeId,
+                            &_slotIdGenerator);
+        stage = std::move(outStage);
+        groupBySlots.push_back(slot);
+    }
+
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs;
+    std::vector<sbe::value::SlotVector> aggSlotsByAcc;
+    for (size_t idx = 0; idx < groupNode->accumulators.size(); ++idx) {
+        auto [aggExprs, outStage] = buildAccumulator(_state,
+                                                     groupNode->accumulators[idx],
+                                                     std::move(stage),
+                                                     std::move(argExprs[idx]),
+                                                     nodeId);
+        stage = std::move(outStage);
+
+        sbe::value::SlotVector aggSlots;
+        for (auto&& aggExpr : aggExprs) {
+            aggSlots.push_back(_slotIdGenerator.generate());
+            aggs.emplace(aggSlots.back(), std::move(aggExpr));
+        }
+        aggSlotsByAcc.push_back(std::move(aggSlots));
+    }
+
+    auto collatorSlot = _state.env->getSlotIfExists("collator"_sd);
+    if (isStreaming) {
+        stage = makeStreamingAgg(
+            std::move(stage), groupBySlots, std::move(aggs), collatorSlot, nodeId);
+    } else if (degreeOfParallelism > 1) {
+        // The combining expression of an aggregate only reads the partial aggregate at its own
+        // position among the aggregates of the accumulator, so that position alone is filled in.
+        sbe::value::SlotMap<MakeMergingExprFn> makeMergingExprs;
+        for (size_t idx = 0; idx < groupNode->accumulators.size(); ++idx) {
+            const auto& acc = groupNode->accumulators[idx];
+            const auto& aggSlots = aggSlotsByAcc[idx];
+            for (size_t slotIdx = 0; slotIdx < aggSlots.size(); ++slotIdx) {
+                makeMergingExprs.emplace(
+                    aggSlots[slotIdx],
+                    [this, &acc, numSlots = aggSlots.size(), slotIdx](
+                        sbe::value::SlotId partialSlot) {
+                        auto combineExprs = buildCombinePartialAggs(
+                            _state, acc, sbe::value::SlotVector(numSlots, partialSlot));
+                        return std::move(combineExprs[slotIdx]);
+                    });
+            }
+        }
+
+        auto [parallelStage, finalSlots] = makeParallelHashAgg(std::move(stage),
+                                                               degreeOfParallelism,
+                                                               groupBySlots,
+                                                               std::move(aggs),
+                                                               makeMergingExprs,
+                                                               collatorSlot,
+                                                               _cq.getExpCtx()->allowDiskUse,
+                                                               _yieldPolicy,
+                                                               nodeId,
+                                                               &_slotIdGenerator);
+        stage = std::move(parallelStage);
+        for (auto&& aggSlots : aggSlotsByAcc) {
+            for (auto&& slot : aggSlots) {
+                slot = finalSlots.at(slot);
+            }
+        }
+    } else {
+        // The hash table may only spill to disk if the partial aggregates of every accumulator can
+        // be combined once they are read back.
+        const bool allowDiskUse = _cq.getExpCtx()->allowDiskUse &&
+            std::all_of(groupNode->accumulators.begin(),
+                        groupNode->accumulators.end(),
+                        [](const auto& acc) { return canCombinePartialAggs(acc); });
+        sbe::HashAggStage::MergingExprMap mergingExprs;
+        if (allowDiskUse) {
+            for (size_t idx = 0; idx < groupNode->accumulators.size(); ++idx) {
+                const auto& aggSlots = aggSlotsByAcc[idx];
+                auto spilledSlots = _slotIdGenerator.generateMultiple(aggSlots.size());
+                auto combineExprs = buildCombinePartialAggs(
+                    _state, groupNode->accumulators[idx], spilledSlots);
+                for (size_t slotIdx = 0; slotIdx < aggSlots.size(); ++slotIdx) {
+                    mergingExprs.emplace(
+                        aggSlots[slotIdx],
+                        std::make_pair(spilledSlots[slotIdx], std::move(combineExprs[slotIdx])));
+                }
+            }
+        }
+        stage = makeHashAgg(std::move(stage),
+                            groupBySlots,
+                            std::move(aggs),
+                            collatorSlot,
+                            nodeId,
+                            allowDiskUse,
+                            std::move(mergingExprs));
+    }
+
+    sbe::EExpression::Vector newObjArgs;
+    newObjArgs.push_back(makeConstant("_id"_sd));
+    if (isSingleId) {
+        newObjArgs.push_back(makeVariable(groupBySlots[0]));
+    } else {
+        // The fields of a compound '_id' are named "_id.<field>".
+        sbe::EExpression::Vector idArgs;
+        for (size_t idx = 0; idx < groupByExprs.size(); ++idx) {
+            StringData fieldName = groupByExprs[idx].first;
+            idArgs.push_back(makeConstant(fieldName.substr("_id."_sd.size())));
+            idArgs.push_back(makeVariable(groupBySlots[idx]));
+        }
+        newObjArgs.push_back(sbe::makeE<sbe::EFunction>("newObj", std::move(idArgs)));
+    }
+    for (size_t idx = 0; idx < groupNode->accumulators.size(); ++idx) {
+        const auto& acc = groupNode->accumulators[idx];
+        auto [finalExpr, outStage] =
+            buildFinalize(_state, acc, aggSlotsByAcc[idx], std::move(stage), nodeId);
+        stage = std::move(outStage);
+        newObjArgs.push_back(makeConstant(acc.fieldName));
+        newObjArgs.push_back(std::move(finalExpr));
+    }
+
+    PlanStageSlots outputs;
+    outputs.set(kResult, _slotIdGenerator.generate());
+    stage = makeProject(std::move(stage),
+                        nodeId,
+                        outputs.get(kResult),
+                        sbe::makeE<sbe::EFunction>("newObj", std::move(newObjArgs)));
+
+    return {std::move(stage.stage), std::move(outputs)};
+}
+
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildWindow(
+    const QuerySolutionNode* root, const PlanStageReqs& reqs) {
+    const auto windowNode = static_cast<const WindowNode*>(root);
+    const auto nodeId = root->nodeId();
+    tassert(6000520,
+            "$_internalSetWindowFields can only produce result documents and record ids",
+            !reqs.has(kReturnKey) && !reqs.getIndexKeyBitset());
+
+    PlanStageReqs childReqs;
+    childReqs.set(kResult).setIf(kRecordId, reqs.has(kRecordId));
+    auto [childStage, outputs] = build(windowNode->children[0], childReqs);
+    EvalStage stage;
+    stage.stage = std::move(childStage);
+    auto resultSlot = outputs.get(kResult);
+
+    auto projectExpr = [&](std::unique_ptr<sbe::EExpression> expr) {
+        auto [slot, outStage] =
+            projectEvalExpr(std::move(expr), std::move(stage), nodeId, &_slotIdGenerator);
+        stage = std::move(outStage);
+        return slot;
+    };
+
+    // The partition key comes first among the slots buffered by the window stage. As in the
+    // classic engine, a missing partition key falls into the null partition and an array is an
+    // error.
+    sbe::value::SlotVector currSlots;
+    if (windowNode->partitionBy) {
+        auto [partitionByExpr, outStage] = generateExpression(
+            _state, windowNode->partitionBy->get(), std::move(stage), resultSlot, nodeId);
+        stage = std::move(outStage);
+        currSlots.push_back(projectExpr(makeLocalBind(
+            &_frameIdGenerator,
+            [](sbe::EVariable partitionKey) {
+                return sbe::makeE<sbe::EIf>(
+                    makeFunction("isArray", partitionKey.clone()),
+                    sbe::makeE<sbe::EFail>(ErrorCodes::TypeMismatch,
+                                           "An expression used to partition cannot evaluate to "
+                                           "value of type array"),
+                    makeFillEmptyNull(partitionKey.clone()));
+            },
+            partitionByExpr.extractExpr())));
+    }
+    const size_t partitionSlotCount = currSlots.size();
+    currSlots.push_back(resultSlot);
+    if (reqs.has(kRecordId)) {
+        currSlots.push_back(outputs.get(kRecordId));
+    }
+
+    // $derivative and $integral read the single field the partition is sorted by.
+    boost::optional<sbe::value::SlotId> sortBySlot;
+    const auto& sortBy = windowNode->sortBy;
+    if (sortBy && sortBy->isSingleElementKey() && (*sortBy)[0].fieldPath) {
+        auto sortByExpr = ExpressionFieldPath::createPathFromString(
+            _cq.getExpCtx().get(),
+            (*sortBy)[0].fieldPath->fullPath(),
+            _cq.getExpCtx()->variablesParseState);
+        auto [sortByEvalExpr, outStage] =
+            generateExpression(_state, sortByExpr.get(), std::move(stage), resultSlot, nodeId);
+        stage = std::move(outStage);
+        sortBySlot = projectExpr(sortByEvalExpr.extractExpr());
+        currSlots.push_back(*sortBySlot);
+    }
+
+    std::vector<sbe::WindowStage::Window> windows;
+    std::vector<std::string> outputFieldNames;
+    std::vector<std::unique_ptr<sbe::EExpression>> finalExprs;
+    for (auto&& outputField : windowNode->outputFields) {
+        auto [argExpr, outStage] = generateExpression(
+            _state, outputField.expr->input().get(), std::move(stage), resultSlot, nodeId);
+        stage = std::move(outStage);
+        auto argSlot = projectExpr(argExpr.extractExpr());
+        currSlots.push_back(argSlot);
+
+        auto translation = buildWindowFunction(_state, *outputField.expr, argSlot, sortBySlot);
+        std::move(translation.windows.begin(),
+                  translation.windows.end(),
+                  std::back_inserter(windows));
+        outputFieldNames.push_back(outputField.fieldName);
+        finalExprs.push_back(std::move(translation.finalExpr));
+    }
+
+    stage.stage = sbe::makeS<sbe::WindowStage>(std::move(stage.stage),
+                                               std::move(currSlots),
+                                               partitionSlotCount,
+                                               std::move(windows),
+                                               _state.env->getSlotIfExists("collator"_sd),
+                                               nodeId);
+
+    sbe::value::SlotVector outputFieldSlots;
+    for (auto&& finalExpr : finalExprs) {
+        outputFieldSlots.push_back(projectExpr(std::move(finalExpr)));
+    }
+
+    // The window functions overwrite the fields of the same name. Unlike in the classic $addFields,
+    // such a field moves to the end of the document.
+    outputs.set(kResult, _slotIdGenerator.generate());
+    stage = makeMkBsonObj(std::move(stage),
+                          outputs.get(kResult),
+                          resultSlot,
+                          sbe::MakeBsonObjStage::FieldBehavior::drop,
+                          std::vector<std::string>{},
+                          std::move(outputFieldNames),
+                          std::move(outputFieldSlots),
+                          false,
+                          true,
+                          nodeId);
+
+    return {std::move(stage.stage), std::move(outputs)};
+}
+
 // Returns a non-null pointer to the root of a plan tree, or a non-OK status if the PlanStage tree
 // could not be constructed.
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::build(
@@ -2412,7 +3248,10 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
             {STAGE_AND_HASH, &SlotBasedStageBuilder::buildAndHash},
             {STAGE_AND_SORTED, &SlotBasedStageBuilder::buildAndSorted},
             {STAGE_SORT_MERGE, &SlotBasedStageBuilder::buildSortMerge},
-            {STAGE_SHARDING_FILTER, &SlotBasedStageBuilder::buildShardFilter}};
+            {STAGE_SHARDING_FILTER, &SlotBasedStageBuilder::buildShardFilter},
+            {STAGE_EQ_LOOKUP, &SlotBasedStageBuilder::buildEqLookup},
+            {STAGE_GROUP, &SlotBasedStageBuilder::buildGroup},
+            {STAGE_WINDOW, &SlotBasedStageBuilder::buildWindow}};
 
     tassert(4822884,
             str::stream() << "Unsupported QSN in SBE stage builder: " << root->toString(),
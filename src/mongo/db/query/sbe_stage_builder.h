@@ -183,6 +183,14 @@ public:
         _isTailableCollScanResumeBranch = b;
     }
 
+    boost::optional<size_t> getExchangeProducers() const {
+        return _exchangeProducers;
+    }
+
+    void setExchangeProducers(boost::optional<size_t> exchangeProducers) {
+        _exchangeProducers = exchangeProducers;
+    }
+
     friend PlanStageSlots::PlanStageSlots(const PlanStageReqs& reqs,
                                           sbe::value::SlotIdGenerator* slotIdGenerator);
 
@@ -204,6 +212,11 @@ private:
     // collection scan, this flag indicates whether we're currently building an anchor or resume
     // branch. At all other times, this flag will be false.
     bool _isTailableCollScanResumeBranch{false};
+
+    // When a parent stage places an exchange above stages of its own, such as the partial
+    // aggregation of a parallel $group, this holds the number of producers of that exchange. The
+    // collection scan below is then split across as many producers, and leaves the exchange out.
+    boost::optional<size_t> _exchangeProducers;
 };
 
 void PlanStageSlots::forEachSlot(const PlanStageReqs& reqs,
@@ -267,6 +280,24 @@ struct PlanStageData {
     // metrics, the stats are cached in here.
     std::unique_ptr<sbe::PlanStageStats> savedStatsOnEarlyExit{nullptr};
 
+    // The following describe the values in the RuntimeEnvironment which depend on the query the
+    // plan was built for. They are used to rebind a plan recovered from the SBE plan cache to the
+    // query being executed.
+    stdx::unordered_map<MatchExpression::InputParamId, sbe::value::SlotId> inputParamToSlotMap;
+    stdx::unordered_map<Variables::Id, sbe::value::SlotId> variableIdToSlotMap;
+    stdx::unordered_map<PlanNodeId, IndexBoundsSlots> indexBoundsSlots;
+    bool hasNonParameterizedIndexBounds{false};
+
+    /**
+     * Makes a copy of this PlanStageData which does not share the RuntimeEnvironment values with
+     * this one, so that the slots of either of them can be rebound independently.
+     */
+    PlanStageData makeDeepCopy() const {
+        PlanStageData copy{env->makeDeepCopy()};
+        copy.copyFrom(*this);
+        return copy;
+    }
+
 private:
     // This copy function copies data from 'other' but will not create a copy of its
     // RuntimeEnvironment and CompileCtx.
@@ -277,6 +308,10 @@ private:
         shouldTrackResumeToken = other.shouldTrackResumeToken;
         shouldUseTailableScan = other.shouldUseTailableScan;
         replanReason = other.replanReason;
+        inputParamToSlotMap = other.inputParamToSlotMap;
+        variableIdToSlotMap = other.variableIdToSlotMap;
+        indexBoundsSlots = other.indexBoundsSlots;
+        hasNonParameterizedIndexBounds = other.hasNonParameterizedIndexBounds;
         if (other.savedStatsOnEarlyExit) {
             savedStatsOnEarlyExit.reset(other.savedStatsOnEarlyExit->clone());
         } else {
@@ -401,6 +436,45 @@ private:
         const QuerySolutionNode* child,
         PlanStageReqs childReqs);
 
+    /**
+     * Lowers an EqLookupNode into a left outer join between its child and the foreign collection.
+     * The per-key lookup is executed according to the node's 'lookupStrategy' (see
+     * 'buildLookupForKey()').
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> buildEqLookup(
+        const QuerySolutionNode* root, const PlanStageReqs& reqs);
+
+    /**
+     * Lowers a GroupNode into an aggregation over its child. When the $group only reads fields of
+     * a non-multikey index scanned by its child, the aggregation is computed from the index key
+     * slots instead of from fetched documents. A StreamingAggStage replaces the HashAggStage
+     * whenever the rows of each group are known to arrive together, i.e. when the group-by key is
+     * a constant or when the index is ordered by the group-by field. The fields of a compound '_id'
+     * keep the order in which the $group spells them out.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> buildGroup(
+        const QuerySolutionNode* root, const PlanStageReqs& reqs);
+
+    /**
+     * Lowers a WindowNode into a WindowStage over its child, which produces the documents grouped
+     * by partition and sorted within each partition. The WindowStage buffers the partition key,
+     * the document and the input of every window function, and the values of the window functions
+     * are then written to the fields of the document.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> buildWindow(
+        const QuerySolutionNode* root, const PlanStageReqs& reqs);
+
+    /**
+     * Builds the sub-tree which produces every document of 'foreignColl' matching the single local
+     * join key held in 'localKeySlot', exposing each document and its record id through
+     * 'foreignRecordSlot' and 'foreignRecordIdSlot'.
+     */
+    std::unique_ptr<sbe::PlanStage> buildLookupForKey(const EqLookupNode* eqLookupNode,
+                                                      const CollectionPtr& foreignColl,
+                                                      sbe::value::SlotId localKeySlot,
+                                                      sbe::value::SlotId foreignRecordSlot,
+                                                      sbe::value::SlotId foreignRecordIdSlot);
+
     sbe::value::SlotIdGenerator _slotIdGenerator;
     sbe::value::FrameIdGenerator _frameIdGenerator;
     sbe::value::SpoolIdGenerator _spoolIdGenerator;
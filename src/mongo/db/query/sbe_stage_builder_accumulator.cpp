@@ -33,6 +33,7 @@
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/accumulator_for_window_functions.h"
 #include "mongo/db/pipeline/accumulator_js_reduce.h"
+#include "mongo/db/pipeline/expression.h"
 #include "mongo/db/query/sbe_stage_builder_accumulator.h"
 #include "mongo/db/query/sbe_stage_builder_expression.h"
 #include "mongo/db/query/sbe_stage_builder_helpers.h"
@@ -234,6 +235,84 @@ std::pair<std::unique_ptr<sbe::EExpression>, EvalStage> buildFinalizePassthrough
 
     return {makeVariable(aggSlots[0]), std::move(inputStage)};
 }
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggsMin(
+    StageBuilderState& state,
+    const AccumulationExpression& expr,
+    const sbe::value::SlotVector& inputSlots) {
+    std::vector<std::unique_ptr<sbe::EExpression>> aggs;
+    auto collatorSlot = state.env->getSlotIfExists("collator"_sd);
+    if (collatorSlot) {
+        aggs.push_back(makeFunction("collMin"_sd,
+                                    sbe::makeE<sbe::EVariable>(*collatorSlot),
+                                    makeVariable(inputSlots[0])));
+    } else {
+        aggs.push_back(makeFunction("min"_sd, makeVariable(inputSlots[0])));
+    }
+    return aggs;
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggsMax(
+    StageBuilderState& state,
+    const AccumulationExpression& expr,
+    const sbe::value::SlotVector& inputSlots) {
+    std::vector<std::unique_ptr<sbe::EExpression>> aggs;
+    auto collatorSlot = state.env->getSlotIfExists("collator"_sd);
+    if (collatorSlot) {
+        aggs.push_back(makeFunction("collMax"_sd,
+                                    sbe::makeE<sbe::EVariable>(*collatorSlot),
+                                    makeVariable(inputSlots[0])));
+    } else {
+        aggs.push_back(makeFunction("max"_sd, makeVariable(inputSlots[0])));
+    }
+    return aggs;
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggsAvg(
+    StageBuilderState& state,
+    const AccumulationExpression& expr,
+    const sbe::value::SlotVector& inputSlots) {
+    // Both the partial sum and the partial count of an $avg are plain sums.
+    std::vector<std::unique_ptr<sbe::EExpression>> aggs;
+    aggs.push_back(makeFunction("sum", makeVariable(inputSlots[0])));
+    aggs.push_back(makeFunction("sum", makeVariable(inputSlots[1])));
+    return aggs;
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggsSum(
+    StageBuilderState& state,
+    const AccumulationExpression& expr,
+    const sbe::value::SlotVector& inputSlots) {
+    // A partial sum is held in the array of a double-double summation, which is finalized into a
+    // number of the widest type summed so far before it is added to the sum of the group.
+    std::vector<std::unique_ptr<sbe::EExpression>> aggs;
+    auto partialSum = makeFunction("doubleDoubleSumFinalize", makeVariable(inputSlots[0]));
+    aggs.push_back(makeFunction("aggDoubleDoubleSum", std::move(partialSum)));
+    return aggs;
+}
+
+using BuildCombinePartialAggsFn =
+    std::function<std::vector<std::unique_ptr<sbe::EExpression>>(
+        StageBuilderState&, const AccumulationExpression&, const sbe::value::SlotVector&)>;
+
+const StringDataMap<BuildCombinePartialAggsFn> kCombinePartialAggsBuilders = {
+    {AccumulatorMin::kName, &buildCombinePartialAggsMin},
+    {AccumulatorMax::kName, &buildCombinePartialAggsMax},
+    {AccumulatorAvg::kName, &buildCombinePartialAggsAvg},
+    {AccumulatorSum::kName, &buildCombinePartialAggsSum},
+};
+
+/**
+ * Returns the path on the current document which 'expr' reads, or boost::none if 'expr' is not a
+ * field path expression of this kind.
+ */
+boost::optional<std::string> getCurrentDocumentPath(const Expression* expr) {
+    auto fieldPathExpr = dynamic_cast<const ExpressionFieldPath*>(expr);
+    if (!fieldPathExpr || fieldPathExpr->isVariableReference() || fieldPathExpr->isROOT()) {
+        return boost::none;
+    }
+    return fieldPathExpr->getFieldPathWithoutCurrentPrefix().fullPath();
+}
 };  // namespace
 
 std::pair<std::unique_ptr<sbe::EExpression>, EvalStage> buildArgument(
@@ -321,4 +400,75 @@ std::pair<std::unique_ptr<sbe::EExpression>, EvalStage> buildFinalize(
                        std::move(inputStage),
                        planNodeId);
 }
+
+bool canCombinePartialAggs(const AccumulationStatement& acc) {
+    return kCombinePartialAggsBuilders.find(acc.expr.name) != kCombinePartialAggsBuilders.end();
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggs(
+    StageBuilderState& state,
+    const AccumulationStatement& acc,
+    const sbe::value::SlotVector& inputSlots) {
+    auto accExprName = acc.expr.name;
+    tassert(6001010,
+            str::stream() << "Cannot combine the partial aggregates of accumulator: "
+                          << accExprName,
+            kCombinePartialAggsBuilders.find(accExprName) != kCombinePartialAggsBuilders.end());
+
+    return std::invoke(kCombinePartialAggsBuilders.at(accExprName), state, acc.expr, inputSlots);
+}
+
+boost::optional<StringSet> getGroupFieldsCoverableByIndexKeys(
+    const std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>>&
+        groupByExpressions,
+    const std::vector<AccumulationStatement>& accumulators) {
+    // Accumulators which ignore null and missing values alike, or turn both into null.
+    static const StringDataSet kCoverableAccumulators = {AccumulatorMin::kName,
+                                                         AccumulatorMax::kName,
+                                                         AccumulatorFirst::kName,
+                                                         AccumulatorLast::kName,
+                                                         AccumulatorSum::kName};
+
+    if (groupByExpressions.size() != 1) {
+        return boost::none;
+    }
+
+    StringSet fields;
+    auto addFields = [&](const Expression* expr) {
+        if (dynamic_cast<const ExpressionConstant*>(expr)) {
+            return true;
+        }
+        if (auto path = getCurrentDocumentPath(expr)) {
+            fields.insert(std::move(*path));
+            return true;
+        }
+        return false;
+    };
+
+    if (!addFields(groupByExpressions[0].second.get())) {
+        return boost::none;
+    }
+    for (auto&& acc : accumulators) {
+        if (!kCoverableAccumulators.count(acc.expr.name) || !addFields(acc.expr.argument.get())) {
+            return boost::none;
+        }
+    }
+    return fields;
+}
+
+std::unique_ptr<sbe::EExpression> buildExpressionFromFieldSlots(
+    const Expression* expr, const StringMap<sbe::value::SlotId>& fieldSlots) {
+    if (auto constantExpr = dynamic_cast<const ExpressionConstant*>(expr)) {
+        auto [tag, val] = makeValue(constantExpr->getValue());
+        return makeConstant(tag, val);
+    }
+
+    auto path = getCurrentDocumentPath(expr);
+    tassert(6001004,
+            "Expected either a constant or a path on the current document",
+            path.has_value());
+    auto it = fieldSlots.find(*path);
+    tassert(6001005, str::stream() << "No slot holds the field: " << *path, it != fieldSlots.end());
+    return makeVariable(it->second);
+}
 }  // namespace mongo::stage_builder
@@ -71,4 +71,44 @@ std::pair<std::unique_ptr<sbe::EExpression>, EvalStage> buildFinalize(
     const sbe::value::SlotVector& aggSlots,
     EvalStage stage,
     PlanNodeId planNodeId);
+
+/**
+ * Returns true if the partial aggregates which a HashAggStage spills to disk for 'acc' can be
+ * combined by the expressions of 'buildCombinePartialAggs()'.
+ */
+bool canCombinePartialAggs(const AccumulationStatement& acc);
+
+/**
+ * Translates an input AccumulationStatement into the SBE EExpressions folding its partial
+ * aggregates, made visible in 'inputSlots' when they are read back from disk, into the aggregates
+ * of a group. There is one expression per aggregate returned by 'buildAccumulator()', in the same
+ * order.
+ */
+std::vector<std::unique_ptr<sbe::EExpression>> buildCombinePartialAggs(
+    StageBuilderState& state,
+    const AccumulationStatement& acc,
+    const sbe::value::SlotVector& inputSlots);
+
+/**
+ * Collects the fields of the input documents which a $group with the given group-by expressions
+ * and accumulators reads, provided that the $group can be computed from index keys holding these
+ * fields in place of the documents themselves. Every expression must be either a constant or a path
+ * on the current document, and every accumulator must treat null and missing values alike, since an
+ * index key holds null for both. For the same reason there must be a single group-by expression: a
+ * missing field is left out of a compound group key whereas a null one is not. Returns boost::none
+ * if the $group does not qualify.
+ */
+boost::optional<StringSet> getGroupFieldsCoverableByIndexKeys(
+    const std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>>&
+        groupByExpressions,
+    const std::vector<AccumulationStatement>& accumulators);
+
+/**
+ * Translates 'expr', which must be either a constant or a path on the current document, into an
+ * expression reading the value of the path from the slot it is mapped to in 'fieldSlots'. This is
+ * how the group-by expressions and accumulator arguments of a $group are computed from index key
+ * slots.
+ */
+std::unique_ptr<sbe::EExpression> buildExpressionFromFieldSlots(
+    const Expression* expr, const StringMap<sbe::value::SlotId>& fieldSlots);
 }  // namespace mongo::stage_builder
@@ -34,14 +34,18 @@
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/sbe/stages/block_to_row.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
 #include "mongo/db/exec/sbe/stages/loop_join.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/exec/sbe/stages/row_to_block.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/util/make_data_structure.h"
@@ -525,6 +529,163 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateOptimizedOplo
     return {std::move(stage), std::move(outputs)};
 }
 
+/**
+ * Returns the number of threads with which to scan the collection, or 1 if the scan must run
+ * serially. Only plain forward scans of a large enough collection run in parallel, since a parallel
+ * scan returns the documents out of their natural order and can neither resume, tail the
+ * collection nor track the oplog.
+ *
+ * Every producer of the exchange reads through its own recovery unit. For the producers to see the
+ * same data, the query must read at a point in time, which the producers then share.
+ */
+size_t getDegreeOfParallelism(OperationContext* opCtx,
+                              const CollectionPtr& collection,
+                              const CollectionScanNode* csn,
+                              bool isTailableResumeBranch,
+                              bool allowParallelScan) {
+    const size_t maxDegreeOfParallelism = internalQuerySBEMaxDegreeOfParallelism.load();
+    if (!allowParallelScan || maxDegreeOfParallelism <= 1 ||
+        csn->direction != CollectionScanParams::FORWARD || csn->resumeAfterRecordId ||
+        csn->tailable || isTailableResumeBranch || csn->shouldTrackLatestOplogTimestamp ||
+        csn->requestResumeToken || csn->shouldWaitForOplogVisibility ||
+        collection->ns().isOplog()) {
+        return 1;
+    }
+
+    if (collection->numRecords(opCtx) < internalQuerySBEParallelScanMinRecords.load()) {
+        return 1;
+    }
+
+    if (!opCtx->recoveryUnit()->getPointInTimeReadTimestamp(opCtx)) {
+        return 1;
+    }
+    return maxDegreeOfParallelism;
+}
+
+/**
+ * Returns an expression evaluating 'expr' for every document of the block held by 'blockSlot', or
+ * nullptr if 'expr' cannot be evaluated block-wise. The result is a block of Booleans which is only
+ * false for documents which are known not to match, so it can be used as a pre-filter in front of
+ * the row-wise filter. Only comparisons of a top-level field against a number qualify: they are
+ * exact for scalar numbers and yield Nothing, hence true, for every other type, including arrays
+ * whose elements the row-wise filter still needs to traverse. $lt and $lte are not supported since
+ * MQL sorts NaN below all numbers while the block-wise comparisons of NaN are always false.
+ * Parameterized predicates are skipped too, as a cached plan may rebind them to any value.
+ */
+std::unique_ptr<sbe::EExpression> generateBlockPredicate(const MatchExpression* expr,
+                                                         sbe::value::SlotId blockSlot) {
+    StringData cmpFn;
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+            cmpFn = "valueBlockEqScalar"_sd;
+            break;
+        case MatchExpression::GT:
+            cmpFn = "valueBlockGtScalar"_sd;
+            break;
+        case MatchExpression::GTE:
+            cmpFn = "valueBlockGteScalar"_sd;
+            break;
+        default:
+            return nullptr;
+    }
+
+    auto cmpExpr = static_cast<const ComparisonMatchExpression*>(expr);
+    const auto& rhs = cmpExpr->getData();
+    if (cmpExpr->getInputParamId() || cmpExpr->path().empty() ||
+        cmpExpr->path().find('.') != std::string::npos || !rhs.isNumber()) {
+        return nullptr;
+    }
+
+    auto [tagView, valView] = sbe::bson::convertFrom<true>(
+        rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+    if (sbe::value::isNaN(tagView, valView)) {
+        return nullptr;
+    }
+
+    auto [tag, val] = sbe::value::copyValue(tagView, valView);
+    return makeFunction(
+        "valueBlockFillEmpty",
+        makeFunction(cmpFn,
+                     makeFunction("valueBlockGetField",
+                                  makeVariable(blockSlot),
+                                  makeConstant(cmpExpr->path())),
+                     makeConstant(tag, val)),
+        makeConstant(sbe::value::TypeTags::Boolean, sbe::value::bitcastFrom<bool>(true)));
+}
+
+/**
+ * Selects block-at-a-time execution for the filter of a collection scan when
+ * 'internalQuerySlotBasedExecutionBlockSize' is non-zero and the filter has predicates which can be
+ * evaluated block-wise (see 'generateBlockPredicate()'). The documents produced by 'stage' are
+ * batched into blocks, the eligible predicates are evaluated once per block, and only the rows
+ * which may match are unpacked:
+ *
+ *   blockToRow [s5, s6] [s3, s4] s7
+ *   project [s7 = valueBlockLogicalAnd(...)]
+ *   rowToBlock [s3, s4] [s1, s2] blockSize
+ *   <stage>
+ *
+ * On success, 'resultSlot' and 'recordIdSlot' are updated to the slots of the unpacked rows. The
+ * full filter must still be applied on top of the returned stage.
+ */
+std::unique_ptr<sbe::PlanStage> generateBlockPreFilter(StageBuilderState& state,
+                                                       const MatchExpression* filter,
+                                                       std::unique_ptr<sbe::PlanStage> stage,
+                                                       sbe::value::SlotId& resultSlot,
+                                                       sbe::value::SlotId& recordIdSlot,
+                                                       PlanNodeId planNodeId) {
+    const int blockSize = internalQuerySBEBlockSize.load();
+    if (blockSize <= 0) {
+        return stage;
+    }
+
+    auto resultBlockSlot = state.slotId();
+    auto recordIdBlockSlot = state.slotId();
+
+    std::unique_ptr<sbe::EExpression> bitmapExpr;
+    auto addPredicate = [&](const MatchExpression* expr) {
+        auto predicate = generateBlockPredicate(expr, resultBlockSlot);
+        if (!predicate) {
+            return;
+        }
+        bitmapExpr = bitmapExpr
+            ? makeFunction("valueBlockLogicalAnd", std::move(bitmapExpr), std::move(predicate))
+            : std::move(predicate);
+    };
+
+    if (filter->matchType() == MatchExpression::AND) {
+        for (size_t idx = 0; idx < filter->numChildren(); ++idx) {
+            addPredicate(filter->getChild(idx));
+        }
+    } else {
+        addPredicate(filter);
+    }
+
+    if (!bitmapExpr) {
+        return stage;
+    }
+
+    auto bitmapSlot = state.slotId();
+    auto outResultSlot = state.slotId();
+    auto outRecordIdSlot = state.slotId();
+
+    stage = sbe::makeS<sbe::RowToBlockStage>(std::move(stage),
+                                             sbe::makeSV(resultSlot, recordIdSlot),
+                                             sbe::makeSV(resultBlockSlot, recordIdBlockSlot),
+                                             static_cast<size_t>(blockSize),
+                                             planNodeId);
+    stage = sbe::makeProjectStage(std::move(stage), planNodeId, bitmapSlot, std::move(bitmapExpr));
+    stage = sbe::makeS<sbe::BlockToRowStage>(std::move(stage),
+                                             sbe::makeSV(resultBlockSlot, recordIdBlockSlot),
+                                             sbe::makeSV(outResultSlot, outRecordIdSlot),
+                                             bitmapSlot,
+                                             planNodeId);
+
+    resultSlot = outResultSlot;
+    recordIdSlot = outRecordIdSlot;
+    return stage;
+}
+
 /**
  * Generates a generic collection scan sub-tree.
  *  - If a resume token has been provided, the scan will start from a RecordId contained within this
@@ -532,13 +693,18 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateOptimizedOplo
  *  - Else if 'isTailableResumeBranch' is true, the scan will start from a RecordId contained in
  * slot "resumeRecordId".
  *  - Otherwise the scan will start from the beginning of the collection.
+ *
+ * When the collection is large enough, the scan and the filter are run by several producers of an
+ * exchange, each scanning a range of the collection (see 'getDegreeOfParallelism()').
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollScan(
     StageBuilderState& state,
     const CollectionPtr& collection,
     const CollectionScanNode* csn,
     PlanYieldPolicy* yieldPolicy,
-    bool isTailableResumeBranch) {
+    bool isTailableResumeBranch,
+    bool allowParallelScan,
+    boost::optional<size_t> exchangeProducers) {
     const auto forward = csn->direction == CollectionScanParams::FORWARD;
 
     invariant(!csn->shouldTrackLatestOplogTimestamp || collection->ns().isOplog());
@@ -564,22 +730,45 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
     auto&& [fields, slots, tsSlot] = makeOplogTimestampSlotsIfNeeded(
         state.env, state.slotIdGenerator, csn->shouldTrackLatestOplogTimestamp);
 
+    const auto degreeOfParallelism = exchangeProducers
+        ? *exchangeProducers
+        : getDegreeOfParallelism(
+              state.opCtx, collection, csn, isTailableResumeBranch, allowParallelScan);
+
     sbe::ScanCallbacks callbacks({}, {}, makeOpenCallbackIfNeeded(collection, csn));
-    auto stage = sbe::makeS<sbe::ScanStage>(collection->uuid(),
-                                            resultSlot,
-                                            recordIdSlot,
-                                            boost::none /* snapshotIdSlot */,
-                                            boost::none /* indexIdSlot */,
-                                            boost::none /* indexKeySlot */,
-                                            boost::none /* keyPatternSlot */,
-                                            tsSlot,
-                                            std::move(fields),
-                                            std::move(slots),
-                                            seekRecordIdSlot,
-                                            forward,
-                                            yieldPolicy,
-                                            csn->nodeId(),
-                                            std::move(callbacks));
+    std::unique_ptr<sbe::PlanStage> stage;
+    if (degreeOfParallelism > 1) {
+        // The producers run on their own threads and operation contexts and do not yield. Instead,
+        // the exchange keeps the query from yielding until they are done.
+        stage = sbe::makeS<sbe::ParallelScanStage>(collection->uuid(),
+                                                   resultSlot,
+                                                   recordIdSlot,
+                                                   boost::none /* snapshotIdSlot */,
+                                                   boost::none /* indexIdSlot */,
+                                                   boost::none /* indexKeySlot */,
+                                                   boost::none /* keyPatternSlot */,
+                                                   std::move(fields),
+                                                   std::move(slots),
+                                                   nullptr /* yieldPolicy */,
+                                                   csn->nodeId(),
+                                                   std::move(callbacks));
+    } else {
+        stage = sbe::makeS<sbe::ScanStage>(collection->uuid(),
+                                           resultSlot,
+                                           recordIdSlot,
+                                           boost::none /* snapshotIdSlot */,
+                                           boost::none /* indexIdSlot */,
+                                           boost::none /* indexKeySlot */,
+                                           boost::none /* keyPatternSlot */,
+                                           tsSlot,
+                                           std::move(fields),
+                                           std::move(slots),
+                                           seekRecordIdSlot,
+                                           forward,
+                                           yieldPolicy,
+                                           csn->nodeId(),
+                                           std::move(callbacks));
+    }
 
     if (seekRecordIdSlot) {
         stage = buildResumeFromRecordIdSubtree(state,
@@ -599,6 +788,15 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
         // 'generateOptimizedOplogScan()'.
         invariant(!csn->stopApplyingFilterAfterFirstMatch);
 
+        if (!tsSlot) {
+            stage = generateBlockPreFilter(state,
+                                           csn->filter.get(),
+                                           std::move(stage),
+                                           resultSlot,
+                                           recordIdSlot,
+                                           csn->nodeId());
+        }
+
         auto relevantSlots = sbe::makeSV(resultSlot, recordIdSlot);
 
         auto [_, outputStage] = generateFilter(state,
@@ -609,6 +807,17 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
         stage = std::move(outputStage.stage);
     }
 
+    if (degreeOfParallelism > 1 && !exchangeProducers) {
+        stage = sbe::makeS<sbe::ExchangeConsumer>(std::move(stage),
+                                                  degreeOfParallelism,
+                                                  sbe::makeSV(resultSlot, recordIdSlot),
+                                                  sbe::ExchangePolicy::roundrobin,
+                                                  nullptr /* partition */,
+                                                  nullptr /* orderLess */,
+                                                  yieldPolicy,
+                                                  csn->nodeId());
+    }
+
     PlanStageSlots outputs;
     outputs.set(PlanStageSlots::kResult, resultSlot);
     outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
@@ -622,12 +831,35 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     const CollectionPtr& collection,
     const CollectionScanNode* csn,
     PlanYieldPolicy* yieldPolicy,
-    bool isTailableResumeBranch) {
+    bool isTailableResumeBranch,
+    bool allowParallelScan,
+    boost::optional<size_t> exchangeProducers) {
     if (csn->minRecord || csn->maxRecord || csn->stopApplyingFilterAfterFirstMatch) {
+        tassert(6000601,
+                "An optimized oplog scan cannot be split across exchange producers",
+                !exchangeProducers);
         return generateOptimizedOplogScan(
             state, collection, csn, yieldPolicy, isTailableResumeBranch);
     } else {
-        return generateGenericCollScan(state, collection, csn, yieldPolicy, isTailableResumeBranch);
+        return generateGenericCollScan(state,
+                                       collection,
+                                       csn,
+                                       yieldPolicy,
+                                       isTailableResumeBranch,
+                                       allowParallelScan,
+                                       exchangeProducers);
+    }
+}
+
+size_t getCollScanDegreeOfParallelism(OperationContext* opCtx,
+                                      const CollectionPtr& collection,
+                                      const CollectionScanNode* csn,
+                                      bool isTailableResumeBranch,
+                                      bool allowParallelScan) {
+    if (csn->minRecord || csn->maxRecord || csn->stopApplyingFilterAfterFirstMatch) {
+        return 1;
     }
+    return getDegreeOfParallelism(
+        opCtx, collection, csn, isTailableResumeBranch, allowParallelScan);
 }
 }  // namespace mongo::stage_builder
@@ -50,6 +50,14 @@ class PlanStageSlots;
  *     were requested to track this data.
  *   * A generated PlanStage sub-tree.
  *
+ * If 'allowParallelScan' is true, a scan of a large collection may be split across the producers of
+ * an exchange, as limited by the 'internalQuerySBEMaxDegreeOfParallelism' knob. The documents are
+ * then returned out of their natural order.
+ *
+ * If 'exchangeProducers' is set, the scan is split across that many producers and the exchange is
+ * left out, for the caller to place it above stages which every producer runs on its share of the
+ * documents. The caller obtains the number of producers from 'getCollScanDegreeOfParallelism()'.
+ *
  * In cases of an error, throws.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -57,6 +65,18 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     const CollectionPtr& collection,
     const CollectionScanNode* csn,
     PlanYieldPolicy* yieldPolicy,
-    bool isTailableResumeBranch);
+    bool isTailableResumeBranch,
+    bool allowParallelScan,
+    boost::optional<size_t> exchangeProducers = boost::none);
+
+/**
+ * Returns the number of producers across which 'generateCollScan()' splits the scan described by
+ * 'csn', or 1 if the scan runs serially.
+ */
+size_t getCollScanDegreeOfParallelism(OperationContext* opCtx,
+                                      const CollectionPtr& collection,
+                                      const CollectionScanNode* csn,
+                                      bool isTailableResumeBranch,
+                                      bool allowParallelScan);
 
 }  // namespace mongo::stage_builder
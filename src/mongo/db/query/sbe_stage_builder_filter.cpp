@@ -689,6 +689,36 @@ void generateArraySize(MatchExpressionVisitorContext* context,
                       LeafTraversalMode::kDoNotTraverseLeaf);
 }
 
+/**
+ * Returns an expression producing the right-hand side of the comparison 'expr'. If the literal has
+ * been parameterized, it is stored in a runtime environment slot so that the plan can be re-used
+ * with a different value. Otherwise, the literal is baked into the plan as a constant.
+ */
+std::unique_ptr<sbe::EExpression> makeComparisonRhs(MatchExpressionVisitorContext* context,
+                                                    const ComparisonMatchExpression* expr) {
+    const auto& rhs = expr->getData();
+    auto [tagView, valView] = sbe::bson::convertFrom<true>(
+        rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+
+    // Both the runtime environment and EConstant assume ownership of the value so we have to make
+    // a copy here.
+    auto paramId = expr->getInputParamId();
+    if (!paramId) {
+        auto [tag, val] = sbe::value::copyValue(tagView, valView);
+        return makeConstant(tag, val);
+    }
+
+    auto& inputParamToSlotMap = context->state.inputParamToSlotMap;
+    auto it = inputParamToSlotMap.find(*paramId);
+    if (it == inputParamToSlotMap.end()) {
+        auto [tag, val] = sbe::value::copyValue(tagView, valView);
+        auto slot =
+            context->state.env->registerSlot(tag, val, true, context->state.slotIdGenerator);
+        it = inputParamToSlotMap.emplace(*paramId, slot).first;
+    }
+    return makeVariable(it->second);
+}
+
 /**
  * Generates a path traversal SBE plan stage sub-tree which implements the comparison match
  * expression 'expr'. The comparison itself executes using the given 'binaryOp'.
@@ -789,9 +819,6 @@ void generateComparison(MatchExpressionVisitorContext* context,
             }
         }
 
-        // SBE EConstant assumes ownership of the value so we have to make a copy here.
-        auto [tag, val] = sbe::value::copyValue(tagView, valView);
-
         // When 'rhs' is not NaN, return false if lhs is NaN. Otherwise, use usual comparison
         // semantics.
         return {makeBinaryOp(
@@ -799,7 +826,7 @@ void generateComparison(MatchExpressionVisitorContext* context,
                     makeNot(makeFillEmptyFalse(makeFunction("isNaN", makeVariable(inputSlot)))),
                     makeFillEmptyFalse(makeBinaryOp(binaryOp,
                                                     makeVariable(inputSlot),
-                                                    makeConstant(tag, val),
+                                                    makeComparisonRhs(context, expr),
                                                     context->state.env))),
                 std::move(inputStage)};
     };
@@ -34,10 +34,12 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/branch.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
 #include "mongo/db/exec/sbe/stages/loop_join.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/exec/sbe/stages/streaming_agg.h"
 #include "mongo/db/exec/sbe/stages/traverse.h"
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unwind.h"
@@ -448,7 +450,9 @@ EvalStage makeHashAgg(EvalStage stage,
                       sbe::value::SlotVector gbs,
                       sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
                       boost::optional<sbe::value::SlotId> collatorSlot,
-                      PlanNodeId planNodeId) {
+                      PlanNodeId planNodeId,
+                      bool allowDiskUse,
+                      sbe::HashAggStage::MergingExprMap mergingExprs) {
     stage.outSlots = gbs;
     for (auto& [slot, _] : aggs) {
         stage.outSlots.push_back(slot);
@@ -459,10 +463,111 @@ EvalStage makeHashAgg(EvalStage stage,
                                                 sbe::makeSV(),
                                                 true /* optimized close */,
                                                 collatorSlot,
+                                                allowDiskUse,
+                                                std::move(mergingExprs),
                                                 planNodeId);
     return stage;
 }
 
+EvalStage makeStreamingAgg(EvalStage stage,
+                           sbe::value::SlotVector gbs,
+                           sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
+                           boost::optional<sbe::value::SlotId> collatorSlot,
+                           PlanNodeId planNodeId) {
+    stage.outSlots = gbs;
+    for (auto& [slot, _] : aggs) {
+        stage.outSlots.push_back(slot);
+    }
+    stage.stage = sbe::makeS<sbe::StreamingAggStage>(
+        std::move(stage.stage), std::move(gbs), std::move(aggs), collatorSlot, planNodeId);
+    return stage;
+}
+
+std::pair<EvalStage, sbe::value::SlotMap<sbe::value::SlotId>> makeParallelHashAgg(
+    EvalStage stage,
+    size_t degreeOfParallelism,
+    sbe::value::SlotVector gbs,
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
+    const sbe::value::SlotMap<MakeMergingExprFn>& makeMergingExprs,
+    boost::optional<sbe::value::SlotId> collatorSlot,
+    bool allowDiskUse,
+    PlanYieldPolicy* yieldPolicy,
+    PlanNodeId planNodeId,
+    sbe::value::SlotIdGenerator* slotIdGenerator) {
+    auto makeSpillMergingExprs = [&](const sbe::value::SlotMap<sbe::value::SlotId>& aggSlots) {
+        sbe::HashAggStage::MergingExprMap mergingExprs;
+        if (allowDiskUse) {
+            for (auto& [aggSlot, partialSlot] : aggSlots) {
+                auto spilledSlot = slotIdGenerator->generate();
+                mergingExprs.emplace(aggSlot,
+                                     std::make_pair(spilledSlot,
+                                                    makeMergingExprs.at(partialSlot)(spilledSlot)));
+            }
+        }
+        return mergingExprs;
+    };
+
+    // The partial aggregates flow through the exchange along with the group-by keys. Every final
+    // aggregate folds in the partial aggregates of its group.
+    auto exchangeSlots = gbs;
+    sbe::value::SlotMap<sbe::value::SlotId> partialSlots;
+    sbe::value::SlotMap<sbe::value::SlotId> finalSlots;
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> finalAggs;
+    for (auto& [slot, _] : aggs) {
+        tassert(6000600,
+                "Parallel hash aggregation requires a merging expression for every aggregate",
+                makeMergingExprs.count(slot) > 0);
+
+        auto finalSlot = slotIdGenerator->generate();
+        exchangeSlots.push_back(slot);
+        partialSlots.emplace(slot, slot);
+        finalSlots.emplace(slot, finalSlot);
+        finalAggs.emplace(finalSlot, makeMergingExprs.at(slot)(slot));
+    }
+
+    auto partialMergingExprs = makeSpillMergingExprs(partialSlots);
+    auto partialStage = sbe::makeS<sbe::HashAggStage>(std::move(stage.stage),
+                                                      gbs,
+                                                      std::move(aggs),
+                                                      sbe::makeSV(),
+                                                      true /* optimized close */,
+                                                      collatorSlot,
+                                                      allowDiskUse,
+                                                      std::move(partialMergingExprs),
+                                                      planNodeId);
+
+    auto exchangeStage = sbe::makeS<sbe::ExchangeConsumer>(std::move(partialStage),
+                                                           degreeOfParallelism,
+                                                           std::move(exchangeSlots),
+                                                           sbe::ExchangePolicy::roundrobin,
+                                                           nullptr /* partition */,
+                                                           nullptr /* orderLess */,
+                                                           yieldPolicy,
+                                                           planNodeId);
+
+    sbe::value::SlotMap<sbe::value::SlotId> finalToPartialSlots;
+    for (auto& [slot, finalSlot] : finalSlots) {
+        finalToPartialSlots.emplace(finalSlot, slot);
+    }
+    auto finalMergingExprs = makeSpillMergingExprs(finalToPartialSlots);
+
+    EvalStage outStage;
+    outStage.outSlots = gbs;
+    for (auto& [slot, _] : finalAggs) {
+        outStage.outSlots.push_back(slot);
+    }
+    outStage.stage = sbe::makeS<sbe::HashAggStage>(std::move(exchangeStage),
+                                                   std::move(gbs),
+                                                   std::move(finalAggs),
+                                                   sbe::makeSV(),
+                                                   true /* optimized close */,
+                                                   collatorSlot,
+                                                   allowDiskUse,
+                                                   std::move(finalMergingExprs),
+                                                   planNodeId);
+    return {std::move(outStage), std::move(finalSlots)};
+}
+
 EvalStage makeMkBsonObj(EvalStage stage,
                         sbe::value::SlotId objSlot,
                         boost::optional<sbe::value::SlotId> rootSlot,
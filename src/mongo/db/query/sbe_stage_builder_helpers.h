@@ -36,8 +36,10 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/exec/sbe/stages/makeobj.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/sbe_stage_builder_eval_frame.h"
 #include "mongo/db/query/stage_types.h"
 
@@ -340,11 +342,58 @@ EvalStage makeUnion(std::vector<EvalStage> inputStages,
                     sbe::value::SlotVector outputVals,
                     PlanNodeId planNodeId);
 
+/**
+ * Builds a HashAggStage over 'stage'. If 'allowDiskUse' is set, the stage spills its partial
+ * aggregates to disk once it runs out of memory, and 'mergingExprs' must map every slot of 'aggs'
+ * to the slot in which a spilled partial aggregate is read back and the expression folding it in.
+ */
 EvalStage makeHashAgg(EvalStage stage,
                       sbe::value::SlotVector gbs,
                       sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
                       boost::optional<sbe::value::SlotId> collatorSlot,
-                      PlanNodeId planNodeId);
+                      PlanNodeId planNodeId,
+                      bool allowDiskUse = false,
+                      sbe::HashAggStage::MergingExprMap mergingExprs = {});
+
+/**
+ * Same as 'makeHashAgg()', but builds a StreamingAggStage. The input of 'stage' must arrive grouped
+ * by the 'gbs' slots.
+ */
+EvalStage makeStreamingAgg(EvalStage stage,
+                           sbe::value::SlotVector gbs,
+                           sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
+                           boost::optional<sbe::value::SlotId> collatorSlot,
+                           PlanNodeId planNodeId);
+
+using MakeMergingExprFn = std::function<std::unique_ptr<sbe::EExpression>(sbe::value::SlotId)>;
+
+/**
+ * Builds a two-phase hash aggregation whose input is split across the producers of an exchange.
+ * Each of the 'degreeOfParallelism' producers runs a clone of the input stage and computes partial
+ * aggregates over its share of the input, which are then combined by a final aggregation above the
+ * exchange. The input stage must divide its input between its clones, as a ParallelScanStage does,
+ * otherwise rows would be aggregated more than once.
+ *
+ * The 'makeMergingExprs' map every aggregate slot to a function building the aggregate expression
+ * which folds a partial aggregate, held in the given slot, into the final one (e.g. 'sum' for
+ * 'count'). The same expressions merge the partial aggregates spilled by either phase when
+ * 'allowDiskUse' is true. The 'yieldPolicy' of the query is handed to the exchange, which keeps
+ * the query from yielding while the producers run.
+ *
+ * Returns the final aggregation along with a map from every slot of 'aggs' to the slot holding the
+ * corresponding final aggregate.
+ */
+std::pair<EvalStage, sbe::value::SlotMap<sbe::value::SlotId>> makeParallelHashAgg(
+    EvalStage stage,
+    size_t degreeOfParallelism,
+    sbe::value::SlotVector gbs,
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
+    const sbe::value::SlotMap<MakeMergingExprFn>& makeMergingExprs,
+    boost::optional<sbe::value::SlotId> collatorSlot,
+    bool allowDiskUse,
+    PlanYieldPolicy* yieldPolicy,
+    PlanNodeId planNodeId,
+    sbe::value::SlotIdGenerator* slotIdGenerator);
 
 EvalStage makeMkBsonObj(EvalStage stage,
                         sbe::value::SlotId objSlot,
@@ -791,6 +840,20 @@ std::pair<sbe::IndexKeysInclusionSet, std::vector<std::string>> makeIndexKeyIncl
     return {std::move(indexKeyBitset), std::move(keyFieldNames)};
 }
 
+/**
+ * Runtime environment slots holding the bounds of an index scan. Keeping the bounds out of the plan
+ * lets a plan recovered from the SBE plan cache be rebound to the bounds of another query. Exactly
+ * one of the members is set.
+ */
+struct IndexBoundsSlots {
+    // Set for a single-interval index scan, holds the low and high KeyStrings.
+    boost::optional<std::pair<sbe::value::SlotId, sbe::value::SlotId>> singleInterval;
+
+    // Set for a multi-interval index scan whose bounds could be decomposed into single intervals,
+    // holds an array of {l: KS(...), h: KS(...)} objects.
+    boost::optional<sbe::value::SlotId> intervals;
+};
+
 /**
  * Common parameters to SBE stage builder functions extracted into separate class to simplify
  * argument passing. Also contains a mapping of global variable ids to slot ids.
@@ -834,6 +897,16 @@ struct StageBuilderState {
 
     const Variables& variables;
     stdx::unordered_map<Variables::Id, sbe::value::SlotId> globalVariables;
+
+    // Runtime environment slots holding the values of parameterized MatchExpression literals,
+    // keyed by their input parameter ids.
+    stdx::unordered_map<MatchExpression::InputParamId, sbe::value::SlotId> inputParamToSlotMap;
+
+    // Runtime environment slots holding index bounds, keyed by the node id of each index scan.
+    stdx::unordered_map<PlanNodeId, IndexBoundsSlots> indexBoundsSlots;
+
+    // Set if the bounds of some index scan were baked into the plan as constants.
+    bool hasNonParameterizedIndexBounds{false};
 };
 
 }  // namespace mongo::stage_builder
@@ -49,6 +49,7 @@
 #include "mongo/db/exec/sbe/stages/unwind.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
@@ -194,16 +195,12 @@ std::vector<std::pair<BSONObj, BSONObj>> decomposeIntoSingleIntervals(
     return {keysQueue.begin(), keysQueue.end()};
 }
 
-/**
- * Constructs low/high key values from the given index 'bounds' if they can be represented either as
- * a single interval between the low and high keys, or multiple single intervals. If index bounds
- * for some interval cannot be expressed as valid low/high keys, then an empty vector is returned.
- */
-std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-makeIntervalsFromIndexBounds(const IndexBounds& bounds,
-                             bool forward,
-                             KeyString::Version version,
-                             Ordering ordering) {
+}  // namespace
+
+IndexIntervals makeIntervalsFromIndexBounds(const IndexBounds& bounds,
+                                            bool forward,
+                                            KeyString::Version version,
+                                            Ordering ordering) {
     auto lowKeyInclusive{IndexBounds::isStartIncludedInBound(bounds.boundInclusion)};
     auto highKeyInclusive{IndexBounds::isEndIncludedInBound(bounds.boundInclusion)};
     auto intervals = [&]() -> std::vector<std::pair<BSONObj, BSONObj>> {
@@ -224,8 +221,7 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
 
     LOGV2_DEBUG(
         4742905, 5, "Number of generated interval(s) for ixscan", "num"_attr = intervals.size());
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        result;
+    IndexIntervals result;
     for (auto&& [lowKey, highKey] : intervals) {
         LOGV2_DEBUG(4742906,
                     5,
@@ -250,6 +246,30 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+std::pair<sbe::value::TypeTags, sbe::value::Value> packIndexIntervalsInSbeArray(
+    IndexIntervals intervals) {
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    sbe::value::ValueGuard boundsGuard{boundsTag, boundsVal};
+    auto arr = sbe::value::getArrayView(boundsVal);
+    arr->reserve(intervals.size());
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        arr->push_back(tag, val);
+        obj->reserve(2);
+        obj->push_back("l"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        obj->push_back("h"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+    }
+    boundsGuard.reset();
+    return {boundsTag, boundsVal};
+}
+
+namespace {
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -275,6 +295,8 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * This subtree is similar to the single-interval subtree with the only difference that instead
  * of projecting a single pair of the low/high keys, we project an array of such pairs and then
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
+ * The array is produced by 'boundsExpr', which is either a constant or a variable referring to a
+ * runtime environment slot.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
 generateOptimizedMultiIntervalIndexScan(
@@ -282,8 +304,7 @@ generateOptimizedMultiIntervalIndexScan(
     const std::string& indexName,
     const BSONObj& keyPattern,
     bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
+    std::unique_ptr<sbe::EExpression> boundsExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     boost::optional<sbe::value::SlotId> snapshotIdSlot,
@@ -299,37 +320,17 @@ generateOptimizedMultiIntervalIndexScan(
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
 
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    arr->reserve(intervals.size());
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->reserve(2);
-        obj->push_back("l"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
-        obj->push_back("h"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
-    // Project out the constructed array as a constant value and add an unwind stage on top to
-    // flatten the array.
+    // Project out the array of intervals and add an unwind stage on top to flatten the array.
     auto unwind = sbe::makeS<sbe::UnwindStage>(
         sbe::makeProjectStage(
             sbe::makeS<sbe::LimitSkipStage>(
                 sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
             planNodeId,
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(boundsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -790,8 +791,8 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
     const std::string& indexName,
     const BSONObj& keyPattern,
     bool forward,
-    std::unique_ptr<KeyString::Value> lowKey,
-    std::unique_ptr<KeyString::Value> highKey,
+    std::unique_ptr<sbe::EExpression> lowKeyExpr,
+    std::unique_ptr<sbe::EExpression> highKeyExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     boost::optional<sbe::value::SlotId> snapshotIdSlot,
@@ -808,12 +809,8 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
     // Construct a constant table scan to deliver a single row with two fields 'lowKeySlot' and
     // 'highKeySlot', representing seek boundaries, into the index scan.
     sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> projects;
-    projects.emplace(lowKeySlot,
-                     makeConstant(sbe::value::TypeTags::ksValue,
-                                  sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release())));
-    projects.emplace(highKeySlot,
-                     makeConstant(sbe::value::TypeTags::ksValue,
-                                  sbe::value::bitcastFrom<KeyString::Value*>(highKey.release())));
+    projects.emplace(lowKeySlot, std::move(lowKeyExpr));
+    projects.emplace(highKeySlot, std::move(highKeyExpr));
     if (indexIdSlot) {
         // Construct a copy of 'indexName' to project for use in the index consistency check.
         projects.emplace(*indexIdSlot, makeConstant(indexName));
@@ -957,17 +954,41 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
         relevantSlots.push_back(*indexKeyPatternSlot);
     }
 
+    // When the SBE plan cache is enabled, the index bounds are stored in runtime environment slots
+    // rather than baked into the plan as constants, so that a cached plan can be rebound to the
+    // bounds of another query of the same shape.
+    const bool parameterizeBounds = feature_flags::gFeatureFlagSbePlanCache.isEnabledAndIgnoreFCV();
+    auto makeBoundExpr = [&](sbe::value::TypeTags tag,
+                             sbe::value::Value val) -> std::pair<std::unique_ptr<sbe::EExpression>,
+                                                                 sbe::value::SlotId> {
+        if (parameterizeBounds) {
+            auto slot = state.env->registerSlot(tag, val, true, state.slotIdGenerator);
+            return {makeVariable(slot), slot};
+        }
+        return {makeConstant(tag, val), sbe::value::SlotId{0}};
+    };
+
     if (intervals.size() == 1) {
         // If we have just a single interval, we can construct a simplified sub-tree.
         auto&& [lowKey, highKey] = intervals[0];
-        sbe::value::SlotId recordIdSlot;
+        auto [lowKeyExpr, lowKeySlot] =
+            makeBoundExpr(sbe::value::TypeTags::ksValue,
+                          sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        auto [highKeyExpr, highKeySlot] =
+            makeBoundExpr(sbe::value::TypeTags::ksValue,
+                          sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+        if (parameterizeBounds) {
+            state.indexBoundsSlots[ixn->nodeId()].singleInterval =
+                std::make_pair(lowKeySlot, highKeySlot);
+        }
 
+        sbe::value::SlotId recordIdSlot;
         std::tie(recordIdSlot, stage) = generateSingleIntervalIndexScan(collection,
                                                                         indexName,
                                                                         keyPattern,
                                                                         ixn->direction == 1,
-                                                                        std::move(lowKey),
-                                                                        std::move(highKey),
+                                                                        std::move(lowKeyExpr),
+                                                                        std::move(highKeyExpr),
                                                                         indexKeyBitset,
                                                                         indexKeySlots,
                                                                         snapshotIdSlot,
@@ -982,13 +1003,19 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     } else if (intervals.size() > 1) {
         // If we were able to decompose multi-interval index bounds into a number of single-interval
         // bounds, we can also built an optimized sub-tree to perform an index scan.
+        auto [boundsTag, boundsVal] = packIndexIntervalsInSbeArray(std::move(intervals));
+        auto [boundsExpr, boundsSlot] = makeBoundExpr(boundsTag, boundsVal);
+        if (parameterizeBounds) {
+            state.indexBoundsSlots[ixn->nodeId()].intervals = boundsSlot;
+        }
+
         sbe::value::SlotId recordIdSlot;
         std::tie(recordIdSlot, stage) =
             generateOptimizedMultiIntervalIndexScan(collection,
                                                     indexName,
                                                     keyPattern,
                                                     ixn->direction == 1,
-                                                    std::move(intervals),
+                                                    std::move(boundsExpr),
                                                     indexKeyBitset,
                                                     indexKeySlots,
                                                     snapshotIdSlot,
@@ -1001,7 +1028,10 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
 
         outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
     } else {
-        // Generate a generic index scan for multi-interval index bounds.
+        // Generate a generic index scan for multi-interval index bounds. The bounds are baked into
+        // the plan, so it cannot be rebound to the bounds of another query.
+        state.hasNonParameterizedIndexBounds = true;
+
         sbe::value::SlotId recordIdSlot;
         std::tie(recordIdSlot, stage) = generateGenericMultiIntervalIndexScan(
             collection,
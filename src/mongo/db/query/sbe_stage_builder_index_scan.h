@@ -41,6 +41,33 @@ namespace mongo::stage_builder {
 class PlanStageReqs;
 class PlanStageSlots;
 
+/**
+ * A list of low/high KeyString pairs, one for each interval of an index scan.
+ */
+using IndexIntervals =
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>;
+
+/**
+ * Constructs low/high key values from the given index 'bounds' if they can be represented either as
+ * a single interval between the low and high keys, or multiple single intervals. If index bounds
+ * for some interval cannot be expressed as valid low/high keys, then an empty vector is returned.
+ */
+IndexIntervals makeIntervalsFromIndexBounds(const IndexBounds& bounds,
+                                            bool forward,
+                                            KeyString::Version version,
+                                            Ordering ordering);
+
+/**
+ * Packs the given 'intervals' into an SBE array of objects holding the low and high keys of each
+ * interval. E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ *
+ * The caller owns the returned value.
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> packIndexIntervalsInSbeArray(
+    IndexIntervals intervals);
+
 /**
  * This method generates an SBE plan stage tree implementing an index scan. It returns a tuple
  * containing: (1) a slot produced by the index scan that holds the record ID ('recordIdSlot');
@@ -67,14 +94,15 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
  *         nlj [indexIdSlot, keyPatternSlot] [lowKeySlot, highKeySlot]
  *              left
  *                  project [indexIdSlot = <indexName>, keyPatternSlot = <index key pattern>,
- *                          lowKeySlot =  KS(...), highKeySlot = KS(...)]
+ *                          lowKeySlot = <lowKeyExpr>, highKeySlot = <highKeyExpr>]
  *                  limit 1
  *                  coscan
  *               right
  *                  ixseek lowKeySlot highKeySlot recordIdSlot [] @coll @index
  *
  * The inner branch of the nested loop join produces a single row with the low/high keys which is
- * fed to the ixscan.
+ * fed to the ixscan. The keys are produced by 'lowKeyExpr' and 'highKeyExpr', which are either
+ * KeyString constants or variables referring to runtime environment slots.
  *
  * If 'recordSlot' is provided, than the corresponding slot will be filled out with each KeyString
  * in the index.
@@ -84,8 +112,8 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
     const std::string& indexName,
     const BSONObj& keyPattern,
     bool forward,
-    std::unique_ptr<KeyString::Value> lowKey,
-    std::unique_ptr<KeyString::Value> highKey,
+    std::unique_ptr<sbe::EExpression> lowKeyExpr,
+    std::unique_ptr<sbe::EExpression> highKeyExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector vars,
     boost::optional<sbe::value::SlotId> snapshotIdSlot,
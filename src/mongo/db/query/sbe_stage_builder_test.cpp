@@ -29,7 +29,16 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/bson/unordered_fields_bsonobj_comparator.h"
+#include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/shard_filterer_mock.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_source_set_window_fields.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/sbe_stage_builder_test_fixture.h"
 #include "mongo/db/query/shard_filterer_factory_mock.h"
@@ -43,6 +52,28 @@ protected:
         return std::make_unique<ShardFiltererFactoryMock>(
             std::make_unique<ConstantFilterMock>(true, BSONObj{}));
     }
+
+    /**
+     * Makes a GroupNode over 'child' which groups by 'groupBy' and computes the accumulators
+     * described by the fields of 'accumulators'.
+     */
+    std::unique_ptr<GroupNode> makeGroupNode(std::unique_ptr<QuerySolutionNode> child,
+                                             boost::intrusive_ptr<Expression> groupBy,
+                                             const BSONObj& accumulators) {
+        std::vector<AccumulationStatement> accStmts;
+        for (auto&& elem : accumulators) {
+            accStmts.push_back(AccumulationStatement::parseAccumulationStatement(
+                _expCtx.get(), elem, _expCtx->variablesParseState));
+        }
+        std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> groupByExprs;
+        groupByExprs.emplace_back("_id", std::move(groupBy));
+        return std::make_unique<GroupNode>(std::move(child),
+                                           std::move(groupByExprs),
+                                           std::move(accStmts),
+                                           false /* doingMerge */);
+    }
+
+    boost::intrusive_ptr<ExpressionContext> _expCtx{new ExpressionContextForTest()};
 };
 
 TEST_F(SbeStageBuilderTest, TestVirtualScan) {
@@ -216,4 +247,282 @@ TEST_F(SbeStageBuilderTest, VirtualIndexScanWithoutRecordId) {
     }
     ASSERT_EQ(index, 3);
 }
+
+TEST_F(SbeStageBuilderTest, EqLookupAgainstMissingForeignCollectionProducesEmptyArrays) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "out" << 2)),
+                                       BSON_ARRAY(BSON("a" << BSON_ARRAY(1 << 2))),
+                                       BSON_ARRAY(BSON("b" << 1))};
+
+    // Construct a QuerySolution joining a VirtualScanNode with a collection that does not exist.
+    auto virtScan =
+        std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+    auto eqLookupNode =
+        std::make_unique<EqLookupNode>(std::move(virtScan),
+                                       NamespaceString{"testdb.sbe_stage_builder_foreign"},
+                                       FieldPath{"a"},
+                                       FieldPath{"b"},
+                                       FieldPath{"out"},
+                                       EqLookupNode::LookupStrategy::kNestedLoopJoin,
+                                       boost::none);
+    auto querySolution = makeQuerySolution(std::move(eqLookupNode));
+
+    // Translate the QuerySolution tree to an sbe::PlanStage.
+    auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+    auto [resultSlots, stage, data] =
+        buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+    auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+
+    // Every local document is returned exactly once, with an empty 'out' array.
+    auto expected = std::vector<BSONObj>{BSON("a" << 1 << "out" << BSONArray()),
+                                         BSON("a" << BSON_ARRAY(1 << 2) << "out" << BSONArray()),
+                                         BSON("b" << 1 << "out" << BSONArray())};
+    size_t index = 0;
+    for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+        ASSERT_LT(index, expected.size());
+        auto [tagDoc, valDoc] = resultAccessors[0]->getViewOfValue();
+        ASSERT_TRUE(tagDoc == sbe::value::TypeTags::bsonObject);
+        ASSERT_BSONOBJ_EQ(BSONObj(sbe::value::bitcastTo<const char*>(valDoc)), expected[index++]);
+    }
+    ASSERT_EQ(index, expected.size());
+}
+
+TEST_F(SbeStageBuilderTest, GroupComputesAccumulatorsPerGroup) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "b" << 2)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << 3)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << 4)),
+                                       BSON_ARRAY(BSON("b" << 5))};
+
+    auto virtScan =
+        std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+    auto groupNode = makeGroupNode(
+        std::move(virtScan),
+        ExpressionFieldPath::parse(_expCtx.get(), "$a", _expCtx->variablesParseState),
+        BSON("total" << BSON("$sum"
+                             << "$b")
+                     << "first"
+                     << BSON("$first"
+                             << "$b")));
+    auto querySolution = makeQuerySolution(std::move(groupNode));
+
+    auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+    auto [resultSlots, stage, data] =
+        buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+    auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+
+    // The groups come out of a hash table, so order them by '_id' before comparing. A missing
+    // group-by value forms the null group.
+    BSONObjSet results = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+        auto [tag, val] = resultAccessors[0]->getViewOfValue();
+        ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+        BSONObjBuilder bob;
+        sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+        results.insert(bob.obj());
+    }
+    auto expected = std::vector<BSONObj>{BSON("_id" << BSONNULL << "total" << 5 << "first" << 5),
+                                         BSON("_id" << 1 << "total" << 6 << "first" << 2),
+                                         BSON("_id" << 2 << "total" << 3 << "first" << 3)};
+    ASSERT_EQ(results.size(), expected.size());
+    size_t index = 0;
+    for (auto&& result : results) {
+        ASSERT_BSONOBJ_EQ(result, expected[index++]);
+    }
+}
+
+TEST_F(SbeStageBuilderTest, GroupKeepsTheFieldOrderOfACompoundId) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "b" << 2)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << 2))};
+
+    auto virtScan =
+        std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+    std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> groupByExprs;
+    groupByExprs.emplace_back(
+        "_id.b", ExpressionFieldPath::parse(_expCtx.get(), "$b", _expCtx->variablesParseState));
+    groupByExprs.emplace_back(
+        "_id.a", ExpressionFieldPath::parse(_expCtx.get(), "$a", _expCtx->variablesParseState));
+    auto groupNode = std::make_unique<GroupNode>(std::move(virtScan),
+                                                 std::move(groupByExprs),
+                                                 std::vector<AccumulationStatement>{},
+                                                 false /* doingMerge */);
+    auto querySolution = makeQuerySolution(std::move(groupNode));
+
+    auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+    auto [resultSlots, stage, data] =
+        buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+    auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+
+    // The fields of '_id' are spelled out as in the $group, not in alphabetical order.
+    ASSERT_TRUE(stage->getNext() == sbe::PlanState::ADVANCED);
+    auto [tag, val] = resultAccessors[0]->getViewOfValue();
+    ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+    BSONObjBuilder bob;
+    sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+    auto result = bob.obj();
+    ASSERT_BSONOBJ_BINARY_EQ(result, BSON("_id" << BSON("b" << 2 << "a" << 1)));
+    ASSERT_TRUE(stage->getNext() == sbe::PlanState::IS_EOF);
+}
+
+TEST_F(SbeStageBuilderTest, GroupTellsNullFromMissingAsTheClassicEngineDoes) {
+    const std::vector<BSONObj> inputs = {fromjson("{a: null, b: 1}"),
+                                         fromjson("{b: 1}"),
+                                         fromjson("{a: null}"),
+                                         fromjson("{}"),
+                                         fromjson("{a: null, b: 1}")};
+
+    for (auto&& groupSpec : {fromjson("{$group: {_id: '$a', count: {$sum: 1}}}"),
+                             fromjson("{$group: {_id: {a: '$a', b: '$b'}, count: {$sum: 1}}}")}) {
+        auto groupStage = DocumentSourceGroup::createFromBson(groupSpec.firstElement(), _expCtx);
+        auto group = static_cast<DocumentSourceGroup*>(groupStage.get());
+
+        // Run the $group in the classic engine.
+        std::deque<DocumentSource::GetNextResult> mockResults;
+        for (auto&& input : inputs) {
+            mockResults.emplace_back(Document{input});
+        }
+        group->setSource(DocumentSourceMock::createForTest(std::move(mockResults), _expCtx).get());
+        BSONObjSet expected = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        for (auto next = group->getNext(); next.isAdvanced(); next = group->getNext()) {
+            expected.insert(next.releaseDocument().toBson());
+        }
+
+        // Run the same $group in SBE.
+        std::vector<BSONArray> docs;
+        for (auto&& input : inputs) {
+            docs.push_back(BSON_ARRAY(input));
+        }
+        auto virtScan =
+            std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+        auto groupNode = std::make_unique<GroupNode>(std::move(virtScan),
+                                                     group->getIdFields(),
+                                                     group->getAccumulatedFields(),
+                                                     false /* doingMerge */);
+        auto querySolution = makeQuerySolution(std::move(groupNode));
+        auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+        auto [resultSlots, stage, data] =
+            buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+        auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+        BSONObjSet results = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+            auto [tag, val] = resultAccessors[0]->getViewOfValue();
+            ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+            BSONObjBuilder bob;
+            sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+            results.insert(bob.obj());
+        }
+
+        // A missing '_id' groups along with null, whereas a missing field of a compound '_id' is
+        // left out of it and forms a group of its own.
+        ASSERT_EQ(results.size(), expected.size()) << groupSpec;
+        auto expectedIt = expected.begin();
+        for (auto&& result : results) {
+            ASSERT_BSONOBJ_EQ(result, *expectedIt++);
+        }
+    }
+}
+
+TEST_F(SbeStageBuilderTest, GroupByConstantUsesStreamingAggregation) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1)),
+                                       BSON_ARRAY(BSON("a" << 2)),
+                                       BSON_ARRAY(BSON("a" << 3))};
+
+    auto virtScan =
+        std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+    auto groupNode = makeGroupNode(std::move(virtScan),
+                                   ExpressionConstant::create(_expCtx.get(), Value(BSONNULL)),
+                                   BSON("count" << BSON("$sum" << 1)));
+    auto querySolution = makeQuerySolution(std::move(groupNode));
+
+    auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+    auto [resultSlots, stage, data] =
+        buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+
+    // All of the documents belong to the same group, which needs no hash table.
+    auto planString = sbe::DebugPrinter{}.print(stage->debugPrint());
+    ASSERT_STRING_CONTAINS(planString, "sgroup");
+
+    auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+    ASSERT_TRUE(stage->getNext() == sbe::PlanState::ADVANCED);
+    auto [tag, val] = resultAccessors[0]->getViewOfValue();
+    ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+    BSONObjBuilder bob;
+    sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+    ASSERT_BSONOBJ_EQ(bob.obj(), BSON("_id" << BSONNULL << "count" << 3));
+    ASSERT_TRUE(stage->getNext() == sbe::PlanState::IS_EOF);
+}
+
+TEST_F(SbeStageBuilderTest, WindowComputesTheSameFieldsAsTheClassicEngine) {
+    // The documents arrive sorted by partition and by 't' within each partition. A missing
+    // partition key falls into the null partition.
+    const std::vector<BSONObj> inputs = {fromjson("{_id: 0, p: null, t: 1, v: 5}"),
+                                         fromjson("{_id: 1, t: 2, v: null}"),
+                                         fromjson("{_id: 2, p: null, t: 3, v: 7.5}"),
+                                         fromjson("{_id: 3, p: 1, t: 1, v: 2}"),
+                                         fromjson("{_id: 4, p: 1, t: 2, v: 8}"),
+                                         fromjson("{_id: 5, p: 1, t: 4, v: 1.5}"),
+                                         fromjson("{_id: 6, p: 1, t: 7, v: -3}"),
+                                         fromjson("{_id: 7, p: 'a', t: 1, v: 4}")};
+    const auto numericInputs = std::vector<BSONObj>(inputs.begin() + 3, inputs.end());
+
+    const auto windowSpec = fromjson(
+        "{$_internalSetWindowFields: {partitionBy: '$p', sortBy: {t: 1}, output: {"
+        "sum: {$sum: '$v', window: {documents: [-1, 1]}},"
+        "avg: {$avg: '$v', window: {documents: ['unbounded', 'current']}},"
+        "min: {$min: '$v', window: {documents: [-2, 0]}},"
+        "max: {$max: '$v', window: {documents: ['current', 'unbounded']}},"
+        "prev: {$shift: {output: '$v', by: -1, default: 'none'}}}}}");
+    const auto sortedWindowSpec = fromjson(
+        "{$_internalSetWindowFields: {partitionBy: '$p', sortBy: {t: 1}, output: {"
+        "rate: {$derivative: {input: '$v'}, window: {documents: [-1, 0]}},"
+        "area: {$integral: {input: '$v'}, window: {documents: [-2, 0]}}}}}");
+
+    for (auto&& [spec, specInputs] : {std::make_pair(windowSpec, inputs),
+                                      std::make_pair(sortedWindowSpec, numericInputs)}) {
+        auto windowStage =
+            DocumentSourceInternalSetWindowFields::createFromBson(spec.firstElement(), _expCtx);
+        auto window = static_cast<DocumentSourceInternalSetWindowFields*>(windowStage.get());
+
+        // Run the window functions in the classic engine.
+        std::deque<DocumentSource::GetNextResult> mockResults;
+        for (auto&& input : specInputs) {
+            mockResults.emplace_back(Document{input});
+        }
+        auto mock = DocumentSourceMock::createForTest(std::move(mockResults), _expCtx);
+        window->setSource(mock.get());
+        std::vector<BSONObj> expected;
+        for (auto next = window->getNext(); next.isAdvanced(); next = window->getNext()) {
+            expected.push_back(next.releaseDocument().toBson());
+        }
+
+        // Run the same window functions in SBE.
+        std::vector<BSONArray> docs;
+        for (auto&& input : specInputs) {
+            docs.push_back(BSON_ARRAY(input));
+        }
+        auto virtScan =
+            std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+        auto windowNode = std::make_unique<WindowNode>(std::move(virtScan),
+                                                       window->getPartitionBy(),
+                                                       window->getSortBy(),
+                                                       window->getOutputFields());
+        auto querySolution = makeQuerySolution(std::move(windowNode));
+        auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+        auto [resultSlots, stage, data] =
+            buildPlanStage(std::move(querySolution), false, std::move(shardFiltererInterface));
+        auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+        std::vector<BSONObj> results;
+        for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+            auto [tag, val] = resultAccessors[0]->getViewOfValue();
+            ASSERT_TRUE(tag == sbe::value::TypeTags::bsonObject);
+            results.push_back(BSONObj{sbe::value::bitcastTo<const char*>(val)}.getOwned());
+        }
+
+        // The classic engine appends the window functions in no particular order.
+        ASSERT_EQ(results.size(), expected.size()) << spec;
+        UnorderedFieldsBSONObjComparator comparator;
+        for (size_t idx = 0; idx < results.size(); ++idx) {
+            ASSERT_TRUE(comparator.evaluate(results[idx] == expected[idx]))
+                << spec << " " << results[idx] << " " << expected[idx];
+        }
+    }
+}
 }  // namespace mongo
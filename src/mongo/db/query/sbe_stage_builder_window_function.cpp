@@ -0,0 +1,473 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_stage_builder_window_function.h"
+
+#include "mongo/db/pipeline/window_function/window_function_shift.h"
+#include "mongo/db/query/datetime/date_time_support.h"
+
+namespace mongo::stage_builder {
+namespace {
+struct FrameBounds {
+    boost::optional<int64_t> lower;
+    boost::optional<int64_t> upper;
+};
+
+boost::optional<int64_t> translateBound(const WindowBounds::Bound<int>& bound) {
+    if (stdx::holds_alternative<WindowBounds::Unbounded>(bound)) {
+        return boost::none;
+    } else if (stdx::holds_alternative<WindowBounds::Current>(bound)) {
+        return 0;
+    }
+    return stdx::get<int>(bound);
+}
+
+sbe::WindowStage::Window makeWindow(sbe::value::SlotId windowSlot,
+                                    std::unique_ptr<sbe::EExpression> initExpr,
+                                    std::unique_ptr<sbe::EExpression> addExpr,
+                                    std::unique_ptr<sbe::EExpression> removeExpr,
+                                    const FrameBounds& bounds,
+                                    bool removeSeesNextRow = false) {
+    return sbe::WindowStage::Window{windowSlot,
+                                    std::move(initExpr),
+                                    std::move(addExpr),
+                                    std::move(removeExpr),
+                                    bounds.lower,
+                                    bounds.upper,
+                                    removeSeesNextRow};
+}
+
+/**
+ * Builds a window which adds up the numeric values of 'argSlot' for the rows of the frame. As with
+ * the classic 'RemovableSum', the state keeps a double-double sum of the finite values along with
+ * counts of the NaN and infinite values, so that removing a row restores the sum of the remaining
+ * rows exactly.
+ */
+sbe::WindowStage::Window makeRemovableSum(StageBuilderState& state,
+                                          sbe::value::SlotId argSlot,
+                                          const FrameBounds& bounds) {
+    auto sumSlot = state.slotId();
+    return makeWindow(
+        sumSlot,
+        nullptr,
+        makeFunction("removableSumAdd", makeVariable(sumSlot), makeVariable(argSlot)),
+        makeFunction("removableSumRemove", makeVariable(sumSlot), makeVariable(argSlot)),
+        bounds);
+}
+
+WindowFunctionTranslation buildWindowFunctionSum(StageBuilderState& state,
+                                                 const window_function::Expression& expr,
+                                                 sbe::value::SlotId argSlot,
+                                                 boost::optional<sbe::value::SlotId> sortBySlot,
+                                                 const FrameBounds& bounds) {
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(makeRemovableSum(state, argSlot, bounds));
+    translation.finalExpr =
+        makeFunction("removableSumFinalize", makeVariable(translation.windows.back().windowSlot));
+    return translation;
+}
+
+WindowFunctionTranslation buildWindowFunctionAvg(StageBuilderState& state,
+                                                 const window_function::Expression& expr,
+                                                 sbe::value::SlotId argSlot,
+                                                 boost::optional<sbe::value::SlotId> sortBySlot,
+                                                 const FrameBounds& bounds) {
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(makeRemovableSum(state, argSlot, bounds));
+    auto sumSlot = translation.windows.back().windowSlot;
+
+    auto countSlot = state.slotId();
+    auto makeCountUpdate = [&](sbe::EPrimBinary::Op op) {
+        return sbe::makeE<sbe::EIf>(
+            makeFunction("isNumber", makeVariable(argSlot)),
+            makeBinaryOp(op,
+                         makeVariable(countSlot),
+                         makeConstant(sbe::value::TypeTags::NumberInt64, 1)),
+            makeVariable(countSlot));
+    };
+    translation.windows.push_back(makeWindow(countSlot,
+                                             makeConstant(sbe::value::TypeTags::NumberInt64, 0),
+                                             makeCountUpdate(sbe::EPrimBinary::add),
+                                             makeCountUpdate(sbe::EPrimBinary::sub),
+                                             bounds));
+
+    // As with the classic $avg, a NaN or infinite sum is returned as is, and any other sum is
+    // divided by the count as a double, unless it is a decimal.
+    translation.finalExpr = sbe::makeE<sbe::EIf>(
+        makeBinaryOp(sbe::EPrimBinary::eq,
+                     makeVariable(countSlot),
+                     makeConstant(sbe::value::TypeTags::NumberInt64, 0)),
+        makeConstant(sbe::value::TypeTags::Null, 0),
+        makeLocalBind(
+            state.frameIdGenerator,
+            [&](sbe::EVariable sum) {
+                return sbe::makeE<sbe::EIf>(
+                    makeBinaryOp(sbe::EPrimBinary::logicOr,
+                                 makeFunction("isNaN", sum.clone()),
+                                 makeFunction("isInfinity", sum.clone())),
+                    sum.clone(),
+                    makeBinaryOp(sbe::EPrimBinary::div, sum.clone(), makeVariable(countSlot)));
+            },
+            makeFunction("removableSumFinalize", makeVariable(sumSlot))));
+    return translation;
+}
+
+/**
+ * $min and $max cannot remove a row from their state, so the WindowStage recomputes it whenever a
+ * row leaves the frame.
+ */
+WindowFunctionTranslation buildWindowFunctionMinMax(StageBuilderState& state,
+                                                    sbe::value::SlotId argSlot,
+                                                    sbe::EPrimBinary::Op op,
+                                                    const FrameBounds& bounds) {
+    auto windowSlot = state.slotId();
+    auto addExpr = sbe::makeE<sbe::EIf>(
+        generateNullOrMissing(makeVariable(argSlot)),
+        makeVariable(windowSlot),
+        sbe::makeE<sbe::EIf>(
+            makeBinaryOp(sbe::EPrimBinary::logicOr,
+                         makeNot(makeFunction("exists", makeVariable(windowSlot))),
+                         makeBinaryOp(
+                             op, makeVariable(argSlot), makeVariable(windowSlot), state.env)),
+            makeVariable(argSlot),
+            makeVariable(windowSlot)));
+
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(
+        makeWindow(windowSlot, nullptr, std::move(addExpr), nullptr, bounds));
+    translation.finalExpr = makeFillEmptyNull(makeVariable(windowSlot));
+    return translation;
+}
+
+WindowFunctionTranslation buildWindowFunctionMin(StageBuilderState& state,
+                                                 const window_function::Expression& expr,
+                                                 sbe::value::SlotId argSlot,
+                                                 boost::optional<sbe::value::SlotId> sortBySlot,
+                                                 const FrameBounds& bounds) {
+    return buildWindowFunctionMinMax(state, argSlot, sbe::EPrimBinary::less, bounds);
+}
+
+WindowFunctionTranslation buildWindowFunctionMax(StageBuilderState& state,
+                                                 const window_function::Expression& expr,
+                                                 sbe::value::SlotId argSlot,
+                                                 boost::optional<sbe::value::SlotId> sortBySlot,
+                                                 const FrameBounds& bounds) {
+    return buildWindowFunctionMinMax(state, argSlot, sbe::EPrimBinary::greater, bounds);
+}
+
+/**
+ * The frame of $shift holds at most the single row being shifted to, so the window simply holds the
+ * value of that row, or nothing if the row falls outside of the partition.
+ */
+WindowFunctionTranslation buildWindowFunctionShift(StageBuilderState& state,
+                                                   const window_function::Expression& expr,
+                                                   sbe::value::SlotId argSlot,
+                                                   boost::optional<sbe::value::SlotId> sortBySlot,
+                                                   const FrameBounds& bounds) {
+    auto& shiftExpr = static_cast<const window_function::ExpressionShift&>(expr);
+    auto windowSlot = state.slotId();
+
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(makeWindow(windowSlot,
+                                             nullptr,
+                                             makeFillEmptyNull(makeVariable(argSlot)),
+                                             makeConstant(sbe::value::TypeTags::Nothing, 0),
+                                             bounds));
+
+    auto defaultVal = shiftExpr.defaultVal();
+    if (defaultVal && !defaultVal->missing()) {
+        auto [tag, val] = makeValue(*defaultVal);
+        translation.finalExpr = makeFunction(
+            "fillEmpty", makeVariable(windowSlot), sbe::makeE<sbe::EConstant>(tag, val));
+    } else {
+        translation.finalExpr = makeFillEmptyNull(makeVariable(windowSlot));
+    }
+    return translation;
+}
+
+/**
+ * Produces the value of the sortBy field of the row entering a frame of $derivative or $integral,
+ * failing if it is not a date when a 'unit' is given, or not a number otherwise.
+ */
+std::unique_ptr<sbe::EExpression> makeCheckedSortBy(
+    const window_function::ExpressionWithUnit& expr,
+    boost::optional<sbe::value::SlotId> sortBySlot) {
+    tassert(6000510,
+            str::stream() << expr.getOpName() << " window function requires a sortBy slot",
+            sortBySlot.has_value());
+
+    if (expr.unit()) {
+        return sbe::makeE<sbe::EIf>(
+            makeFunction("isDate", makeVariable(*sortBySlot)),
+            makeVariable(*sortBySlot),
+            sbe::makeE<sbe::EFail>(ErrorCodes::Error{6000511},
+                                   str::stream() << expr.getOpName()
+                                                 << " with 'unit' expects the sortBy field to be "
+                                                    "a Date"));
+    }
+    return sbe::makeE<sbe::EIf>(
+        makeFunction("isNumber", makeVariable(*sortBySlot)),
+        makeVariable(*sortBySlot),
+        sbe::makeE<sbe::EFail>(ErrorCodes::Error{6000512},
+                               str::stream() << expr.getOpName()
+                                             << " (with no 'unit') expects the sortBy field to be "
+                                                "numeric"));
+}
+
+std::unique_ptr<sbe::EExpression> makeCheckedInput(const window_function::Expression& expr,
+                                                   sbe::value::SlotId argSlot) {
+    return sbe::makeE<sbe::EIf>(
+        makeFunction("isNumber", makeVariable(argSlot)),
+        makeVariable(argSlot),
+        sbe::makeE<sbe::EFail>(ErrorCodes::Error{6000513},
+                               str::stream() << expr.getOpName() << " input must be numeric"));
+}
+
+/**
+ * Returns the number of milliseconds in the 'unit' of $derivative or $integral, if any.
+ */
+boost::optional<long long> getUnitMillis(const window_function::ExpressionWithUnit& expr) {
+    if (!expr.unit()) {
+        return boost::none;
+    }
+    return uassertStatusOK(timeUnitTypicalMilliseconds(*expr.unit()));
+}
+
+/**
+ * $derivative only depends on the first and the last row of its frame. The window tracking the last
+ * row keeps its state when a row leaves the frame, while the window tracking the first row moves on
+ * to the row following the one leaving the frame, so neither is ever recomputed.
+ */
+WindowFunctionTranslation buildWindowFunctionDerivative(
+    StageBuilderState& state,
+    const window_function::Expression& expr,
+    sbe::value::SlotId argSlot,
+    boost::optional<sbe::value::SlotId> sortBySlot,
+    const FrameBounds& bounds) {
+    auto& derivativeExpr = static_cast<const window_function::ExpressionWithUnit&>(expr);
+    auto makePoint = [&]() {
+        return makeFunction("newArray",
+                            makeCheckedSortBy(derivativeExpr, sortBySlot),
+                            makeCheckedInput(expr, argSlot));
+    };
+
+    auto firstSlot = state.slotId();
+    auto lastSlot = state.slotId();
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(makeWindow(
+        firstSlot,
+        nullptr,
+        sbe::makeE<sbe::EIf>(
+            makeFunction("exists", makeVariable(firstSlot)), makeVariable(firstSlot), makePoint()),
+        makePoint(),
+        bounds,
+        true /* removeSeesNextRow */));
+    translation.windows.push_back(
+        makeWindow(lastSlot, nullptr, makePoint(), makeVariable(lastSlot), bounds));
+
+    auto getCoordinate = [](sbe::value::SlotId pointSlot, int32_t idx) {
+        return makeFunction("getElement",
+                            makeVariable(pointSlot),
+                            makeConstant(sbe::value::TypeTags::NumberInt32, idx));
+    };
+    auto unitMillis = getUnitMillis(derivativeExpr);
+    translation.finalExpr = makeLocalBind(
+        state.frameIdGenerator,
+        [&](sbe::EVariable run, sbe::EVariable rise) {
+            // The run is zero when the frame holds a single row, in which case the derivative is
+            // null rather than an error.
+            auto result = makeBinaryOp(sbe::EPrimBinary::div, rise.clone(), run.clone());
+            if (unitMillis) {
+                result = makeBinaryOp(sbe::EPrimBinary::mul,
+                                      std::move(result),
+                                      makeConstant(sbe::value::TypeTags::NumberInt64, *unitMillis));
+            }
+            return sbe::makeE<sbe::EIf>(
+                makeBinaryOp(sbe::EPrimBinary::logicOr,
+                             makeNot(makeFunction("exists", run.clone())),
+                             makeBinaryOp(sbe::EPrimBinary::eq,
+                                          run.clone(),
+                                          makeConstant(sbe::value::TypeTags::NumberInt32, 0))),
+                makeConstant(sbe::value::TypeTags::Null, 0),
+                std::move(result));
+        },
+        makeBinaryOp(
+            sbe::EPrimBinary::sub, getCoordinate(lastSlot, 0), getCoordinate(firstSlot, 0)),
+        makeBinaryOp(
+            sbe::EPrimBinary::sub, getCoordinate(lastSlot, 1), getCoordinate(firstSlot, 1)));
+    return translation;
+}
+
+/**
+ * $integral adds up the areas of the trapezoids formed by consecutive rows of its frame. The state
+ * is an array [sum, firstX, firstY, lastX, lastY] holding the removable sum of the areas along with
+ * the coordinates of the first and the last row of the frame. A row entering the frame adds the
+ * trapezoid it forms with the last row, while the first row leaving the frame removes the one it
+ * forms with the row following it, which becomes the first row.
+ */
+WindowFunctionTranslation buildWindowFunctionIntegral(
+    StageBuilderState& state,
+    const window_function::Expression& expr,
+    sbe::value::SlotId argSlot,
+    boost::optional<sbe::value::SlotId> sortBySlot,
+    const FrameBounds& bounds) {
+    auto& integralExpr = static_cast<const window_function::ExpressionWithUnit&>(expr);
+    auto windowSlot = state.slotId();
+
+    auto getElement = [&](int32_t idx) {
+        return makeFunction("getElement",
+                            makeVariable(windowSlot),
+                            makeConstant(sbe::value::TypeTags::NumberInt32, idx));
+    };
+    auto makeArea = [](std::unique_ptr<sbe::EExpression> fromX,
+                       std::unique_ptr<sbe::EExpression> fromY,
+                       std::unique_ptr<sbe::EExpression> toX,
+                       std::unique_ptr<sbe::EExpression> toY) {
+        return makeBinaryOp(
+            sbe::EPrimBinary::div,
+            makeBinaryOp(sbe::EPrimBinary::mul,
+                         makeBinaryOp(sbe::EPrimBinary::sub, std::move(toX), std::move(fromX)),
+                         makeBinaryOp(sbe::EPrimBinary::add, std::move(toY), std::move(fromY))),
+            makeConstant(sbe::value::TypeTags::NumberDouble, 2.0));
+    };
+
+    auto addExpr = makeLocalBind(
+        state.frameIdGenerator,
+        [&](sbe::EVariable x, sbe::EVariable y) {
+            return sbe::makeE<sbe::EIf>(
+                makeFunction("exists", makeVariable(windowSlot)),
+                makeFunction(
+                    "newArray",
+                    makeFunction("removableSumAdd",
+                                 getElement(0),
+                                 makeArea(getElement(3), getElement(4), x.clone(), y.clone())),
+                    getElement(1),
+                    getElement(2),
+                    x.clone(),
+                    y.clone()),
+                makeFunction("newArray",
+                             makeFunction("removableSumAdd",
+                                          makeConstant(sbe::value::TypeTags::Nothing, 0),
+                                          makeConstant(sbe::value::TypeTags::NumberInt32, 0)),
+                             x.clone(),
+                             y.clone(),
+                             x.clone(),
+                             y.clone()));
+        },
+        makeCheckedSortBy(integralExpr, sortBySlot),
+        makeCheckedInput(expr, argSlot));
+
+    auto removeExpr = makeLocalBind(
+        state.frameIdGenerator,
+        [&](sbe::EVariable x, sbe::EVariable y) {
+            return makeFunction(
+                "newArray",
+                makeFunction("removableSumRemove",
+                             getElement(0),
+                             makeArea(getElement(1), getElement(2), x.clone(), y.clone())),
+                x.clone(),
+                y.clone(),
+                getElement(3),
+                getElement(4));
+        },
+        makeCheckedSortBy(integralExpr, sortBySlot),
+        makeCheckedInput(expr, argSlot));
+
+    WindowFunctionTranslation translation;
+    translation.windows.push_back(makeWindow(windowSlot,
+                                             nullptr,
+                                             std::move(addExpr),
+                                             std::move(removeExpr),
+                                             bounds,
+                                             true /* removeSeesNextRow */));
+
+    // With a 'unit', the x coordinates are dates whose differences are in milliseconds.
+    auto result = makeFunction("removableSumFinalize", getElement(0));
+    if (auto unitMillis = getUnitMillis(integralExpr)) {
+        result = makeBinaryOp(sbe::EPrimBinary::div,
+                              std::move(result),
+                              makeConstant(sbe::value::TypeTags::NumberInt64, *unitMillis));
+    }
+    translation.finalExpr = sbe::makeE<sbe::EIf>(makeFunction("exists", makeVariable(windowSlot)),
+                                                 std::move(result),
+                                                 makeConstant(sbe::value::TypeTags::Null, 0));
+    return translation;
+}
+
+using BuildWindowFunctionFn =
+    std::function<WindowFunctionTranslation(StageBuilderState&,
+                                            const window_function::Expression&,
+                                            sbe::value::SlotId,
+                                            boost::optional<sbe::value::SlotId>,
+                                            const FrameBounds&)>;
+
+const StringDataMap<BuildWindowFunctionFn> kWindowFunctionBuilders = {
+    {"$sum", &buildWindowFunctionSum},
+    {"$avg", &buildWindowFunctionAvg},
+    {"$min", &buildWindowFunctionMin},
+    {"$max", &buildWindowFunctionMax},
+    {"$shift", &buildWindowFunctionShift},
+    {"$derivative", &buildWindowFunctionDerivative},
+    {"$integral", &buildWindowFunctionIntegral},
+};
+}  // namespace
+
+bool canBuildWindowFunction(const window_function::Expression& expr) {
+    return kWindowFunctionBuilders.count(expr.getOpName()) > 0 &&
+        stdx::holds_alternative<WindowBounds::DocumentBased>(expr.bounds().bounds);
+}
+
+WindowFunctionTranslation buildWindowFunction(StageBuilderState& state,
+                                              const window_function::Expression& expr,
+                                              sbe::value::SlotId argSlot,
+                                              boost::optional<sbe::value::SlotId> sortBySlot) {
+    auto opName = expr.getOpName();
+    auto it = kWindowFunctionBuilders.find(opName);
+    uassert(6000514,
+            str::stream() << "Unsupported window function in SBE window function builder: "
+                          << opName,
+            it != kWindowFunctionBuilders.end());
+
+    auto bounds = expr.bounds();
+    auto documentBounds = stdx::get_if<WindowBounds::DocumentBased>(&bounds.bounds);
+    uassert(6000515,
+            str::stream() << "Only document-based windows are supported in SBE, but " << opName
+                          << " uses a range-based window",
+            documentBounds);
+
+    return it->second(state,
+                      expr,
+                      argSlot,
+                      sortBySlot,
+                      FrameBounds{translateBound(documentBounds->lower),
+                                  translateBound(documentBounds->upper)});
+}
+}  // namespace mongo::stage_builder
@@ -0,0 +1,64 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/window.h"
+#include "mongo/db/pipeline/window_function/window_function_expression.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+
+namespace mongo::stage_builder {
+/**
+ * The translation of a window function into SBE: the windows to be maintained by a WindowStage,
+ * along with an expression computing the value of the window function from the state of those
+ * windows.
+ */
+struct WindowFunctionTranslation {
+    std::vector<sbe::WindowStage::Window> windows;
+    std::unique_ptr<sbe::EExpression> finalExpr;
+};
+
+/**
+ * Returns true if 'buildWindowFunction()' can translate the window function 'expr'.
+ */
+bool canBuildWindowFunction(const window_function::Expression& expr);
+
+/**
+ * Translates a $setWindowFields window function into SBE. The 'argSlot' holds the value of the
+ * window function's input expression and the optional 'sortBySlot' holds the value of the sortBy
+ * field, both of which must be among the current slots of the WindowStage. Only document-based
+ * windows are supported, over the $sum, $avg, $min, $max, $shift, $derivative and $integral window
+ * functions.
+ */
+WindowFunctionTranslation buildWindowFunction(StageBuilderState& state,
+                                              const window_function::Expression& expr,
+                                              sbe::value::SlotId argSlot,
+                                              boost::optional<sbe::value::SlotId> sortBySlot);
+}  // namespace mongo::stage_builder
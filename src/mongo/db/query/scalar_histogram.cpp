@@ -0,0 +1,222 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/scalar_histogram.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+constexpr auto kBucketsField = "buckets"_sd;
+constexpr auto kBoundField = "bound"_sd;
+constexpr auto kEqualCountField = "equalCount"_sd;
+constexpr auto kRangeCountField = "rangeCount"_sd;
+constexpr auto kRangeDistinctsField = "rangeDistincts"_sd;
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false /* considerFieldName */);
+}
+
+/**
+ * Returns the fraction of the values strictly between 'lo' and 'hi' which are expected to be less
+ * than 'value', where 'lo' < 'value' < 'hi'. 'lo' is nullptr for the first bucket, which has no
+ * lower bound.
+ */
+double rangeFractionBelow(const BSONElement* lo, const BSONElement& hi, const BSONElement& value) {
+    if (value.canonicalType() != hi.canonicalType()) {
+        // All the values in the range which have the type of the upper bound sort after 'value'.
+        return 0.0;
+    }
+    if (lo && lo->isNumber() && hi.isNumber() && value.isNumber()) {
+        const double low = lo->numberDouble();
+        const double high = hi.numberDouble();
+        if (high > low) {
+            return std::clamp((value.numberDouble() - low) / (high - low), 0.0, 1.0);
+        }
+    }
+    // Without a way to interpolate assume the value sits in the middle of the range.
+    return 0.5;
+}
+
+double getCount(const BSONObj& bucket, StringData fieldName) {
+    auto elem = bucket[fieldName];
+    uassert(6001100,
+            str::stream() << "Histogram bucket field '" << fieldName << "' must be a number",
+            elem.isNumber());
+    return elem.numberDouble();
+}
+}  // namespace
+
+ScalarHistogram ScalarHistogram::make(const std::vector<std::pair<BSONElement, double>>& values,
+                                      size_t numBuckets) {
+    tassert(6001101, "A histogram must have at least one bucket", numBuckets > 0);
+
+    double totalCount = 0;
+    for (auto&& [value, count] : values) {
+        totalCount += count;
+    }
+    const double depth = totalCount / numBuckets;
+
+    ScalarHistogram histogram;
+    BSONArrayBuilder bounds;
+    Bucket current;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const auto& [value, count] = values[i];
+        const bool isLast = i + 1 == values.size();
+        const bool canClose = histogram._buckets.size() + 1 < numBuckets;
+        if (isLast || (canClose && current.rangeCount + count >= depth)) {
+            current.equalCount = count;
+            bounds.append(value);
+            histogram._buckets.push_back(current);
+            current = Bucket{};
+        } else {
+            current.rangeCount += count;
+            current.rangeDistincts += 1;
+        }
+    }
+
+    histogram._boundsObj = bounds.obj();
+    for (auto&& bound : histogram._boundsObj) {
+        histogram._bounds.push_back(bound);
+    }
+    return histogram;
+}
+
+ScalarHistogram ScalarHistogram::fromBSON(const BSONObj& obj) {
+    auto bucketsElem = obj[kBucketsField];
+    uassert(6001102, "Histogram must contain an array of buckets", bucketsElem.type() == Array);
+
+    ScalarHistogram histogram;
+    BSONArrayBuilder bounds;
+    BSONElement prevBound;
+    for (auto&& bucketElem : bucketsElem.Obj()) {
+        uassert(6001103, "Histogram bucket must be an object", bucketElem.type() == Object);
+        auto bucketObj = bucketElem.Obj();
+        auto bound = bucketObj[kBoundField];
+        uassert(6001104, "Histogram bucket must have a bound", !bound.eoo());
+        uassert(6001105,
+                "Histogram bucket bounds must be in ascending order",
+                prevBound.eoo() || compareValues(prevBound, bound) < 0);
+        prevBound = bound;
+        bounds.append(bound);
+        histogram._buckets.push_back({getCount(bucketObj, kEqualCountField),
+                                      getCount(bucketObj, kRangeCountField),
+                                      getCount(bucketObj, kRangeDistinctsField)});
+    }
+
+    histogram._boundsObj = bounds.obj();
+    for (auto&& bound : histogram._boundsObj) {
+        histogram._bounds.push_back(bound);
+    }
+    return histogram;
+}
+
+BSONObj ScalarHistogram::toBSON() const {
+    BSONObjBuilder bob;
+    BSONArrayBuilder buckets(bob.subarrayStart(kBucketsField));
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        BSONObjBuilder bucket(buckets.subobjStart());
+        bucket.appendAs(_bounds[i], kBoundField);
+        bucket.append(kEqualCountField, _buckets[i].equalCount);
+        bucket.append(kRangeCountField, _buckets[i].rangeCount);
+        bucket.append(kRangeDistinctsField, _buckets[i].rangeDistincts);
+    }
+    buckets.doneFast();
+    return bob.obj();
+}
+
+double ScalarHistogram::estimateEqual(const BSONElement& value) const {
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const int cmp = compareValues(value, _bounds[i]);
+        if (cmp > 0) {
+            continue;
+        }
+        if (cmp == 0) {
+            return _buckets[i].equalCount;
+        }
+        // The value falls inside the range of this bucket, assume a uniform distribution of the
+        // distinct values within the range.
+        const auto& bucket = _buckets[i];
+        return bucket.rangeDistincts > 0 ? bucket.rangeCount / bucket.rangeDistincts : 0.0;
+    }
+    return 0.0;
+}
+
+double ScalarHistogram::estimateLessThan(const BSONElement& value, bool inclusive) const {
+    double count = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const auto& bucket = _buckets[i];
+        const int cmp = compareValues(value, _bounds[i]);
+        if (cmp > 0) {
+            count += bucket.rangeCount + bucket.equalCount;
+            continue;
+        }
+        if (cmp == 0) {
+            return count + bucket.rangeCount + (inclusive ? bucket.equalCount : 0.0);
+        }
+        const BSONElement* lo = i > 0 ? &_bounds[i - 1] : nullptr;
+        return count + bucket.rangeCount * rangeFractionBelow(lo, _bounds[i], value);
+    }
+    return count;
+}
+
+double ScalarHistogram::estimateInterval(const Interval& interval) const {
+    if (interval.getDirection() == Interval::Direction::kDirectionDescending) {
+        return estimateInterval(interval.reverseClone());
+    }
+    if (interval.isPoint()) {
+        return estimateEqual(interval.start);
+    }
+    const double upTo = estimateLessThan(interval.end, interval.endInclusive);
+    const double below = estimateLessThan(interval.start, !interval.startInclusive);
+    return std::max(0.0, upTo - below);
+}
+
+double ScalarHistogram::getTotalCount() const {
+    double count = 0;
+    for (auto&& bucket : _buckets) {
+        count += bucket.rangeCount + bucket.equalCount;
+    }
+    return count;
+}
+
+double ScalarHistogram::getDistinctCount() const {
+    double count = 0;
+    for (auto&& bucket : _buckets) {
+        count += bucket.rangeDistincts + 1;
+    }
+    return count;
+}
+
+}  // namespace mongo
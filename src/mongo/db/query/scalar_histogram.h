@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/interval.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * An equi-depth histogram over the values of a single field, as produced by the 'analyze' command.
+ * Each bucket is identified by its (inclusive) upper bound and records:
+ *   - 'equalCount': the number of values equal to the upper bound,
+ *   - 'rangeCount': the number of values strictly between the previous bound and this one,
+ *   - 'rangeDistincts': the number of distinct values strictly between the two bounds.
+ *
+ * Values are ordered using the BSON canonical ordering without a collation, which is the order in
+ * which the values appear in an index. Counts are doubles since the histogram may be scaled up
+ * from a sample of the collection.
+ */
+class ScalarHistogram {
+public:
+    struct Bucket {
+        double equalCount = 0;
+        double rangeCount = 0;
+        double rangeDistincts = 0;
+    };
+
+    /**
+     * Builds a histogram with at most 'numBuckets' buckets from the distinct values in 'values',
+     * each paired with the number of times it occurs. The values must be sorted in ascending
+     * order and be distinct. The BSONElements only need to stay valid for the duration of the
+     * call.
+     */
+    static ScalarHistogram make(const std::vector<std::pair<BSONElement, double>>& values,
+                                size_t numBuckets);
+
+    /**
+     * Parses a histogram serialized by toBSON(). Throws if 'obj' is malformed.
+     */
+    static ScalarHistogram fromBSON(const BSONObj& obj);
+
+    ScalarHistogram() = default;
+
+    BSONObj toBSON() const;
+
+    /**
+     * Estimates the number of values equal to 'value'.
+     */
+    double estimateEqual(const BSONElement& value) const;
+
+    /**
+     * Estimates the number of values falling within 'interval'. The interval may be in either
+     * direction.
+     */
+    double estimateInterval(const Interval& interval) const;
+
+    /**
+     * Total number of values summarized by this histogram.
+     */
+    double getTotalCount() const;
+
+    /**
+     * Estimated number of distinct values summarized by this histogram.
+     */
+    double getDistinctCount() const;
+
+    size_t getNumBuckets() const {
+        return _buckets.size();
+    }
+
+    const BSONElement& getBound(size_t i) const {
+        return _bounds[i];
+    }
+
+    const Bucket& getBucket(size_t i) const {
+        return _buckets[i];
+    }
+
+private:
+    /**
+     * Estimates the number of values which are less than 'value', or less than or equal to it if
+     * 'inclusive' is true.
+     */
+    double estimateLessThan(const BSONElement& value, bool inclusive) const;
+
+    // Owns the bucket upper bounds, stored as an array in ascending order. '_bounds' holds one
+    // element pointing into this object per bucket.
+    BSONObj _boundsObj;
+    std::vector<BSONElement> _bounds;
+    std::vector<Bucket> _buckets;
+};
+
+/**
+ * The statistics collected on a collection by the 'analyze' command which are available to the
+ * query planner.
+ */
+struct CollectionStatistics {
+    // Number of documents in the collection when the statistics were collected.
+    long long numRecords = 0;
+
+    // Histograms keyed by the dotted path of the analyzed field.
+    StringMap<ScalarHistogram> histograms;
+};
+
+}  // namespace mongo
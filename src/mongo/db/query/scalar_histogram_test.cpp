@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/scalar_histogram.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Builds a histogram from 'valuesObj', whose fields are the distinct values in ascending order,
+ * and 'counts', the number of occurrences of each of them.
+ */
+ScalarHistogram makeHistogram(const BSONObj& valuesObj,
+                              const std::vector<double>& counts,
+                              size_t numBuckets) {
+    std::vector<std::pair<BSONElement, double>> values;
+    size_t i = 0;
+    for (auto&& elem : valuesObj) {
+        values.emplace_back(elem, counts[i++]);
+    }
+    return ScalarHistogram::make(values, numBuckets);
+}
+
+/**
+ * Makes a histogram over the integers [1, 100], each of which occurs exactly once.
+ */
+ScalarHistogram makeUniformHistogram(size_t numBuckets) {
+    BSONObjBuilder bob;
+    for (int i = 1; i <= 100; ++i) {
+        bob.append("", i);
+    }
+    return makeHistogram(bob.obj(), std::vector<double>(100, 1.0), numBuckets);
+}
+
+TEST(ScalarHistogramTest, BuildsEquiDepthBuckets) {
+    auto histogram = makeUniformHistogram(10);
+    ASSERT_EQ(histogram.getNumBuckets(), 10U);
+    for (size_t i = 0; i < histogram.getNumBuckets(); ++i) {
+        ASSERT_EQ(histogram.getBound(i).numberInt(), static_cast<int>(10 * (i + 1)));
+        ASSERT_EQ(histogram.getBucket(i).equalCount, 1.0);
+        ASSERT_EQ(histogram.getBucket(i).rangeCount, 9.0);
+        ASSERT_EQ(histogram.getBucket(i).rangeDistincts, 9.0);
+    }
+    ASSERT_EQ(histogram.getTotalCount(), 100.0);
+    ASSERT_EQ(histogram.getDistinctCount(), 100.0);
+}
+
+TEST(ScalarHistogramTest, NeverExceedsRequestedNumberOfBuckets) {
+    auto histogram = makeHistogram(BSON_ARRAY(1 << 2 << 3 << 4 << 5), {10, 10, 10, 10, 10}, 2);
+    ASSERT_EQ(histogram.getNumBuckets(), 2U);
+    ASSERT_EQ(histogram.getTotalCount(), 50.0);
+    ASSERT_EQ(histogram.getDistinctCount(), 5.0);
+}
+
+TEST(ScalarHistogramTest, EstimatesEqualityPredicates) {
+    auto histogram = makeUniformHistogram(10);
+    ASSERT_EQ(histogram.estimateEqual(BSON("" << 50).firstElement()), 1.0);
+    ASSERT_EQ(histogram.estimateEqual(BSON("" << 55).firstElement()), 1.0);
+    ASSERT_EQ(histogram.estimateEqual(BSON("" << 1000).firstElement()), 0.0);
+    ASSERT_EQ(histogram.estimateEqual(BSON("" << 50.0).firstElement()), 1.0);
+}
+
+TEST(ScalarHistogramTest, TracksHeavyHittersAsBucketBounds) {
+    auto histogram = makeHistogram(BSON_ARRAY("a"
+                                              << "b"
+                                              << "c"
+                                              << "d"
+                                              << "e"),
+                                   {50, 1, 1, 1, 1},
+                                   2);
+    ASSERT_EQ(histogram.getNumBuckets(), 2U);
+    ASSERT_EQ(histogram.estimateEqual(BSON(""
+                                           << "a")
+                                          .firstElement()),
+              50.0);
+    ASSERT_EQ(histogram.estimateEqual(BSON(""
+                                           << "c")
+                                          .firstElement()),
+              1.0);
+    ASSERT_EQ(histogram.estimateEqual(BSON("" << 1).firstElement()), 0.0);
+}
+
+TEST(ScalarHistogramTest, EstimatesRangePredicates) {
+    auto histogram = makeUniformHistogram(10);
+
+    // Ranges whose ends are bucket bounds are estimated exactly.
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON("" << 20 << "" << 40), true, true)), 21.0);
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON("" << 20 << "" << 40), false, false)),
+              19.0);
+
+    // Ranges ending inside a bucket are interpolated.
+    ASSERT_APPROX_EQUAL(
+        histogram.estimateInterval(Interval(BSON("" << 25 << "" << 35), false, false)), 10.0, 0.01);
+
+    // Descending intervals produce the same estimate as their ascending counterpart.
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON("" << 40 << "" << 20), true, true)), 21.0);
+
+    // Point intervals are estimated as equality predicates.
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON("" << 30 << "" << 30), true, true)), 1.0);
+
+    ASSERT_EQ(histogram.estimateInterval(
+                  Interval(BSON("" << MINKEY << "" << MAXKEY), true, true)),
+              100.0);
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON("" << 200 << "" << 300), true, true)),
+              0.0);
+}
+
+TEST(ScalarHistogramTest, RangeOfOtherTypeEstimatesZero) {
+    auto histogram = makeUniformHistogram(10);
+    ASSERT_EQ(histogram.estimateInterval(Interval(BSON(""
+                                                       << ""
+                                                       << "" << BSONObj()),
+                                                  true,
+                                                  false)),
+              0.0);
+}
+
+TEST(ScalarHistogramTest, RoundTripsThroughBSON) {
+    auto histogram = makeUniformHistogram(10);
+    auto parsed = ScalarHistogram::fromBSON(histogram.toBSON());
+    ASSERT_BSONOBJ_EQ(parsed.toBSON(), histogram.toBSON());
+    ASSERT_EQ(parsed.estimateInterval(Interval(BSON("" << 20 << "" << 40), true, true)), 21.0);
+}
+
+TEST(ScalarHistogramTest, RejectsUnorderedBuckets) {
+    auto bucket = [](int bound) {
+        return BSON("bound" << bound << "equalCount" << 1 << "rangeCount" << 0 << "rangeDistincts"
+                            << 0);
+    };
+    ASSERT_THROWS_CODE(
+        ScalarHistogram::fromBSON(BSON("buckets" << BSON_ARRAY(bucket(2) << bucket(1)))),
+        AssertionException,
+        6001105);
+    ASSERT_THROWS_CODE(
+        ScalarHistogram::fromBSON(BSON("buckets" << 1)), AssertionException, 6001102);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -76,7 +76,20 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
     auto root = builder->build(solution.root());
     auto data = builder->getPlanStageData();
 
+    attachSlotBasedExecutableTree(opCtx, cq, root.get(), yieldPolicy);
+
+    return {std::move(root), std::move(data)};
+}
+
+void attachSlotBasedExecutableTree(OperationContext* opCtx,
+                                   const CanonicalQuery& cq,
+                                   sbe::PlanStage* root,
+                                   PlanYieldPolicy* yieldPolicy) {
+    auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(yieldPolicy);
+    invariant(sbeYieldPolicy);
+
     root->attachToOperationContext(opCtx);
+    root->attachNewYieldPolicy(sbeYieldPolicy);
 
     auto expCtx = cq.getExpCtxRaw();
     tassert(5327100, "No expression context", expCtx);
@@ -85,8 +98,6 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
     }
 
     // Register this plan to yield according to the configured policy.
-    sbeYieldPolicy->registerPlan(root.get());
-
-    return {std::move(root), std::move(data)};
+    sbeYieldPolicy->registerPlan(root);
 }
 }  // namespace mongo::stage_builder
@@ -57,4 +57,15 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const QuerySolution& solution,
                              PlanYieldPolicy* yieldPolicy);
 
+/**
+ * Attaches the slot-based PlanStage tree 'root' to the operation executing the query 'cq': the tree
+ * is attached to 'opCtx', switched to 'yieldPolicy' and registered with it. This is done as part of
+ * 'buildSlotBasedExecutableTree()', and must also be done for trees which were not built for 'cq',
+ * such as plans recovered from the SBE plan cache.
+ */
+void attachSlotBasedExecutableTree(OperationContext* opCtx,
+                                   const CanonicalQuery& cq,
+                                   sbe::PlanStage* root,
+                                   PlanYieldPolicy* yieldPolicy);
+
 }  // namespace mongo::stage_builder
@@ -44,9 +44,11 @@ StringData stageTypeToString(StageType stageType) {
         {STAGE_DELETE, "DELETE"_sd},
         {STAGE_DISTINCT_SCAN, "DISTINCT_SCAN"_sd},
         {STAGE_EOF, "EOF"_sd},
+        {STAGE_EQ_LOOKUP, "EQ_LOOKUP"_sd},
         {STAGE_FETCH, "FETCH"_sd},
         {STAGE_GEO_NEAR_2D, "GEO_NEAR_2D"_sd},
         {STAGE_GEO_NEAR_2DSPHERE, "GEO_NEAR_2DSPHERE"_sd},
+        {STAGE_GROUP, "GROUP"_sd},
         {STAGE_IDHACK, "IDHACK"_sd},
         {STAGE_IXSCAN, "IXSCAN"_sd},
         {STAGE_LIMIT, "LIMIT"_sd},
@@ -61,6 +63,7 @@ StringData stageTypeToString(StageType stageType) {
         {STAGE_RECORD_STORE_FAST_COUNT, "RECORD_STORE_FAST_COUNT"_sd},
         {STAGE_RETURN_KEY, "RETURN_KEY"_sd},
         {STAGE_SAMPLE_FROM_TIMESERIES_BUCKET, "SAMPLE_FROM_TIMESERIES_BUCKET"_sd},
+        {STAGE_SENTINEL, "SENTINEL"_sd},
         {STAGE_SHARDING_FILTER, "SHARDING_FILTER"_sd},
         {STAGE_SKIP, "SKIP"_sd},
         {STAGE_SORT_DEFAULT, "SORT"_sd},
@@ -74,6 +77,7 @@ StringData stageTypeToString(StageType stageType) {
         {STAGE_UNKNOWN, "UNKNOWN"_sd},
         {STAGE_UNPACK_TIMESERIES_BUCKET, "UNPACK_TIMESERIES_BUCKET"_sd},
         {STAGE_UPDATE, "UPDATE"_sd},
+        {STAGE_WINDOW, "WINDOW"_sd},
     };
     if (auto it = kStageTypesMap.find(stageType); it != kStageTypesMap.end()) {
         return it->second;
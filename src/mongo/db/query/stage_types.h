@@ -126,6 +126,8 @@ enum StageType {
 
     // Stages for DocumentSources.
     STAGE_GROUP,
+    STAGE_EQ_LOOKUP,
+    STAGE_WINDOW,
     STAGE_SENTINEL,
 };
 
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/stats_catalog.h"
+
+#include <algorithm>
+
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace {
+const auto statsCatalogDecoration =
+    ServiceContext::declareDecoration<std::unique_ptr<StatsCatalog>>();
+
+ServiceContext::ConstructorActionRegisterer statsCatalogRegisterer{
+    "StatsCatalogRegisterer", [](ServiceContext* serviceCtx) {
+        statsCatalogDecoration(serviceCtx) = std::make_unique<StatsCatalog>(serviceCtx);
+    }};
+
+constexpr auto kStatisticsCollectionPrefix = "system.statistics."_sd;
+
+// The maximum number of collections whose statistics are cached.
+constexpr int kCacheSize = 1000;
+}  // namespace
+
+StatsCatalog::StatsCatalog(ServiceContext* serviceContext)
+    : _cache(serviceContext, _threadPool), _threadPool([] {
+          ThreadPool::Options options;
+          options.poolName = "StatsCatalog";
+          options.minThreads = 0;
+          options.maxThreads = 1;
+          return options;
+      }()) {
+    _threadPool.startup();
+}
+
+StatsCatalog::~StatsCatalog() = default;
+
+StatsCatalog& StatsCatalog::get(ServiceContext* serviceContext) {
+    return *statsCatalogDecoration(serviceContext);
+}
+
+StatsCatalog& StatsCatalog::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+NamespaceString StatsCatalog::makeStatisticsNamespace(const NamespaceString& nss) {
+    return NamespaceString(nss.db(), kStatisticsCollectionPrefix.toString() + nss.coll());
+}
+
+boost::optional<NamespaceString> StatsCatalog::getAnalyzedNamespace(
+    const NamespaceString& statsNss) {
+    if (!statsNss.coll().startsWith(kStatisticsCollectionPrefix)) {
+        return boost::none;
+    }
+    return NamespaceString(statsNss.db(),
+                           statsNss.coll().substr(kStatisticsCollectionPrefix.size()));
+}
+
+std::shared_ptr<const CollectionStatistics> StatsCatalog::getStatistics(
+    OperationContext* opCtx, const CollectionPtr& collection) {
+    const auto& nss = collection->ns();
+    if (auto cached = _cache.peekLatestCached(nss)) {
+        if (cached->collectionUUID == collection->uuid()) {
+            return cached->stats;
+        }
+        // The statistics were loaded for a previous incarnation of the collection.
+        _cache.invalidate(nss);
+    }
+
+    // Planning does not wait for the statistics, which would take more locks and read another
+    // collection in the middle of the query. The plans built until they are loaded simply go
+    // without them.
+    (void)_cache.acquireAsync(nss);
+    return nullptr;
+}
+
+void StatsCatalog::invalidate(const NamespaceString& nss) {
+    _cache.invalidate(nss);
+}
+
+void StatsCatalog::invalidateAll() {
+    _cache.invalidateAll();
+}
+
+StatsCatalog::Cache::Cache(ServiceContext* service, ThreadPoolInterface& threadPool)
+    : ReadThroughCache(
+          _mutex,
+          service,
+          threadPool,
+          [this](OperationContext* opCtx,
+                 const NamespaceString& nss,
+                 const ValueHandle& unusedCachedValue) { return _lookup(opCtx, nss); },
+          kCacheSize) {}
+
+StatsCatalog::Cache::LookupResult StatsCatalog::Cache::_lookup(OperationContext* opCtx,
+                                                               const NamespaceString& nss) {
+    auto collectionUUID = CollectionCatalog::get(opCtx)->lookupUUIDByNSS(opCtx, nss);
+    if (!collectionUUID) {
+        return LookupResult(boost::none);
+    }
+
+    auto stats = std::make_shared<CollectionStatistics>();
+    DBDirectClient client(opCtx);
+    auto cursor = client.query(makeStatisticsNamespace(nss),
+                               BSON(kCollectionUUIDFieldName << *collectionUUID),
+                               Query(),
+                               0 /* limit */,
+                               0 /* nToSkip */,
+                               nullptr /* fieldsToReturn */,
+                               QueryOption_SecondaryOk);
+    while (cursor && cursor->more()) {
+        auto doc = cursor->nextSafe();
+        try {
+            auto histogram = ScalarHistogram::fromBSON(doc[kHistogramFieldName].Obj());
+            stats->numRecords =
+                std::max(stats->numRecords, doc[kDocumentsFieldName].safeNumberLong());
+            stats->histograms.insert_or_assign(doc[kIdFieldName].String(), std::move(histogram));
+        } catch (const DBException& ex) {
+            LOGV2_WARNING(6001107,
+                          "Ignoring malformed statistics document",
+                          "namespace"_attr = nss,
+                          "document"_attr = redact(doc),
+                          "error"_attr = redact(ex.toStatus()));
+        }
+    }
+
+    if (stats->histograms.empty()) {
+        return LookupResult(CachedStatistics{*collectionUUID, nullptr});
+    }
+    return LookupResult(CachedStatistics{*collectionUUID, std::move(stats)});
+}
+
+}  // namespace mongo
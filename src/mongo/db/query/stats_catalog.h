@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/scalar_histogram.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/read_through_cache.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Caches the statistics collected by the 'analyze' command, which are persisted in the
+ * '<db>.system.statistics.<collection>' collection with one document per analyzed field:
+ *
+ *   {_id: <field path>, collectionUUID: <UUID>, documents: <count>, histogram: <histogram>}
+ *
+ * The statistics of a collection are loaded in the background the first time they are requested,
+ * so that planning never waits for them, and kept until the statistics collection is written to
+ * or dropped. Collections without statistics are cached as well, so that the statistics
+ * collection is only queried once. The cache holds a bounded number of collections, evicting the
+ * least recently used ones.
+ */
+class StatsCatalog {
+    StatsCatalog(const StatsCatalog&) = delete;
+    StatsCatalog& operator=(const StatsCatalog&) = delete;
+
+public:
+    static constexpr auto kIdFieldName = "_id"_sd;
+    static constexpr auto kCollectionUUIDFieldName = "collectionUUID"_sd;
+    static constexpr auto kDocumentsFieldName = "documents"_sd;
+    static constexpr auto kHistogramFieldName = "histogram"_sd;
+    static constexpr auto kLastUpdatedFieldName = "lastUpdated"_sd;
+
+    explicit StatsCatalog(ServiceContext* serviceContext);
+    ~StatsCatalog();
+
+    static StatsCatalog& get(ServiceContext* serviceContext);
+    static StatsCatalog& get(OperationContext* opCtx);
+
+    /**
+     * Returns the namespace in which the statistics of the collection 'nss' are stored.
+     */
+    static NamespaceString makeStatisticsNamespace(const NamespaceString& nss);
+
+    /**
+     * Returns the namespace of the collection whose statistics are stored in 'statsNss', or
+     * boost::none if 'statsNss' is not a statistics collection.
+     */
+    static boost::optional<NamespaceString> getAnalyzedNamespace(const NamespaceString& statsNss);
+
+    /**
+     * Returns the cached statistics of 'collection', or nullptr if it has never been analyzed.
+     * Statistics collected on a previous incarnation of the collection, with a different UUID, are
+     * ignored. Never blocks: when the statistics are not cached yet, schedules their loading and
+     * returns nullptr.
+     */
+    std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* opCtx,
+                                                              const CollectionPtr& collection);
+
+    /**
+     * Drops the cached statistics of 'nss' so that they are reloaded on the next request.
+     */
+    void invalidate(const NamespaceString& nss);
+
+    /**
+     * Drops the cached statistics of every collection.
+     */
+    void invalidateAll();
+
+private:
+    struct CachedStatistics {
+        UUID collectionUUID;
+
+        // Null if the collection has not been analyzed.
+        std::shared_ptr<const CollectionStatistics> stats;
+    };
+
+    class Cache : public ReadThroughCache<NamespaceString, CachedStatistics> {
+        Cache(const Cache&) = delete;
+        Cache& operator=(const Cache&) = delete;
+
+    public:
+        Cache(ServiceContext* service, ThreadPoolInterface& threadPool);
+
+    private:
+        LookupResult _lookup(OperationContext* opCtx, const NamespaceString& nss);
+
+        Mutex _mutex = MONGO_MAKE_LATCH("StatsCatalog::Cache");
+    };
+
+    Cache _cache;
+
+    // Thread pool on which the statistics are loaded.
+    ThreadPool _threadPool;
+};
+
+}  // namespace mongo
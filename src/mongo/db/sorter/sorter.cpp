@@ -54,16 +54,22 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
+#include "mongo/db/client.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_thread_pool.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/is_mongos.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/future.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -204,10 +210,26 @@ public:
           _fileCurrentOffset(fileStartOffset),
           _fileEndOffset(fileEndOffset),
           _dbName(dbName),
+          _readAheadBytes(gSorterFileReadAheadBytes.load()),
           _originalChecksum(checksum) {}
 
     void openSource() {}
 
+    void limitReadAheadBytes(size_t maxBytes) {
+        if (maxBytes >= _readAheadBytes) {
+            return;
+        }
+
+        // The bytes still buffered are read again from '_fileCurrentOffset' by the next fill.
+        _readAheadBytes = maxBytes;
+        _readAheadBuffer.reset();
+        _readAheadPos = _readAheadLen = 0;
+    }
+
+    size_t getReadAheadBytes() const {
+        return _readAheadBytes;
+    }
+
     void closeSource() {
         // If the file iterator reads through all data objects, we can ensure non-corrupt data
         // by comparing the newly calculated checksum with the original checksum from the data
@@ -336,10 +358,37 @@ private:
                   str::stream() << "Current file offset (" << _fileCurrentOffset
                                 << ") greater than end offset (" << _fileEndOffset << ")");
 
-        _file->read(_fileCurrentOffset, size, out);
+        if (_readAheadPos + size > _readAheadLen) {
+            if (size >= _readAheadBytes) {
+                // Buffering the request would not save a read, so go straight to the file.
+                _readAheadPos = _readAheadLen = 0;
+                _file->read(_fileCurrentOffset, size, out);
+                _fileCurrentOffset += size;
+                return;
+            }
+            _fillReadAheadBuffer(size);
+        }
+
+        memcpy(out, _readAheadBuffer.get() + _readAheadPos, size);
+        _readAheadPos += size;
         _fileCurrentOffset += size;
     }
 
+    /**
+     * Reads the next '_readAheadBytes' of the range, or what is left of it, into the read-ahead
+     * buffer. Any unread bytes still buffered are read again. Reads at least 'minSize' bytes.
+     */
+    void _fillReadAheadBuffer(size_t minSize) {
+        if (!_readAheadBuffer) {
+            _readAheadBuffer.reset(new char[_readAheadBytes]);
+        }
+
+        _readAheadLen = std::max(
+            minSize, std::min(_readAheadBytes, size_t(_fileEndOffset - _fileCurrentOffset)));
+        _readAheadPos = 0;
+        _file->read(_fileCurrentOffset, _readAheadLen, _readAheadBuffer.get());
+    }
+
     const Settings _settings;
     bool _done = false;
 
@@ -352,6 +401,15 @@ private:
     std::streamoff _fileEndOffset;      // File offset at which the sorted data range ends.
     boost::optional<std::string> _dbName;
 
+    // Raw bytes of the range read from disk ahead of the block currently being decoded, so that
+    // several small blocks are fetched with a single read. The bytes at '_readAheadPos' and up to
+    // '_readAheadLen' start at '_fileCurrentOffset' in the file. Lowered by a merge so that the
+    // buffers of all the merged ranges fit in the sorter's memory limit.
+    size_t _readAheadBytes;
+    std::unique_ptr<char[]> _readAheadBuffer;
+    size_t _readAheadPos = 0;
+    size_t _readAheadLen = 0;
+
     // Checksum value that is updated with each read of a data object from disk. We can compare
     // this value with _originalChecksum to check for data corruption if and only if the
     // FileIterator is exhausted.
@@ -380,37 +438,39 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
+        // Every input may buffer its source at the same time, so they share the memory limit.
+        const size_t readAheadLimit = iters.empty() ? 0 : opts.maxMemoryUsageBytes / iters.size();
         for (size_t i = 0; i < iters.size(); i++) {
+            iters[i]->limitReadAheadBytes(readAheadLimit);
             iters[i]->openSource();
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_unique<Stream>(i, iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _liveStreams = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = playMatches(1);
     }
 
     ~MergeIterator() {
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
     }
 
     void openSource() {}
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 &&
+            (_first || _liveStreams > 1 || (_liveStreams == 1 && winner().more())))
             return true;
 
         _remaining = 0;
@@ -424,21 +484,19 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return winner().current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        const size_t advanced = _tree[0];
+        if (!_streams[advanced]->advance()) {
+            // Destroying the stream closes its source. An exhausted stream loses every match.
+            _streams[advanced].reset();
+            _liveStreams--;
+            verify(_liveStreams > 0);
         }
+        replayMatches(advanced);
 
-        return _current->current();
+        return winner().current();
     }
 
 
@@ -480,32 +538,78 @@ private:
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
+    // The streams are merged with a loser tree: '_tree[0]' holds the index into '_streams' of the
+    // overall winner, whose current value is the next to be returned, and each internal node
+    // '_tree[1]' through '_tree[k - 1]' holds the loser of the match played at that node. Stream
+    // 'i' enters as leaf 'k + i', whose parent is node '(k + i) / 2'. Replacing the winner only
+    // replays the matches on its path to the root, which costs log(k) comparisons compared with
+    // up to 2 * log(k) for re-sifting a binary heap.
 
-        template <typename Ptr>
-        bool operator()(const Ptr& lhs, const Ptr& rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+    Stream& winner() {
+        return *_streams[_tree[0]];
+    }
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+    /**
+     * Returns true if stream 'lhs' should be returned before stream 'rhs'. Exhausted streams lose
+     * to all others, and ties are broken by input order to keep the merge stable.
+     */
+    bool beats(size_t lhs, size_t rhs) const {
+        if (!_streams[rhs]) {
+            return true;
+        }
+        if (!_streams[lhs]) {
+            return false;
         }
 
-    private:
-        const Comparator _comp;
-    };
+        dassertCompIsSane(_comp, _streams[lhs]->current(), _streams[rhs]->current());
+        int ret = _comp(_streams[lhs]->current(), _streams[rhs]->current());
+        if (ret) {
+            return ret < 0;
+        }
+        return _streams[lhs]->fileNum < _streams[rhs]->fileNum;
+    }
+
+    /**
+     * Plays all of the matches in the subtree rooted at 'node', recording the losers, and returns
+     * the winner.
+     */
+    size_t playMatches(size_t node) {
+        const size_t numStreams = _streams.size();
+        if (node >= numStreams) {
+            return node - numStreams;
+        }
+
+        size_t left = playMatches(2 * node);
+        size_t right = playMatches(2 * node + 1);
+        if (beats(left, right)) {
+            _tree[node] = right;
+            return left;
+        }
+        _tree[node] = left;
+        return right;
+    }
+
+    /**
+     * Replays the matches from the leaf of stream 'changed' up to the root after its current value
+     * has changed, and records the new overall winner.
+     */
+    void replayMatches(size_t changed) {
+        size_t best = changed;
+        for (size_t node = (_streams.size() + changed) / 2; node > 0; node /= 2) {
+            if (beats(_tree[node], best)) {
+                std::swap(_tree[node], best);
+            }
+        }
+        _tree[0] = best;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+    std::vector<std::unique_ptr<Stream>> _streams;  // Null once a stream is exhausted.
+    std::vector<size_t> _tree;                      // Loser tree over '_streams'.
+    size_t _liveStreams = 0;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -524,6 +628,17 @@ public:
         invariant(opts.limit == 0);
     }
 
+    ~NoLimitSorter() {
+        // The comparator may refer to state owned by the user of this sorter, so the background
+        // sorts must not outlive it.
+        for (auto&& run : _pendingRuns) {
+            run->cancelled.store(true);
+        }
+        for (auto&& run : _pendingRuns) {
+            run->sorted.wait();
+        }
+    }
+
     NoLimitSorter(const std::string& fileName,
                   const std::vector<SorterRange>& ranges,
                   const SortOptions& opts,
@@ -560,8 +675,8 @@ public:
         _memUsed += memUsage;
         this->_totalDataSizeSorted += memUsage;
 
-        if (_memUsed > this->_opts.maxMemoryUsageBytes)
-            spill();
+        if (_memUsed > runMemoryLimit())
+            spillRun();
     }
 
     void emplace(Key&& key, Value&& val) override {
@@ -573,14 +688,14 @@ public:
 
         _data.emplace_back(std::move(key), std::move(val));
 
-        if (_memUsed > this->_opts.maxMemoryUsageBytes)
-            spill();
+        if (_memUsed > runMemoryLimit())
+            spillRun();
     }
 
     Iterator* done() {
         invariant(!std::exchange(_done, true));
 
-        if (this->_iters.empty()) {
+        if (this->_iters.empty() && _pendingRuns.empty()) {
             sort();
             if (this->_opts.moveSortedDataIntoIterator) {
                 return new InMemIterator<Key, Value>(std::move(_data));
@@ -605,16 +720,29 @@ private:
         const Comparator& _comp;
     };
 
+    /**
+     * A run handed off to the sorter thread pool, which is written to disk once it is sorted.
+     */
+    struct PendingRun {
+        std::deque<Data> data;
+        AtomicWord<bool> cancelled{false};  // Set to abandon the sort.
+        std::exception_ptr error;           // Thrown by the sort, rethrown by the sorter.
+        Future<void> sorted;                // Ready once the sort has finished or failed.
+    };
+
     void sort() {
         STLComparator less(_comp);
         std::stable_sort(_data.begin(), _data.end(), less);
         this->_numSorted += _data.size();
     }
 
-    void spill() {
-        if (_data.empty())
-            return;
+    size_t runMemoryLimit() const {
+        return this->_opts.parallelSpills
+            ? this->_opts.maxMemoryUsageBytes / (this->_opts.maxPendingRuns + 1)
+            : this->_opts.maxMemoryUsageBytes;
+    }
 
+    void assertExtSortAllowed() const {
         if (!this->_opts.extSortAllowed) {
             // This error message only applies to sorts from user queries made through the find or
             // aggregation commands. Other clients, such as bulk index builds, should suppress this
@@ -625,16 +753,117 @@ private:
                           << "Sort exceeded memory limit of " << this->_opts.maxMemoryUsageBytes
                           << " bytes, but did not opt in to external sorting.");
         }
+    }
+
+    /**
+     * Spills the in-memory data once it reaches the memory limit for a run. With parallel spills,
+     * the data is sorted on the sorter thread pool while the caller continues to add data, and up
+     * to maxPendingRuns runs may be waiting to be sorted and written at once.
+     */
+    void spillRun() {
+        auto pool = this->_opts.parallelSpills ? sorter::getSorterThreadPool() : nullptr;
+        if (!pool) {
+            spill();
+            return;
+        }
 
-        sort();
+        assertExtSortAllowed();
+
+        writeSortedRuns(false /* wait */);
+        if (_pendingRuns.size() >= this->_opts.maxPendingRuns) {
+            // Wait for the oldest run, so that the pending runs stay within the memory limit.
+            writeSortedRuns(true /* wait */);
+        }
+
+        auto run = std::make_shared<PendingRun>();
+        run->data.swap(_data);
+        _memUsed = 0;
+
+        auto [promise, future] = makePromiseFuture<void>();
+        run->sorted = std::move(future);
+        _pendingRuns.push_back(run);
+
+        // A pool which is shut down runs the task on the calling thread with a non-OK status, in
+        // which case the run is sorted right away.
+        pool->schedule([this, run, promise = std::move(promise)](Status) mutable {
+            try {
+                STLComparator less(_comp);
+                std::stable_sort(
+                    run->data.begin(), run->data.end(), [&](const Data& lhs, const Data& rhs) {
+                        if (MONGO_unlikely(run->cancelled.loadRelaxed())) {
+                            uasserted(ErrorCodes::CallbackCanceled, "Sorting a run was canceled");
+                        }
+                        return less(lhs, rhs);
+                    });
+            } catch (...) {
+                run->error = std::current_exception();
+            }
+            promise.emplaceValue();
+        });
+    }
+
+    /**
+     * Writes the pending runs to disk in the order in which they were spilled, up to the first one
+     * which is still being sorted. If 'wait' is true, waits for that run and writes it too. The
+     * wait is interrupted along with the operation of the calling thread, if any. Rethrows the
+     * error of a failed sort.
+     */
+    void writeSortedRuns(bool wait) {
+        // Runs must be written in input order to keep the merge stable.
+        while (!_pendingRuns.empty()) {
+            auto& run = _pendingRuns.front();
+            if (!run->sorted.isReady()) {
+                if (!wait) {
+                    return;
+                }
+                wait = false;
+                run->sorted.wait(callerInterruptible());
+            }
+
+            if (run->error) {
+                std::rethrow_exception(run->error);
+            }
 
+            this->_numSorted += run->data.size();
+            writeRun(run->data);
+            _pendingRuns.pop_front();
+        }
+    }
+
+    static Interruptible* callerInterruptible() {
+        if (haveClient()) {
+            if (auto opCtx = cc().getOperationContext()) {
+                return opCtx;
+            }
+        }
+        return Interruptible::notInterruptible();
+    }
+
+    /**
+     * Writes the already sorted 'run' to disk as a new range of the spill file, emptying it.
+     */
+    void writeRun(std::deque<Data>& run) {
         SortedFileWriter<Key, Value> writer(this->_opts, this->_file, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        for (; !run.empty(); run.pop_front()) {
+            writer.addAlreadySorted(run.front().first, run.front().second);
         }
         Iterator* iteratorPtr = writer.done();
 
         this->_iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
+    }
+
+    void spill() {
+        while (!_pendingRuns.empty()) {
+            writeSortedRuns(true /* wait */);
+        }
+
+        if (_data.empty())
+            return;
+
+        assertExtSortAllowed();
+
+        sort();
+        writeRun(_data);
 
         _memUsed = 0;
     }
@@ -644,6 +873,9 @@ private:
     bool _done = false;
     size_t _memUsed = 0;
     std::deque<Data> _data;  // Data that has not been spilled.
+
+    // Runs being sorted on the sorter thread pool or waiting to be written, oldest first.
+    std::deque<std::shared_ptr<PendingRun>> _pendingRuns;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -674,6 +906,10 @@ public:
         _best = {contender.first.getOwned(), contender.second.getOwned()};
     }
 
+    const Key* getCutoffKey() const {
+        return _haveData ? &_best.first : nullptr;
+    }
+
     Iterator* done() {
         if (_haveData) {
             if (this->_opts.moveSortedDataIntoIterator) {
@@ -790,6 +1026,15 @@ public:
         return iterator;
     }
 
+    const Key* getCutoffKey() const {
+        // Once '_data' holds 'limit' entries it is a max-heap whose front is the worst kept entry,
+        // which is at least as tight a bound as '_cutoff'.
+        if (_data.size() == this->_opts.limit) {
+            return &_data.front().first;
+        }
+        return _haveCutoff ? &_cutoff.first : nullptr;
+    }
+
 private:
     class STLComparator {
     public:
@@ -1033,6 +1278,7 @@ void Sorter<Key, Value>::File::write(const char* data, std::streamsize size) {
     try {
         _file.write(data, size);
         _offset += size;
+        _stats.bytesSpilled += size;
     } catch (const std::system_error& ex) {
         if (ex.code() == std::errc::no_space_on_device) {
             uasserted(ErrorCodes::OutOfDiskSpace,
@@ -1133,6 +1379,9 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
+    Timer timer;
+    const int32_t uncompressedSize = size;
+
     std::string compressed;
     snappy::Compress(outBuffer, size, &compressed);
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
@@ -1165,6 +1414,7 @@ void SortedFileWriter<Key, Value>::spill() {
     size = shouldCompress ? -size : size;
     _file->write(reinterpret_cast<const char*>(&size), sizeof(size));
     _file->write(outBuffer, std::abs(size));
+    _file->recordSpilledBlock(uncompressedSize, timer.elapsed());
 
     _buffer.reset();
 }
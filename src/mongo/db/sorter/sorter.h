@@ -41,6 +41,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/sorter/sorter_gen.h"
+#include "mongo/db/sorter/sorter_stats.h"
 #include "mongo/util/bufreader.h"
 
 /**
@@ -119,11 +120,22 @@ struct SortOptions {
     // instead of copying.
     bool moveSortedDataIntoIterator;
 
+    // If true, a sorter without a limit sorts each run that it spills on a shared background thread
+    // pool while more data is added.
+    bool parallelSpills;
+
+    // The number of runs that a sorter with parallel spills may have waiting to be sorted and
+    // written. Runs are then limited to maxMemoryUsageBytes / (maxPendingRuns + 1), so that the
+    // pending runs and the run being filled together stay within the limit.
+    size_t maxPendingRuns;
+
     SortOptions()
         : limit(0),
           maxMemoryUsageBytes(64 * 1024 * 1024),
           extSortAllowed(false),
-          moveSortedDataIntoIterator(false) {}
+          moveSortedDataIntoIterator(false),
+          parallelSpills(gSorterParallelSpills.load()),
+          maxPendingRuns(gSorterMaxPendingRuns.load()) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -156,6 +168,16 @@ struct SortOptions {
         moveSortedDataIntoIterator = newMoveSortedDataIntoIterator;
         return *this;
     }
+
+    SortOptions& ParallelSpills(bool newParallelSpills = true) {
+        parallelSpills = newParallelSpills;
+        return *this;
+    }
+
+    SortOptions& MaxPendingRuns(size_t newMaxPendingRuns) {
+        maxPendingRuns = newMaxPendingRuns;
+        return *this;
+    }
 };
 
 /**
@@ -210,6 +232,10 @@ public:
     virtual void openSource() = 0;
     virtual void closeSource() = 0;
 
+    // Caps the number of bytes that this iterator may read from its source ahead of the data it
+    // returns. Only iterators over a spill file read ahead.
+    virtual void limitReadAheadBytes(size_t maxBytes) {}
+
     virtual SorterRange getRange() const {
         invariant(false, "Only FileIterator has ranges");
         MONGO_UNREACHABLE;
@@ -290,6 +316,20 @@ public:
          */
         std::streamoff currentOffset();
 
+        /**
+         * Records that a block holding 'uncompressedSize' bytes of serialized data was spilled,
+         * taking 'elapsed' to compress, protect and write. The bytes written to the file are
+         * counted by write().
+         */
+        void recordSpilledBlock(uint64_t uncompressedSize, Microseconds elapsed) {
+            _stats.bytesSpilledUncompressed += uncompressedSize;
+            _stats.spillTime += elapsed;
+        }
+
+        const SorterFileStats& stats() const {
+            return _stats;
+        }
+
     private:
         void _open();
 
@@ -304,6 +344,8 @@ public:
 
         // Whether to keep the on-disk file even after this in-memory object has been destructed.
         bool _keep = false;
+
+        SorterFileStats _stats;
     };
 
     explicit Sorter(const SortOptions& opts);
@@ -334,6 +376,15 @@ public:
      */
     virtual Iterator* done() = 0;
 
+    /**
+     * Returns the key which any key passed to a subsequent add() call must sort strictly before in
+     * order to be kept, or nullptr if no such bound is known yet. Only sorters which apply a limit
+     * ever establish a bound. The returned pointer is invalidated by the next call to add().
+     */
+    virtual const Key* getCutoffKey() const {
+        return nullptr;
+    }
+
     virtual ~Sorter() {}
 
     size_t numSpills() const {
@@ -348,6 +399,14 @@ public:
         return _totalDataSizeSorted;
     }
 
+    /**
+     * Returns statistics about the data spilled to disk so far, which are all zero if this sorter
+     * has never spilled.
+     */
+    SorterFileStats spillStats() const {
+        return _file ? _file->stats() : SorterFileStats();
+    }
+
     PersistedState persistDataForShutdown();
 
 protected:
@@ -38,13 +38,16 @@
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
+#include "mongo/db/service_context_test_fixture.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
 
 
 namespace mongo {
@@ -349,6 +352,23 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, DESC),
                                         std::make_shared<IntIterator>(30, 0, -1));
         }
+        {  // test a number of sources which is not a power of two
+            std::shared_ptr<IWIterator> iterators[] = {
+                std::make_shared<IntIterator>(0, 70, 7),  // 0, 7, ... 63
+                std::make_shared<IntIterator>(1, 70, 7),  // 1, 8, ... 64
+                std::make_shared<IntIterator>(2, 70, 7),  // 2, 9, ... 65
+                std::make_shared<EmptyIterator>(),
+                std::make_shared<IntIterator>(3, 70, 7),  // 3, 10, ... 66
+                std::make_shared<IntIterator>(4, 40, 7),  // 4, 11, ... 39
+                std::make_shared<IntIterator>(5, 70, 7),  // 5, 12, ... 68
+                std::make_shared<IntIterator>(6, 70, 7),  // 6, 13, ... 69
+                std::make_shared<IntIterator>(39, 70, 7)};  // 39, 46, ... 67
+
+            std::shared_ptr<IWIterator> expected[] = {std::make_shared<IntIterator>(0, 70, 1),
+                                                      std::make_shared<IntIterator>(39, 40, 1)};
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        mergeIterators(expected, ASC));
+        }
         {  // test Limit
             std::shared_ptr<IWIterator> iterators[] = {
                 std::make_shared<IntIterator>(1, 20, 2),   // 1, 3, ... 19
@@ -651,6 +671,19 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallelSpills : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return Parent::adjustSortOptions(opts).ParallelSpills().MaxPendingRuns(3);
+    }
+    size_t correctNumRanges() const override {
+        // Each run is limited to a quarter of the memory limit so that the three runs waiting to be
+        // sorted and the run being filled fit in memory together.
+        return Parent::NUM_ITEMS * sizeof(IWPair) / (Parent::MEM_LIMIT / 4) + 1;
+    }
+};
 }  // namespace SorterTests
 
 class SorterSuite : public mongo::unittest::OldStyleSuiteSpecification {
@@ -669,6 +702,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallelSpills</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallelSpills</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -866,6 +901,205 @@ TEST_F(SorterMakeFromExistingRangesTest, RoundTrip) {
     }
 }
 
+TEST(SortedFileWriterTest, RangesReadBackWithAnyReadAheadSize) {
+    unittest::TempDir tempDir("sortedFileWriterTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    const int numItems = 100 * 1000;
+
+    for (int readAheadBytes : {0, 1, 6, 4 * 1024, 1024 * 1024}) {
+        RAIIServerParameterControllerForTest controller{"internalSorterFileReadAheadBytes",
+                                                        readAheadBytes};
+        auto file =
+            std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+
+        // Write two ranges to the same file and read them back interleaved, so that each iterator
+        // has to track its own position within the file.
+        SortedFileWriter<IntWrapper, IntWrapper> evens(opts, file);
+        for (int i = 0; i < numItems; i += 2) {
+            evens.addAlreadySorted(i, -i);
+        }
+        std::shared_ptr<IWIterator> evensIter(evens.done());
+
+        SortedFileWriter<IntWrapper, IntWrapper> odds(opts, file);
+        for (int i = 1; i < numItems; i += 2) {
+            odds.addAlreadySorted(i, -i);
+        }
+        std::shared_ptr<IWIterator> oddsIter(odds.done());
+
+        std::vector<std::shared_ptr<IWIterator>> iters{evensIter, oddsIter};
+        ASSERT_ITERATORS_EQUIVALENT(
+            std::shared_ptr<IWIterator>(IWIterator::merge(iters, opts, IWComparator(ASC))),
+            std::make_shared<IntIterator>(0, numItems));
+    }
+}
+
+TEST(SortedFileWriterTest, MergedRangesShareTheMemoryLimitForReadingAhead) {
+    unittest::TempDir tempDir("sortedFileWriterTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path()).MaxMemoryUsageBytes(1024);
+    const int numItems = 10 * 1000;
+    const int numRanges = 4;
+    auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+
+    std::vector<std::shared_ptr<IWIterator>> iters;
+    for (int range = 0; range < numRanges; ++range) {
+        SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+        for (int i = range; i < numItems; i += numRanges) {
+            writer.addAlreadySorted(i, -i);
+        }
+        iters.emplace_back(writer.done());
+    }
+
+    auto fileIter = [&](size_t i) {
+        return dynamic_cast<sorter::FileIterator<IntWrapper, IntWrapper>*>(iters[i].get());
+    };
+    ASSERT_EQ(size_t(gSorterFileReadAheadBytes.load()), fileIter(0)->getReadAheadBytes());
+
+    std::shared_ptr<IWIterator> merged(IWIterator::merge(iters, opts, IWComparator(ASC)));
+    for (size_t i = 0; i < iters.size(); ++i) {
+        ASSERT_EQ(opts.maxMemoryUsageBytes / numRanges, fileIter(i)->getReadAheadBytes());
+    }
+    ASSERT_ITERATORS_EQUIVALENT(merged, std::make_shared<IntIterator>(0, numItems));
+}
+
+TEST(SortedFileWriterTest, RecordsSpillStats) {
+    unittest::TempDir tempDir("sortedFileWriterTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+    ASSERT_EQ(0U, file->stats().bytesSpilled);
+
+    // Identical pairs compress well, so the blocks are stored compressed.
+    const int numItems = 100 * 1000;
+    SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+    for (int i = 0; i < numItems; i++) {
+        writer.addAlreadySorted(0, 0);
+    }
+    std::unique_ptr<IWIterator> iter(writer.done());
+
+    const auto& stats = file->stats();
+    ASSERT_EQ(numItems * sizeof(IWPair), stats.bytesSpilledUncompressed);
+    ASSERT_GT(stats.bytesSpilled, 0U);
+    ASSERT_LT(stats.bytesSpilled, stats.bytesSpilledUncompressed);
+    ASSERT_EQ(static_cast<uint64_t>(file->currentOffset()), stats.bytesSpilled);
+}
+
+TEST(SorterSpillStatsTest, CountsAllDataOnceSorterHasSpilled) {
+    unittest::TempDir tempDir("sorterTests");
+    const auto opts =
+        SortOptions().TempDir(tempDir.path()).ExtSortAllowed().MaxMemoryUsageBytes(16 * 1024);
+
+    std::unique_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+    ASSERT_EQ(0U, sorter->spillStats().bytesSpilled);
+
+    const int numItems = 10 * 1000;
+    for (int i = numItems - 1; i >= 0; i--) {
+        sorter->add(i, -i);
+    }
+    ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                std::make_shared<IntIterator>(0, numItems));
+    ASSERT_GT(sorter->numSpills(), 1U);
+
+    // Once a sorter has spilled, done() spills whatever is left in memory as well.
+    const auto stats = sorter->spillStats();
+    ASSERT_EQ(numItems * sizeof(IWPair), stats.bytesSpilledUncompressed);
+    ASSERT_GT(stats.bytesSpilled, 0U);
+}
+
+/**
+ * Compares like IWComparator in ascending order once 'unblocked' is set.
+ */
+class BlockingIWComparator {
+public:
+    explicit BlockingIWComparator(Notification<void>* unblocked) : _unblocked(unblocked) {}
+    int operator()(const IWPair& lhs, const IWPair& rhs) const {
+        _unblocked->get();
+        return IWComparator(ASC)(lhs, rhs);
+    }
+
+private:
+    Notification<void>* _unblocked;
+};
+
+class ThrowingIWComparator {
+public:
+    int operator()(const IWPair& lhs, const IWPair& rhs) const {
+        uasserted(ErrorCodes::BadValue, "Cannot compare");
+    }
+};
+
+/**
+ * Runs sorters with parallel spills under a global ServiceContext, which owns the thread pool on
+ * which their runs are sorted.
+ */
+class SorterParallelSpillsTest : public ServiceContextTest {
+public:
+    // With three pending runs, each run is limited to a quarter of the memory limit, so that
+    // kNumItems make three runs and leave a few items in memory.
+    static constexpr size_t kMemLimit = 4 * 1024;
+    static constexpr int kNumItems = 400;
+
+    static SortOptions makeOptions(const unittest::TempDir& tempDir) {
+        return SortOptions()
+            .TempDir(tempDir.path())
+            .ExtSortAllowed()
+            .MaxMemoryUsageBytes(kMemLimit)
+            .ParallelSpills()
+            .MaxPendingRuns(3);
+    }
+
+    static void addItems(IWSorter* sorter) {
+        for (int i = kNumItems - 1; i >= 0; i--) {
+            sorter->add(i, -i);
+        }
+    }
+};
+
+TEST_F(SorterParallelSpillsTest, SorterKeepsAcceptingDataWhileRunsAreSorted) {
+    unittest::TempDir tempDir("sorterTests");
+    Notification<void> unblocked;
+    std::unique_ptr<IWSorter> sorter(
+        IWSorter::make(makeOptions(tempDir), BlockingIWComparator(&unblocked)));
+
+    // None of the three runs can be sorted yet, so none of them has been written.
+    addItems(sorter.get());
+    ASSERT_EQ(0U, sorter->numSpills());
+    ASSERT_EQ(0U, sorter->numSorted());
+
+    unblocked.set();
+    ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                std::make_shared<IntIterator>(0, kNumItems));
+    ASSERT_EQ(4U, sorter->numSpills());
+    ASSERT_EQ(static_cast<size_t>(kNumItems), sorter->numSorted());
+}
+
+TEST_F(SorterParallelSpillsTest, WaitingForARunIsInterruptible) {
+    unittest::TempDir tempDir("sorterTests");
+    auto opCtx = makeOperationContext();
+    Notification<void> unblocked;
+    std::unique_ptr<IWSorter> sorter(
+        IWSorter::make(makeOptions(tempDir), BlockingIWComparator(&unblocked)));
+
+    addItems(sorter.get());
+    opCtx->markKilled();
+    ASSERT_THROWS_CODE(sorter->done(), DBException, ErrorCodes::Interrupted);
+
+    // The sorter waits for the runs still being sorted when it is destroyed.
+    unblocked.set();
+}
+
+TEST_F(SorterParallelSpillsTest, ComparatorErrorsArePropagated) {
+    unittest::TempDir tempDir("sorterTests");
+    std::unique_ptr<IWSorter> sorter(IWSorter::make(makeOptions(tempDir), ThrowingIWComparator()));
+
+    // The error surfaces either when a later run is spilled or when the sort finishes.
+    ASSERT_THROWS_CODE(
+        [&] {
+            addItems(sorter.get());
+            delete sorter->done();
+        }(),
+        DBException,
+        ErrorCodes::BadValue);
+}
+
 }  // namespace
 }  // namespace sorter
 }  // namespace mongo
@@ -29,7 +29,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -430,6 +432,22 @@ public:
         return {};
     }
 
+    /**
+     * Returns up to 'numRanges - 1' RecordIds, in increasing order, that split this record store
+     * into 'numRanges' ranges of roughly equal size, so that the ranges can be scanned
+     * independently, e.g. by the producers of a parallel scan. The i-th range is the half-open
+     * interval [boundaries[i - 1], boundaries[i]); the first range is unbounded below and the last
+     * one is unbounded above.
+     *
+     * The boundaries are estimated from a sample of the record store and need not exist by the
+     * time the ranges are scanned. Fewer boundaries, possibly none, are returned when the record
+     * store is too small to split or does not support random cursors.
+     */
+    virtual std::vector<RecordId> getScanRangeBoundaries(OperationContext* opCtx,
+                                                         size_t numRanges) const {
+        return sampleScanRangeBoundaries(getRandomCursor(opCtx).get(), numRanges);
+    }
+
     // higher level
 
 
@@ -583,6 +601,44 @@ public:
     }
 
 protected:
+    // The number of records sampled per requested range when choosing scan range boundaries.
+    // Oversampling evens out the sizes of the ranges.
+    static constexpr size_t kScanRangeSamplesPerRange = 8;
+
+    /**
+     * Chooses the boundaries for getScanRangeBoundaries() from the first
+     * 'numRanges * kScanRangeSamplesPerRange' records returned by the random 'cursor'. Returns no
+     * boundaries if 'cursor' is null.
+     */
+    static std::vector<RecordId> sampleScanRangeBoundaries(RecordCursor* cursor,
+                                                           size_t numRanges) {
+        std::vector<RecordId> samples;
+        if (!cursor || numRanges < 2) {
+            return samples;
+        }
+
+        for (size_t i = 0; i < numRanges * kScanRangeSamplesPerRange; ++i) {
+            auto record = cursor->next();
+            if (!record) {
+                break;
+            }
+            samples.push_back(record->id);
+        }
+
+        // Random cursors may return the same record more than once.
+        std::sort(samples.begin(), samples.end());
+        samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+
+        std::vector<RecordId> boundaries;
+        for (size_t i = 1; i < numRanges; ++i) {
+            auto pos = i * samples.size() / numRanges;
+            if (pos > 0 && (boundaries.empty() || boundaries.back() < samples[pos])) {
+                boundaries.push_back(samples[pos]);
+            }
+        }
+        return boundaries;
+    }
+
     std::string _ns;
 };
 
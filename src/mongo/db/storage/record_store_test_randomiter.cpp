@@ -180,5 +180,57 @@ TEST(RecordStoreTestHarness, GetRandomIteratorSingleton) {
         }
     }
 }
+
+// An empty record store cannot be split into scan ranges.
+TEST(RecordStoreTestHarness, GetScanRangeBoundariesEmpty) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT(rs->getScanRangeBoundaries(opCtx.get(), 4).empty());
+}
+
+// Insert multiple records and split the record store into scan ranges. The boundaries must be
+// strictly increasing and no more than one fewer than the requested number of ranges.
+TEST(RecordStoreTestHarness, GetScanRangeBoundariesNonEmpty) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const unsigned nToInsert = 5000;
+    set<RecordId> locs;
+    for (unsigned i = 0; i < nToInsert; i++) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        stringstream ss;
+        ss << "record " << i;
+        string data = ss.str();
+
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res =
+            rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp());
+        ASSERT_OK(res.getStatus());
+        locs.insert(res.getValue());
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT(rs->getScanRangeBoundaries(opCtx.get(), 1).empty());
+
+    const size_t numRanges = 8;
+    auto boundaries = rs->getScanRangeBoundaries(opCtx.get(), numRanges);
+    // Returns no boundaries if the record store does not support random cursors.
+    if (!rs->getRandomCursor(opCtx.get())) {
+        ASSERT(boundaries.empty());
+        return;
+    }
+
+    ASSERT_FALSE(boundaries.empty());
+    ASSERT_LTE(boundaries.size(), numRanges - 1);
+    for (size_t i = 0; i < boundaries.size(); i++) {
+        ASSERT(locs.count(boundaries[i]));
+        if (i > 0) {
+            ASSERT_LT(boundaries[i - 1], boundaries[i]);
+        }
+    }
+}
 }  // namespace
 }  // namespace mongo
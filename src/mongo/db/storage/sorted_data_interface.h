@@ -294,6 +294,23 @@ public:
         virtual boost::optional<IndexKeyEntry> seek(const KeyString::Value& keyString,
                                                     RequestedInfo parts = kKeyAndLoc) = 0;
 
+        /**
+         * Equivalent to seekForKeyString() and seek() respectively, with a hint to the
+         * implementation that the cursor is moving through the index in its own direction, so
+         * that the provided keyString is often a short distance ahead of the current position.
+         * This is the case when visiting the intervals of index bounds in order, e.g. for large
+         * $in lists. Implementations may then reach the key by stepping from the current position
+         * rather than by searching for it from scratch.
+         */
+        virtual boost::optional<KeyStringEntry> seekForKeyStringNearby(
+            const KeyString::Value& keyString) {
+            return seekForKeyString(keyString);
+        }
+        virtual boost::optional<IndexKeyEntry> seekNearby(const KeyString::Value& keyString,
+                                                          RequestedInfo parts = kKeyAndLoc) {
+            return seek(keyString, parts);
+        }
+
         /**
          * Seeks to a key with a hint to the implementation that you only want exact matches. If
          * an exact match can't be found, boost::none will be returned and the resulting
@@ -0,0 +1,162 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+
+#include <memory>
+
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Tests that seekNearby() positions the cursor like seek() regardless of where the cursor was.
+void testSeekNearby(bool unique, bool forward) {
+    const auto harnessHelper = newSortedDataInterfaceHarnessHelper();
+    auto opCtx = harnessHelper->newOperationContext();
+    auto sorted = harnessHelper->newSortedDataInterface(unique,
+                                                        /*partial=*/false,
+                                                        {
+                                                            {key1, loc1},
+                                                            {key2, loc1},
+                                                            {key3, loc1},
+                                                            {key5, loc1},
+                                                            {key6, loc1},
+                                                        });
+
+    auto cursor = sorted->newCursor(opCtx.get(), forward);
+    auto seekKey = [&](const BSONObj& key, bool inclusive) {
+        return makeKeyStringForSeek(sorted.get(), key, forward, inclusive);
+    };
+
+    const auto& first = forward ? key1 : key6;
+    const auto& second = forward ? key2 : key5;
+    const auto& last = forward ? key6 : key1;
+
+    // An unpositioned cursor.
+    ASSERT_EQ(cursor->seekNearby(seekKey(first, true)), IndexKeyEntry(first, loc1));
+
+    // The next key.
+    ASSERT_EQ(cursor->seekNearby(seekKey(second, true)), IndexKeyEntry(second, loc1));
+
+    // A key which is not present lands on the following one.
+    ASSERT_EQ(cursor->seekNearby(seekKey(key4, true)),
+              IndexKeyEntry(forward ? key5 : key3, loc1));
+
+    // A key behind the current position.
+    ASSERT_EQ(cursor->seekNearby(seekKey(key3, true)), IndexKeyEntry(key3, loc1));
+
+    // Past the last key.
+    ASSERT_EQ(cursor->seekNearby(seekKey(last, false)), boost::none);
+
+    // From the end of the index.
+    ASSERT_EQ(cursor->seekNearby(seekKey(first, false)), IndexKeyEntry(second, loc1));
+    ASSERT_EQ(cursor->next(), IndexKeyEntry(key3, loc1));
+}
+TEST(SortedDataInterface, SeekNearby_Unique_Forward) {
+    testSeekNearby(true, true);
+}
+TEST(SortedDataInterface, SeekNearby_Unique_Reverse) {
+    testSeekNearby(true, false);
+}
+TEST(SortedDataInterface, SeekNearby_Standard_Forward) {
+    testSeekNearby(false, true);
+}
+TEST(SortedDataInterface, SeekNearby_Standard_Reverse) {
+    testSeekNearby(false, false);
+}
+
+// Tests seekNearby() to keys both close to and far from the current position of the cursor.
+void testSeekNearbyManyKeys(bool forward) {
+    const auto harnessHelper = newSortedDataInterfaceHarnessHelper();
+    auto opCtx = harnessHelper->newOperationContext();
+    auto sorted = harnessHelper->newSortedDataInterface(/*unique=*/false, /*partial=*/false);
+
+    const int kNumKeys = 200;
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < kNumKeys; ++i) {
+            ASSERT_OK(sorted->insert(
+                opCtx.get(), makeKeyString(sorted.get(), BSON("" << i * 2), loc1), true));
+        }
+        uow.commit();
+    }
+
+    auto cursor = sorted->newCursor(opCtx.get(), forward);
+    for (int step : {1, 3, 7, 20, 150}) {
+        for (int i = 0; i < kNumKeys; i += step) {
+            // Seek to odd values, which are not present, so that the cursor lands on the
+            // neighbouring even value.
+            const int target = forward ? 2 * i + 1 : 2 * (kNumKeys - i) - 1;
+            const int expected = forward ? target + 1 : target - 1;
+            auto entry = cursor->seekNearby(
+                makeKeyStringForSeek(sorted.get(), BSON("" << target), forward, true));
+            if (expected >= 2 * kNumKeys) {
+                ASSERT_EQ(entry, boost::none);
+            } else {
+                ASSERT_EQ(entry, IndexKeyEntry(BSON("" << expected), loc1));
+            }
+        }
+    }
+}
+TEST(SortedDataInterface, SeekNearby_ManyKeys_Forward) {
+    testSeekNearbyManyKeys(true);
+}
+TEST(SortedDataInterface, SeekNearby_ManyKeys_Reverse) {
+    testSeekNearbyManyKeys(false);
+}
+
+// Tests that seekNearby() respects the end position of the cursor.
+TEST(SortedDataInterface, SeekNearby_EndPosition) {
+    const auto harnessHelper = newSortedDataInterfaceHarnessHelper();
+    auto opCtx = harnessHelper->newOperationContext();
+    auto sorted = harnessHelper->newSortedDataInterface(/*unique=*/false,
+                                                        /*partial=*/false,
+                                                        {
+                                                            {key1, loc1},
+                                                            {key2, loc1},
+                                                            {key3, loc1},
+                                                            {key4, loc1},
+                                                        });
+
+    auto cursor = sorted->newCursor(opCtx.get());
+    cursor->setEndPosition(key3, /*inclusive=*/false);
+    ASSERT_EQ(cursor->seekNearby(makeKeyStringForSeek(sorted.get(), key1, true, true)),
+              IndexKeyEntry(key1, loc1));
+    ASSERT_EQ(cursor->seekNearby(makeKeyStringForSeek(sorted.get(), key2, true, true)),
+              IndexKeyEntry(key2, loc1));
+    ASSERT_EQ(cursor->seekNearby(makeKeyStringForSeek(sorted.get(), key3, true, true)),
+              boost::none);
+}
+
+}  // namespace
+}  // namespace mongo
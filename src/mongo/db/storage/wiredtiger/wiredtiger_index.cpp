@@ -51,6 +51,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_cursor_helpers.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -829,15 +830,22 @@ public:
         const KeyString::Value& keyStringValue) override {
         dassert(_opCtx->lockState()->isReadLocked());
         seekWTCursor(keyStringValue);
+        return finishSeek();
+    }
 
-        updatePosition();
-        if (_eof)
-            return {};
-
-        dassert(!atOrPastEndPointAfterSeeking());
-        dassert(!_id.isNull());
+    boost::optional<KeyStringEntry> seekForKeyStringNearby(
+        const KeyString::Value& keyStringValue) override {
+        dassert(_opCtx->lockState()->isReadLocked());
+        if (!stepWTCursorTo(keyStringValue)) {
+            seekWTCursor(keyStringValue);
+        }
+        return finishSeek();
+    }
 
-        return getKeyStringEntry();
+    boost::optional<IndexKeyEntry> seekNearby(const KeyString::Value& keyString,
+                                              RequestedInfo parts = kKeyAndLoc) override {
+        seekForKeyStringNearby(keyString);
+        return curr(parts);
     }
 
     boost::optional<KeyStringEntry> seekExactForKeyString(const KeyString::Value& key) override {
@@ -1105,6 +1113,62 @@ protected:
         return false;
     }
 
+    // Updates our cached position after the cursor was moved by a seek, and returns the entry it
+    // landed on.
+    boost::optional<KeyStringEntry> finishSeek() {
+        updatePosition();
+        if (_eof)
+            return {};
+
+        dassert(!atOrPastEndPointAfterSeeking());
+        dassert(!_id.isNull());
+
+        return getKeyStringEntry();
+    }
+
+    // Tries to position the cursor like seekWTCursor() would, by stepping forward from the current
+    // position over at most 'wiredTigerIndexCursorMaxStepsBeforeSeek' keys. This is cheaper than a
+    // search from the root when the query is close ahead, typically on the same page. Returns false
+    // if the cursor could not be positioned this way, in which case the caller must seek instead.
+    bool stepWTCursorTo(const KeyString::Value& query) {
+        const int maxSteps = gWiredTigerIndexCursorMaxStepsBeforeSeek.load();
+        if (maxSteps <= 0 || _eof || _lastMoveSkippedKey) {
+            return false;
+        }
+
+        // Stepping is only possible if the query is ahead of the current position.
+        const int cmpCurrent = KeyString::compare(
+            _key.getBuffer(), query.getBuffer(), _key.getSize(), query.getSize());
+        if (_forward ? cmpCurrent >= 0 : cmpCurrent <= 0) {
+            return false;
+        }
+
+        // Ensure an active transaction is open.
+        WiredTigerRecoveryUnit::get(_opCtx)->getSession();
+
+        WT_CURSOR* c = _cursor->get();
+        WT_ITEM curKey;
+        for (int i = 0; i < maxSteps; ++i) {
+            advanceWTCursor();
+            if (_cursorAtEof) {
+                // There is no key at or ahead of the query.
+                return true;
+            }
+
+            getKey(c, &curKey);
+            const int cmp = KeyString::compare(static_cast<const char*>(curKey.data),
+                                               query.getBuffer(),
+                                               curKey.size,
+                                               query.getSize());
+            if (_forward ? cmp >= 0 : cmp <= 0) {
+                LOGV2_TRACE_CURSOR(
+                    6001600, "reached seek key after {steps} steps", "steps"_attr = i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
     /**
      * This must be called after moving the cursor to update our cached position. It should not
      * be called after a restore that did not restore to original state since that does not
@@ -1576,6 +1576,21 @@ std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
     return std::make_unique<RandomCursor>(opCtx, *this, "");
 }
 
+std::vector<RecordId> WiredTigerRecordStore::getScanRangeBoundaries(OperationContext* opCtx,
+                                                                    size_t numRanges) const {
+    if (numRanges < 2) {
+        return {};
+    }
+
+    // With 'next_random_sample_size', WiredTiger divides the table into that many equally sized
+    // pieces and returns each sample from a different piece. This spreads the samples evenly over
+    // the key space, rather than relying on a random walk of the tree.
+    const std::string config = str::stream()
+        << "next_random_sample_size=" << numRanges * kScanRangeSamplesPerRange;
+    RandomCursor cursor(opCtx, *this, config);
+    return sampleScanRangeBoundaries(&cursor, numRanges);
+}
+
 Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
     WiredTigerCursor startWrap(_uri, _tableId, true, opCtx);
     WT_CURSOR* start = startWrap.get();
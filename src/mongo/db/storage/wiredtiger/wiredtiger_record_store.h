@@ -170,6 +170,9 @@ public:
 
     std::unique_ptr<RecordCursor> getRandomCursor(OperationContext* opCtx) const final;
 
+    std::vector<RecordId> getScanRangeBoundaries(OperationContext* opCtx,
+                                                 size_t numRanges) const final;
+
     virtual Status truncate(OperationContext* opCtx);
 
     virtual bool compactSupported() const {
@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests the SBE lowering of EqLookupNode against real collections.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/planner_analysis.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/stage_builder_util.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kLocalNss("unittests.QueryStageEqLookupLocal");
+const NamespaceString kForeignNss("unittests.QueryStageEqLookupForeign");
+
+class QueryStageEqLookupTest : public unittest::Test {
+public:
+    QueryStageEqLookupTest() : _client(_opCtx.get()) {
+        dropCollections();
+
+        insert(kLocalNss, BSON("_id" << 0 << "a" << 1));
+        insert(kLocalNss, BSON("_id" << 1 << "a" << 2));
+        insert(kLocalNss, BSON("_id" << 2 << "a" << BSON_ARRAY(1 << 3)));
+        insert(kLocalNss, BSON("_id" << 3 << "a" << 4));
+        insert(kLocalNss, BSON("_id" << 4));
+
+        insert(kForeignNss, BSON("_id" << 0 << "b" << 1));
+        insert(kForeignNss, BSON("_id" << 1 << "b" << 1));
+        insert(kForeignNss, BSON("_id" << 2 << "b" << 3));
+        insert(kForeignNss, BSON("_id" << 3 << "b" << 4));
+        insert(kForeignNss, BSON("_id" << 4 << "b" << BSON_ARRAY(3 << 4)));
+        insert(kForeignNss, BSON("_id" << 5 << "b" << BSONNULL));
+        insert(kForeignNss, BSON("_id" << 6 << "b" << 5));
+    }
+
+    ~QueryStageEqLookupTest() {
+        dropCollections();
+    }
+
+    void dropCollections() {
+        for (auto&& nss : {kLocalNss, kForeignNss}) {
+            dbtests::WriteContextForTests ctx(_opCtx.get(), nss.ns());
+            _client.dropCollection(nss.ns());
+        }
+    }
+
+    void insert(const NamespaceString& nss, const BSONObj& obj) {
+        dbtests::WriteContextForTests ctx(_opCtx.get(), nss.ns());
+        _client.insert(nss.ns(), obj);
+    }
+
+    void addForeignIndex(const BSONObj& keyPattern) {
+        ASSERT_OK(dbtests::createIndex(_opCtx.get(), kForeignNss.ns(), keyPattern));
+    }
+
+    /**
+     * Runs an equality $lookup of the local field 'a' against the foreign field 'b' with the given
+     * strategy, seeking the foreign index with 'foreignIndexKeyPattern' for an indexed loop join.
+     * Returns the '_id's of the foreign documents matched by each local document.
+     */
+    std::map<int, std::vector<int>> runLookup(
+        EqLookupNode::LookupStrategy strategy,
+        boost::optional<BSONObj> foreignIndexKeyPattern = boost::none) {
+        AutoGetCollectionForReadCommand localColl(_opCtx.get(), kLocalNss);
+        Lock::CollectionLock foreignLock(_opCtx.get(), kForeignNss, MODE_IS);
+
+        auto findCommand = std::make_unique<FindCommandRequest>(kLocalNss);
+        auto cq = uassertStatusOK(
+            CanonicalQuery::canonicalize(_opCtx.get(),
+                                         std::move(findCommand),
+                                         false /* explain */,
+                                         nullptr /* expCtx */,
+                                         ExtensionsCallbackReal(_opCtx.get(), &kLocalNss)));
+
+        boost::optional<IndexEntry> foreignIndex;
+        if (foreignIndexKeyPattern) {
+            auto foreignColl = CollectionCatalog::get(_opCtx.get())
+                                   ->lookupCollectionByNamespace(_opCtx.get(), kForeignNss);
+            std::vector<const IndexDescriptor*> indexes;
+            foreignColl->getIndexCatalog()->findIndexesByKeyPattern(
+                _opCtx.get(), *foreignIndexKeyPattern, false, &indexes);
+            ASSERT_EQ(indexes.size(), 1U);
+            foreignIndex = indexEntryFromIndexCatalogEntry(
+                _opCtx.get(), foreignColl, *foreignColl->getIndexCatalog()->getEntry(indexes[0]));
+        }
+
+        auto solution = std::make_unique<QuerySolution>();
+        auto scanNode = std::make_unique<CollectionScanNode>();
+        scanNode->name = kLocalNss.ns();
+        solution->setRoot(std::make_unique<EqLookupNode>(std::move(scanNode),
+                                                         kForeignNss,
+                                                         FieldPath{"a"},
+                                                         FieldPath{"b"},
+                                                         FieldPath{"out"},
+                                                         strategy,
+                                                         std::move(foreignIndex)));
+
+        PlanYieldPolicySBE yieldPolicy(PlanYieldPolicy::YieldPolicy::NO_YIELD,
+                                       _opCtx->getServiceContext()->getFastClockSource(),
+                                       0,
+                                       Milliseconds::zero(),
+                                       nullptr,
+                                       nullptr);
+        auto [stage, data] = stage_builder::buildSlotBasedExecutableTree(
+            _opCtx.get(), localColl.getCollection(), *cq, *solution, &yieldPolicy);
+        stage->prepare(data.ctx);
+        auto resultAccessor =
+            stage->getAccessor(data.ctx, data.outputs.get(stage_builder::PlanStageSlots::kResult));
+        stage->open(false);
+
+        std::map<int, std::vector<int>> results;
+        while (stage->getNext() == sbe::PlanState::ADVANCED) {
+            auto [tag, val] = resultAccessor->getViewOfValue();
+            ASSERT(tag == sbe::value::TypeTags::bsonObject);
+            BSONObj doc{sbe::value::bitcastTo<const char*>(val)};
+
+            auto& matches = results[doc["_id"].numberInt()];
+            for (auto&& match : doc["out"].Obj()) {
+                matches.push_back(match["_id"].numberInt());
+            }
+            std::sort(matches.begin(), matches.end());
+        }
+        stage->close();
+        return results;
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _opCtx = cc().makeOperationContext();
+    DBDirectClient _client;
+
+    // Missing and null local values match null and missing foreign values.
+    const std::map<int, std::vector<int>> _expected{
+        {0, {0, 1}}, {1, {}}, {2, {0, 1, 2, 4}}, {3, {3, 4}}, {4, {5}}};
+};
+
+TEST_F(QueryStageEqLookupTest, NestedLoopJoin) {
+    ASSERT(runLookup(EqLookupNode::LookupStrategy::kNestedLoopJoin) == _expected);
+}
+
+TEST_F(QueryStageEqLookupTest, HashJoin) {
+    ASSERT(runLookup(EqLookupNode::LookupStrategy::kHashJoin) == _expected);
+}
+
+TEST_F(QueryStageEqLookupTest, IndexedLoopJoinOnAscendingIndex) {
+    addForeignIndex(BSON("b" << 1));
+    ASSERT(runLookup(EqLookupNode::LookupStrategy::kIndexedLoopJoin, BSON("b" << 1)) ==
+           _expected);
+}
+
+TEST_F(QueryStageEqLookupTest, IndexedLoopJoinOnDescendingIndex) {
+    addForeignIndex(BSON("b" << -1));
+    ASSERT(runLookup(EqLookupNode::LookupStrategy::kIndexedLoopJoin, BSON("b" << -1)) ==
+           _expected);
+}
+
+TEST_F(QueryStageEqLookupTest, IndexedLoopJoinOnCompoundDescendingIndex) {
+    addForeignIndex(BSON("b" << -1 << "_id" << 1));
+    ASSERT(runLookup(EqLookupNode::LookupStrategy::kIndexedLoopJoin,
+                     BSON("b" << -1 << "_id" << 1)) == _expected);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -84,6 +84,13 @@ public:
         _arm.addNewShardCursors(std::move(newCursors));
     }
 
+    /**
+     * Requests more results from the remotes which have none buffered, without waiting for them.
+     */
+    Status scheduleGetMores() {
+        return _arm.scheduleGetMores();
+    }
+
     /**
      * Blocks until '_arm' has been killed, which involves cleaning up any remote cursors managed
      * by this results merger.
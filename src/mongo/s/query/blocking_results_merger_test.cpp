@@ -52,6 +52,33 @@ TEST_F(ResultsMergerTestFixture, ShouldBeAbleToBlockUntilKilled) {
     blockingMerger.kill(operationContext());
 }
 
+TEST_F(ResultsMergerTestFixture, ShouldScheduleGetMoresWithoutWaiting) {
+    std::vector<RemoteCursor> cursors;
+    cursors.emplace_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 1, {})));
+    BlockingResultsMerger blockingMerger(operationContext(),
+                                         makeARMParamsFromExistingCursors(std::move(cursors)),
+                                         executor(),
+                                         nullptr);
+
+    // The getMore is sent before anything asks for the next result.
+    ASSERT_OK(blockingMerger.scheduleGetMores());
+    onCommand([&](const auto& request) {
+        ASSERT(request.cmdObj["getMore"]);
+        return CursorResponse(kTestNss, 0LL, {BSON("x" << 1)})
+            .toBSON(CursorResponse::ResponseType::SubsequentResponse);
+    });
+
+    auto future = launchAsync([&]() {
+        auto next = unittest::assertGet(blockingMerger.next(operationContext()));
+        ASSERT_FALSE(next.isEOF());
+        ASSERT_BSONOBJ_EQ(*next.getResult(), BSON("x" << 1));
+        next = unittest::assertGet(blockingMerger.next(operationContext()));
+        ASSERT_TRUE(next.isEOF());
+    });
+    future.default_timed_get();
+}
+
 TEST_F(ResultsMergerTestFixture, ShouldBeAbleToBlockUntilDeadlineExpires) {
     // Set the deadline to be two seconds in the future. We always test that the deadline
     // expires, so there's no racing.
@@ -100,6 +100,13 @@ std::unique_ptr<RouterStageMerge> DocumentSourceMergeCursors::convertToRouterSta
         pExpCtx->opCtx, pExpCtx->mongoProcessInterface->taskExecutor, std::move(*_armParams));
 }
 
+void DocumentSourceMergeCursors::prefetch() {
+    if (!_blockingResultsMerger) {
+        populateMerger();
+    }
+    uassertStatusOK(_blockingResultsMerger->scheduleGetMores());
+}
+
 DocumentSource::GetNextResult DocumentSourceMergeCursors::doGetNext() {
     if (!_blockingResultsMerger) {
         populateMerger();
@@ -148,6 +148,12 @@ public:
         _ownCursors = false;
     }
 
+    /**
+     * Takes ownership of the remote cursors and requests their next batches, so that results are
+     * on their way before the first call to getNext().
+     */
+    void prefetch() final;
+
 protected:
     GetNextResult doGetNext() final;
     void doDispose() final;
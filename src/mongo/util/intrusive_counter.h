@@ -70,7 +70,12 @@ public:
     };
 
     friend void intrusive_ptr_release(const RefCountable* ptr) {
-        if (ptr->_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // If the count is one, the caller holds the only reference, so no other thread can be
+        // adding or dropping one concurrently and the atomic decrement can be skipped. This is the
+        // common case for objects which never leave the thread that created them. The load must
+        // be acquire for the same reason as in isShared().
+        if (ptr->_count.load(std::memory_order_acquire) == 1 ||
+            ptr->_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             delete ptr;
         }
     };